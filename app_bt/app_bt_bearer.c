@@ -0,0 +1,468 @@
+/*******************************************************************************
+ * File Name: app_bt_bearer.c
+ *
+ * Description: This file keeps the state of every ATT bearer and
+ *              maps traffic classes to bearers. With APP_BT_EATT_SUPPORT it also
+ *              sets up the Enhanced ATT bearers of each link.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "GeneratedSource/cycfg_gatt_db.h"
+#include "app_bt_utils.h"
+#include "app_bt_bearer.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+#if APP_BT_EATT_SUPPORT
+#include "wiced_bt_eatt.h"
+#endif
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Default ATT MTU until the peer negotiates a larger one */
+#define APP_BT_BEARER_DEFAULT_MTU       (23u)
+
+#if APP_BT_EATT_SUPPORT
+/* MTU offered on the enhanced bearers, EATT requires at least 64 */
+#define APP_BT_EATT_MTU                 (CY_BT_MTU_SIZE)
+
+/* Receive buffers the stack keeps per enhanced bearer */
+#define APP_BT_EATT_RX_BUFF_COUNT       (2u)
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Bearer table, one slot per ATT bearer of every link
+ */
+static app_bt_bearer_t app_bt_bearer_table[APP_BT_MAX_BEARERS];
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_bearer_add
+*
+* Function Description:
+* @brief  Stores a new bearer of a link. The unenhanced bearer is added with
+*         bearer_id equal to conn_id. Each enhanced bearer takes over the
+*         first traffic class that has no enhanced bearer yet.
+*
+* @param conn_id      conn_id of the unenhanced bearer of the link
+*
+* @param bearer_id    GATT conn_id of the new bearer
+*
+* @param mtu          ATT MTU of the new bearer
+*
+* @return app_bt_bearer_t*  Bearer slot, NULL if the table is full
+*/
+app_bt_bearer_t *app_bt_bearer_add(uint16_t conn_id, uint16_t bearer_id, uint16_t mtu)
+{
+    app_bt_bearer_t *p_bearer = NULL;
+    uint8_t used_mask = 0;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_BEARERS; i++)
+    {
+        if ((NULL == p_bearer) && (0 == app_bt_bearer_table[i].bearer_id))
+        {
+            p_bearer = &app_bt_bearer_table[i];
+        }
+        else if ((app_bt_bearer_table[i].conn_id == conn_id) &&
+                 (app_bt_bearer_table[i].bearer_id != conn_id))
+        {
+            used_mask |= app_bt_bearer_table[i].traffic_mask;
+        }
+    }
+
+    if (NULL != p_bearer)
+    {
+        memset(p_bearer, 0, sizeof(*p_bearer));
+        p_bearer->bearer_id = bearer_id;
+        p_bearer->conn_id = conn_id;
+        p_bearer->mtu = (0 != mtu) ? mtu : APP_BT_BEARER_DEFAULT_MTU;
+
+        if (bearer_id != conn_id)
+        {
+            for (uint8_t traffic = 0; traffic < APP_BT_TRAFFIC_COUNT; traffic++)
+            {
+                if (0 == (used_mask & (1u << traffic)))
+                {
+                    p_bearer->traffic_mask = (uint8_t)(1u << traffic);
+                    break;
+                }
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return p_bearer;
+}
+
+/**
+* Function Name:
+* app_bt_bearer_remove
+*
+* Function Description:
+* @brief  Releases one bearer. Its traffic falls back to the unenhanced bearer.
+*
+* @param bearer_id    GATT conn_id of the bearer
+*
+* @return void
+*/
+void app_bt_bearer_remove(uint16_t bearer_id)
+{
+    app_bt_bearer_t *p_bearer = app_bt_bearer_find(bearer_id);
+
+    if (NULL != p_bearer)
+    {
+        taskENTER_CRITICAL();
+        memset(p_bearer, 0, sizeof(*p_bearer));
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bearer_remove_conn
+*
+* Function Description:
+* @brief  Releases every bearer of a link that went down
+*
+* @param conn_id      conn_id of the unenhanced bearer of the link
+*
+* @return void
+*/
+void app_bt_bearer_remove_conn(uint16_t conn_id)
+{
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_BEARERS; i++)
+    {
+        if (app_bt_bearer_table[i].conn_id == conn_id)
+        {
+            memset(&app_bt_bearer_table[i], 0, sizeof(app_bt_bearer_table[i]));
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_bearer_find
+*
+* Function Description:
+* @brief  Looks up a bearer
+*
+* @param bearer_id    GATT conn_id of the bearer
+*
+* @return app_bt_bearer_t*  Bearer slot, NULL if unknown
+*/
+app_bt_bearer_t *app_bt_bearer_find(uint16_t bearer_id)
+{
+    if (0 == bearer_id)
+    {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < APP_BT_MAX_BEARERS; i++)
+    {
+        if (app_bt_bearer_table[i].bearer_id == bearer_id)
+        {
+            return &app_bt_bearer_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+* Function Name:
+* app_bt_bearer_conn_id
+*
+* Function Description:
+* @brief  Maps any bearer of a link to the conn_id of its unenhanced bearer,
+*         which is the key of the connection table
+*
+* @param bearer_id    GATT conn_id of the bearer
+*
+* @return uint16_t    conn_id of the link, 0 if the bearer is unknown
+*/
+uint16_t app_bt_bearer_conn_id(uint16_t bearer_id)
+{
+    app_bt_bearer_t *p_bearer = app_bt_bearer_find(bearer_id);
+
+    return (NULL != p_bearer) ? p_bearer->conn_id : 0;
+}
+
+/**
+* Function Name:
+* app_bt_bearer_for_traffic
+*
+* Function Description:
+* @brief  Picks the bearer that carries a traffic class on a link. Without an
+*         enhanced bearer for the class, the unenhanced bearer is used.
+*
+* @param bearer_id    Any bearer of the link
+*
+* @param traffic      Traffic class of the PDU to send
+*
+* @return uint16_t    GATT conn_id to send on
+*/
+uint16_t app_bt_bearer_for_traffic(uint16_t bearer_id, app_bt_traffic_t traffic)
+{
+    uint16_t conn_id = app_bt_bearer_conn_id(bearer_id);
+
+    if (0 == conn_id)
+    {
+        return bearer_id;
+    }
+    for (uint8_t i = 0; i < APP_BT_MAX_BEARERS; i++)
+    {
+        if ((app_bt_bearer_table[i].conn_id == conn_id) &&
+            (app_bt_bearer_table[i].traffic_mask & (1u << traffic)))
+        {
+            return app_bt_bearer_table[i].bearer_id;
+        }
+    }
+    return conn_id;
+}
+
+/**
+* Function Name:
+* app_bt_bearer_mtu
+*
+* Function Description:
+* @brief  Returns the ATT MTU of a bearer
+*
+* @param bearer_id    GATT conn_id of the bearer
+*
+* @return uint16_t    ATT MTU, default MTU if the bearer is unknown
+*/
+uint16_t app_bt_bearer_mtu(uint16_t bearer_id)
+{
+    app_bt_bearer_t *p_bearer = app_bt_bearer_find(bearer_id);
+
+    return (NULL != p_bearer) ? p_bearer->mtu : APP_BT_BEARER_DEFAULT_MTU;
+}
+
+/**
+* Function Name:
+* app_bt_bearer_traffic_of_handle
+*
+* Function Description:
+* @brief  Returns the traffic class of a characteristic value
+*
+* @param attr_handle  Handle of the characteristic value
+*
+* @return app_bt_traffic_t  Traffic class
+*/
+app_bt_traffic_t app_bt_bearer_traffic_of_handle(uint16_t attr_handle)
+{
+    switch (attr_handle)
+    {
+    case HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_DATA_VALUE:
+        return APP_BT_TRAFFIC_OTA_DATA;
+    case HDLC_BAS_BATTERY_LEVEL_VALUE:
+    case HDLC_HISTORY_BATTERY_HISTORY_VALUE:
+        return APP_BT_TRAFFIC_BATTERY;
+    default:
+        return APP_BT_TRAFFIC_CONTROL;
+    }
+}
+
+#if APP_BT_EATT_SUPPORT
+/**
+* Function Name:
+* app_bt_eatt_connect_ind_cb
+*
+* Function Description:
+* @brief  Accepts the enhanced bearers a central asks for, up to the number
+*         of traffic classes
+*
+* @param p_ind        EATT connection request from the peer
+*
+* @return void
+*/
+static void app_bt_eatt_connect_ind_cb(wiced_bt_eatt_connection_indication_event_t *p_ind)
+{
+    wiced_bt_eatt_connection_response_t rsp;
+    wiced_bt_eatt_bearers_t bearers;
+
+    memset(&rsp, 0, sizeof(rsp));
+    memcpy(rsp.bdaddr, p_ind->bdaddr, BD_ADDR_LEN);
+    rsp.trans_id = p_ind->trans_id;
+    rsp.mtu = APP_BT_EATT_MTU;
+    rsp.num_bearers = MIN(p_ind->num_bearers, APP_BT_EATT_BEARERS_PER_CONN);
+    rsp.result = (0 != rsp.num_bearers) ? L2CAP_LE_RESULT_CONN_OK :
+                                          L2CAP_LE_RESULT_NO_RESOURCES;
+
+    APP_LOG_INFO("EATT request for %d bearers, accepting %d \r\n",
+           p_ind->num_bearers, rsp.num_bearers);
+    wiced_bt_eatt_connect_response(&rsp, bearers);
+}
+
+/**
+* Function Name:
+* app_bt_eatt_connect_cmpl_cb
+*
+* Function Description:
+* @brief  Adds an enhanced bearer once it is up
+*
+* @param p_data       EATT bearer that completed setup
+*
+* @return void
+*/
+static void app_bt_eatt_connect_cmpl_cb(wiced_bt_eatt_connection_data_t *p_data)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find_by_addr(p_data->bdaddr);
+    app_bt_bearer_t *p_bearer;
+
+    if ((WICED_BT_SUCCESS != p_data->result) || (NULL == p_conn))
+    {
+        APP_LOG_ERR("EATT bearer setup failed: %d \r\n", p_data->result);
+        return;
+    }
+
+    p_bearer = app_bt_bearer_add(p_conn->conn_id, p_data->conn_id, p_data->mtu);
+    if (NULL == p_bearer)
+    {
+        APP_LOG_WARNING("Bearer table full, releasing EATT bearer 0x%x \r\n", p_data->conn_id);
+        wiced_bt_gatt_disconnect(p_data->conn_id);
+        return;
+    }
+    APP_LOG_INFO("EATT bearer 0x%x up on conn_id %d, mtu %d, traffic 0x%x \r\n",
+           p_data->conn_id, p_conn->conn_id, p_bearer->mtu, p_bearer->traffic_mask);
+}
+
+/**
+* Function Name:
+* app_bt_eatt_reconfigure_ind_cb
+*
+* Function Description:
+* @brief  Tracks an MTU change requested by the peer on an enhanced bearer
+*
+* @param p_data       Reconfigured bearer
+*
+* @return void
+*/
+static void app_bt_eatt_reconfigure_ind_cb(wiced_bt_eatt_reconfig_data_t *p_data)
+{
+    app_bt_bearer_t *p_bearer = app_bt_bearer_find(p_data->conn_id);
+
+    if (NULL != p_bearer)
+    {
+        p_bearer->mtu = p_data->mtu;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_eatt_release_cb
+*
+* Function Description:
+* @brief  Drops an enhanced bearer that was released
+*
+* @param bearer_id    GATT conn_id of the bearer
+*
+* @param reason       Release reason
+*
+* @return void
+*/
+static void app_bt_eatt_release_cb(uint16_t bearer_id, uint16_t reason)
+{
+    APP_LOG_INFO("EATT bearer 0x%x released, reason %d \r\n", bearer_id, reason);
+    app_bt_bearer_remove(bearer_id);
+}
+
+/**
+* Function Name:
+* app_bt_eatt_init
+*
+* Function Description:
+* @brief  Registers with the stack for Enhanced ATT bearers
+*
+* @return void
+*/
+void app_bt_eatt_init(void)
+{
+    static wiced_bt_eatt_callbacks_t eatt_cb =
+    {
+        .p_eatt_connect_ind_cb       = app_bt_eatt_connect_ind_cb,
+        .p_eatt_connect_cmpl_cb      = app_bt_eatt_connect_cmpl_cb,
+        .p_eatt_reconfigure_cmpl_cb  = app_bt_eatt_reconfigure_ind_cb,
+        .p_eatt_reconfigure_ind_cb   = app_bt_eatt_reconfigure_ind_cb,
+        .p_eatt_release_cb           = app_bt_eatt_release_cb,
+    };
+    wiced_bt_gatt_status_t status;
+
+    status = wiced_bt_eatt_register(&eatt_cb, APP_BT_EATT_MTU,
+                                    APP_BT_EATT_BEARERS_PER_CONN,
+                                    APP_BT_EATT_RX_BUFF_COUNT);
+    APP_LOG_INFO("EATT registration status: %s \r\n", get_bt_gatt_status_name(status));
+}
+
+/**
+* Function Name:
+* app_bt_eatt_connect
+*
+* Function Description:
+* @brief  Opens the enhanced bearers of a link. EATT runs over an encrypted
+*         link only, so this is called once encryption is on.
+*
+* @param bd_addr      Peer address of the link
+*
+* @return void
+*/
+void app_bt_eatt_connect(wiced_bt_device_address_t bd_addr)
+{
+    wiced_bt_eatt_bearers_t bearers;
+    wiced_result_t result;
+
+    result = wiced_bt_eatt_connect(bd_addr, APP_BT_EATT_BEARERS_PER_CONN, bearers);
+    if (WICED_BT_SUCCESS != result)
+    {
+        APP_LOG_ERR("EATT connect failed: %d \r\n", result);
+    }
+}
+#endif /* APP_BT_EATT_SUPPORT */
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * File Name: app_bt_bearer.h
+ *
+ * Description: This file is the public interface of app_bt_bearer.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_BEARER_H__
+#define APP_BT_BEARER_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "wiced_bt_gatt.h"
+#include "app_bt_conn.h"
+#include "app_ota_context.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#ifndef APP_BT_EATT_SUPPORT
+#define APP_BT_EATT_SUPPORT             (0)
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Classes of server initiated traffic. With EATT each class gets its
+ *        own bearer so one class never waits behind another.
+ */
+typedef enum
+{
+    APP_BT_TRAFFIC_OTA_DATA = 0,    /* OTA data characteristic */
+    APP_BT_TRAFFIC_CONTROL,         /* OTA control point notifications/indications */
+    APP_BT_TRAFFIC_BATTERY,         /* Battery level and history notifications */
+    APP_BT_TRAFFIC_COUNT
+} app_bt_traffic_t;
+
+#if APP_BT_EATT_SUPPORT
+/* One enhanced bearer per traffic class */
+#define APP_BT_EATT_BEARERS_PER_CONN    ((uint8_t)APP_BT_TRAFFIC_COUNT)
+#else
+#define APP_BT_EATT_BEARERS_PER_CONN    (0u)
+#endif
+
+/* The unenhanced bearer plus the enhanced ones */
+#define APP_BT_BEARERS_PER_CONN         (1u + APP_BT_EATT_BEARERS_PER_CONN)
+#define APP_BT_MAX_BEARERS              (APP_BT_MAX_CONNECTIONS * APP_BT_BEARERS_PER_CONN)
+
+/**
+ * @brief State kept per ATT bearer. Requests from the peer are answered on
+ *        the bearer they arrived on, so request state lives here.
+ */
+typedef struct
+{
+    uint16_t                bearer_id;      /* GATT conn_id of the bearer, 0 when free */
+    uint16_t                conn_id;        /* conn_id of the unenhanced bearer of the link */
+    uint16_t                mtu;            /* ATT MTU of this bearer */
+    uint8_t                 traffic_mask;   /* Bit n set: traffic class n uses this bearer */
+    gatt_write_req_buf_t    write_buff;     /* Prepare Write queue of this bearer */
+} app_bt_bearer_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+app_bt_bearer_t        *app_bt_bearer_add        (uint16_t conn_id, uint16_t bearer_id,
+                                                  uint16_t mtu);
+void                    app_bt_bearer_remove     (uint16_t bearer_id);
+void                    app_bt_bearer_remove_conn(uint16_t conn_id);
+app_bt_bearer_t        *app_bt_bearer_find       (uint16_t bearer_id);
+uint16_t                app_bt_bearer_conn_id    (uint16_t bearer_id);
+uint16_t                app_bt_bearer_for_traffic(uint16_t bearer_id, app_bt_traffic_t traffic);
+uint16_t                app_bt_bearer_mtu        (uint16_t bearer_id);
+app_bt_traffic_t        app_bt_bearer_traffic_of_handle(uint16_t attr_handle);
+
+#if APP_BT_EATT_SUPPORT
+void                    app_bt_eatt_init         (void);
+void                    app_bt_eatt_connect      (wiced_bt_device_address_t bd_addr);
+#endif
+
+#endif
+/* [] END OF FILE */
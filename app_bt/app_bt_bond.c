@@ -0,0 +1,919 @@
+/*******************************************************************************
+ * File Name: app_bt_bond.c
+ *
+ * Description: Log-structured flash store of the bond records and
+ *              local identity keys, loaded into RAM at boot
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "cy_ota_api.h"
+#include "cy_ota_flash.h"
+#include "cy_device_headers.h"
+#include "app_ota_storage.h"
+#include "app_bt_bond.h"
+#include "app_bt_utils.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_BT_BOND_MAGIC               (0x444E4F42u)   /* "BOND" */
+
+/* Record types. An erased header reads as APP_BT_BOND_REC_FREE. */
+#define APP_BT_BOND_REC_LOCAL_KEYS      (0x01u)
+#define APP_BT_BOND_REC_LINK_KEYS       (0x02u)
+#define APP_BT_BOND_REC_DELETE          (0x03u)
+#define APP_BT_BOND_REC_FREE            (0xFFu)
+
+/* Records start on a word boundary */
+#define APP_BT_BOND_ALIGN(len)          (((len) + 3u) & ~3u)
+
+#define APP_BT_BOND_PAYLOAD_MAX         (sizeof(wiced_bt_device_link_keys_t))
+
+#define APP_BT_BOND_SECTOR(index)       (APP_BT_BOND_FLASH_OFFSET + \
+                                         ((uint32_t)(index) * APP_BT_BOND_SECTOR_SIZE))
+
+/* Byte address of an external flash offset in the XIP window */
+#define APP_BT_BOND_XIP(offset)         ((const uint8_t *)(CY_XIP_BASE + (offset)))
+
+/* Records waiting for the storage task. More changes than this before it
+ * runs rewrite the whole RAM index instead. */
+#define APP_BT_BOND_PENDING             (4u)
+
+/* Delay before a failed flash write is tried again */
+#define APP_BT_BOND_RETRY_MS            (5000u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Header at the start of the active sector, written last so that a
+ *        sector being filled by a compaction is not taken for a valid one
+ */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    seq;            /* Higher in the sector written last */
+} app_bt_bond_sector_t;
+
+/**
+ * @brief Header of a record appended to the active sector
+ */
+typedef struct
+{
+    uint8_t     type;
+    uint8_t     reserved;
+    uint16_t    len;            /* Payload bytes, before alignment */
+    uint32_t    crc;            /* CRC-32 of the payload */
+} app_bt_bond_rec_t;
+
+/**
+ * @brief Record waiting to be appended by the storage task
+ */
+typedef struct
+{
+    uint8_t     type;
+    uint16_t    len;
+    uint8_t     payload[APP_BT_BOND_PAYLOAD_MAX];
+} app_bt_bond_op_t;
+
+CY_STATIC_ASSERT(sizeof(wiced_bt_local_identity_keys_t) <= APP_BT_BOND_PAYLOAD_MAX,
+                 "Local keys do not fit a record");
+
+/* Everything live must fit in one sector with room for updates */
+CY_STATIC_ASSERT((sizeof(app_bt_bond_sector_t) +
+                  (APP_BT_BOND_MAX + 1u) * (sizeof(app_bt_bond_rec_t) +
+                  APP_BT_BOND_ALIGN(APP_BT_BOND_PAYLOAD_MAX))) <= (APP_BT_BOND_SECTOR_SIZE / 2u),
+                 "Bond store does not fit in half a sector");
+
+/**
+ * @brief In-RAM index, a copy of every live record. Bonds are ordered from
+ *        the most to the least recently used; the flash is only read at boot.
+ */
+static wiced_bt_device_link_keys_t      app_bt_bond_table[APP_BT_BOND_MAX];
+static uint8_t                          app_bt_bond_num;
+static wiced_bt_local_identity_keys_t   app_bt_bond_local_keys;
+static bool                             app_bt_bond_local_valid;
+
+/* Active sector, its sequence number and the offset of the next record.
+ * Only the storage task uses them after app_bt_bond_init(). */
+static uint8_t                          app_bt_bond_active;
+static uint32_t                         app_bt_bond_seq;
+static uint32_t                         app_bt_bond_wr;
+
+/* Set when the active sector cannot take a record where app_bt_bond_wr is */
+static bool                             app_bt_bond_compact_needed;
+
+/* Changes applied to the RAM index but not yet to the flash, oldest first.
+ * app_bt_bond_resync asks for a compaction, which writes all of them. */
+static app_bt_bond_op_t                 app_bt_bond_ops[APP_BT_BOND_PENDING];
+static uint8_t                          app_bt_bond_ops_head;
+static uint8_t                          app_bt_bond_ops_count;
+static bool                             app_bt_bond_local_dirty;
+static bool                             app_bt_bond_resync;
+static volatile bool                    app_bt_bond_sync_queued;
+static TimerHandle_t                    app_bt_bond_retry_timer;
+
+/* Copy of the RAM index written by a compaction */
+static wiced_bt_device_link_keys_t      app_bt_bond_snap[APP_BT_BOND_MAX];
+static wiced_bt_local_identity_keys_t   app_bt_bond_snap_local;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static uint32_t app_bt_bond_crc32(const uint8_t *p_data, uint32_t len);
+static int      app_bt_bond_find(const wiced_bt_device_address_t bd_addr);
+static void     app_bt_bond_to_front(int index);
+static void     app_bt_bond_insert(const wiced_bt_device_link_keys_t *p_keys);
+static void     app_bt_bond_remove(int index);
+static bool     app_bt_bond_write_rec(uint32_t offset, uint8_t type,
+                                      const void *p_payload, uint16_t len);
+static bool     app_bt_bond_compact(void);
+static bool     app_bt_bond_append(const app_bt_bond_op_t *p_op);
+static void     app_bt_bond_queue(uint8_t type, const void *p_payload, uint16_t len);
+static void     app_bt_bond_sync_post(void);
+static void     app_bt_bond_sync(void);
+static void     app_bt_bond_retry_cb(TimerHandle_t timer);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_bond_crc32
+*
+* Function Description:
+* @brief  CRC-32 (IEEE 802.3) of a buffer, computed bit by bit: records are
+*         small and only checked at boot and when written
+*
+* @param p_data   Buffer
+*
+* @param len      Length of the buffer
+*
+* @return uint32_t  CRC of the buffer
+*/
+static uint32_t app_bt_bond_crc32(const uint8_t *p_data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (len--)
+    {
+        crc ^= *p_data++;
+        for (uint8_t bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+* Function Name:
+* app_bt_bond_find
+*
+* Function Description:
+* @brief  Looks up the bond of a peer in the RAM index
+*
+* @param bd_addr  Identity address of the peer
+*
+* @return int     Rank of the bond, -1 if the peer is not bonded
+*/
+static int app_bt_bond_find(const wiced_bt_device_address_t bd_addr)
+{
+    for (int i = 0; i < (int)app_bt_bond_num; i++)
+    {
+        if (0 == memcmp(app_bt_bond_table[i].bd_addr, bd_addr, BD_ADDR_LEN))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+* Function Name:
+* app_bt_bond_to_front
+*
+* Function Description:
+* @brief  Makes a bond the most recently used one
+*
+* @param index    Rank of the bond
+*
+* @return void
+*/
+static void app_bt_bond_to_front(int index)
+{
+    wiced_bt_device_link_keys_t keys;
+
+    if (index <= 0)
+    {
+        return;
+    }
+    keys = app_bt_bond_table[index];
+    memmove(&app_bt_bond_table[1], &app_bt_bond_table[0],
+            (uint32_t)index * sizeof(app_bt_bond_table[0]));
+    app_bt_bond_table[0] = keys;
+}
+
+/**
+* Function Name:
+* app_bt_bond_insert
+*
+* Function Description:
+* @brief  Puts a bond first in the RAM index, replacing the earlier keys of
+*         the same peer. The table must have room for a new peer.
+*
+* @param p_keys   Link keys of the peer
+*
+* @return void
+*/
+static void app_bt_bond_insert(const wiced_bt_device_link_keys_t *p_keys)
+{
+    int index = app_bt_bond_find(p_keys->bd_addr);
+
+    if (index < 0)
+    {
+        index = (int)app_bt_bond_num++;
+    }
+    app_bt_bond_table[index] = *p_keys;
+    app_bt_bond_to_front(index);
+}
+
+/**
+* Function Name:
+* app_bt_bond_remove
+*
+* Function Description:
+* @brief  Drops a bond from the RAM index
+*
+* @param index    Rank of the bond
+*
+* @return void
+*/
+static void app_bt_bond_remove(int index)
+{
+    app_bt_bond_num--;
+    memmove(&app_bt_bond_table[index], &app_bt_bond_table[index + 1],
+            (uint32_t)(app_bt_bond_num - index) * sizeof(app_bt_bond_table[0]));
+}
+
+/**
+* Function Name:
+* app_bt_bond_write_rec
+*
+* Function Description:
+* @brief  Programs one record at an erased offset of the external flash
+*
+* @param offset     External flash offset of the record
+*
+* @param type       Record type
+*
+* @param p_payload  Payload
+*
+* @param len        Payload length
+*
+* @return bool      true if the record was written
+*/
+static bool app_bt_bond_write_rec(uint32_t offset, uint8_t type,
+                                  const void *p_payload, uint16_t len)
+{
+    uint8_t buf[sizeof(app_bt_bond_rec_t) + APP_BT_BOND_ALIGN(APP_BT_BOND_PAYLOAD_MAX)];
+    app_bt_bond_rec_t *p_rec = (app_bt_bond_rec_t *)buf;
+    uint32_t size = sizeof(app_bt_bond_rec_t) + APP_BT_BOND_ALIGN(len);
+
+    /* Padding stays erased */
+    memset(buf, 0xFF, size);
+    p_rec->type = type;
+    p_rec->reserved = 0xFFu;
+    p_rec->len = len;
+    p_rec->crc = app_bt_bond_crc32(p_payload, len);
+    memcpy(&buf[sizeof(app_bt_bond_rec_t)], p_payload, len);
+
+    return (CY_RSLT_SUCCESS == cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                offset, buf, size));
+}
+
+/**
+* Function Name:
+* app_bt_bond_compact
+*
+* Function Description:
+* @brief  Rewrites the RAM index into the other sector, least recently used
+*         bond first, then its header, then erases the old sector. A reset
+*         at any point leaves one complete sector with the highest sequence.
+*         The index is copied first, so the copy holds every pending change
+*         and the pending records are dropped. Runs in the storage task.
+*
+* @return bool    true if the other sector is now the active one
+*/
+static bool app_bt_bond_compact(void)
+{
+    uint8_t target = (uint8_t)(app_bt_bond_active ^ 1u);
+    uint32_t wr = APP_BT_BOND_SECTOR(target) + sizeof(app_bt_bond_sector_t);
+    app_bt_bond_sector_t hdr = { APP_BT_BOND_MAGIC, app_bt_bond_seq + 1u };
+    uint8_t num;
+    bool local_valid;
+    bool ok;
+
+    taskENTER_CRITICAL();
+    num = app_bt_bond_num;
+    memcpy(app_bt_bond_snap, app_bt_bond_table, num * sizeof(app_bt_bond_table[0]));
+    app_bt_bond_snap_local = app_bt_bond_local_keys;
+    local_valid = app_bt_bond_local_valid;
+    app_bt_bond_ops_count = 0;
+    app_bt_bond_local_dirty = false;
+    app_bt_bond_resync = false;
+    taskEXIT_CRITICAL();
+
+    ok = (CY_RSLT_SUCCESS == cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                              APP_BT_BOND_SECTOR(target),
+                                              APP_BT_BOND_SECTOR_SIZE));
+    if (ok && local_valid)
+    {
+        ok = app_bt_bond_write_rec(wr, APP_BT_BOND_REC_LOCAL_KEYS,
+                                   &app_bt_bond_snap_local, sizeof(app_bt_bond_snap_local));
+        wr += sizeof(app_bt_bond_rec_t) + APP_BT_BOND_ALIGN(sizeof(app_bt_bond_snap_local));
+    }
+    for (int i = (int)num - 1; ok && (i >= 0); i--)
+    {
+        ok = app_bt_bond_write_rec(wr, APP_BT_BOND_REC_LINK_KEYS,
+                                   &app_bt_bond_snap[i], sizeof(app_bt_bond_snap[i]));
+        wr += sizeof(app_bt_bond_rec_t) + APP_BT_BOND_ALIGN(sizeof(app_bt_bond_snap[i]));
+    }
+    ok = ok && (CY_RSLT_SUCCESS == cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                    APP_BT_BOND_SECTOR(target),
+                                                    &hdr, sizeof(hdr)));
+    if (!ok)
+    {
+        /* The copy was lost with the dropped records, redo it later */
+        taskENTER_CRITICAL();
+        app_bt_bond_resync = true;
+        taskEXIT_CRITICAL();
+        APP_LOG_ERR("Bond store compaction failed\r\n");
+        return false;
+    }
+
+    /* The new sector wins on its sequence number even if this fails */
+    (void)cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                           APP_BT_BOND_SECTOR(app_bt_bond_active),
+                           APP_BT_BOND_SECTOR_SIZE);
+    app_bt_bond_active = target;
+    app_bt_bond_seq = hdr.seq;
+    app_bt_bond_wr = wr;
+    app_bt_bond_compact_needed = false;
+    APP_LOG_INFO("Bond store compacted into sector %d, %d bonds\r\n", target, num);
+    return true;
+}
+
+/**
+* Function Name:
+* app_bt_bond_append
+*
+* Function Description:
+* @brief  Persists a change already applied to the RAM index. Appends one
+*         record to the active sector, or compacts when it is full, which
+*         persists the change with everything else. Runs in the storage
+*         task.
+*
+* @param p_op     Record to append
+*
+* @return bool    true if the change is in the flash
+*/
+static bool app_bt_bond_append(const app_bt_bond_op_t *p_op)
+{
+    uint32_t size = sizeof(app_bt_bond_rec_t) + APP_BT_BOND_ALIGN(p_op->len);
+
+    if (!app_bt_bond_compact_needed &&
+        (app_bt_bond_wr + size <= APP_BT_BOND_SECTOR(app_bt_bond_active) + APP_BT_BOND_SECTOR_SIZE))
+    {
+        if (app_bt_bond_write_rec(app_bt_bond_wr, p_op->type, p_op->payload, p_op->len))
+        {
+            app_bt_bond_wr += size;
+            return true;
+        }
+        /* Part of the record may be programmed, skip past it */
+        app_bt_bond_compact_needed = true;
+    }
+    return app_bt_bond_compact();
+}
+
+/**
+* Function Name:
+* app_bt_bond_queue
+*
+* Function Description:
+* @brief  Queues a change already applied to the RAM index for the storage
+*         task. Called in the Bluetooth stack task, which never waits for
+*         the flash.
+*
+* @param type       Record type
+*
+* @param p_payload  Payload
+*
+* @param len        Payload length
+*
+* @return void
+*/
+static void app_bt_bond_queue(uint8_t type, const void *p_payload, uint16_t len)
+{
+    app_bt_bond_op_t *p_op;
+
+    taskENTER_CRITICAL();
+    if (app_bt_bond_ops_count < APP_BT_BOND_PENDING)
+    {
+        p_op = &app_bt_bond_ops[(app_bt_bond_ops_head + app_bt_bond_ops_count) %
+                                APP_BT_BOND_PENDING];
+        p_op->type = type;
+        p_op->len = len;
+        memcpy(p_op->payload, p_payload, len);
+        app_bt_bond_ops_count++;
+    }
+    else
+    {
+        app_bt_bond_resync = true;
+    }
+    taskEXIT_CRITICAL();
+
+    app_bt_bond_sync_post();
+}
+
+/**
+* Function Name:
+* app_bt_bond_sync_post
+*
+* Function Description:
+* @brief  Has the storage task write the pending changes, unless it already
+*         has a write queued. Retries later when its queue is full.
+*
+* @return void
+*/
+static void app_bt_bond_sync_post(void)
+{
+    if (app_bt_bond_sync_queued)
+    {
+        return;
+    }
+    app_bt_bond_sync_queued = true;
+    if (CY_RSLT_SUCCESS != app_ota_storage_run(app_bt_bond_sync))
+    {
+        app_bt_bond_sync_queued = false;
+        xTimerStart(app_bt_bond_retry_timer, 0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bond_sync
+*
+* Function Description:
+* @brief  Writes the pending changes, oldest first. Runs in the storage task.
+*         A change that cannot be written is kept and tried again after
+*         APP_BT_BOND_RETRY_MS.
+*
+* @return void
+*/
+static void app_bt_bond_sync(void)
+{
+    app_bt_bond_op_t op;
+    bool resync;
+    bool pending;
+    bool ok = true;
+
+    app_bt_bond_sync_queued = false;
+
+    /* Jobs run after the bring-up, this only tells if it failed */
+    if (CY_RSLT_SUCCESS != app_ota_storage_wait(0))
+    {
+        APP_LOG_ERR("Bond store not written, flash not ready\r\n");
+        return;
+    }
+
+    while (ok)
+    {
+        pending = true;
+        taskENTER_CRITICAL();
+        resync = app_bt_bond_resync;
+        if (!resync && app_bt_bond_local_dirty)
+        {
+            op.type = APP_BT_BOND_REC_LOCAL_KEYS;
+            op.len = sizeof(app_bt_bond_local_keys);
+            memcpy(op.payload, &app_bt_bond_local_keys, sizeof(app_bt_bond_local_keys));
+            app_bt_bond_local_dirty = false;
+        }
+        else if (!resync && (0u != app_bt_bond_ops_count))
+        {
+            op = app_bt_bond_ops[app_bt_bond_ops_head];
+            app_bt_bond_ops_head = (uint8_t)((app_bt_bond_ops_head + 1u) % APP_BT_BOND_PENDING);
+            app_bt_bond_ops_count--;
+        }
+        else
+        {
+            pending = resync;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!pending)
+        {
+            break;
+        }
+        /* A failed append falls back to a compaction, which asks for
+         * another one when it fails too */
+        ok = resync ? app_bt_bond_compact() : app_bt_bond_append(&op);
+    }
+
+    if (!ok)
+    {
+        xTimerStart(app_bt_bond_retry_timer, 0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bond_retry_cb
+*
+* Function Description:
+* @brief  Posts the pending changes to the storage task again, runs in the
+*         timer service task
+*
+* @param timer    unused
+*
+* @return void
+*/
+static void app_bt_bond_retry_cb(TimerHandle_t timer)
+{
+    (void)timer;
+    app_bt_bond_sync_post();
+}
+
+/**
+* Function Name:
+* app_bt_bond_init
+*
+* Function Description:
+* @brief  Loads the store into the RAM index. Reads the external flash
+*         through the XIP window, so it does not wait for the OTA storage
+*         bring-up. Call from main() before the stack is initialized.
+*
+* @return void
+*/
+void app_bt_bond_init(void)
+{
+    app_bt_bond_sector_t hdr[APP_BT_BOND_SECTOR_COUNT];
+    app_bt_bond_rec_t rec;
+    uint8_t payload[APP_BT_BOND_ALIGN(APP_BT_BOND_PAYLOAD_MAX)];
+    uint32_t end;
+    bool valid[APP_BT_BOND_SECTOR_COUNT];
+    int index;
+
+    app_bt_bond_num = 0;
+    app_bt_bond_local_valid = false;
+
+    app_bt_bond_retry_timer = xTimerCreate("Bond", pdMS_TO_TICKS(APP_BT_BOND_RETRY_MS),
+                                           pdFALSE, NULL, app_bt_bond_retry_cb);
+    if (NULL == app_bt_bond_retry_timer)
+    {
+        APP_LOG_ERR("Bond retry timer creation failed\r\n");
+        CY_ASSERT(0);
+    }
+
+    for (uint8_t i = 0; i < APP_BT_BOND_SECTOR_COUNT; i++)
+    {
+        memcpy(&hdr[i], APP_BT_BOND_XIP(APP_BT_BOND_SECTOR(i)), sizeof(hdr[i]));
+        valid[i] = (APP_BT_BOND_MAGIC == hdr[i].magic) && (0xFFFFFFFFu != hdr[i].seq);
+    }
+    if (!valid[0] && !valid[1])
+    {
+        /* Nothing stored yet, the first record formats sector 0 */
+        app_bt_bond_active = 1u;
+        app_bt_bond_seq = 0;
+        app_bt_bond_compact_needed = true;
+        APP_LOG_INFO("Bond store empty\r\n");
+        return;
+    }
+    app_bt_bond_active = (!valid[0] || (valid[1] && (hdr[1].seq > hdr[0].seq))) ? 1u : 0u;
+    app_bt_bond_seq = hdr[app_bt_bond_active].seq;
+    app_bt_bond_compact_needed = false;
+
+    app_bt_bond_wr = APP_BT_BOND_SECTOR(app_bt_bond_active) + sizeof(app_bt_bond_sector_t);
+    end = APP_BT_BOND_SECTOR(app_bt_bond_active) + APP_BT_BOND_SECTOR_SIZE;
+    while (app_bt_bond_wr + sizeof(rec) <= end)
+    {
+        memcpy(&rec, APP_BT_BOND_XIP(app_bt_bond_wr), sizeof(rec));
+        if (APP_BT_BOND_REC_FREE == rec.type)
+        {
+            break;
+        }
+        if ((rec.len > sizeof(payload)) ||
+            (app_bt_bond_wr + sizeof(rec) + APP_BT_BOND_ALIGN(rec.len) > end))
+        {
+            app_bt_bond_compact_needed = true;
+            break;
+        }
+        memcpy(payload, APP_BT_BOND_XIP(app_bt_bond_wr + sizeof(rec)), rec.len);
+        if (rec.crc != app_bt_bond_crc32(payload, rec.len))
+        {
+            /* Torn by a reset while it was written, everything before is good */
+            app_bt_bond_compact_needed = true;
+            break;
+        }
+
+        if ((APP_BT_BOND_REC_LOCAL_KEYS == rec.type) &&
+            (sizeof(app_bt_bond_local_keys) == rec.len))
+        {
+            memcpy(&app_bt_bond_local_keys, payload, rec.len);
+            app_bt_bond_local_valid = true;
+        }
+        else if ((APP_BT_BOND_REC_LINK_KEYS == rec.type) &&
+                 (sizeof(wiced_bt_device_link_keys_t) == rec.len))
+        {
+            index = app_bt_bond_find(((wiced_bt_device_link_keys_t *)payload)->bd_addr);
+            if ((index < 0) && (APP_BT_BOND_MAX == app_bt_bond_num))
+            {
+                app_bt_bond_remove((int)app_bt_bond_num - 1);
+            }
+            app_bt_bond_insert((wiced_bt_device_link_keys_t *)payload);
+        }
+        else if ((APP_BT_BOND_REC_DELETE == rec.type) && (BD_ADDR_LEN == rec.len))
+        {
+            index = app_bt_bond_find(payload);
+            if (index >= 0)
+            {
+                app_bt_bond_remove(index);
+            }
+        }
+        app_bt_bond_wr += sizeof(rec) + APP_BT_BOND_ALIGN(rec.len);
+    }
+
+    APP_LOG_INFO("Bond store: %d bonds, local keys %s, sector %d used %lu bytes\r\n",
+                 app_bt_bond_num, app_bt_bond_local_valid ? "present" : "absent",
+                 app_bt_bond_active,
+                 (unsigned long)(app_bt_bond_wr - APP_BT_BOND_SECTOR(app_bt_bond_active)));
+}
+
+/**
+* Function Name:
+* app_bt_bond_load_lists
+*
+* Function Description:
+* @brief  Adds every bonded peer to the address resolution list and to the
+*         advertising filter accept list of the controller. Call once the
+*         stack is enabled.
+*
+* @return void
+*/
+void app_bt_bond_load_lists(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    wiced_result_t result;
+
+    for (uint8_t rank = 0; app_bt_bond_get_by_rank(rank, &keys); rank++)
+    {
+        result = wiced_bt_dev_add_device_to_address_resolution_db(&keys);
+        if (WICED_BT_SUCCESS != result)
+        {
+            APP_LOG_WARNING("Address resolution entry not added, error %d\r\n", result);
+        }
+        wiced_bt_ble_update_advertising_filter_accept_list(WICED_TRUE, keys.bd_addr);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bond_get_local_keys
+*
+* Function Description:
+* @brief  Provides the local identity keys, so that the device keeps its
+*         identity resolving key and the bonds stay usable across resets
+*
+* @param p_keys   Filled with the keys
+*
+* @return wiced_result_t  WICED_BT_SUCCESS, WICED_BT_ERROR if none are stored
+*/
+wiced_result_t app_bt_bond_get_local_keys(wiced_bt_local_identity_keys_t *p_keys)
+{
+    if (!app_bt_bond_local_valid)
+    {
+        return WICED_BT_ERROR;
+    }
+    *p_keys = app_bt_bond_local_keys;
+    return WICED_BT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_bond_save_local_keys
+*
+* Function Description:
+* @brief  Stores the local identity keys generated by the stack. The flash
+*         is written by the storage task, and again until it succeeds.
+*
+* @param p_keys   Keys to store
+*
+* @return void
+*/
+void app_bt_bond_save_local_keys(const wiced_bt_local_identity_keys_t *p_keys)
+{
+    bool pending;
+
+    taskENTER_CRITICAL();
+    if (!app_bt_bond_local_valid ||
+        (0 != memcmp(&app_bt_bond_local_keys, p_keys, sizeof(*p_keys))))
+    {
+        app_bt_bond_local_keys = *p_keys;
+        app_bt_bond_local_valid = true;
+        app_bt_bond_local_dirty = true;
+    }
+    /* Keys equal to the RAM copy may still be waiting for the flash */
+    pending = app_bt_bond_local_dirty || app_bt_bond_resync;
+    taskEXIT_CRITICAL();
+
+    if (pending)
+    {
+        app_bt_bond_sync_post();
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bond_get
+*
+* Function Description:
+* @brief  Provides the link keys of a bonded peer
+*
+* @param bd_addr  Identity address of the peer
+*
+* @param p_keys   Filled with the keys
+*
+* @return wiced_result_t  WICED_BT_SUCCESS, WICED_BT_ERROR if the peer is unknown
+*/
+wiced_result_t app_bt_bond_get(const wiced_bt_device_address_t bd_addr,
+                               wiced_bt_device_link_keys_t *p_keys)
+{
+    wiced_result_t result = WICED_BT_ERROR;
+    int index;
+
+    taskENTER_CRITICAL();
+    index = app_bt_bond_find(bd_addr);
+    if (index >= 0)
+    {
+        *p_keys = app_bt_bond_table[index];
+        result = WICED_BT_SUCCESS;
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+/**
+* Function Name:
+* app_bt_bond_save
+*
+* Function Description:
+* @brief  Stores the link keys of a peer that has just bonded. Keys equal to
+*         the stored ones cost no flash write. When the table is full the
+*         least recently used bond is dropped, from the store and from the
+*         address resolution list. The flash is written by the storage task.
+*
+* @param p_keys   Link keys of the peer
+*
+* @return void
+*/
+void app_bt_bond_save(const wiced_bt_device_link_keys_t *p_keys)
+{
+    wiced_bt_device_link_keys_t evicted;
+    bool evict = false;
+    bool changed;
+    int index;
+
+    taskENTER_CRITICAL();
+    index = app_bt_bond_find(p_keys->bd_addr);
+    changed = (index < 0) || (0 != memcmp(&app_bt_bond_table[index], p_keys, sizeof(*p_keys)));
+    if ((index < 0) && (APP_BT_BOND_MAX == app_bt_bond_num))
+    {
+        evicted = app_bt_bond_table[app_bt_bond_num - 1u];
+        app_bt_bond_remove((int)app_bt_bond_num - 1);
+        evict = true;
+    }
+    app_bt_bond_insert(p_keys);
+    taskEXIT_CRITICAL();
+
+    if (evict)
+    {
+        APP_LOG_INFO("Bond table full, dropping ");
+        print_bd_address(evicted.bd_addr);
+        wiced_bt_dev_remove_device_from_address_resolution_db(&evicted);
+        wiced_bt_ble_update_advertising_filter_accept_list(WICED_FALSE, evicted.bd_addr);
+        app_bt_bond_queue(APP_BT_BOND_REC_DELETE, evicted.bd_addr, BD_ADDR_LEN);
+    }
+    if (index < 0)
+    {
+        wiced_bt_ble_update_advertising_filter_accept_list(WICED_TRUE, p_keys->bd_addr);
+    }
+    if (changed)
+    {
+        app_bt_bond_queue(APP_BT_BOND_REC_LINK_KEYS, p_keys, sizeof(*p_keys));
+    }
+}
+
+/**
+* Function Name:
+* app_bt_bond_used
+*
+* Function Description:
+* @brief  Makes the bond of a peer that has just reconnected the most
+*         recently used one, in RAM only. The order in the store is the
+*         order in which the peers last bonded.
+*
+* @param bd_addr  Identity address of the peer
+*
+* @return void
+*/
+void app_bt_bond_used(const wiced_bt_device_address_t bd_addr)
+{
+    taskENTER_CRITICAL();
+    app_bt_bond_to_front(app_bt_bond_find(bd_addr));
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_bond_count
+*
+* Function Description:
+* @brief  Number of bonded peers
+*
+* @return uint8_t  Number of bonds in the RAM index
+*/
+uint8_t app_bt_bond_count(void)
+{
+    return app_bt_bond_num;
+}
+
+/**
+* Function Name:
+* app_bt_bond_get_by_rank
+*
+* Function Description:
+* @brief  Provides a bond by recency, to load the address resolution list
+*         and pick the target of directed advertising
+*
+* @param rank     0 for the most recently used bond
+*
+* @param p_keys   Filled with the keys
+*
+* @return bool    false if there are not that many bonds
+*/
+bool app_bt_bond_get_by_rank(uint8_t rank, wiced_bt_device_link_keys_t *p_keys)
+{
+    bool found = false;
+
+    taskENTER_CRITICAL();
+    if (rank < app_bt_bond_num)
+    {
+        *p_keys = app_bt_bond_table[rank];
+        found = true;
+    }
+    taskEXIT_CRITICAL();
+    return found;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * File Name: app_bt_bond.h
+ *
+ * Description: Bond records and local identity keys kept in the
+ *              external flash, with an in-RAM index
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_BOND_H__
+#define APP_BT_BOND_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+#include "wiced_result.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Bonded centrals kept; pairing one more evicts the least recently used */
+#define APP_BT_BOND_MAX                     (4u)
+
+/* Two external flash sectors used in turn, after the SMIF cache record and
+ * before the confirmation record. Must not overlap flashmap.mk areas. */
+#define APP_BT_BOND_FLASH_OFFSET            (0x000EF000u)
+#define APP_BT_BOND_SECTOR_SIZE             (0x00001000u)
+#define APP_BT_BOND_SECTOR_COUNT            (2u)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void           app_bt_bond_init             (void);
+void           app_bt_bond_load_lists       (void);
+wiced_result_t app_bt_bond_get_local_keys   (wiced_bt_local_identity_keys_t *p_keys);
+void           app_bt_bond_save_local_keys  (const wiced_bt_local_identity_keys_t *p_keys);
+wiced_result_t app_bt_bond_get              (const wiced_bt_device_address_t bd_addr,
+                                             wiced_bt_device_link_keys_t *p_keys);
+void           app_bt_bond_save             (const wiced_bt_device_link_keys_t *p_keys);
+void           app_bt_bond_used             (const wiced_bt_device_address_t bd_addr);
+uint8_t        app_bt_bond_count            (void);
+bool           app_bt_bond_get_by_rank      (uint8_t rank, wiced_bt_device_link_keys_t *p_keys);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,523 @@
+/*******************************************************************************
+ * File Name: app_bt_conn.c
+ *
+ * Description: This file implements the connection table that tracks
+ *              every connected central, its CCCD subscriptions and link
+ *              parameters.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "GeneratedSource/cycfg_gatt_db.h"
+#include "app_bt_conn.h"
+#include "app_bt_notify.h"
+#include "app_bt_bearer.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Default ATT MTU until the peer negotiates a larger one */
+#define APP_BT_CONN_DEFAULT_MTU         (23u)
+
+/* Default LL payload until data length extension is negotiated */
+#define APP_BT_CONN_DEFAULT_TX_OCTETS   (27u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Connection table, one slot per connected central
+ */
+static app_bt_conn_t app_bt_conn_table[APP_BT_MAX_CONNECTIONS];
+
+/**
+ * @brief CCCD attribute handles, indexed by app_bt_cccd_t
+ */
+static const uint16_t app_bt_cccd_handles[APP_BT_CCCD_COUNT] =
+{
+    [APP_BT_CCCD_BAS_BATTERY_LEVEL] = HDLD_BAS_BATTERY_LEVEL_CLIENT_CHAR_CONFIG,
+    [APP_BT_CCCD_OTA_CONTROL_POINT] = HDLD_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_CLIENT_CHAR_CONFIG,
+    [APP_BT_CCCD_HISTORY]           = HDLD_HISTORY_BATTERY_HISTORY_CLIENT_CHAR_CONFIG,
+};
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_conn_add
+*
+* Function Description:
+* @brief  Claims a free slot in the connection table for a new connection
+*
+* @param conn_id      Connection ID reported by the stack
+*
+* @param peer_addr    Bluetooth address of the peer
+*
+* @return app_bt_conn_t*  Pointer to the slot, NULL if the table is full
+*/
+app_bt_conn_t *app_bt_conn_add(uint16_t conn_id, wiced_bt_device_address_t peer_addr)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+
+    for (uint8_t i = 0; (NULL == p_conn) && (i < APP_BT_MAX_CONNECTIONS); i++)
+    {
+        if (0 == app_bt_conn_table[i].conn_id)
+        {
+            p_conn = &app_bt_conn_table[i];
+        }
+    }
+
+    if (NULL != p_conn)
+    {
+        taskENTER_CRITICAL();
+        memset(p_conn, 0, sizeof(*p_conn));
+        memcpy(p_conn->peer_addr, peer_addr, BD_ADDR_LEN);
+        p_conn->mtu = APP_BT_CONN_DEFAULT_MTU;
+        p_conn->tx_octets = APP_BT_CONN_DEFAULT_TX_OCTETS;
+        p_conn->tx_phy = BTM_BLE_PHY_1M;
+        p_conn->rx_phy = BTM_BLE_PHY_1M;
+        p_conn->conn_id = conn_id;
+        taskEXIT_CRITICAL();
+    }
+    return p_conn;
+}
+
+/**
+* Function Name:
+* app_bt_conn_remove
+*
+* Function Description:
+* @brief  Releases the slot held by a connection. All CCCD subscriptions of
+*         the connection are dropped with it.
+*
+* @param conn_id      Connection ID reported by the stack
+*
+* @return void
+*/
+void app_bt_conn_remove(uint16_t conn_id)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+
+    if (NULL != p_conn)
+    {
+        taskENTER_CRITICAL();
+        memset(p_conn, 0, sizeof(*p_conn));
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+* Function Name:
+* app_bt_conn_find
+*
+* Function Description:
+* @brief  Looks up the connection table entry of a connection. The conn_id
+*         of an enhanced ATT bearer resolves to the link it belongs to.
+*
+* @param conn_id      Connection ID reported by the stack
+*
+* @return app_bt_conn_t*  Pointer to the slot, NULL if not connected
+*/
+app_bt_conn_t *app_bt_conn_find(uint16_t conn_id)
+{
+    uint16_t link_conn_id;
+
+    if (0 == conn_id)
+    {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (app_bt_conn_table[i].conn_id == conn_id)
+        {
+            return &app_bt_conn_table[i];
+        }
+    }
+
+    link_conn_id = app_bt_bearer_conn_id(conn_id);
+    if ((0 != link_conn_id) && (link_conn_id != conn_id))
+    {
+        return app_bt_conn_find(link_conn_id);
+    }
+    return NULL;
+}
+
+/**
+* Function Name:
+* app_bt_conn_find_by_addr
+*
+* Function Description:
+* @brief  Looks up the connection table entry of a peer address, used by
+*         management events which only carry the Bluetooth address
+*
+* @param peer_addr    Bluetooth address of the peer
+*
+* @return app_bt_conn_t*  Pointer to the slot, NULL if not connected
+*/
+app_bt_conn_t *app_bt_conn_find_by_addr(wiced_bt_device_address_t peer_addr)
+{
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if ((0 != app_bt_conn_table[i].conn_id) &&
+            (0 == memcmp(app_bt_conn_table[i].peer_addr, peer_addr, BD_ADDR_LEN)))
+        {
+            return &app_bt_conn_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+* Function Name:
+* app_bt_conn_count
+*
+* Function Description:
+* @brief  Returns the number of connected centrals
+*
+* @return uint8_t     Number of occupied slots
+*/
+uint8_t app_bt_conn_count(void)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (0 != app_bt_conn_table[i].conn_id)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+* Function Name:
+* app_bt_conn_slot_available
+*
+* Function Description:
+* @brief  Tells whether another central can be accepted
+*
+* @return bool        true if at least one slot is free
+*/
+bool app_bt_conn_slot_available(void)
+{
+    return (app_bt_conn_count() < APP_BT_MAX_CONNECTIONS);
+}
+
+/**
+* Function Name:
+* app_bt_conn_cccd_from_handle
+*
+* Function Description:
+* @brief  Maps a CCCD attribute handle to its bit position
+*
+* @param attr_handle  GATT attribute handle
+*
+* @return int         app_bt_cccd_t value, -1 if the handle is not a CCCD
+*/
+int app_bt_conn_cccd_from_handle(uint16_t attr_handle)
+{
+    for (int i = 0; i < APP_BT_CCCD_COUNT; i++)
+    {
+        if (app_bt_cccd_handles[i] == attr_handle)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+* Function Name:
+* app_bt_conn_cccd_write
+*
+* Function Description:
+* @brief  Stores a CCCD value written by a peer in that peer's bitmaps
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param cccd         CCCD being written
+*
+* @param p_val        Pointer to the written value
+*
+* @param len          Length of the written value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_conn_cccd_write(uint16_t conn_id, app_bt_cccd_t cccd,
+                                              uint8_t *p_val, uint16_t len)
+{
+    app_bt_conn_t *p_conn;
+    uint16_t value;
+    uint8_t bit = (uint8_t)(1u << cccd);
+
+    if (cccd >= APP_BT_CCCD_COUNT)
+    {
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+    if ((len < 1) || (len > 2))
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+
+    value = p_val[0] | ((len > 1) ? (uint16_t)(p_val[1] << 8) : 0);
+
+    /* Looked up with the update, the stack task may remove or reuse the
+     * entry in between */
+    taskENTER_CRITICAL();
+    p_conn = app_bt_conn_find(conn_id);
+    if (NULL == p_conn)
+    {
+        taskEXIT_CRITICAL();
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+    if (value & GATT_CLIENT_CONFIG_NOTIFICATION)
+    {
+        p_conn->notify_bitmap |= bit;
+    }
+    else
+    {
+        p_conn->notify_bitmap &= (uint8_t)~bit;
+    }
+    if (value & GATT_CLIENT_CONFIG_INDICATION)
+    {
+        p_conn->indicate_bitmap |= bit;
+    }
+    else
+    {
+        p_conn->indicate_bitmap &= (uint8_t)~bit;
+    }
+    taskEXIT_CRITICAL();
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_conn_cccd_value
+*
+* Function Description:
+* @brief  Rebuilds the CCCD value a connection has written
+*
+* @param conn_id      Connection ID
+*
+* @param cccd         CCCD to read
+*
+* @return uint16_t    CCCD value, 0 if the connection is unknown
+*/
+uint16_t app_bt_conn_cccd_value(uint16_t conn_id, app_bt_cccd_t cccd)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+    uint16_t value = 0;
+    uint8_t bit = (uint8_t)(1u << cccd);
+
+    if (NULL != p_conn)
+    {
+        if (p_conn->notify_bitmap & bit)
+        {
+            value |= GATT_CLIENT_CONFIG_NOTIFICATION;
+        }
+        if (p_conn->indicate_bitmap & bit)
+        {
+            value |= GATT_CLIENT_CONFIG_INDICATION;
+        }
+    }
+    return value;
+}
+
+/**
+* Function Name:
+* app_bt_conn_client_features_write
+*
+* Function Description:
+* @brief  Stores the Client Supported Features written by a peer. A feature
+*         the client enabled cannot be disabled again on the same connection.
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param p_val        Pointer to the written value
+*
+* @param len          Length of the written value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_conn_client_features_write(uint16_t conn_id,
+                                                         uint8_t *p_val, uint16_t len)
+{
+    app_bt_conn_t *p_conn;
+    wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
+
+    if (len < 1)
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+
+    taskENTER_CRITICAL();
+    p_conn = app_bt_conn_find(conn_id);
+    if (NULL == p_conn)
+    {
+        status = WICED_BT_GATT_INVALID_HANDLE;
+    }
+    else if ((p_conn->client_features & p_val[0]) != p_conn->client_features)
+    {
+        status = WICED_BT_GATT_VALUE_NOT_ALLOWED;
+    }
+    else
+    {
+        p_conn->client_features = p_val[0];
+    }
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+* Function Name:
+* app_bt_conn_client_features
+*
+* Function Description:
+* @brief  Returns the Client Supported Features of a connection
+*
+* @param conn_id      Connection ID
+*
+* @return uint8_t     Feature bits, 0 if the connection is unknown
+*/
+uint8_t app_bt_conn_client_features(uint16_t conn_id)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+
+    return (NULL != p_conn) ? p_conn->client_features : 0;
+}
+
+/**
+* Function Name:
+* app_bt_conn_notify_all
+*
+* Function Description:
+* @brief  Queues the same value as a notification for every connection that
+*         enabled notifications on the given CCCD. The value is copied, so the
+*         caller may reuse its buffer once this returns.
+*
+* @param cccd         CCCD gating the notification
+*
+* @param attr_handle  Handle of the characteristic value
+*
+* @param len          Length of the value
+*
+* @param p_val        Pointer to the serialized value
+*
+* @return uint8_t     Number of connections notified
+*/
+uint8_t app_bt_conn_notify_all(app_bt_cccd_t cccd, uint16_t attr_handle,
+                               uint16_t len, uint8_t *p_val)
+{
+    uint16_t conn_ids[APP_BT_MAX_CONNECTIONS];
+    uint8_t num_conn = 0;
+    uint8_t sent = 0;
+    uint8_t bit = (uint8_t)(1u << cccd);
+    wiced_bt_gatt_status_t status;
+
+    /* Take a snapshot so the table can change while the values are queued */
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if ((0 != app_bt_conn_table[i].conn_id) &&
+            (app_bt_conn_table[i].notify_bitmap & bit))
+        {
+            conn_ids[num_conn++] = app_bt_conn_table[i].conn_id;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < num_conn; i++)
+    {
+        status = app_bt_notify_queue(conn_ids[i], attr_handle, len, p_val);
+        if (WICED_BT_GATT_SUCCESS == status)
+        {
+            sent++;
+        }
+        else
+        {
+            APP_LOG_ERR("Notification to conn_id %d failed: %d\r\n", conn_ids[i], status);
+        }
+    }
+    return sent;
+}
+
+/**
+* Function Name:
+* app_bt_conn_disconnect_all
+*
+* Function Description:
+* @brief  Asks the stack to disconnect every central. Each link is removed
+*         from the table when the stack reports its disconnection.
+*
+* @return uint8_t     Number of disconnections requested
+*/
+uint8_t app_bt_conn_disconnect_all(void)
+{
+    uint16_t conn_ids[APP_BT_MAX_CONNECTIONS];
+    uint8_t num_conn = 0;
+
+    /* Take a snapshot, the stack task removes the links meanwhile */
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (0 != app_bt_conn_table[i].conn_id)
+        {
+            conn_ids[num_conn++] = app_bt_conn_table[i].conn_id;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < num_conn; i++)
+    {
+        if (WICED_BT_GATT_SUCCESS != wiced_bt_gatt_disconnect(conn_ids[i]))
+        {
+            APP_LOG_ERR("Disconnection of conn_id %d failed\r\n", conn_ids[i]);
+        }
+    }
+    return num_conn;
+}
+
+/* [] END OF FILE */
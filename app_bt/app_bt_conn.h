@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * File Name: app_bt_conn.h
+ *
+ * Description: This file is the public interface of app_bt_conn.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_CONN_H__
+#define APP_BT_CONN_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdbool.h>
+#include "wiced_bt_dev.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_gatt.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Number of simultaneous centrals supported. Must not exceed the
+ *        "MaxClientsConnections" setting in app_bt_configs/design.cybt
+ */
+#define APP_BT_MAX_CONNECTIONS          (3u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Client Characteristic Configuration Descriptors tracked per
+ *        connection. Each value is a bit position in the CCCD bitmaps.
+ */
+typedef enum
+{
+    APP_BT_CCCD_BAS_BATTERY_LEVEL = 0,
+    APP_BT_CCCD_OTA_CONTROL_POINT,
+    APP_BT_CCCD_HISTORY,
+    APP_BT_CCCD_COUNT
+} app_bt_cccd_t;
+
+/**
+ * @brief Per-connection state kept for every connected central
+ */
+typedef struct
+{
+    uint16_t                    conn_id;          /* 0 when the slot is free */
+    wiced_bt_device_address_t   peer_addr;        /* Peer Bluetooth address */
+    uint16_t                    mtu;              /* ATT MTU in use on this link */
+    wiced_bt_ble_conn_params_t  conn_params;      /* Current link parameters */
+    uint16_t                    tx_octets;        /* Negotiated LL max TX payload (DLE) */
+    uint8_t                     tx_phy;           /* Current TX PHY, BTM_BLE_PHY_* */
+    uint8_t                     rx_phy;           /* Current RX PHY, BTM_BLE_PHY_* */
+    uint8_t                     notify_bitmap;    /* Bit n set: CCCD n has notifications enabled */
+    uint8_t                     indicate_bitmap;  /* Bit n set: CCCD n has indications enabled */
+    uint8_t                     client_features;  /* Client Supported Features written by the peer */
+} app_bt_conn_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+app_bt_conn_t          *app_bt_conn_add          (uint16_t conn_id,
+                                                  wiced_bt_device_address_t peer_addr);
+void                    app_bt_conn_remove       (uint16_t conn_id);
+app_bt_conn_t          *app_bt_conn_find         (uint16_t conn_id);
+app_bt_conn_t          *app_bt_conn_find_by_addr (wiced_bt_device_address_t peer_addr);
+uint8_t                 app_bt_conn_count        (void);
+bool                    app_bt_conn_slot_available(void);
+uint8_t                 app_bt_conn_disconnect_all(void);
+
+int                     app_bt_conn_cccd_from_handle(uint16_t attr_handle);
+wiced_bt_gatt_status_t  app_bt_conn_cccd_write   (uint16_t conn_id, app_bt_cccd_t cccd,
+                                                  uint8_t *p_val, uint16_t len);
+uint16_t                app_bt_conn_cccd_value   (uint16_t conn_id, app_bt_cccd_t cccd);
+
+wiced_bt_gatt_status_t  app_bt_conn_client_features_write(uint16_t conn_id,
+                                                  uint8_t *p_val, uint16_t len);
+uint8_t                 app_bt_conn_client_features(uint16_t conn_id);
+
+/* Queue one serialized value for every connection subscribed to the CCCD */
+uint8_t                 app_bt_conn_notify_all   (app_bt_cccd_t cccd, uint16_t attr_handle,
+                                                  uint16_t len, uint8_t *p_val);
+
+#endif
+/* [] END OF FILE */
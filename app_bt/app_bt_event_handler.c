@@ -40,10 +40,29 @@
 *        Header Files
 *******************************************************************************/
 
+#include <stdint.h>
 #include "cyhal.h"
 #include "wiced_bt_stack.h"
+#include <timers.h>
 #include "app_bt_event_handler.h"
 #include "app_bt_gatt_handler.h"
+#include "app_bt_gatt_queue.h"
+#include "app_bt_notify.h"
+#include "app_bt_bearer.h"
+#include "app_bt_link_ctrl.h"
+#include "app_ota_l2cap.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_bas.h"
+#include "app_bt_svc_ota.h"
+#include "app_bt_svc_diag.h"
+#include "app_bt_svc_hist.h"
+#include "app_bt_bond.h"
+#include "app_sched.h"
+#include "app_reboot.h"
+#include "app_trace.h"
+#include "app_boot_time.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BT
+#include "app_log.h"
 
 /*******************************************************************************
 *        Macro Definitions
@@ -58,42 +77,63 @@
  */
 cyhal_pwm_t adv_led_pwm;
 
-/**
- * @brief FreeRTOS variable to store handle of task created to update and send
-   dummy values of temperature
- */
-TaskHandle_t bas_task_handle;
+app_bt_adv_conn_mode_t app_bt_adv_conn_state = APP_BT_ADV_OFF_CONN_OFF;
 
 /**
- * @brief Variable for 5 sec timer object
+ * @brief Current reconnection advertising stage, and the timer that moves
+ *        to the next one
  */
-cyhal_timer_t bas_timer_obj;
-
-/**
- * @brief Configure timer for 5 sec
- */
-const cyhal_timer_cfg_t bas_timer_cfg =
-{
-    .compare_value = 0,                    /* Timer compare value, not used */
-    .period = BATTERY_LEVEL_UPDATE_MS, /* Defines the timer period */
-    .direction = CYHAL_TIMER_DIR_UP,       /* Timer counts up */
-    .is_compare = false,                   /* Don't use compare mode */
-    .is_continuous = true,                 /* Run timer indefinitely */
-    .value = 0                             /* Initial value of counter */
-};
-
-app_bt_adv_conn_mode_t app_bt_adv_conn_state = APP_BT_ADV_OFF_CONN_OFF;
+static app_bt_adv_stage_t app_bt_adv_stage = APP_BT_ADV_STAGE_OPEN;
+static TimerHandle_t app_bt_adv_stage_timer;
 
+/* Counts the starts of a stage, tells a stale timer expiry apart */
+static volatile uint32_t app_bt_adv_stage_epoch;
 
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
-
+static uint16_t app_bt_trace_btm_arg(wiced_bt_management_evt_t event,
+                                     wiced_bt_management_evt_data_t *p_event_data);
+static void app_bt_adv_start(void);
+static void app_bt_adv_stage_timer_cb(TimerHandle_t timer);
+static int app_bt_adv_stage_next(void *p_data);
 
 /*******************************************************************************
  *       Function Definitions
  ******************************************************************************/
 
+/**
+* Function Name: app_bt_trace_btm_arg
+*
+* Function Description:
+* @brief  Picks the value recorded in the trace with a management event:
+*         the status, the new advertising mode or the new connection
+*         interval
+*
+* @param event          Management event
+*
+* @param p_event_data   Event data
+*
+* @return uint16_t      Value for the arg field of the trace entry
+*/
+static uint16_t app_bt_trace_btm_arg(wiced_bt_management_evt_t event,
+                                     wiced_bt_management_evt_data_t *p_event_data)
+{
+    switch (event)
+    {
+    case BTM_ENABLED_EVT:
+        return (uint16_t)p_event_data->enabled.status;
+    case BTM_ENCRYPTION_STATUS_EVT:
+        return (uint16_t)p_event_data->encryption_status.result;
+    case BTM_BLE_ADVERT_STATE_CHANGED_EVT:
+        return (uint16_t)p_event_data->ble_advert_state_changed;
+    case BTM_BLE_CONNECTION_PARAM_UPDATE:
+        return p_event_data->ble_connection_param_update.conn_interval;
+    default:
+        return 0;
+    }
+}
+
 /**
 * Function Name: app_bt_management_callback
 *
@@ -118,6 +158,10 @@ wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event,
     wiced_bt_device_address_t bda = {0};
     wiced_bt_ble_advert_mode_t *p_adv_mode = NULL;
     wiced_bt_dev_encryption_status_t *p_status = NULL;
+    app_bt_conn_t *p_conn = NULL;
+
+    app_trace_record(APP_TRACE_BTM, (uint8_t)event, 0, 0,
+                     app_bt_trace_btm_arg(event, p_event_data));
 
     switch (event)
     {
@@ -125,19 +169,21 @@ wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event,
         /* Bluetooth Controller and Host Stack Enabled */
         if (WICED_BT_SUCCESS == p_event_data->enabled.status)
         {
+            app_boot_time_mark(APP_BOOT_PHASE_BT_ENABLED);
             /* Initialize the application */
             wiced_bt_set_local_bdaddr((uint8_t *)cy_bt_device_address, BLE_ADDR_PUBLIC);
             /* Bluetooth is enabled */
             wiced_bt_dev_read_local_addr(bda);
-            printf("Local Bluetooth Address: ");
+            APP_LOG_INFO("Local Bluetooth Address: ");
             print_bd_address(bda);
             /* Perform application-specific initialization */
             app_bt_init();
+            app_boot_time_mark(APP_BOOT_PHASE_APP_INIT);
             result = WICED_BT_SUCCESS;
         }
         else
         {
-            printf("Failed to initialize Bluetooth controller and stack \r\n");
+            APP_LOG_ERR("Failed to initialize Bluetooth controller and stack \r\n");
         }
         break;
 
@@ -167,93 +213,135 @@ wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event,
 
     case BTM_LOCAL_IDENTITY_KEYS_UPDATE_EVT:
         /* Local identity Keys Update */
+        app_bt_bond_save_local_keys(&p_event_data->local_identity_keys_update);
         result = WICED_BT_SUCCESS;
         break;
 
     case BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT:
-        /* Local identity Keys Request */
-        result = WICED_BT_ERROR;
+        /* Local identity Keys Request, the stack generates new keys on error */
+        result = app_bt_bond_get_local_keys(&p_event_data->local_identity_keys_request);
         break;
 
     case BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT:
         /* Paired Device Link Keys update */
+        app_bt_bond_save(&p_event_data->paired_device_link_keys_update);
         result = WICED_BT_SUCCESS;
         break;
 
     case BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
         /* Paired Device Link Keys Request */
-        result = WICED_BT_ERROR;
+        result = app_bt_bond_get(p_event_data->paired_device_link_keys_request.bd_addr,
+                                 &p_event_data->paired_device_link_keys_request);
         break;
 
     case BTM_ENCRYPTION_STATUS_EVT:
         p_status = &p_event_data->encryption_status;
-        printf("Encryption Status Event for : bd ");
+        APP_LOG_INFO("Encryption Status Event for : bd ");
         print_bd_address(p_status->bd_addr);
-        printf("  res: %d \r\n", p_status->result);
+        APP_LOG_INFO("  res: %d \r\n", p_status->result);
+        if (WICED_BT_SUCCESS == p_status->result)
+        {
+            /* Directed advertising goes to the peer seen last */
+            app_bt_bond_used(p_status->bd_addr);
+        }
+#if APP_BT_EATT_SUPPORT
+        /* Enhanced ATT bearers need an encrypted link */
+        if (WICED_BT_SUCCESS == p_status->result)
+        {
+            app_bt_eatt_connect(p_status->bd_addr);
+        }
+#endif
         result = WICED_BT_SUCCESS;
         break;
 
     case BTM_SECURITY_REQUEST_EVT:
-        printf("  BTM_SECURITY_REQUEST_EVT\r\n");
+        APP_LOG_INFO("  BTM_SECURITY_REQUEST_EVT\r\n");
         wiced_bt_ble_security_grant(p_event_data->security_request.bd_addr,
                                     WICED_BT_SUCCESS);
         result = WICED_BT_SUCCESS;
         break;
 
     case BTM_BLE_CONNECTION_PARAM_UPDATE:
-        printf("BTM_BLE_CONNECTION_PARAM_UPDATE \r\n");
+        p_conn = app_bt_conn_find_by_addr(p_event_data->ble_connection_param_update.bd_addr);
+        if ((NULL != p_conn) &&
+            (WICED_BT_SUCCESS == p_event_data->ble_connection_param_update.status))
+        {
+            p_conn->conn_params.conn_interval = p_event_data->ble_connection_param_update.conn_interval;
+            p_conn->conn_params.conn_latency = p_event_data->ble_connection_param_update.conn_latency;
+            p_conn->conn_params.supervision_timeout = p_event_data->ble_connection_param_update.supervision_timeout;
+            app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_LINK);
+            app_bt_link_ctrl_params_updated(p_conn->conn_id,
+                                            p_conn->conn_params.conn_interval);
+        }
+        APP_LOG_INFO("BTM_BLE_CONNECTION_PARAM_UPDATE \r\n");
         print_bd_address(p_event_data->ble_connection_param_update.bd_addr);
-        printf("ble_connection_param_update.conn_interval       : %d\r\n",
+        APP_LOG_INFO("ble_connection_param_update.conn_interval       : %d\r\n",
                 p_event_data->ble_connection_param_update.conn_interval);
-        printf("ble_connection_param_update.conn_latency        : %d\r\n",
+        APP_LOG_INFO("ble_connection_param_update.conn_latency        : %d\r\n",
                 p_event_data->ble_connection_param_update.conn_latency);
-        printf("ble_connection_param_update.supervision_timeout : %d\r\n",
+        APP_LOG_INFO("ble_connection_param_update.supervision_timeout : %d\r\n",
                 p_event_data->ble_connection_param_update.supervision_timeout);
-        printf("ble_connection_param_update.status              : %d\r\n\n",
+        APP_LOG_INFO("ble_connection_param_update.status              : %d\r\n\n",
                 p_event_data->ble_connection_param_update.status);
         result = WICED_BT_SUCCESS;
         break;
 
     case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
-        printf("BTM_BLE_DATA_LENGTH_UPDATE_EVENT, \r\n"
+        APP_LOG_INFO("BTM_BLE_DATA_LENGTH_UPDATE_EVENT, \r\n"
                 "Max tx octets is :%d ,\r\n"
                 "Max rx octets is :%d \r\n",
                 p_event_data->ble_data_length_update_event.max_tx_octets,
                 p_event_data->ble_data_length_update_event.max_rx_octets);
-                break;
+        p_conn = app_bt_conn_find_by_addr(p_event_data->ble_data_length_update_event.bd_address);
+        if (NULL != p_conn)
+        {
+            p_conn->tx_octets = p_event_data->ble_data_length_update_event.max_tx_octets;
+            app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_LINK);
+        }
+        result = WICED_BT_SUCCESS;
+        break;
+
+    case BTM_BLE_PHY_UPDATE_EVT:
+        APP_LOG_INFO("BTM_BLE_PHY_UPDATE_EVT, status %d tx_phy %d rx_phy %d \r\n",
+                p_event_data->ble_phy_update_event.status,
+                p_event_data->ble_phy_update_event.tx_phy,
+                p_event_data->ble_phy_update_event.rx_phy);
+        p_conn = app_bt_conn_find_by_addr(p_event_data->ble_phy_update_event.bd_address);
+        if ((NULL != p_conn) && (WICED_BT_SUCCESS == p_event_data->ble_phy_update_event.status))
+        {
+            p_conn->tx_phy = p_event_data->ble_phy_update_event.tx_phy;
+            p_conn->rx_phy = p_event_data->ble_phy_update_event.rx_phy;
+            app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_LINK);
+        }
+        result = WICED_BT_SUCCESS;
+        break;
 
     case BTM_BLE_ADVERT_STATE_CHANGED_EVT:
         /* Advertisement State Changed */
         p_adv_mode = &p_event_data->ble_advert_state_changed;
-        printf("Advertisement State Change: %s\r\n",
+        APP_LOG_INFO("Advertisement State Change: %s\r\n",
                 get_bt_advert_mode_name(*p_adv_mode));
         if (BTM_BLE_ADVERT_OFF == *p_adv_mode)
         {
             /* Advertisement Stopped */
-            printf("Advertisement stopped\r\n");
-            /* Check connection status after advertisement stops */
-            if (ota_app.bt_conn_id == 0)
-            {
-                app_bt_adv_conn_state = APP_BT_ADV_OFF_CONN_OFF;
-            }
-            else
-            {
-                app_bt_adv_conn_state = APP_BT_ADV_OFF_CONN_ON;
-            }
+            APP_LOG_INFO("Advertisement stopped\r\n");
         }
         else
         {
             /* Advertisement Started */
-            printf("Advertisement started\r\n");
-            app_bt_adv_conn_state = APP_BT_ADV_ON_CONN_OFF;
+            APP_LOG_INFO("Advertisement started\r\n");
+            /* Prints the boot report the first time only */
+            app_boot_time_mark(APP_BOOT_PHASE_ADV_STARTED);
         }
+        /* Combine the new advertising state with the connection count */
+        app_bt_adv_conn_state_update();
         /* Update Advertisement LED to reflect the updated state */
-        app_bt_adv_led_update();
+        app_sched_post(APP_SCHED_EVT_LED);
         result = WICED_BT_SUCCESS;
         break;
 
     default:
-        printf("Unhandled Bluetooth Management Event: 0x%x %s\r\n",
+        APP_LOG_DEBUG("Unhandled Bluetooth Management Event: 0x%x %s\r\n",
                 event, get_bt_event_name(event));
         break;
     }
@@ -281,16 +369,19 @@ void app_bt_init(void)
     wiced_bt_gatt_status_t status = WICED_BT_GATT_ERROR;
     wiced_result_t result;
 
-    printf("app_bt_INIT() called\r\n");
+    APP_LOG_INFO("app_bt_INIT() called\r\n");
     /* Initialize the PWM used for Advertising LED */
     cy_result = cyhal_pwm_init(&adv_led_pwm, ADV_LED_GPIO, NULL);
 
     /* PWM init failed. Stop program execution */
     if (CY_RSLT_SUCCESS != cy_result)
     {
-        printf("Advertisement LED PWM Initialization has failed! \r\n");
+        APP_LOG_ERR("Advertisement LED PWM Initialization has failed! \r\n");
         CY_ASSERT(0);
     }
+    /* LED changes are posted by the Bluetooth callbacks and applied in the
+     * application loop */
+    app_sched_register(APP_SCHED_EVT_LED, app_bt_adv_led_update, 0);
 
     /* Disable pairing for this application */
     wiced_bt_set_pairable_mode(WICED_TRUE, 0);
@@ -301,200 +392,298 @@ void app_bt_init(void)
 
     /* Register with BT stack to receive GATT callback */
     status = wiced_bt_gatt_register(app_bt_gatt_event_callback);
-    printf("GATT event Handler registration status: %s \r\n",
+    APP_LOG_INFO("GATT event Handler registration status: %s \r\n",
             get_bt_gatt_status_name(status));
 
+    /* Hand every service handle range to its module */
+    app_bt_svc_init();
+    app_bt_gatt_svc_register();
+    app_bt_svc_bas_register();
+    app_bt_svc_ota_register();
+    app_bt_svc_diag_register();
+    app_bt_svc_hist_register();
+
     /* Initialize GATT Database */
     status = wiced_bt_gatt_db_init(gatt_database, gatt_database_len, NULL);
-    printf("GATT database initialization status: %s \r\n",
+    APP_LOG_INFO("GATT database initialization status: %s \r\n",
             get_bt_gatt_status_name(status));
 
-    /* Start Undirected Bluetooth LE Advertisements on device startup.
-     * The corresponding parameters are contained in 'app_bt_cfg.c' */
-    result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
-    if (WICED_BT_SUCCESS != result)
+    /* Notifications are coalesced per connection before they are sent */
+    app_bt_notify_init();
+
+    /* Connection intervals follow OTA and notification activity */
+    app_bt_link_ctrl_init();
+
+#if APP_BT_EATT_SUPPORT
+    /* Accept and open Enhanced ATT bearers, one per traffic class */
+    app_bt_eatt_init();
+#endif
+
+#if APP_OTA_L2CAP_SUPPORT
+    /* OTA image data can also arrive on an L2CAP channel */
+    if (CY_RSLT_SUCCESS != app_ota_l2cap_init())
     {
-        printf("Advertisement cannot start because of error: %d \r\n",
-                result);
+        APP_LOG_ERR("OTA L2CAP transport initialization failed \r\n");
+    }
+#endif
+
+    /* Bonded peers using private addresses are resolved by the controller
+     * and may connect while only bonded peers are accepted */
+    app_bt_bond_load_lists();
+
+    app_bt_adv_stage_timer = xTimerCreate("Adv", pdMS_TO_TICKS(APP_BT_ADV_DIRECTED_MS),
+                                          pdFALSE, NULL, app_bt_adv_stage_timer_cb);
+    if (NULL == app_bt_adv_stage_timer)
+    {
+        APP_LOG_ERR("Advertising stage timer creation failed\r\n");
         CY_ASSERT(0);
     }
 
-    printf("***********************************************\r\n");
-    printf("**Discover device with \"Battery Server\" name*\r\n");
-    printf("***********************************************\r\n\n");
+    /* Start Bluetooth LE Advertisements on device startup, directed first
+     * when a peer is bonded. The corresponding parameters are contained in
+     * 'app_bt_cfg.c' */
+    app_bt_adv_stage = APP_BT_ADV_STAGE_DIRECTED;
+    app_bt_adv_start();
+
+    APP_LOG_INFO("***********************************************\r\n");
+    APP_LOG_INFO("**Discover device with \"Battery Server\" name*\r\n");
+    APP_LOG_INFO("***********************************************\r\n\n");
 
 }
 
 /**
 * Function Name:
-* app_bt_adv_led_update
+* app_bt_adv_conn_state_update
 *
 * Function Description :
-* @brief This function updates the advertising LED state based on Bluetooth LE
-*         advertising connection state.
+* @brief This function derives the advertising/connection state from the
+*         current advertising mode and the number of connected centrals.
 *
 * @return void
 */
-void app_bt_adv_led_update(void)
+void app_bt_adv_conn_state_update(void)
 {
-    cy_rslt_t cy_result = CY_RSLT_SUCCESS;
+    bool adv_on = (BTM_BLE_ADVERT_OFF != wiced_bt_ble_get_current_advert_mode());
+    bool conn_on = (0 != app_bt_conn_count());
 
-    /* Stop the advertising led pwm */
-    cy_result = cyhal_pwm_stop(&adv_led_pwm);
-    if (CY_RSLT_SUCCESS != cy_result)
+    if (conn_on)
     {
-        printf("Failed to stop PWM !!\r\n");
+        app_bt_adv_conn_state = adv_on ? APP_BT_ADV_ON_CONN_ON : APP_BT_ADV_OFF_CONN_ON;
     }
+    else
+    {
+        app_bt_adv_conn_state = adv_on ? APP_BT_ADV_ON_CONN_OFF : APP_BT_ADV_OFF_CONN_OFF;
+    }
+}
 
-    /* Update LED state based on Bluetooth LE advertising/connection state.
-     * LED OFF for no advertisement/connection, LED blinking for advertisement
-     * state, and LED ON for connected state  */
-    switch (app_bt_adv_conn_state)
+/**
+* Function Name:
+* app_bt_adv_restart
+*
+* Function Description :
+* @brief This function restarts advertising as long as the connection table
+*         has a free slot and advertising is not running. With no central
+*         connected, reconnection advertising starts over.
+*
+* @return void
+*/
+void app_bt_adv_restart(void)
+{
+    if (!app_bt_conn_slot_available() ||
+        (BTM_BLE_ADVERT_OFF != wiced_bt_ble_get_current_advert_mode()))
     {
-    case APP_BT_ADV_OFF_CONN_OFF:
-        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_OFF_DUTY_CYCLE,
-                                             ADV_LED_PWM_FREQUENCY);
-        break;
+        return;
+    }
 
-    case APP_BT_ADV_ON_CONN_OFF:
-        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_BLINKING_DUTY_CYCLE,
-                                             ADV_LED_PWM_FREQUENCY);
+    app_bt_adv_stage = (0 == app_bt_conn_count()) ? APP_BT_ADV_STAGE_DIRECTED :
+                                                    APP_BT_ADV_STAGE_OPEN;
+    app_bt_adv_start();
+}
+
+/**
+* Function Name:
+* app_bt_adv_start
+*
+* Function Description :
+* @brief This function starts advertising for the current stage. Stages that
+*         have no use, with no bond or a connected last peer, are skipped.
+*
+* @return void
+*/
+static void app_bt_adv_start(void)
+{
+    wiced_bt_device_link_keys_t last;
+    wiced_result_t result;
+
+    xTimerStop(app_bt_adv_stage_timer, 0);
+    app_bt_adv_stage_epoch++;
+
+    /* The links are being closed for a reboot */
+    if (app_reboot_pending())
+    {
+        return;
+    }
+
+    if ((APP_BT_ADV_STAGE_DIRECTED == app_bt_adv_stage) &&
+        (!app_bt_bond_get_by_rank(0, &last) || (NULL != app_bt_conn_find_by_addr(last.bd_addr))))
+    {
+        app_bt_adv_stage = APP_BT_ADV_STAGE_ACCEPT_LIST;
+    }
+    if ((APP_BT_ADV_STAGE_ACCEPT_LIST == app_bt_adv_stage) &&
+        ((0 == app_bt_bond_count()) || (0 != app_bt_conn_count())))
+    {
+        app_bt_adv_stage = APP_BT_ADV_STAGE_OPEN;
+    }
+
+    switch (app_bt_adv_stage)
+    {
+    case APP_BT_ADV_STAGE_DIRECTED:
+        APP_LOG_INFO("Directed advertising to ");
+        print_bd_address(last.bd_addr);
+        result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_DIRECTED_HIGH,
+                                               last.key_data.ble_addr_type, last.bd_addr);
+        xTimerChangePeriod(app_bt_adv_stage_timer, pdMS_TO_TICKS(APP_BT_ADV_DIRECTED_MS), 0);
         break;
 
-    case APP_BT_ADV_OFF_CONN_ON:
-        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_ON_DUTY_CYCLE,
-                                             ADV_LED_PWM_FREQUENCY);
+    case APP_BT_ADV_STAGE_ACCEPT_LIST:
+        APP_LOG_INFO("Advertising to %d bonded peers\r\n", app_bt_bond_count());
+        wiced_bt_ble_update_advertisement_filter_policy(BTM_BLE_ADV_POLICY_FILTER_CONN_FILTER_SCAN);
+        result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
+        xTimerChangePeriod(app_bt_adv_stage_timer, pdMS_TO_TICKS(APP_BT_ADV_ACCEPT_LIST_MS), 0);
         break;
 
     default:
-        /* LED OFF for unexpected states */
-        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_OFF_DUTY_CYCLE,
-                                             ADV_LED_PWM_FREQUENCY);
+        wiced_bt_ble_update_advertisement_filter_policy(BTM_BLE_ADV_POLICY_ACCEPT_CONN_AND_SCAN);
+        result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
         break;
     }
-    /* Check if update to PWM parameters is successful*/
-    if (CY_RSLT_SUCCESS != cy_result)
-    {
-        printf("Failed to set duty cycle parameters!!\r\n");
-    }
-
-    /* Start the advertising led pwm */
-    cy_result = cyhal_pwm_start(&adv_led_pwm);
 
-    /* Check if PWM started successfully */
-    if (CY_RSLT_SUCCESS != cy_result)
+    if (WICED_BT_SUCCESS != result)
     {
-        printf("Failed to start PWM !!\r\n");
+        APP_LOG_ERR("Advertisement cannot start because of error: %d \r\n",
+                result);
+        CY_ASSERT(0);
     }
 }
 
 /**
 * Function Name:
-* app_bt_batt_level_init
+* app_bt_adv_stage_timer_cb
 *
 * Function Description :
-* @brief This function Starts the timer for updating Battery Level
+* @brief Ends the current stage of reconnection advertising. Runs in the
+*         timer task, so the stage change is handed to the Bluetooth stack
+*         task, which also restarts advertising on connection events.
 *
-* @param void
+* @param timer  Unused
 *
 * @return void
 */
-void app_bt_batt_level_init(void)
+static void app_bt_adv_stage_timer_cb(TimerHandle_t timer)
 {
-    /* Start the timer */
-    if (CY_RSLT_SUCCESS != cyhal_timer_start(&bas_timer_obj))
+    (void)timer;
+
+    if (WICED_SUCCESS != wiced_app_event_serialize(app_bt_adv_stage_next,
+                                                   (void *)(uintptr_t)app_bt_adv_stage_epoch))
     {
-        printf("BAS timer start failed !");
-        CY_ASSERT(0);
+        APP_LOG_ERR("Advertising stage change not serialized\r\n");
     }
 }
 
 /**
 * Function Name:
-* bas_task
+* app_bt_adv_stage_next
 *
-* Function Description:
-* @brief This task updates dummy battery value every time it is notified
-*         and sends a notification to the connected peer
+* Function Description :
+* @brief Moves reconnection advertising to its next stage when no central
+*         has connected in the current one. Runs in the Bluetooth stack task.
 *
-* @param pvParam: unused
+* @param p_data Stage epoch when the timer expired, the stage has been
+*               restarted since when it differs
 *
-* @return void
+* @return int   0
 */
-void bas_task(void *pvParam)
+static int app_bt_adv_stage_next(void *p_data)
 {
-
-    cy_rslt_t cy_result = CY_RSLT_SUCCESS;
-    /* Initialize the HAL timer used to count seconds */
-    cy_result = cyhal_timer_init(&bas_timer_obj, NC, NULL);
-    if (CY_RSLT_SUCCESS != cy_result)
-    {
-        printf("BAS timer init failed !\n");
-    }
-    /* Configure the timer for 5 seconds */
-    cyhal_timer_configure(&bas_timer_obj, &bas_timer_cfg);
-    cy_result = cyhal_timer_set_frequency(&bas_timer_obj, BATTERY_LEVEL_UPDATE_FREQ);
-    if (CY_RSLT_SUCCESS != cy_result)
+    if (((uint32_t)(uintptr_t)p_data != app_bt_adv_stage_epoch) ||
+        (APP_BT_ADV_STAGE_OPEN == app_bt_adv_stage) || (0 != app_bt_conn_count()))
     {
-        printf("BAS timer set freq failed !\n");
+        return 0;
     }
-    /* Register for a callback whenever timer reaches terminal count */
-    cyhal_timer_register_callback(&bas_timer_obj, bas_timer_callb, NULL);
-    cyhal_timer_enable_event(&bas_timer_obj, CYHAL_TIMER_IRQ_TERMINAL_COUNT, 3, true);
 
-    /* Start battery level timer */
-    app_bt_batt_level_init();
-
-    while(true)
+    /* The filter policy only changes while advertising is off */
+    if (BTM_BLE_ADVERT_OFF != wiced_bt_ble_get_current_advert_mode())
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        /* Battery level is read from gatt db and is reduced by 2 percent
-        * by default and initialized again to 100 once it reaches 0*/
-        if (0 == app_bas_battery_level[0])
-        {
-            app_bas_battery_level[0] = 100;
-        }
-        else
-        {
-            app_bas_battery_level[0] = app_bas_battery_level[0] - BATTERY_LEVEL_CHANGE;
-        }
-        if (ota_app.bt_conn_id)
-        {
-            if (app_bas_battery_level_client_char_config[0] & GATT_CLIENT_CONFIG_NOTIFICATION)
-            {
-                wiced_bt_gatt_server_send_notification(ota_app.bt_conn_id,
-                                                HDLC_BAS_BATTERY_LEVEL_VALUE,
-                                                app_bas_battery_level_len,
-                                                app_bas_battery_level,NULL);
-
-                printf("================================================\r\n");
-                printf("Sending Notification: Battery level: %u\r\n",
-                        app_bas_battery_level[0]);
-                printf("================================================\r\n");
-            }
-        }
+        wiced_bt_start_advertisements(BTM_BLE_ADVERT_OFF, 0, NULL);
     }
+    app_bt_adv_stage++;
+    app_bt_adv_start();
+    return 0;
 }
 
 /**
 * Function Name:
-* bas_timer_callb
-*
-* Function Description:
-* @brief  This callback function is invoked on timeout of 1 second timer
-*
-* @param callback_arg: unused
+* app_bt_adv_led_update
 *
-* @param event: unused
+* Function Description :
+* @brief This function updates the advertising LED state based on Bluetooth LE
+*         advertising connection state. Runs in the application loop on
+*         APP_SCHED_EVT_LED.
 *
 * @return void
 */
-void bas_timer_callb(void *callback_arg, cyhal_timer_event_t event)
+void app_bt_adv_led_update(void)
 {
-    BaseType_t xHigherPriorityTaskWoken;
-    xHigherPriorityTaskWoken = pdFALSE;
-    vTaskNotifyGiveFromISR(bas_task_handle, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    cy_rslt_t cy_result = CY_RSLT_SUCCESS;
+
+    /* Stop the advertising led pwm */
+    cy_result = cyhal_pwm_stop(&adv_led_pwm);
+    if (CY_RSLT_SUCCESS != cy_result)
+    {
+        APP_LOG_ERR("Failed to stop PWM !!\r\n");
+    }
+
+    /* Update LED state based on Bluetooth LE advertising/connection state.
+     * LED OFF for no advertisement/connection, LED blinking for advertisement
+     * state, and LED ON as long as at least one central is connected */
+    switch (app_bt_adv_conn_state)
+    {
+    case APP_BT_ADV_OFF_CONN_OFF:
+        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_OFF_DUTY_CYCLE,
+                                             ADV_LED_PWM_FREQUENCY);
+        break;
+
+    case APP_BT_ADV_ON_CONN_OFF:
+        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_BLINKING_DUTY_CYCLE,
+                                             ADV_LED_PWM_FREQUENCY);
+        break;
+
+    case APP_BT_ADV_OFF_CONN_ON:
+    case APP_BT_ADV_ON_CONN_ON:
+        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_ON_DUTY_CYCLE,
+                                             ADV_LED_PWM_FREQUENCY);
+        break;
+
+    default:
+        /* LED OFF for unexpected states */
+        cy_result = cyhal_pwm_set_duty_cycle(&adv_led_pwm, LED_OFF_DUTY_CYCLE,
+                                             ADV_LED_PWM_FREQUENCY);
+        break;
+    }
+    /* Check if update to PWM parameters is successful*/
+    if (CY_RSLT_SUCCESS != cy_result)
+    {
+        APP_LOG_ERR("Failed to set duty cycle parameters!!\r\n");
+    }
+
+    /* Start the advertising led pwm */
+    cy_result = cyhal_pwm_start(&adv_led_pwm);
+
+    /* Check if PWM started successfully */
+    if (CY_RSLT_SUCCESS != cy_result)
+    {
+        APP_LOG_ERR("Failed to start PWM !!\r\n");
+    }
 }
 
 /* [] END OF FILE */
@@ -52,6 +52,7 @@
 #include <task.h>
 /* OTA related header files */
 #include "app_ota_context.h"
+#include "app_bt_conn.h"
 
 /*******************************************************************************
 *        Macro Definitions
@@ -74,8 +75,16 @@
 /**
  * @brief Update rate of Battery level
  */
-#define BATTERY_LEVEL_UPDATE_MS   (9999u)
-#define BATTERY_LEVEL_UPDATE_FREQ (10000)
+#define BATTERY_LEVEL_UPDATE_MS   (1000u)
+
+/**
+ * @brief Reconnection advertising with no central connected and bonds stored:
+ *        high duty cycle directed advertising to the last peer (the stack
+ *        stops it after 1.28 s), then undirected advertising that only
+ *        bonded peers may connect to, then advertising open to all
+ */
+#define APP_BT_ADV_DIRECTED_MS    (1300u)
+#define APP_BT_ADV_ACCEPT_LIST_MS (5000u)
 
 /*******************************************************************************
 *        Variable Definitions
@@ -99,9 +108,20 @@ typedef enum
 {
     APP_BT_ADV_OFF_CONN_OFF,
     APP_BT_ADV_ON_CONN_OFF,
-    APP_BT_ADV_OFF_CONN_ON
+    APP_BT_ADV_OFF_CONN_ON,
+    APP_BT_ADV_ON_CONN_ON
 } app_bt_adv_conn_mode_t;
 
+/**
+ * @brief Stages of reconnection advertising, in order
+ */
+typedef enum
+{
+    APP_BT_ADV_STAGE_DIRECTED,      /* Directed to the last bonded peer */
+    APP_BT_ADV_STAGE_ACCEPT_LIST,   /* Connections from bonded peers only */
+    APP_BT_ADV_STAGE_OPEN           /* Connections from anyone */
+} app_bt_adv_stage_t;
+
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
@@ -116,13 +136,9 @@ wiced_bt_dev_status_t  app_bt_management_callback(wiced_bt_management_evt_t even
 
 
 void                   app_bt_adv_led_update                 (void);
+void                   app_bt_adv_conn_state_update          (void);
+void                   app_bt_adv_restart                    (void);
 void                   app_bt_init                           (void);
-void                   app_bt_batt_level_init                (void);
-
-/* Task to send notifications with dummy battery values */
-void bas_task(void *pvParam);
-/* HAL timer callback registered when timer reaches terminal count */
-void bas_timer_callb(void *callback_arg, cyhal_timer_event_t event);
 
 #endif
 /* [] END OF FILE */
@@ -41,30 +41,104 @@
  ******************************************************************************/
 #include "wiced_bt_stack.h"
 #include <FreeRTOS.h>
+#include <task.h>
 #include "cyabs_rtos.h"
 #include "app_bt_event_handler.h"
 #include "app_bt_gatt_handler.h"
+#include "app_bt_conn.h"
+#include "app_bt_notify.h"
+#include "app_bt_bearer.h"
+#include "app_bt_link_ctrl.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_ota.h"
+#include "app_bt_svc_hist.h"
+#include "app_bt_gatt_queue.h"
+#include "app_trace.h"
+#include "app_sched.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
 
 /*******************************************************************************
 *        Macro Definitions
 *******************************************************************************/
+/* ATT MTU that fills one 251 byte LL payload after the 4 byte L2CAP header */
+#define APP_BT_PREFERRED_MTU            (247u)
+
+/* Maximum LL payload and the matching transmit time on the 1M PHY */
+#define APP_BT_MAX_TX_OCTETS            (251u)
+#define APP_BT_MAX_TX_TIME_US           (2120u)
 
 /*******************************************************************************
 *        Variable Definitions
 *******************************************************************************/
 extern app_bt_adv_conn_mode_t app_bt_adv_conn_state ;
-gatt_write_req_buf_t write_buff;
 
 /* MTU size negotiated between local and peer device */
-static uint16_t preferred_mtu_size = CY_BT_MTU_SIZE;
+static uint16_t preferred_mtu_size = APP_BT_PREFERRED_MTU;
 
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
+static uint16_t app_bt_trace_att_handle(wiced_bt_gatt_attribute_request_t *p_attr_req);
 
 /*******************************************************************************
 *       Function Definitions
 *******************************************************************************/
+/**
+* Function Name:
+* app_bt_trace_att_handle
+*
+* Function Description:
+* @brief  Returns the attribute handle an ATT request targets, or 0 for
+*         requests that do not name a single handle
+*
+* @param p_attr_req     Attribute request from the stack
+*
+* @return uint16_t      Handle recorded in the trace entry
+*/
+static uint16_t app_bt_trace_att_handle(wiced_bt_gatt_attribute_request_t *p_attr_req)
+{
+    switch (p_attr_req->opcode)
+    {
+    case GATT_REQ_READ:
+    case GATT_REQ_READ_BLOB:
+        return p_attr_req->data.read_req.handle;
+    case GATT_REQ_WRITE:
+    case GATT_CMD_WRITE:
+    case GATT_REQ_PREPARE_WRITE:
+        return p_attr_req->data.write_req.handle;
+    default:
+        return 0;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_gatt_opcode_is_cmd
+*
+* Function Description:
+* @brief  Tells the ATT PDUs from the client that take no response: write
+*         commands, and the confirmation of an indication
+*
+* @param opcode         ATT opcode
+*
+* @return bool          true if no response, error response included, may
+*                       be sent
+*/
+bool app_bt_gatt_opcode_is_cmd(wiced_bt_gatt_opcode_t opcode)
+{
+    switch (opcode)
+    {
+    case GATT_CMD_WRITE:
+    case GATT_CMD_SIGNED_WRITE:
+    case GATT_HANDLE_VALUE_CONF:
+    case GATT_HANDLE_VALUE_NOTIF:
+        return true;
+    default:
+        return false;
+    }
+}
+
 /**
 * Function Name:
 * app_bt_free_buffer
@@ -97,32 +171,81 @@ uint8_t *app_bt_alloc_buffer(uint16_t len)
     uint8_t *p = (uint8_t *)wiced_bt_get_buffer(len);
     if (!p)
     {
-        printf("OOM\r\n");
+        APP_LOG_ERR("OOM\r\n");
         CY_ASSERT(0);
     }
     return p;
 }
 
-static wiced_bt_gatt_status_t app_bt_ble_send_notification(uint16_t bt_conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t* p_val)
+wiced_bt_gatt_status_t app_bt_ble_send_notification(uint16_t bt_conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t* p_val)
 {
     wiced_bt_gatt_status_t status = (wiced_bt_gatt_status_t)WICED_BT_GATT_ERROR;
 
-    status = wiced_bt_gatt_server_send_notification(bt_conn_id, attr_handle, val_len, p_val, NULL);    /* bt_notify_buff is not allocated, no need to keep track of it w/context */
+    status = app_bt_notify_queue(bt_conn_id, attr_handle, val_len, p_val);    /* value is copied, bt_notify_buff can be reused */
     if (status != WICED_BT_SUCCESS)
     {
-        printf("%s() Notification FAILED conn_id:0x%x (%d) handle: %d val_len: %d value:%d\n", __func__, bt_conn_id, bt_conn_id, attr_handle, val_len, *p_val);
+        APP_LOG_ERR("%s() Notification FAILED conn_id:0x%x (%d) handle: %d val_len: %d value:%d\n", __func__, bt_conn_id, bt_conn_id, attr_handle, val_len, *p_val);
     }
     return status;
 }
 
-static wiced_bt_gatt_status_t app_bt_ble_send_indication(uint16_t bt_conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t* p_val)
+/* Like app_bt_ble_send_notification(), but sent at once: for command
+ * responses, which the peer waits on before it goes on */
+wiced_bt_gatt_status_t app_bt_ble_send_response(uint16_t bt_conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t* p_val)
+{
+    wiced_bt_gatt_status_t status = app_bt_notify_send(bt_conn_id, attr_handle, val_len, p_val);
+
+    if (status != WICED_BT_SUCCESS)
+    {
+        APP_LOG_ERR("%s() Notification FAILED conn_id:0x%x (%d) handle: %d val_len: %d value:%d\n", __func__, bt_conn_id, bt_conn_id, attr_handle, val_len, *p_val);
+    }
+    return status;
+}
+
+wiced_bt_gatt_status_t app_bt_ble_send_indication(uint16_t bt_conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t* p_val)
 {
     wiced_bt_gatt_status_t status = (wiced_bt_gatt_status_t)WICED_BT_GATT_ERROR;
+    uint8_t *p_buf = app_bt_alloc_buffer(val_len);
 
-    status = wiced_bt_gatt_server_send_indication(bt_conn_id, attr_handle, val_len, p_val, NULL);    /* bt_notify_buff is not allocated, no need to keep track of it w/context */
+    /* Indications use the control bearer so they do not wait behind OTA data */
+    bt_conn_id = app_bt_bearer_for_traffic(bt_conn_id, app_bt_bearer_traffic_of_handle(attr_handle));
+    memcpy(p_buf, p_val, val_len);    /* the stack keeps the buffer until the PDU is sent */
+    status = wiced_bt_gatt_server_send_indication(bt_conn_id, attr_handle, val_len, p_buf,
+                                                  (void *)app_bt_free_buffer);
     if (status != WICED_BT_SUCCESS)
     {
-        printf("%s() Indication FAILED conn_id:0x%x (%d) handle: %d val_len: %d value:%d\n", __func__, bt_conn_id, bt_conn_id, attr_handle, val_len, *p_val);
+        app_bt_free_buffer(p_buf);
+        APP_LOG_ERR("%s() Indication FAILED conn_id:0x%x (%d) handle: %d val_len: %d value:%d\n", __func__, bt_conn_id, bt_conn_id, attr_handle, val_len, *p_val);
+    }
+    return status;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_attr_request
+*
+* Function Description:
+* @brief  Serves one attribute request and answers it with an error response
+*         when a handler fails, unless the opcode takes no response. Runs in
+*         the GATT task, or in the stack callback when APP_BT_GATT_DEFER is 0.
+*
+* @param p_event_data   Event data of GATT_ATTRIBUTE_REQUEST_EVT
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_gatt_attr_request(wiced_bt_gatt_event_data_t *p_event_data)
+{
+    wiced_bt_gatt_attribute_request_t *p_attr_req = &p_event_data->attribute_request;
+    uint16_t error_handle = 0;
+    wiced_bt_gatt_status_t status;
+
+    status = app_bt_server_event_handler(p_event_data, &error_handle);
+    if ((status != WICED_BT_GATT_SUCCESS) && !app_bt_gatt_opcode_is_cmd(p_attr_req->opcode))
+    {
+        wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id,
+                                            p_attr_req->opcode,
+                                            error_handle,
+                                            status);
     }
     return status;
 }
@@ -132,7 +255,10 @@ static wiced_bt_gatt_status_t app_bt_ble_send_indication(uint16_t bt_conn_id, ui
 * app_bt_gatt_event_callback
 *
 * Function Description:
-* @brief  This Function handles the all the GATT events - GATT Event Handler
+* @brief  This Function handles the all the GATT events - GATT Event Handler.
+*         Attribute requests are copied to the GATT task, which sends the
+*         responses, so the stack task is not held by flash writes or OTA
+*         commands. The time spent here is accounted per callback.
 *
 * @param event            Bluetooth LE GATT event type
 *
@@ -144,9 +270,26 @@ wiced_bt_gatt_status_t app_bt_gatt_event_callback(wiced_bt_gatt_evt_t event,
                                     wiced_bt_gatt_event_data_t *p_event_data)
 {
     wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
-    uint16_t error_handle = 0;
     wiced_bt_gatt_attribute_request_t *p_attr_req = &p_event_data->attribute_request;
     pfn_free_buffer_t pfn_free;
+    uint32_t start = app_log_cycles();
+
+    if (GATT_CONNECTION_STATUS_EVT == event)
+    {
+        app_trace_record(APP_TRACE_GATT, (uint8_t)event,
+                         p_event_data->connection_status.conn_id, 0,
+                         (uint16_t)p_event_data->connection_status.connected);
+    }
+    else if (GATT_ATTRIBUTE_REQUEST_EVT == event)
+    {
+        app_trace_record(APP_TRACE_GATT, (uint8_t)event, p_attr_req->conn_id,
+                         app_bt_trace_att_handle(p_attr_req),
+                         (uint16_t)p_attr_req->opcode);
+    }
+    else
+    {
+        app_trace_record(APP_TRACE_GATT, (uint8_t)event, 0, 0, 0);
+    }
 
     /* Call the appropriate callback function based on the GATT event type,
      * and pass the relevant event
@@ -158,15 +301,18 @@ wiced_bt_gatt_status_t app_bt_gatt_event_callback(wiced_bt_gatt_evt_t event,
         break;
 
     case GATT_ATTRIBUTE_REQUEST_EVT:
-        status = app_bt_server_event_handler (p_event_data,
-                                              &error_handle);
-        if(status != WICED_BT_GATT_SUCCESS)
+#if APP_BT_GATT_DEFER
+        status = app_bt_gatt_queue_post(p_attr_req);
+        if ((status != WICED_BT_GATT_SUCCESS) && !app_bt_gatt_opcode_is_cmd(p_attr_req->opcode))
         {
-           wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id,
-                                               p_attr_req->opcode,
-                                               error_handle,
-                                               status);
+            wiced_bt_gatt_server_send_error_rsp(p_attr_req->conn_id,
+                                                p_attr_req->opcode,
+                                                app_bt_trace_att_handle(p_attr_req),
+                                                status);
         }
+#else
+        status = app_bt_gatt_attr_request(p_event_data);
+#endif
         break;
 
         /* GATT buffer request, typically sized to max of bearer mtu - 1 */
@@ -192,9 +338,117 @@ wiced_bt_gatt_status_t app_bt_gatt_event_callback(wiced_bt_gatt_evt_t event,
         break;
     }
 
+    app_bt_gatt_queue_cb_time(app_log_cycles() - start);
     return status;
 }
 
+/**
+* Function Name:
+* app_bt_link_bootstrap
+*
+* Function Description:
+* @brief  Asks the controller for the fastest link the peer accepts: maximum
+*         LL data length and the LE 2M PHY. The ATT MTU is settled when the
+*         peer sends its MTU request. Results come back in
+*         BTM_BLE_DATA_LENGTH_UPDATE_EVENT and BTM_BLE_PHY_UPDATE_EVT.
+*
+* @param bd_addr      Peer address of the new link
+*
+* @return void
+*/
+static void app_bt_link_bootstrap(wiced_bt_device_address_t bd_addr)
+{
+    wiced_bt_ble_phy_preferences_t phy_preferences;
+    wiced_result_t result;
+
+    result = wiced_bt_ble_set_data_packet_length(bd_addr, APP_BT_MAX_TX_OCTETS,
+                                                 APP_BT_MAX_TX_TIME_US);
+    if (WICED_BT_SUCCESS != result)
+    {
+        APP_LOG_ERR("Data length request failed: %d \r\n", result);
+    }
+
+    memcpy(phy_preferences.remote_bd_addr, bd_addr, BD_ADDR_LEN);
+    phy_preferences.tx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy_preferences.rx_phys = BTM_BLE_PREFER_2M_PHY;
+    phy_preferences.phy_opts = BTM_BLE_PREFER_NO_LELR;
+    result = wiced_bt_ble_set_phy(&phy_preferences);
+    if (WICED_BT_SUCCESS != result)
+    {
+        APP_LOG_ERR("2M PHY request failed: %d \r\n", result);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_ota_link_update
+*
+* Function Description:
+* @brief  Copies the link parameters of a connection into ota_app when that
+*         connection is the one driving the OTA. Runs in the GATT task,
+*         the stack task signals APP_BT_GATT_QUEUE_EVT_LINK instead.
+*
+* @param conn_id      Connection ID, any bearer of the link
+*
+* @return void
+*/
+void app_bt_ota_link_update(uint16_t conn_id)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+
+    if ((NULL == p_conn) || (p_conn->conn_id != ota_app.bt_conn_id))
+    {
+        return;
+    }
+    /* The stack task updates the connection table entry */
+    taskENTER_CRITICAL();
+    ota_app.bt_conn_params = p_conn->conn_params;
+    ota_app.bt_mtu = p_conn->mtu;
+    ota_app.bt_tx_octets = p_conn->tx_octets;
+    ota_app.bt_tx_phy = p_conn->tx_phy;
+    ota_app.bt_rx_phy = p_conn->rx_phy;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_gatt_events
+*
+* Function Description:
+* @brief  Runs the events the stack task signalled, in the task that serves
+*         the attribute requests, so the state of the services is only
+*         changed there
+*
+* @param events   app_bt_gatt_queue_evt_t bits
+*
+* @return void
+*/
+void app_bt_gatt_events(uint32_t events)
+{
+    if (0u != (events & APP_BT_GATT_QUEUE_EVT_CONN_DOWN))
+    {
+        app_bt_svc_hist_conn_down();
+
+        /* Clear the OTA connection if the central driving it went away */
+        if ((0u != ota_app.bt_conn_id) && (NULL == app_bt_conn_find(ota_app.bt_conn_id)))
+        {
+            ota_app.bt_conn_id = 0;
+        }
+    }
+    if (0u != (events & APP_BT_GATT_QUEUE_EVT_LINK))
+    {
+        app_bt_ota_link_update(ota_app.bt_conn_id);
+    }
+    if (0u != (events & APP_BT_GATT_QUEUE_EVT_HIST))
+    {
+        app_bt_svc_hist_resume();
+    }
+    if (0u != (events & APP_BT_GATT_QUEUE_EVT_OTA))
+    {
+        app_bt_svc_ota_reply();
+    }
+}
+
 /**
 * Function Name:
 * app_bt_server_event_handler
@@ -215,7 +469,11 @@ wiced_bt_gatt_status_t app_bt_server_event_handler (wiced_bt_gatt_event_data_t *
     wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
     wiced_bt_gatt_attribute_request_t   *p_att_req = &p_data->attribute_request;
     wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
-    cy_ota_agent_state_t ota_lib_state;
+    app_bt_conn_t *p_conn = NULL;
+    app_bt_bearer_t *p_bearer = NULL;
+
+    /* Any request keeps the link out of the idle regime */
+    app_bt_link_ctrl_activity(p_att_req->conn_id, APP_BT_LINK_ACT_GATT);
 
     switch (p_att_req->opcode)
     {
@@ -265,7 +523,7 @@ wiced_bt_gatt_status_t app_bt_server_event_handler (wiced_bt_gatt_event_data_t *
                                               p_error_handle);
         if((p_att_req->opcode == GATT_REQ_PREPARE_WRITE) &&  (status != WICED_BT_GATT_SUCCESS))
         {
-         printf("\n\n== Sending Prepare write error response...\n");
+         APP_LOG_ERR("\n\n== Sending Prepare write error response...\n");
         }
         status = WICED_BT_GATT_SUCCESS;
         break;
@@ -274,38 +532,41 @@ wiced_bt_gatt_status_t app_bt_server_event_handler (wiced_bt_gatt_event_data_t *
         status = app_bt_execute_write_handler(p_data, p_error_handle);
         if((p_att_req->opcode == GATT_REQ_EXECUTE_WRITE) &&  (gatt_status == WICED_BT_GATT_SUCCESS))
         {
-         printf("== Sending execute write success response...\n");
+         APP_LOG_DEBUG("== Sending execute write success response...\n");
          wiced_bt_gatt_server_send_execute_write_rsp(p_att_req->conn_id, p_att_req->opcode);
          status = WICED_BT_GATT_SUCCESS;
         }
         else
         {
-         printf("== Sending execute write error response...\n");
+         APP_LOG_ERR("== Sending execute write error response...\n");
         }
         status = WICED_BT_GATT_SUCCESS;
         break;
 
     case GATT_REQ_MTU:
         /* Application calls wiced_bt_gatt_server_send_mtu_rsp() with the desired mtu */
-        preferred_mtu_size = CY_BT_MTU_SIZE <= (p_att_req->data.remote_mtu) ?
-                             CY_BT_MTU_SIZE : (p_att_req->data.remote_mtu);
+        preferred_mtu_size = APP_BT_PREFERRED_MTU <= (p_att_req->data.remote_mtu) ?
+                             APP_BT_PREFERRED_MTU : (p_att_req->data.remote_mtu);
+        p_conn = app_bt_conn_find(p_att_req->conn_id);
+        if (NULL != p_conn)
+        {
+            p_conn->mtu = preferred_mtu_size;
+        }
+        p_bearer = app_bt_bearer_find(p_att_req->conn_id);
+        if (NULL != p_bearer)
+        {
+            p_bearer->mtu = preferred_mtu_size;
+        }
         status = wiced_bt_gatt_server_send_mtu_rsp(p_att_req->conn_id,
                                                 p_att_req->data.remote_mtu,
-                        wiced_bt_cfg_settings.p_ble_cfg->ble_max_rx_pdu_size);
+                                                APP_BT_PREFERRED_MTU);
+        APP_LOG_INFO("MTU for conn_id %d: %d \r\n", p_att_req->conn_id, preferred_mtu_size);
+        app_bt_ota_link_update(p_att_req->conn_id);
         break;
 
     case GATT_HANDLE_VALUE_CONF: /* Value confirmation */
-        cy_ota_get_state(ota_app.ota_context, &ota_lib_state);
-        if ((ota_lib_state == CY_OTA_STATE_OTA_COMPLETE) && /* Check if we completed the download before rebooting */
-            (ota_app.reboot_at_end != 0))
-        {
-            cy_rtos_delay_milliseconds(1000);
-            Cy_SysPm_TriggerXRes();
-        }
-        else
-        {
-            cy_ota_agent_stop(&ota_app.ota_context); /* Stop OTA */
-        }
+        /* Only the OTA control point is sent as an indication */
+        app_bt_svc_ota_value_conf(p_att_req->conn_id);
         status = WICED_BT_GATT_SUCCESS;
         break;
 
@@ -336,48 +597,60 @@ wiced_bt_gatt_status_t app_bt_server_event_handler (wiced_bt_gatt_event_data_t *
 wiced_bt_gatt_status_t app_bt_connect_event_handler (wiced_bt_gatt_connection_status_t *p_conn_status)
 {
     wiced_bt_gatt_status_t status = WICED_BT_GATT_ERROR;
-    wiced_result_t result;
+    app_bt_conn_t *p_conn = NULL;
+
     if (NULL != p_conn_status)
     {
         if (p_conn_status->connected)
         {
             /* Device has connected */
-            printf("Connected : BDA ");
+            APP_LOG_INFO("Connected : BDA ");
             print_bd_address(p_conn_status->bd_addr);
-            printf("Connection ID '%d'\r\n", p_conn_status->conn_id);
-            /* Store the connection ID and peer BD Address */
-            ota_app.bt_conn_id = p_conn_status->conn_id;
-            memcpy(ota_app.bt_peer_addr, p_conn_status->bd_addr, BD_ADDR_LEN);
-
-            /* Update the adv/conn state */
-            app_bt_adv_conn_state = APP_BT_ADV_OFF_CONN_ON;
-            /* Save BT connection ID in application data structure */
-            ota_app.bt_conn_id = p_conn_status->conn_id;
-            /* Save BT peer ADDRESS in application data structure */
-            memcpy(ota_app.bt_peer_addr, p_conn_status->bd_addr, BD_ADDR_LEN);
+            APP_LOG_INFO("Connection ID '%d'\r\n", p_conn_status->conn_id);
+
+            /* Store the connection ID, peer BD Address and link parameters */
+            p_conn = app_bt_conn_add(p_conn_status->conn_id, p_conn_status->bd_addr);
+            if (NULL == p_conn)
+            {
+                APP_LOG_WARNING("Connection table full, disconnecting '%d'\r\n",
+                        p_conn_status->conn_id);
+                wiced_bt_gatt_disconnect(p_conn_status->conn_id);
+                return WICED_BT_GATT_SUCCESS;
+            }
+            /* The unenhanced ATT bearer of the link */
+            app_bt_bearer_add(p_conn_status->conn_id, p_conn_status->conn_id, 0);
+            wiced_bt_ble_get_connection_parameters(p_conn_status->bd_addr,
+                                                   &p_conn->conn_params);
+            app_bt_link_bootstrap(p_conn_status->bd_addr);
+            app_bt_link_ctrl_conn_up(p_conn_status->conn_id);
+
+            /* Keep advertising while there is room for another central */
+            app_bt_adv_restart();
         }
         else
         {
             /* Device has disconnected */
-            printf("Disconnected : BDA ");
+            APP_LOG_INFO("Disconnected : BDA ");
             print_bd_address(p_conn_status->bd_addr);
-            printf("Connection ID '%d', Reason '%s'\r\n", p_conn_status->conn_id,
+            APP_LOG_INFO("Connection ID '%d', Reason '%s'\r\n", p_conn_status->conn_id,
                     get_bt_gatt_disconn_reason_name(p_conn_status->reason));
-            /* Set the connection id to zero to indicate disconnected state */
-            ota_app.bt_conn_id = 0;
+            app_bt_notify_conn_down(p_conn_status->conn_id);
+            app_bt_gatt_queue_report();
+            app_bt_link_ctrl_conn_down(p_conn_status->conn_id);
+            app_bt_bearer_remove_conn(p_conn_status->conn_id);
+            app_bt_conn_remove(p_conn_status->conn_id);
+
+            /* The History read and the OTA of the link are dropped in the
+             * GATT task, after the requests already queued */
+            app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_CONN_DOWN);
+
             /* Restart the advertisements */
-            result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
-            if (WICED_BT_SUCCESS != result)
-            {
-                printf("Advertisement cannot start because of error: %d \r\n",
-                        result);
-                CY_ASSERT(0);
-            }
-            /* Update the adv/conn state */
-            app_bt_adv_conn_state = APP_BT_ADV_ON_CONN_OFF;
+            app_bt_adv_restart();
         }
+        /* Update the adv/conn state */
+        app_bt_adv_conn_state_update();
         /* Update Advertisement LED to reflect the updated state */
-        app_bt_adv_led_update();
+        app_sched_post(APP_SCHED_EVT_LED);
         status = WICED_BT_GATT_SUCCESS;
     }
 
@@ -390,7 +663,8 @@ wiced_bt_gatt_status_t app_bt_connect_event_handler (wiced_bt_gatt_connection_st
 * Function Description:
 * @brief  The function is invoked when GATTS_REQ_TYPE_WRITE is received from the
 *         client device and is invoked GATT Server Event Callback function. This
-*         handles "Write Requests" received from Client device.
+*         handles "Write Requests" received from Client device. The request is
+*         passed to the service that owns the handle.
 *
 * @param p_write_req   Pointer to Bluetooth LE GATT write request
 *
@@ -402,11 +676,6 @@ wiced_bt_gatt_status_t app_bt_write_handler(wiced_bt_gatt_event_data_t *p_data,
                                                    uint16_t *p_error_handle)
 {
     wiced_bt_gatt_write_req_t* p_write_req;
-    cy_rslt_t result;
-    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
-    uint32_t total_size = 0;
-    bool crc_or_sig_verify = true;
-    uint32_t final_crc32 = 0;
 
     CY_ASSERT(NULL != p_data);
 
@@ -414,148 +683,12 @@ wiced_bt_gatt_status_t app_bt_write_handler(wiced_bt_gatt_event_data_t *p_data,
 
     CY_ASSERT(NULL != p_write_req);
 
-    *p_error_handle = p_write_req->handle;
-
-    switch (p_write_req->handle)
-    {
-    case HDLD_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_CLIENT_CHAR_CONFIG:
-        ota_app.bt_config_descriptor = p_write_req->p_val[0];
-        gatt_status = WICED_BT_GATT_SUCCESS;
-        break;
+    app_trace_record(APP_TRACE_WRITE, 0, p_data->attribute_request.conn_id,
+                     p_write_req->handle, p_write_req->val_len);
 
-    case HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE:
-        switch (p_write_req->p_val[0])
-        {
-        case CY_OTA_UPGRADE_COMMAND_PREPARE_DOWNLOAD:
-            ota_app.connection_type = CY_OTA_CONNECTION_BLE;
-            result = init_ota(&ota_app);
-            if (result != CY_RSLT_SUCCESS)
-            {
-                printf("init_ota() Failed - result: 0x%lx\n", result);
-                gatt_status = WICED_BT_GATT_ERROR;
-                break;
-            }
-            printf("Preparing to download the image \r\n");
-            result = cy_ota_ble_download_prepare(ota_app.ota_context);
-            if (result == CY_RSLT_SUCCESS)
-            {
-                printf("\ncy_ota_ble_download_prepare completed, Sending notification");
-                uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
-                gatt_status = app_bt_ble_send_notification(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE, 1, &bt_notify_buff);
-                if (gatt_status != WICED_BT_GATT_SUCCESS)
-                {
-                    printf("\nApplication BT Send notification callback failed: 0x%lx\n", result);
-                }
-                gatt_status = WICED_BT_GATT_SUCCESS;
-            }
-            else
-            {
-                printf("cy_ota_ble_prepare_download() Failed - result: 0x%lx\n", result);
-                gatt_status = WICED_BT_GATT_ERROR;
-            }
-
-            break;
-
-        case CY_OTA_UPGRADE_COMMAND_DOWNLOAD:
-            if (p_write_req->val_len < 4)
-            {
-                printf("CY_OTA_UPGRADE_COMMAND_DOWNLOAD len < 4\n");
-                gatt_status = WICED_BT_GATT_ERROR;
-                break;
-            }
-
-            total_size = (((uint32_t)p_write_req->p_val[4]) << 24) +
-                (((uint32_t)p_write_req->p_val[3]) << 16) +
-                (((uint32_t)p_write_req->p_val[2]) << 8) +
-                (((uint32_t)p_write_req->p_val[1]) << 0);
-
-            result = cy_ota_ble_download(ota_app.ota_context, total_size);
-            if (result == CY_RSLT_SUCCESS)
-            {
-                printf("\ncy_ota_ble_download completed, Sending notification");
-                uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
-                gatt_status = app_bt_ble_send_notification(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE, 1, &bt_notify_buff);
-                if (gatt_status != WICED_BT_GATT_SUCCESS)
-                {
-                    printf("\nApplication BT Send notification callback failed: 0x%lx\n", result);
-                    break;
-                }
-            }
-            else
-            {
-                printf("cy_ota_ble_download() Failed - result: 0x%lx\n", result);
-                gatt_status = WICED_BT_GATT_ERROR;
-            }
-
-            break;
-
-        case CY_OTA_UPGRADE_COMMAND_VERIFY:
-            if (p_write_req->val_len != 5)
-            {
-                printf("CY_OTA_UPGRADE_COMMAND_VERIFY len != 5\n");
-                gatt_status = WICED_BT_GATT_ERROR;
-                break;
-            }
-
-            final_crc32 = (((uint32_t)p_write_req->p_val[1]) << 0) +
-                (((uint32_t)p_write_req->p_val[2]) << 8) +
-                (((uint32_t)p_write_req->p_val[3]) << 16) +
-                (((uint32_t)p_write_req->p_val[4]) << 24);
-            printf("\nFinal CRC from Host : 0x%lx\n", final_crc32);
-
-            result = cy_ota_ble_download_verify(ota_app.ota_context, final_crc32, crc_or_sig_verify);
-            if (result == CY_RSLT_SUCCESS)
-            {
-                printf("\ncy_ota_ble_download_verify completed, Sending notification");
-                uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
-                gatt_status = app_bt_ble_send_indication(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE, 1, &bt_notify_buff);
-                if (gatt_status != WICED_BT_GATT_SUCCESS)
-                {
-                    printf("\nApplication BT Send Indication callback failed: 0x%lx\n", result);
-                }
-            }
-            else
-            {
-                printf("cy_ota_ble_download_verify() Failed - result: 0x%lx\n", result);
-                uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_BAD;
-                gatt_status = app_bt_ble_send_indication(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE, 1, &bt_notify_buff);
-                if (gatt_status != WICED_BT_GATT_SUCCESS)
-                {
-                    printf("\nApplication BT Send Indication callback failed: 0x%lx\n", result);
-                }
-
-                gatt_status = WICED_BT_GATT_ERROR;
-            }
-
-            break;
-
-        case CY_OTA_UPGRADE_COMMAND_ABORT:
-            result = cy_ota_ble_download_abort(ota_app.ota_context);
-            gatt_status = WICED_BT_GATT_SUCCESS;
-            break;
-        }
-        break;
-
-    case HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_DATA_VALUE:
-        /*Call OTA write handler to handle OTA related writes*/
-        printf("application downloading... \r\n");
-        result = cy_ota_ble_download_write(ota_app.ota_context, p_write_req->p_val, p_write_req->val_len, p_write_req->offset);
-        if (result != CY_RSLT_SUCCESS)
-        {
-            gatt_status = WICED_BT_GATT_ERROR;
-            break;
-        }
-        gatt_status = WICED_BT_GATT_SUCCESS;
-        break;
+    *p_error_handle = p_write_req->handle;
 
-    default:
-        /* Handle normal (non-OTA) indication confirmation requests here */
-        /* Attempt to perform the Write Request */
-        return app_bt_set_value(p_write_req->handle,
-            p_write_req->p_val,
-            p_write_req->val_len);
-    }
-    return (gatt_status);
+    return app_bt_svc_write(p_data->attribute_request.conn_id, p_write_req);
 }
 
 /**
@@ -578,74 +711,70 @@ wiced_bt_gatt_status_t app_bt_set_value(uint16_t attr_handle,
                                                uint8_t *p_val,
                                                uint16_t len)
 {
-    wiced_bt_gatt_status_t status = WICED_BT_GATT_INVALID_HANDLE;
+    gatt_db_lookup_table_t *p_attr = app_bt_svc_attr(attr_handle);
 
-    for (int i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    if (NULL == p_attr)
     {
-        /* Check for a matching handle entry */
-        if (app_gatt_db_ext_attr_tbl[i].handle == attr_handle)
-        {
-            /* Detected a matching handle in the external lookup table */
-            if (app_gatt_db_ext_attr_tbl[i].max_len >= len)
-            {
-                /* Value fits within the supplied buffer; copy over the value */
-                app_gatt_db_ext_attr_tbl[i].cur_len = len;
-                memset(app_gatt_db_ext_attr_tbl[i].p_data, 0x00, app_gatt_db_ext_attr_tbl[i].max_len);
-                memcpy(app_gatt_db_ext_attr_tbl[i].p_data, p_val, app_gatt_db_ext_attr_tbl[i].cur_len);
-
-                if (memcmp(app_gatt_db_ext_attr_tbl[i].p_data, p_val, app_gatt_db_ext_attr_tbl[i].cur_len) == 0)
-                {
-                    status = WICED_BT_GATT_SUCCESS;
-                }
-
-                if(app_gatt_db_ext_attr_tbl[i].handle == HDLD_BAS_BATTERY_LEVEL_CLIENT_CHAR_CONFIG)
-                {
-                    if (GATT_CLIENT_CONFIG_NOTIFICATION == app_bas_battery_level_client_char_config[0])
-                    {
-                        printf("Battery Server Notifications Enabled \r\n");
-                    }
-                    else
-                    {
-                        printf("Battery Server Notifications Disabled \r\n");
-                    }
-                }
-            }
-            else
-            {
-                /* Value to write will not fit within the table */
-                status = WICED_BT_GATT_INVALID_ATTR_LEN;
-                printf("Invalid attribute length\r\n");
-            }
-            break;
-        }
+        return WICED_BT_GATT_INVALID_HANDLE;
     }
-    return status;
+
+    if (p_attr->max_len < len)
+    {
+        /* Value to write will not fit within the table */
+        APP_LOG_ERR("Invalid attribute length\r\n");
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+
+    /* Value fits within the supplied buffer; copy over the value */
+    p_attr->cur_len = len;
+    memset(p_attr->p_data, 0x00, p_attr->max_len);
+    memcpy(p_attr->p_data, p_val, len);
+
+    return WICED_BT_GATT_SUCCESS;
 }
+
 /**
 * Function Name:
-* app_bt_find_by_handle
+* app_bt_send_conn_value
 *
 * Function Description:
-* @brief  Find attribute description by handle
+* @brief  Sends a read response for a value that is kept per connection and
+*         therefore cannot be served from the GATT database
+*
+* @param conn_id       Connection ID
+*
+* @param opcode        Bluetooth LE GATT request type opcode
+*
+* @param offset        Offset requested by the peer
+*
+* @param len_requested Maximum length of the response
 *
-* @param handle    handle to look up
+* @param p_val         Pointer to the value of this connection
 *
-* @return gatt_db_lookup_table_t   pointer containing handle data
+* @param len           Length of the value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
 */
-static gatt_db_lookup_table_t *app_bt_find_by_handle(uint16_t handle)
+static wiced_bt_gatt_status_t app_bt_send_conn_value(uint16_t conn_id,
+                                                     wiced_bt_gatt_opcode_t opcode,
+                                                     uint16_t offset,
+                                                     uint16_t len_requested,
+                                                     uint8_t *p_val, uint16_t len)
 {
-    int i;
-    for (i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    uint16_t to_send;
+    uint8_t *p_rsp;
+
+    if (offset >= len)
     {
-        if (app_gatt_db_ext_attr_tbl[i].handle == handle)
-        {
-            return (&app_gatt_db_ext_attr_tbl[i]);
-        }
+        return WICED_BT_GATT_INVALID_OFFSET;
     }
-    return NULL;
+    to_send = MIN(len_requested, len - offset);
+    p_rsp = app_bt_alloc_buffer(to_send);
+    memcpy(p_rsp, &p_val[offset], to_send);
+    return wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, to_send,
+                                                     p_rsp, (void *)app_bt_free_buffer);
 }
 
-
 /**
 * Function Name:
 * app_bt_gatt_req_read_handler
@@ -672,26 +801,37 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_handler(uint16_t conn_id,
                                                 uint16_t *p_error_handle)
 {
     gatt_db_lookup_table_t *puAttribute;
-    uint16_t attr_len_to_copy, to_send;
-    uint8_t *from;
+    wiced_bt_gatt_status_t status;
+    uint16_t attr_len, to_send;
+    uint8_t scratch[2];
+    uint8_t *p_val;
 
     *p_error_handle = p_read_req->handle;
 
-    if((puAttribute = app_bt_find_by_handle(p_read_req->handle)) == NULL)
+    status = app_bt_svc_read(conn_id, p_read_req->handle, p_read_req->offset, scratch,
+                             &p_val, &attr_len);
+    if (WICED_BT_GATT_SUCCESS != status)
     {
-        return WICED_BT_GATT_INVALID_HANDLE;
+        return status;
     }
 
-    attr_len_to_copy = puAttribute->cur_len;
+    /* Values kept per connection must be copied, the source may change before
+     * the stack sends the response */
+    puAttribute = app_bt_svc_attr(p_read_req->handle);
+    if ((NULL == puAttribute) || (puAttribute->p_data != p_val))
+    {
+        return app_bt_send_conn_value(conn_id, opcode, p_read_req->offset, len_requested,
+                                      p_val, attr_len);
+    }
 
-    if (p_read_req->offset >= puAttribute->cur_len)
+    if (p_read_req->offset >= attr_len)
     {
         return WICED_BT_GATT_INVALID_OFFSET;
     }
-    to_send = MIN(len_requested, attr_len_to_copy - p_read_req->offset);
-    from = puAttribute->p_data + p_read_req->offset;
+    to_send = MIN(len_requested, attr_len - p_read_req->offset);
     /* No need for context, as buff not allocated */
-    return wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, to_send, from, NULL);
+    return wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, to_send,
+                                                     p_val + p_read_req->offset, NULL);
 }
 
 /**
@@ -717,10 +857,12 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_by_type_handler(uint16_t conn_id,
                                                     uint16_t len_requested,
                                                     uint16_t *p_error_handle)
 {
-    gatt_db_lookup_table_t *puAttribute;
     uint16_t attr_handle = p_read_req->s_handle;
     uint8_t *p_rsp = app_bt_alloc_buffer(len_requested);
     uint8_t pair_len = 0;
+    uint8_t scratch[2];
+    uint8_t *p_val;
+    uint16_t attr_len;
     int used = 0;
 
     if (p_rsp == NULL)
@@ -739,7 +881,8 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_by_type_handler(uint16_t conn_id,
         if (attr_handle == 0)
             break;
 
-        if ((puAttribute = app_bt_find_by_handle(attr_handle)) == NULL)
+        if (app_bt_svc_read(conn_id, attr_handle, 0, scratch, &p_val, &attr_len) !=
+            WICED_BT_GATT_SUCCESS)
         {
             app_bt_free_buffer(p_rsp);
             return WICED_BT_GATT_INVALID_HANDLE;
@@ -750,8 +893,8 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_by_type_handler(uint16_t conn_id,
                                                         len_requested - used,
                                                                     &pair_len,
                                                                     attr_handle,
-                                                        puAttribute->cur_len,
-                                                        puAttribute->p_data);
+                                                                    attr_len,
+                                                                    p_val);
         if (filled == 0)
         {
             break;
@@ -802,10 +945,12 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_multi_handler(uint16_t conn_id,
                                                     uint16_t len_requested,
                                                 uint16_t *p_error_handle)
 {
-    gatt_db_lookup_table_t *puAttribute;
     uint8_t *p_rsp = app_bt_alloc_buffer(len_requested);
     int used = 0;
     int xx;
+    uint8_t scratch[2];
+    uint8_t *p_val;
+    uint16_t attr_len;
     uint16_t handle = wiced_bt_gatt_get_handle_from_stream(p_read_req->p_handle_stream, 0);
     *p_error_handle = handle;
 
@@ -820,7 +965,8 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_multi_handler(uint16_t conn_id,
     {
         handle = wiced_bt_gatt_get_handle_from_stream(p_read_req->p_handle_stream, xx);
         *p_error_handle = handle;
-        if ((puAttribute = app_bt_find_by_handle(handle)) == NULL)
+        if (app_bt_svc_read(conn_id, handle, 0, scratch, &p_val, &attr_len) !=
+            WICED_BT_GATT_SUCCESS)
         {
             app_bt_free_buffer(p_rsp);
             return WICED_BT_GATT_ERR_UNLIKELY;
@@ -828,9 +974,9 @@ wiced_bt_gatt_status_t app_bt_gatt_req_read_multi_handler(uint16_t conn_id,
         {
             int filled = wiced_bt_gatt_put_read_multi_rsp_in_stream(opcode, p_rsp + used,
                                                         len_requested - used,
-                                                        puAttribute->handle,
-                                                        puAttribute->cur_len,
-                                                        puAttribute->p_data);
+                                                        handle,
+                                                        attr_len,
+                                                        p_val);
             if (!filled)
             {
                 break;
@@ -874,43 +1020,53 @@ wiced_bt_gatt_status_t app_bt_prepare_write_handler(uint16_t conn_id,
                                         wiced_bt_gatt_write_req_t *p_req,
                                                 uint16_t *p_error_handle)
 {
-    if(write_buff.in_use == false)
+    app_bt_bearer_t *p_bearer = app_bt_bearer_find(conn_id);
+    gatt_write_req_buf_t *p_write_buff;
+
+    *p_error_handle = p_req->handle;
+
+    /* Prepare Write queues are kept per bearer */
+    if (NULL == p_bearer)
     {
-        memset(&(write_buff.value[0]), 0x00, CY_BT_MTU_SIZE);
-        write_buff.written = 0;
-        write_buff.in_use = true;
-        write_buff.handle = 0;
+        return WICED_BT_GATT_ERROR;
     }
+    p_write_buff = &p_bearer->write_buff;
 
-    *p_error_handle = p_req->handle;
+    if(p_write_buff->in_use == false)
+    {
+        memset(&(p_write_buff->value[0]), 0x00, CY_BT_MTU_SIZE);
+        p_write_buff->written = 0;
+        p_write_buff->in_use = true;
+        p_write_buff->handle = 0;
+    }
 
     /** store the data  */
-    if(write_buff.written == p_req->offset)
+    if(p_write_buff->written == p_req->offset)
     {
-        int remaining = CY_BT_MTU_SIZE - write_buff.written;
+        int remaining = CY_BT_MTU_SIZE - p_write_buff->written;
         int to_write = p_req->val_len;
 
         if (remaining >= to_write)
         {
-            memcpy( (void*)((uint32_t)(&(write_buff.value[0]) + write_buff.written)), p_req->p_val, to_write);
+            memcpy( (void*)((uint32_t)(&(p_write_buff->value[0]) + p_write_buff->written)), p_req->p_val, to_write);
             /* send success response */
-            printf("== Sending prepare write success response...\n");
+            APP_LOG_DEBUG("== Sending prepare write success response...\n");
             wiced_bt_gatt_server_send_prepare_write_rsp(conn_id, opcode, p_req->handle,
                                                         p_req->offset, to_write,
-                                &(write_buff.value[write_buff.written]), NULL);
-            write_buff.written += to_write;
-            write_buff.handle = p_req->handle;
+                                &(p_write_buff->value[p_write_buff->written]), NULL);
+            p_write_buff->written += to_write;
+            p_write_buff->handle = p_req->handle;
             return WICED_BT_GATT_SUCCESS;
         }
         else
         {
-            printf("remaining >= to_write error...\n");
+            APP_LOG_ERR("remaining >= to_write error...\n");
             return WICED_BT_GATT_ERROR;
         }
     }
     else
     {
-        printf("write_buff.written != p_req->offset...\n");
+        APP_LOG_WARNING("write_buff.written != p_req->offset...\n");
     }
     return WICED_BT_GATT_ERROR;
 }
@@ -933,6 +1089,8 @@ wiced_bt_gatt_status_t app_bt_execute_write_handler(wiced_bt_gatt_event_data_t *
 {
     wiced_bt_gatt_write_req_t       *p_write_req;
     wiced_bt_gatt_status_t          status = WICED_BT_GATT_SUCCESS;
+    app_bt_bearer_t                 *p_bearer;
+    gatt_write_req_buf_t            *p_write_buff;
 
     CY_ASSERT(p_req != NULL);
 
@@ -940,27 +1098,141 @@ wiced_bt_gatt_status_t app_bt_execute_write_handler(wiced_bt_gatt_event_data_t *
 
     *p_error_handle = p_write_req->handle;
 
-    CY_ASSERT(p_req != NULL);
+    p_bearer = app_bt_bearer_find(p_req->attribute_request.conn_id);
+    if (NULL == p_bearer)
+    {
+        return WICED_BT_GATT_ERROR;
+    }
+    p_write_buff = &p_bearer->write_buff;
 
-    if(write_buff.in_use == false)
+    if(p_write_buff->in_use == false)
     {
         return WICED_BT_GATT_ERROR;
     }
 
-    cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_NOTICE, "Execute Write with %d bytes\n", write_buff.written);
+    APP_LOG_NOTICE("Execute Write with %d bytes\n", p_write_buff->written);
 
-    p_write_req->handle = write_buff.handle;
+    p_write_req->handle = p_write_buff->handle;
     p_write_req->offset = 0;
-    p_write_req->p_val = &(write_buff.value[0]);
-    p_write_req->val_len = write_buff.written;
+    p_write_req->p_val = &(p_write_buff->value[0]);
+    p_write_req->val_len = p_write_buff->written;
 
     status = app_bt_write_handler(p_req,p_error_handle);
     if (status != WICED_BT_GATT_SUCCESS)
     {
-        printf("app_bt_write_handler() failed....\n");
+        APP_LOG_ERR("app_bt_write_handler() failed....\n");
     }
-    write_buff.in_use = false;
+    p_write_buff->in_use = false;
     return status;
 }
+
+/**
+* Function Name:
+* app_bt_gatt_svc_read
+*
+* Function Description:
+* @brief  Serves the Client Supported Features of the reading connection
+*
+* @param conn_id      Connection ID of the reader
+*
+* @param attr_handle  Attribute handle
+*
+* @param offset       Offset of the request
+*
+* @param pp_val       Set to the value
+*
+* @param p_len        Set to the length of the value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_gatt_svc_read(uint16_t conn_id, uint16_t attr_handle,
+                                                   uint16_t offset, uint8_t **pp_val,
+                                                   uint16_t *p_len)
+{
+    static uint8_t no_features = 0;
+    app_bt_conn_t *p_conn;
+    gatt_db_lookup_table_t *p_attr;
+
+    (void)offset;
+
+    if (HDLC_GATT_CLIENT_SUPPORTED_FEATURES_VALUE == attr_handle)
+    {
+        p_conn = app_bt_conn_find(conn_id);
+        *pp_val = (NULL != p_conn) ? &p_conn->client_features : &no_features;
+        *p_len = 1;
+        return WICED_BT_GATT_SUCCESS;
+    }
+
+    p_attr = app_bt_svc_attr(attr_handle);
+    if (NULL == p_attr)
+    {
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+    *pp_val = p_attr->p_data;
+    *p_len = p_attr->cur_len;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_svc_write
+*
+* Function Description:
+* @brief  Stores the Client Supported Features written by a connection
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param p_write_req  Write request
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_gatt_svc_write(uint16_t conn_id,
+                                                    wiced_bt_gatt_write_req_t *p_write_req)
+{
+    wiced_bt_gatt_status_t gatt_status;
+
+    if (HDLC_GATT_CLIENT_SUPPORTED_FEATURES_VALUE != p_write_req->handle)
+    {
+        return WICED_BT_GATT_WRITE_NOT_PERMIT;
+    }
+
+    gatt_status = app_bt_conn_client_features_write(conn_id, p_write_req->p_val,
+                                                    p_write_req->val_len);
+    if (WICED_BT_GATT_SUCCESS == gatt_status)
+    {
+        APP_LOG_INFO("Client features 0x%02x for conn_id %d \r\n",
+               app_bt_conn_client_features(conn_id), conn_id);
+    }
+    return gatt_status;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_svc_register
+*
+* Function Description:
+* @brief  Registers the GATT service with the GATT dispatch
+*
+* @return void
+*/
+void app_bt_gatt_svc_register(void)
+{
+    static const app_bt_svc_t app_bt_gatt_svc =
+    {
+        .name           = "GATT",
+        .start_handle   = HDLS_GATT,
+        .end_handle     = HDLC_GATT_CLIENT_SUPPORTED_FEATURES_VALUE,
+        .read           = app_bt_gatt_svc_read,
+        .write          = app_bt_gatt_svc_write,
+        .cccd           = NULL,
+    };
+
+    if (WICED_BT_GATT_SUCCESS != app_bt_svc_register(&app_bt_gatt_svc))
+    {
+        APP_LOG_ERR("GATT service registration failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
 /* [] END OF FILE */
 
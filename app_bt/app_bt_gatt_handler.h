@@ -82,8 +82,24 @@ wiced_bt_gatt_status_t app_bt_prepare_write_handler(uint16_t conn_id,
                                                     uint16_t *p_error_handle);
 wiced_bt_gatt_status_t app_bt_execute_write_handler(wiced_bt_gatt_event_data_t *p_req,
                                                     uint16_t *p_error_handle);
+wiced_bt_gatt_status_t app_bt_gatt_attr_request(wiced_bt_gatt_event_data_t *p_event_data);
+bool app_bt_gatt_opcode_is_cmd(wiced_bt_gatt_opcode_t opcode);
 wiced_bt_gatt_status_t app_bt_gatt_event_callback(wiced_bt_gatt_evt_t event,
                                                     wiced_bt_gatt_event_data_t *p_event_data);
+wiced_bt_gatt_status_t app_bt_ble_send_notification(uint16_t bt_conn_id,
+                                                    uint16_t attr_handle,
+                                                    uint16_t val_len, uint8_t *p_val);
+wiced_bt_gatt_status_t app_bt_ble_send_response(uint16_t bt_conn_id,
+                                                    uint16_t attr_handle,
+                                                    uint16_t val_len, uint8_t *p_val);
+wiced_bt_gatt_status_t app_bt_ble_send_indication(uint16_t bt_conn_id,
+                                                    uint16_t attr_handle,
+                                                    uint16_t val_len, uint8_t *p_val);
+void app_bt_gatt_svc_register(void);
+uint8_t *app_bt_alloc_buffer(uint16_t len);
+void app_bt_ota_link_update(uint16_t conn_id);
+void app_bt_gatt_events(uint32_t events);
+void app_bt_free_buffer(uint8_t *p_data);
 /**
  * @brief Typdef for function used to free allocated buffer to stack
  */
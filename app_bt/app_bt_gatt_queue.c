@@ -0,0 +1,506 @@
+/*******************************************************************************
+ * File Name: app_bt_gatt_queue.c
+ *
+ * Description: This file contains the task that serves the GATT
+ *              attribute requests queued by the Bluetooth stack callback.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "cyhal.h"
+#include "wiced_bt_stack.h"
+#include "wiced_memory.h"
+#include "cycfg_bt_settings.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_gatt_queue.h"
+#include "app_bt_bearer.h"
+#include "app_monitor.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_BT_GATT_QUEUE_TASK_NAME         "GATT"
+#define APP_BT_GATT_QUEUE_TASK_STACK_SIZE   (1024u)
+#define APP_BT_GATT_QUEUE_TASK_PRIORITY     (configMAX_PRIORITIES - 3)
+
+/* Largest payload of a request: a write value or the handle list of a read
+ * multiple, both bounded by the MTU */
+#define APP_BT_GATT_QUEUE_DATA_SIZE         (CY_BT_MTU_SIZE)
+
+#define APP_BT_GATT_QUEUE_SLOTS             (APP_BT_GATT_QUEUE_REQ_SLOTS + \
+                                             APP_BT_GATT_QUEUE_CMD_SLOTS)
+
+/* Every slot and every overflow buffer can wait at once, with the marker
+ * of the signalled events */
+#define APP_BT_GATT_QUEUE_FULL_DEPTH        (APP_BT_GATT_QUEUE_SLOTS + \
+                                             APP_BT_GATT_QUEUE_CMD_OVERFLOW + 1u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Where a queued request is held */
+typedef enum
+{
+    APP_BT_GATT_QUEUE_POOL_REQ,
+    APP_BT_GATT_QUEUE_POOL_CMD,
+    APP_BT_GATT_QUEUE_POOL_HEAP,
+} app_bt_gatt_queue_pool_t;
+
+/* Request as received, its payload pointer moved to data. Overflow buffers
+ * are allocated with room for their payload only. */
+typedef struct
+{
+    wiced_bt_gatt_attribute_request_t   req;
+    app_bt_gatt_queue_pool_t            pool;
+    uint8_t                             data[APP_BT_GATT_QUEUE_DATA_SIZE];
+} app_bt_gatt_queue_slot_t;
+
+static app_bt_gatt_queue_slot_t app_bt_gatt_queue_slots[APP_BT_GATT_QUEUE_SLOTS];
+
+/* Free slots of each pool, and every request waiting for the task */
+static QueueHandle_t            app_bt_gatt_queue_req_q;
+static QueueHandle_t            app_bt_gatt_queue_cmd_q;
+static QueueHandle_t            app_bt_gatt_queue_full_q;
+
+/* Overflow buffers not yet freed by the task */
+static volatile uint8_t         app_bt_gatt_queue_heap_used;
+
+/* Events signalled since the task last ran them, and whether a NULL marker
+ * for them is waiting in the queue */
+static volatile uint32_t        app_bt_gatt_queue_events;
+static volatile bool            app_bt_gatt_queue_marker;
+
+/* Only updated in the Bluetooth stack task */
+static app_bt_gatt_queue_stats_t app_bt_gatt_queue_stats;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static uint8_t **app_bt_gatt_queue_payload(wiced_bt_gatt_attribute_request_t *p_req,
+                                           uint16_t *p_len);
+static app_bt_gatt_queue_slot_t *app_bt_gatt_queue_take(bool command, uint16_t len);
+static void app_bt_gatt_queue_release(app_bt_gatt_queue_slot_t *p_slot);
+static void app_bt_gatt_queue_task(void *arg);
+#if !APP_BT_GATT_DEFER
+static int app_bt_gatt_queue_run(void *p_data);
+#endif
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_gatt_queue_init
+*
+* Function Description:
+* @brief  Creates the slot queues and the GATT task. Call from main() before
+*         the stack registers the GATT callback.
+*
+* @return void
+*/
+void app_bt_gatt_queue_init(void)
+{
+    app_bt_gatt_queue_slot_t *p_slot;
+
+    app_bt_gatt_queue_req_q = xQueueCreate(APP_BT_GATT_QUEUE_REQ_SLOTS, sizeof(p_slot));
+    app_bt_gatt_queue_cmd_q = xQueueCreate(APP_BT_GATT_QUEUE_CMD_SLOTS, sizeof(p_slot));
+    app_bt_gatt_queue_full_q = xQueueCreate(APP_BT_GATT_QUEUE_FULL_DEPTH, sizeof(p_slot));
+    if ((NULL == app_bt_gatt_queue_req_q) || (NULL == app_bt_gatt_queue_cmd_q) ||
+        (NULL == app_bt_gatt_queue_full_q) ||
+        (pdPASS != xTaskCreate(app_bt_gatt_queue_task, APP_BT_GATT_QUEUE_TASK_NAME,
+                               APP_BT_GATT_QUEUE_TASK_STACK_SIZE, NULL,
+                               APP_BT_GATT_QUEUE_TASK_PRIORITY, NULL)))
+    {
+        APP_LOG_ERR("GATT queue creation failed\r\n");
+        CY_ASSERT(0);
+    }
+    for (uint8_t slot = 0; slot < APP_BT_GATT_QUEUE_SLOTS; slot++)
+    {
+        p_slot = &app_bt_gatt_queue_slots[slot];
+        p_slot->pool = (slot < APP_BT_GATT_QUEUE_REQ_SLOTS) ? APP_BT_GATT_QUEUE_POOL_REQ :
+                                                              APP_BT_GATT_QUEUE_POOL_CMD;
+        app_bt_gatt_queue_release(p_slot);
+    }
+    app_monitor_task_size(APP_BT_GATT_QUEUE_TASK_NAME, APP_BT_GATT_QUEUE_TASK_STACK_SIZE);
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_payload
+*
+* Function Description:
+* @brief  Finds the part of a request held in a stack buffer, which is only
+*         valid during the callback
+*
+* @param p_req    Attribute request
+*
+* @param p_len    Set to the payload length, 0 when there is none
+*
+* @return uint8_t**  Payload pointer field of the request, NULL when none
+*/
+static uint8_t **app_bt_gatt_queue_payload(wiced_bt_gatt_attribute_request_t *p_req,
+                                           uint16_t *p_len)
+{
+    switch (p_req->opcode)
+    {
+    case GATT_REQ_WRITE:
+    case GATT_CMD_WRITE:
+    case GATT_CMD_SIGNED_WRITE:
+    case GATT_REQ_PREPARE_WRITE:
+        *p_len = p_req->data.write_req.val_len;
+        return &p_req->data.write_req.p_val;
+
+    case GATT_REQ_READ_MULTI:
+    case GATT_REQ_READ_MULTI_VAR_LENGTH:
+        *p_len = (uint16_t)(p_req->data.read_multiple_req.num_handles * sizeof(uint16_t));
+        return &p_req->data.read_multiple_req.p_handle_stream;
+
+    default:
+        *p_len = 0;
+        return NULL;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_take
+*
+* Function Description:
+* @brief  Takes a free slot without waiting. A command that finds every
+*         command slot taken gets a stack buffer instead, as long as fewer
+*         than APP_BT_GATT_QUEUE_CMD_OVERFLOW are in use.
+*
+* @param command  true for an opcode that has no response
+*
+* @param len      Payload length
+*
+* @return app_bt_gatt_queue_slot_t*  Slot, NULL when there is no room
+*/
+static app_bt_gatt_queue_slot_t *app_bt_gatt_queue_take(bool command, uint16_t len)
+{
+    app_bt_gatt_queue_slot_t *p_slot = NULL;
+
+    if (!command)
+    {
+        (void)xQueueReceive(app_bt_gatt_queue_req_q, &p_slot, 0);
+        return p_slot;
+    }
+    if (pdTRUE == xQueueReceive(app_bt_gatt_queue_cmd_q, &p_slot, 0))
+    {
+        return p_slot;
+    }
+    if (app_bt_gatt_queue_heap_used >= APP_BT_GATT_QUEUE_CMD_OVERFLOW)
+    {
+        return NULL;
+    }
+
+    p_slot = (app_bt_gatt_queue_slot_t *)wiced_bt_get_buffer(
+                 (uint32_t)(offsetof(app_bt_gatt_queue_slot_t, data) + len));
+    if (NULL != p_slot)
+    {
+        p_slot->pool = APP_BT_GATT_QUEUE_POOL_HEAP;
+        taskENTER_CRITICAL();
+        app_bt_gatt_queue_heap_used++;
+        taskEXIT_CRITICAL();
+        app_bt_gatt_queue_stats.overflow++;
+    }
+    return p_slot;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_release
+*
+* Function Description:
+* @brief  Returns a slot to its pool, or frees an overflow buffer
+*
+* @param p_slot   Slot the task is done with
+*
+* @return void
+*/
+static void app_bt_gatt_queue_release(app_bt_gatt_queue_slot_t *p_slot)
+{
+    switch (p_slot->pool)
+    {
+    case APP_BT_GATT_QUEUE_POOL_REQ:
+        xQueueSend(app_bt_gatt_queue_req_q, &p_slot, 0);
+        break;
+
+    case APP_BT_GATT_QUEUE_POOL_CMD:
+        xQueueSend(app_bt_gatt_queue_cmd_q, &p_slot, 0);
+        break;
+
+    default:
+        wiced_bt_free_buffer(p_slot);
+        taskENTER_CRITICAL();
+        app_bt_gatt_queue_heap_used--;
+        taskEXIT_CRITICAL();
+        break;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_post
+*
+* Function Description:
+* @brief  Copies an attribute request to a free slot and hands it to the GATT
+*         task, which sends the response. Runs in the Bluetooth stack task
+*         and never waits.
+*
+* @param p_req    Attribute request of GATT_ATTRIBUTE_REQUEST_EVT
+*
+* @return wiced_bt_gatt_status_t  WICED_BT_GATT_SUCCESS when queued, or the
+*                                 error to answer a request with
+*/
+wiced_bt_gatt_status_t app_bt_gatt_queue_post(const wiced_bt_gatt_attribute_request_t *p_req)
+{
+    wiced_bt_gatt_attribute_request_t req = *p_req;
+    app_bt_gatt_queue_slot_t *p_slot;
+    uint8_t **pp_payload;
+    uint16_t len;
+    uint8_t waiting;
+
+    pp_payload = app_bt_gatt_queue_payload(&req, &len);
+    if ((NULL != pp_payload) && (len > APP_BT_GATT_QUEUE_DATA_SIZE))
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+
+    p_slot = app_bt_gatt_queue_take(app_bt_gatt_opcode_is_cmd(req.opcode), len);
+    if (NULL == p_slot)
+    {
+        app_bt_gatt_queue_stats.dropped++;
+        APP_LOG_WARNING("GATT queue full, opcode 0x%x dropped\r\n", req.opcode);
+        return WICED_BT_GATT_INSUF_RESOURCE;
+    }
+
+    p_slot->req = req;
+    if (NULL != pp_payload)
+    {
+        memcpy(p_slot->data, *pp_payload, len);
+        *app_bt_gatt_queue_payload(&p_slot->req, &len) = p_slot->data;
+    }
+
+    waiting = (uint8_t)(uxQueueMessagesWaiting(app_bt_gatt_queue_full_q) + 1u);
+    if (waiting > app_bt_gatt_queue_stats.peak)
+    {
+        app_bt_gatt_queue_stats.peak = waiting;
+    }
+    app_bt_gatt_queue_stats.queued++;
+    xQueueSend(app_bt_gatt_queue_full_q, &p_slot, 0);
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_signal
+*
+* Function Description:
+* @brief  Hands an event to the GATT task, behind the requests already
+*         queued. Never waits. When APP_BT_GATT_DEFER is 0, the event runs
+*         in the Bluetooth stack task instead.
+*
+* @param evt      Event to signal
+*
+* @return void
+*/
+void app_bt_gatt_queue_signal(app_bt_gatt_queue_evt_t evt)
+{
+#if APP_BT_GATT_DEFER
+    app_bt_gatt_queue_slot_t *p_marker = NULL;
+    bool post;
+
+    taskENTER_CRITICAL();
+    app_bt_gatt_queue_events |= (uint32_t)evt;
+    post = !app_bt_gatt_queue_marker;
+    app_bt_gatt_queue_marker = true;
+    taskEXIT_CRITICAL();
+
+    if (post)
+    {
+        xQueueSend(app_bt_gatt_queue_full_q, &p_marker, 0);
+    }
+#else
+    if (WICED_SUCCESS != wiced_app_event_serialize(app_bt_gatt_queue_run,
+                                                   (void *)(uintptr_t)evt))
+    {
+        APP_LOG_ERR("GATT event 0x%x not serialized\r\n", evt);
+    }
+#endif
+}
+
+#if !APP_BT_GATT_DEFER
+/**
+* Function Name:
+* app_bt_gatt_queue_run
+*
+* Function Description:
+* @brief  Runs a signalled event in the Bluetooth stack task
+*
+* @param p_data   app_bt_gatt_queue_evt_t bits
+*
+* @return int     0
+*/
+static int app_bt_gatt_queue_run(void *p_data)
+{
+    app_bt_gatt_events((uint32_t)(uintptr_t)p_data);
+    return 0;
+}
+#endif
+
+/**
+* Function Name:
+* app_bt_gatt_queue_task
+*
+* Function Description:
+* @brief  Serves the queued requests and events in the order they arrived,
+*         with the same handlers the stack callback used to run
+*
+* @param arg      Unused
+*
+* @return void
+*/
+static void app_bt_gatt_queue_task(void *arg)
+{
+    wiced_bt_gatt_event_data_t event_data;
+    app_bt_gatt_queue_slot_t *p_slot;
+    uint32_t events;
+
+    (void)arg;
+
+    while (true)
+    {
+        xQueueReceive(app_bt_gatt_queue_full_q, &p_slot, portMAX_DELAY);
+
+        if (NULL == p_slot)
+        {
+            taskENTER_CRITICAL();
+            events = app_bt_gatt_queue_events;
+            app_bt_gatt_queue_events = 0;
+            app_bt_gatt_queue_marker = false;
+            taskEXIT_CRITICAL();
+            app_bt_gatt_events(events);
+            continue;
+        }
+
+        /* A link that went down while its requests waited is not answered */
+        event_data.attribute_request = p_slot->req;
+        if (NULL != app_bt_bearer_find(event_data.attribute_request.conn_id))
+        {
+            (void)app_bt_gatt_attr_request(&event_data);
+        }
+        app_bt_gatt_queue_release(p_slot);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_cb_time
+*
+* Function Description:
+* @brief  Accounts the duration of one GATT stack callback
+*
+* @param cycles   CPU cycles spent in the callback
+*
+* @return void
+*/
+void app_bt_gatt_queue_cb_time(uint32_t cycles)
+{
+    uint32_t us = cycles / (SystemCoreClock / 1000000u);
+
+    app_bt_gatt_queue_stats.cb_count++;
+    app_bt_gatt_queue_stats.cb_total_us += us;
+    if (us > app_bt_gatt_queue_stats.cb_max_us)
+    {
+        app_bt_gatt_queue_stats.cb_max_us = us;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_get_stats
+*
+* Function Description:
+* @brief  Returns the callback times and queue use since the last report
+*
+* @param p_stats  Filled with the statistics
+*
+* @return void
+*/
+void app_bt_gatt_queue_get_stats(app_bt_gatt_queue_stats_t *p_stats)
+{
+    *p_stats = app_bt_gatt_queue_stats;
+}
+
+/**
+* Function Name:
+* app_bt_gatt_queue_report
+*
+* Function Description:
+* @brief  Logs the callback times and queue use, then starts over. Called
+*         from the stack task when a connection ends.
+*
+* @return void
+*/
+void app_bt_gatt_queue_report(void)
+{
+    app_bt_gatt_queue_stats_t *p_stats = &app_bt_gatt_queue_stats;
+
+    if (0u == p_stats->cb_count)
+    {
+        return;
+    }
+    APP_LOG_INFO("GATT callback: %lu events, avg %lu us, max %lu us; %lu queued, "
+                 "peak %u waiting, %lu overflowed, %lu dropped\r\n",
+                 (unsigned long)p_stats->cb_count,
+                 (unsigned long)(p_stats->cb_total_us / p_stats->cb_count),
+                 (unsigned long)p_stats->cb_max_us, (unsigned long)p_stats->queued,
+                 p_stats->peak, (unsigned long)p_stats->overflow,
+                 (unsigned long)p_stats->dropped);
+    memset(p_stats, 0, sizeof(*p_stats));
+}
+
+/* [] END OF FILE */
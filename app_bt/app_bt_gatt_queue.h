@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * File Name: app_bt_gatt_queue.h
+ *
+ * Description: This file is the public interface of
+ *              app_bt_gatt_queue.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+#ifndef APP_BT_GATT_QUEUE_H__
+#define APP_BT_GATT_QUEUE_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "wiced_bt_gatt.h"
+#include "app_bt_bearer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Slots for requests. A client waits for the response before its
+ *        next request on a bearer, so one slot per bearer never runs out.
+ */
+#define APP_BT_GATT_QUEUE_REQ_SLOTS     (APP_BT_MAX_BEARERS)
+
+/**
+ * @brief Slots for write commands and confirmations, which ATT does not
+ *        flow control. Once they are taken, further ones are copied to
+ *        stack buffers, up to APP_BT_GATT_QUEUE_CMD_OVERFLOW at a time.
+ */
+#define APP_BT_GATT_QUEUE_CMD_SLOTS     (8u)
+#define APP_BT_GATT_QUEUE_CMD_OVERFLOW  (32u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Events the Bluetooth stack task and the OTA storage task signal
+ *        to the GATT task, which owns the state of the services. Signals
+ *        of one event coalesce.
+ */
+typedef enum
+{
+    APP_BT_GATT_QUEUE_EVT_CONN_DOWN = (1u << 0),    /* A link went down */
+    APP_BT_GATT_QUEUE_EVT_LINK      = (1u << 1),    /* Link parameters changed */
+    APP_BT_GATT_QUEUE_EVT_HIST      = (1u << 2),    /* History notifications sent */
+    APP_BT_GATT_QUEUE_EVT_OTA       = (1u << 3),    /* OTA command result to send */
+} app_bt_gatt_queue_evt_t;
+
+/**
+ * @brief Time spent in the GATT stack callback and use of the request queue
+ *        since the last report
+ */
+typedef struct
+{
+    uint32_t    cb_count;       /* Callbacks timed */
+    uint32_t    cb_total_us;    /* Time spent in them */
+    uint32_t    cb_max_us;      /* Longest callback */
+    uint32_t    queued;         /* Attribute requests handed to the task */
+    uint32_t    overflow;       /* Commands copied to stack buffers */
+    uint32_t    dropped;        /* Requests and commands with no room */
+    uint8_t     peak;           /* Most requests and commands waiting at once */
+} app_bt_gatt_queue_stats_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void                    app_bt_gatt_queue_init      (void);
+wiced_bt_gatt_status_t  app_bt_gatt_queue_post      (const wiced_bt_gatt_attribute_request_t *p_req);
+void                    app_bt_gatt_queue_signal    (app_bt_gatt_queue_evt_t evt);
+void                    app_bt_gatt_queue_cb_time   (uint32_t cycles);
+void                    app_bt_gatt_queue_get_stats (app_bt_gatt_queue_stats_t *p_stats);
+void                    app_bt_gatt_queue_report    (void);
+
+#endif
+/* [] END OF FILE */
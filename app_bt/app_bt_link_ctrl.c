@@ -0,0 +1,504 @@
+/*******************************************************************************
+ * File Name: app_bt_link_ctrl.c
+ *
+ * Description: This file implements the connection-interval
+ *              controller. Links with OTA traffic or notification bursts are
+ *              moved to a short interval without peripheral latency, and quiet
+ *              links are relaxed to a long interval with peripheral latency.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "cyhal.h"
+#include "wiced_bt_l2c.h"
+#include "app_bt_conn.h"
+#include "app_bt_link_ctrl.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Controller state of one link
+ */
+typedef struct
+{
+    uint16_t                conn_id;        /* 0 when the slot is free */
+    app_bt_link_regime_t    regime;         /* Regime of the current interval */
+    app_bt_link_regime_t    requested;      /* Regime last asked for */
+    TickType_t              regime_since;   /* Start of the time not yet accounted */
+    TickType_t              last_activity;
+    TickType_t              last_request;
+    TickType_t              window_start;   /* Start of the notification count window */
+    uint16_t                notify_count;
+} app_bt_link_t;
+
+static app_bt_link_t app_bt_link_table[APP_BT_MAX_CONNECTIONS];
+
+/**
+ * @brief Counters summed over all links
+ */
+static app_bt_link_stats_t app_bt_link_stats;
+
+static TimerHandle_t app_bt_link_timer;
+
+static const char *app_bt_link_regime_name[APP_BT_LINK_REGIME_COUNT] =
+{
+    [APP_BT_LINK_REGIME_FAST]    = "fast",
+    [APP_BT_LINK_REGIME_DEFAULT] = "default",
+    [APP_BT_LINK_REGIME_IDLE]    = "idle",
+};
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_bt_link_timer_cb(TimerHandle_t timer);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_link_regime_of
+*
+* Function Description:
+* @brief  Classifies a connection interval
+*
+* @param conn_interval  Connection interval in units of 1.25 ms
+*
+* @return app_bt_link_regime_t  Regime of the interval
+*/
+static app_bt_link_regime_t app_bt_link_regime_of(uint16_t conn_interval)
+{
+    if (conn_interval <= APP_BT_LINK_FAST_INTERVAL_MAX)
+    {
+        return APP_BT_LINK_REGIME_FAST;
+    }
+    if (conn_interval >= APP_BT_LINK_IDLE_INTERVAL_MIN)
+    {
+        return APP_BT_LINK_REGIME_IDLE;
+    }
+    return APP_BT_LINK_REGIME_DEFAULT;
+}
+
+/**
+* Function Name:
+* app_bt_link_find
+*
+* Function Description:
+* @brief  Looks up the controller state of a link
+*
+* @param conn_id      Connection ID
+*
+* @return app_bt_link_t*  Link state, NULL if unknown
+*/
+static app_bt_link_t *app_bt_link_find(uint16_t conn_id)
+{
+    if (0 == conn_id)
+    {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (app_bt_link_table[i].conn_id == conn_id)
+        {
+            return &app_bt_link_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+* Function Name:
+* app_bt_link_account
+*
+* Function Description:
+* @brief  Adds the time since the last call to the current regime of a link.
+*         Called with interrupts masked.
+*
+* @param p_link       Link state
+*
+* @param now          Current tick count
+*
+* @return void
+*/
+static void app_bt_link_account(app_bt_link_t *p_link, TickType_t now)
+{
+    app_bt_link_stats.regime_ms[p_link->regime] +=
+        (uint32_t)((now - p_link->regime_since) * portTICK_PERIOD_MS);
+    p_link->regime_since = now;
+}
+
+/**
+* Function Name:
+* app_bt_link_request
+*
+* Function Description:
+* @brief  Asks the central for the parameters of a regime
+*
+* @param conn_id      Connection ID
+*
+* @param regime       APP_BT_LINK_REGIME_FAST or APP_BT_LINK_REGIME_IDLE
+*
+* @return void
+*/
+static void app_bt_link_request(uint16_t conn_id, app_bt_link_regime_t regime)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+    wiced_bool_t sent;
+
+    if (NULL == p_conn)
+    {
+        return;
+    }
+
+    if (APP_BT_LINK_REGIME_FAST == regime)
+    {
+        sent = wiced_bt_l2cap_update_ble_conn_params(p_conn->peer_addr,
+                                                     APP_BT_LINK_FAST_INTERVAL_MIN,
+                                                     APP_BT_LINK_FAST_INTERVAL_MAX,
+                                                     APP_BT_LINK_FAST_LATENCY,
+                                                     APP_BT_LINK_FAST_TIMEOUT);
+    }
+    else
+    {
+        sent = wiced_bt_l2cap_update_ble_conn_params(p_conn->peer_addr,
+                                                     APP_BT_LINK_IDLE_INTERVAL_MIN,
+                                                     APP_BT_LINK_IDLE_INTERVAL_MAX,
+                                                     APP_BT_LINK_IDLE_LATENCY,
+                                                     APP_BT_LINK_IDLE_TIMEOUT);
+    }
+    APP_LOG_INFO("Requesting %s connection interval for conn_id %d: %s \r\n",
+           app_bt_link_regime_name[regime], conn_id, sent ? "sent" : "failed");
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_init
+*
+* Function Description:
+* @brief  Starts the periodic evaluation of all links
+*
+* @return void
+*/
+void app_bt_link_ctrl_init(void)
+{
+    memset(app_bt_link_table, 0, sizeof(app_bt_link_table));
+    memset(&app_bt_link_stats, 0, sizeof(app_bt_link_stats));
+
+    app_bt_link_timer = xTimerCreate("Link", pdMS_TO_TICKS(APP_BT_LINK_TICK_MS),
+                                     pdTRUE, NULL, app_bt_link_timer_cb);
+    if ((NULL == app_bt_link_timer) || (pdPASS != xTimerStart(app_bt_link_timer, 0)))
+    {
+        APP_LOG_ERR("Link controller timer creation failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_conn_up
+*
+* Function Description:
+* @brief  Starts tracking a new link in the regime of its initial interval
+*
+* @param conn_id      Connection ID
+*
+* @return void
+*/
+void app_bt_link_ctrl_conn_up(uint16_t conn_id)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+    TickType_t now = xTaskGetTickCount();
+
+    if (NULL == p_conn)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (0 == app_bt_link_table[i].conn_id)
+        {
+            app_bt_link_t *p_link = &app_bt_link_table[i];
+
+            memset(p_link, 0, sizeof(*p_link));
+            p_link->conn_id = conn_id;
+            p_link->regime = app_bt_link_regime_of(p_conn->conn_params.conn_interval);
+            p_link->requested = APP_BT_LINK_REGIME_DEFAULT;
+            p_link->regime_since = now;
+            p_link->last_activity = now;
+            p_link->last_request = now;
+            p_link->window_start = now;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_conn_down
+*
+* Function Description:
+* @brief  Stops tracking a link and prints the regime counters
+*
+* @param conn_id      Connection ID
+*
+* @return void
+*/
+void app_bt_link_ctrl_conn_down(uint16_t conn_id)
+{
+    app_bt_link_t *p_link = app_bt_link_find(conn_id);
+
+    if (NULL == p_link)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    app_bt_link_account(p_link, xTaskGetTickCount());
+    p_link->conn_id = 0;
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < APP_BT_LINK_REGIME_COUNT; i++)
+    {
+        APP_LOG_INFO("Link regime %-7s: %lu ms, %lu requests \r\n", app_bt_link_regime_name[i],
+               app_bt_link_stats.regime_ms[i], app_bt_link_stats.requests[i]);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_activity
+*
+* Function Description:
+* @brief  Reports activity on a link. PREPARE_DOWNLOAD switches to the fast
+*         regime at once, other OTA traffic and notification bursts do so
+*         once the dwell time since the last request has passed. Periodic
+*         notifications below the burst rate do not keep the link out of
+*         the idle regime.
+*
+* @param conn_id      Connection ID, any bearer of the link
+*
+* @param activity     Kind of activity
+*
+* @return void
+*/
+void app_bt_link_ctrl_activity(uint16_t conn_id, app_bt_link_activity_t activity)
+{
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+    app_bt_link_t *p_link;
+    TickType_t now = xTaskGetTickCount();
+    bool go_fast = false;
+
+    if (NULL == p_conn)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    p_link = app_bt_link_find(p_conn->conn_id);
+    if (NULL != p_link)
+    {
+        bool dwell_over = ((now - p_link->last_request) >= pdMS_TO_TICKS(APP_BT_LINK_MIN_DWELL_MS));
+        bool burst = false;
+
+        if (APP_BT_LINK_ACT_NOTIFY == activity)
+        {
+            if (p_link->notify_count < UINT16_MAX)
+            {
+                p_link->notify_count++;
+            }
+            burst = (p_link->notify_count > APP_BT_LINK_NOTIFY_BURST);
+        }
+        if ((APP_BT_LINK_ACT_NOTIFY != activity) || burst)
+        {
+            p_link->last_activity = now;
+        }
+
+        if (APP_BT_LINK_REGIME_FAST != p_link->requested)
+        {
+            switch (activity)
+            {
+            case APP_BT_LINK_ACT_OTA_START:
+                go_fast = true;
+                break;
+            case APP_BT_LINK_ACT_OTA_DATA:
+                go_fast = dwell_over;
+                break;
+            case APP_BT_LINK_ACT_NOTIFY:
+                go_fast = dwell_over && burst;
+                break;
+            default:
+                break;
+            }
+        }
+        if (go_fast)
+        {
+            p_link->requested = APP_BT_LINK_REGIME_FAST;
+            p_link->last_request = now;
+            app_bt_link_stats.requests[APP_BT_LINK_REGIME_FAST]++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (go_fast)
+    {
+        app_bt_link_request(p_conn->conn_id, APP_BT_LINK_REGIME_FAST);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_params_updated
+*
+* Function Description:
+* @brief  Moves a link to the regime of the interval the central applied
+*
+* @param conn_id        Connection ID
+*
+* @param conn_interval  New connection interval in units of 1.25 ms
+*
+* @return void
+*/
+void app_bt_link_ctrl_params_updated(uint16_t conn_id, uint16_t conn_interval)
+{
+    app_bt_link_t *p_link = app_bt_link_find(conn_id);
+
+    if (NULL == p_link)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    app_bt_link_account(p_link, xTaskGetTickCount());
+    p_link->regime = app_bt_link_regime_of(conn_interval);
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_link_ctrl_get_stats
+*
+* Function Description:
+* @brief  Returns the regime counters, including the time of the links that
+*         are still up
+*
+* @param p_stats      Filled with the counters
+*
+* @return void
+*/
+void app_bt_link_ctrl_get_stats(app_bt_link_stats_t *p_stats)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (0 != app_bt_link_table[i].conn_id)
+        {
+            app_bt_link_account(&app_bt_link_table[i], now);
+        }
+    }
+    *p_stats = app_bt_link_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_link_timer_cb
+*
+* Function Description:
+* @brief  Relaxes links that stayed quiet for APP_BT_LINK_QUIET_MS, runs in
+*         the timer service task
+*
+* @param timer        unused
+*
+* @return void
+*/
+static void app_bt_link_timer_cb(TimerHandle_t timer)
+{
+    uint16_t relax[APP_BT_MAX_CONNECTIONS];
+    uint8_t num_relax = 0;
+    TickType_t now = xTaskGetTickCount();
+
+    (void)timer;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        app_bt_link_t *p_link = &app_bt_link_table[i];
+
+        if (0 == p_link->conn_id)
+        {
+            continue;
+        }
+        app_bt_link_account(p_link, now);
+
+        if ((now - p_link->window_start) >= pdMS_TO_TICKS(APP_BT_LINK_QUIET_MS))
+        {
+            p_link->window_start = now;
+            p_link->notify_count = 0;
+        }
+
+        if ((APP_BT_LINK_REGIME_IDLE != p_link->requested) &&
+            ((now - p_link->last_activity) >= pdMS_TO_TICKS(APP_BT_LINK_QUIET_MS)) &&
+            ((now - p_link->last_request) >= pdMS_TO_TICKS(APP_BT_LINK_MIN_DWELL_MS)))
+        {
+            p_link->requested = APP_BT_LINK_REGIME_IDLE;
+            p_link->last_request = now;
+            app_bt_link_stats.requests[APP_BT_LINK_REGIME_IDLE]++;
+            relax[num_relax++] = p_link->conn_id;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < num_relax; i++)
+    {
+        app_bt_link_request(relax[i], APP_BT_LINK_REGIME_IDLE);
+    }
+}
+
+/* [] END OF FILE */
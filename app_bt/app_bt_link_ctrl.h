@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * File Name: app_bt_link_ctrl.h
+ *
+ * Description: This file is the public interface of
+ *              app_bt_link_ctrl.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_LINK_CTRL_H__
+#define APP_BT_LINK_CTRL_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include "wiced_bt_ble.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Fast regime: shortest interval, no peripheral latency (units of 1.25 ms) */
+#define APP_BT_LINK_FAST_INTERVAL_MIN       (6u)
+#define APP_BT_LINK_FAST_INTERVAL_MAX       (12u)
+#define APP_BT_LINK_FAST_LATENCY            (0u)
+#define APP_BT_LINK_FAST_TIMEOUT            (200u)      /* units of 10 ms */
+
+/* Idle regime: long interval, the peripheral may skip events */
+#define APP_BT_LINK_IDLE_INTERVAL_MIN       (320u)
+#define APP_BT_LINK_IDLE_INTERVAL_MAX       (400u)
+#define APP_BT_LINK_IDLE_LATENCY            (4u)
+#define APP_BT_LINK_IDLE_TIMEOUT            (600u)      /* units of 10 ms */
+
+/* No activity for this long relaxes a link to the idle regime */
+#define APP_BT_LINK_QUIET_MS                (5000u)
+
+/* Minimum time between two requests on a link, keeps it from flapping */
+#define APP_BT_LINK_MIN_DWELL_MS            (2000u)
+
+/* Notifications within one quiet period that count as a burst. Periodic
+ * battery reports stay below this and do not keep the link fast. */
+#define APP_BT_LINK_NOTIFY_BURST            (10u)
+
+/* Controller evaluation period */
+#define APP_BT_LINK_TICK_MS                 (500u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Connection-interval regimes
+ */
+typedef enum
+{
+    APP_BT_LINK_REGIME_FAST = 0,    /* Interval at or below the fast maximum */
+    APP_BT_LINK_REGIME_DEFAULT,     /* Whatever the central picked */
+    APP_BT_LINK_REGIME_IDLE,        /* Interval at or above the idle minimum */
+    APP_BT_LINK_REGIME_COUNT
+} app_bt_link_regime_t;
+
+/**
+ * @brief Activity reported to the controller
+ */
+typedef enum
+{
+    APP_BT_LINK_ACT_OTA_START = 0,  /* PREPARE_DOWNLOAD, go fast at once */
+    APP_BT_LINK_ACT_OTA_DATA,       /* OTA data or control traffic */
+    APP_BT_LINK_ACT_NOTIFY,         /* Notification queued */
+    APP_BT_LINK_ACT_GATT,           /* Any other request from the central */
+} app_bt_link_activity_t;
+
+/**
+ * @brief Time spent in each regime and number of requests made
+ */
+typedef struct
+{
+    uint32_t    regime_ms[APP_BT_LINK_REGIME_COUNT];
+    uint32_t    requests[APP_BT_LINK_REGIME_COUNT];
+} app_bt_link_stats_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void app_bt_link_ctrl_init          (void);
+void app_bt_link_ctrl_conn_up       (uint16_t conn_id);
+void app_bt_link_ctrl_conn_down     (uint16_t conn_id);
+void app_bt_link_ctrl_activity      (uint16_t conn_id, app_bt_link_activity_t activity);
+void app_bt_link_ctrl_params_updated(uint16_t conn_id, uint16_t conn_interval);
+void app_bt_link_ctrl_get_stats     (app_bt_link_stats_t *p_stats);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,471 @@
+/*******************************************************************************
+ * File Name: app_bt_notify.c
+ *
+ * Description: This file implements the notification scheduler.
+ *              Notifications to a connection are collected for a short window and
+ *              then sent as one ATT Multiple Handle Value Notification when the
+ *              peer supports it, or as individual notifications otherwise.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "cyhal.h"
+#include "wiced_bt_stack.h"
+#include "app_bt_utils.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_notify.h"
+#include "app_bt_bearer.h"
+#include "app_bt_link_ctrl.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Each tuple of a Multiple Handle Value Notification: handle, length, value */
+#define APP_BT_NOTIFY_TUPLE_HDR_LEN     (4u)
+
+/* ATT opcode byte in front of every PDU */
+#define APP_BT_NOTIFY_ATT_OPCODE_LEN    (1u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Pending notification for one attribute
+ */
+typedef struct
+{
+    uint16_t    handle;
+    uint16_t    len;
+    uint8_t     value[APP_BT_NOTIFY_MAX_VAL_LEN];
+} app_bt_notify_entry_t;
+
+/**
+ * @brief Notifications collected for one connection during the window
+ */
+typedef struct
+{
+    uint16_t                conn_id;
+    uint8_t                 count;
+    app_bt_notify_entry_t   entry[APP_BT_NOTIFY_MAX_PENDING];
+} app_bt_notify_conn_t;
+
+static app_bt_notify_conn_t app_bt_notify_pending[APP_BT_MAX_CONNECTIONS];
+
+/**
+ * @brief One-shot timer closing the collection window
+ */
+static TimerHandle_t app_bt_notify_timer;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_bt_notify_timer_cb(TimerHandle_t timer);
+static void app_bt_notify_flush_conn(app_bt_notify_conn_t *p_pending);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_notify_init
+*
+* Function Description:
+* @brief  Creates the timer that closes the notification collection window
+*
+* @return void
+*/
+void app_bt_notify_init(void)
+{
+    memset(app_bt_notify_pending, 0, sizeof(app_bt_notify_pending));
+
+    app_bt_notify_timer = xTimerCreate("Notify", pdMS_TO_TICKS(APP_BT_NOTIFY_WINDOW_MS),
+                                       pdFALSE, NULL, app_bt_notify_timer_cb);
+    if (NULL == app_bt_notify_timer)
+    {
+        APP_LOG_ERR("Notification timer creation failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_notify_send_single
+*
+* Function Description:
+* @brief  Sends one notification from a buffer owned by the stack until the
+*         GATT_APP_BUFFER_TRANSMITTED_EVT, on the bearer of its traffic class
+*
+* @param conn_id      Connection ID of the link
+*
+* @param attr_handle  Handle of the characteristic value
+*
+* @param len          Length of the value
+*
+* @param p_val        Pointer to the value, copied before sending
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_notify_send_single(uint16_t conn_id, uint16_t attr_handle,
+                                                        uint16_t len, const uint8_t *p_val)
+{
+    wiced_bt_gatt_status_t status;
+    uint8_t *p_buf = app_bt_alloc_buffer(len);
+
+    conn_id = app_bt_bearer_for_traffic(conn_id, app_bt_bearer_traffic_of_handle(attr_handle));
+    memcpy(p_buf, p_val, len);
+    status = wiced_bt_gatt_server_send_notification(conn_id, attr_handle, len, p_buf,
+                                                    (void *)app_bt_free_buffer);
+    if (WICED_BT_GATT_SUCCESS != status)
+    {
+        app_bt_free_buffer(p_buf);
+        APP_LOG_ERR("%s() Notification FAILED conn_id:0x%x handle: %d status: %d\n",
+               __func__, conn_id, attr_handle, status);
+    }
+    return status;
+}
+
+/**
+* Function Name:
+* app_bt_notify_queue
+*
+* Function Description:
+* @brief  Queues a notification for a connection. A newer value for an
+*         attribute that is already pending replaces the older one.
+*
+* @param conn_id      Connection ID
+*
+* @param attr_handle  Handle of the characteristic value
+*
+* @param len          Length of the value
+*
+* @param p_val        Pointer to the value, copied into the queue
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_notify_queue(uint16_t conn_id, uint16_t attr_handle,
+                                           uint16_t len, const uint8_t *p_val)
+{
+    app_bt_notify_conn_t *p_pending = NULL;
+    app_bt_notify_entry_t *p_entry = NULL;
+    uint8_t i;
+    uint8_t attempt;
+
+    /* Values are queued per link, whatever bearer the caller knows */
+    conn_id = app_bt_bearer_conn_id(conn_id);
+    if (NULL == app_bt_conn_find(conn_id))
+    {
+        return WICED_BT_GATT_ERROR;
+    }
+
+    app_bt_link_ctrl_activity(conn_id, APP_BT_LINK_ACT_NOTIFY);
+
+    /* Values which do not fit a queue entry bypass the window */
+    if (len > APP_BT_NOTIFY_MAX_VAL_LEN)
+    {
+        return app_bt_notify_send_single(conn_id, attr_handle, len, p_val);
+    }
+
+    /* The slot is looked up and written in one critical section: the timer
+     * task may flush it and hand it to another connection in between */
+    for (attempt = 0; attempt < 2u; attempt++)
+    {
+        p_pending = NULL;
+        p_entry = NULL;
+
+        taskENTER_CRITICAL();
+        for (i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+        {
+            if (app_bt_notify_pending[i].conn_id == conn_id)
+            {
+                p_pending = &app_bt_notify_pending[i];
+                break;
+            }
+            if ((NULL == p_pending) && (0 == app_bt_notify_pending[i].conn_id))
+            {
+                p_pending = &app_bt_notify_pending[i];
+            }
+        }
+        if (NULL != p_pending)
+        {
+            p_pending->conn_id = conn_id;
+            for (i = 0; i < p_pending->count; i++)
+            {
+                if (p_pending->entry[i].handle == attr_handle)
+                {
+                    p_entry = &p_pending->entry[i];
+                    break;
+                }
+            }
+            if ((NULL == p_entry) && (p_pending->count < APP_BT_NOTIFY_MAX_PENDING))
+            {
+                p_entry = &p_pending->entry[p_pending->count++];
+                p_entry->handle = attr_handle;
+            }
+            if (NULL != p_entry)
+            {
+                p_entry->len = len;
+                memcpy(p_entry->value, p_val, len);
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if ((NULL == p_pending) || (NULL != p_entry))
+        {
+            break;
+        }
+
+        /* Queue is full, send what is pending before adding the new value */
+        app_bt_notify_flush_conn(p_pending);
+    }
+
+    if (NULL == p_entry)
+    {
+        return app_bt_notify_send_single(conn_id, attr_handle, len, p_val);
+    }
+
+    if (pdFALSE == xTimerIsTimerActive(app_bt_notify_timer))
+    {
+        xTimerStart(app_bt_notify_timer, 0);
+    }
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_notify_send
+*
+* Function Description:
+* @brief  Sends a notification at once, outside the collection window, for
+*         values a peer waits on such as command responses. A value still
+*         pending for the same attribute is older, so it is dropped.
+*
+* @param conn_id      Connection ID
+*
+* @param attr_handle  Handle of the characteristic value
+*
+* @param len          Length of the value
+*
+* @param p_val        Pointer to the value, copied before sending
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_notify_send(uint16_t conn_id, uint16_t attr_handle,
+                                          uint16_t len, const uint8_t *p_val)
+{
+    conn_id = app_bt_bearer_conn_id(conn_id);
+    if (NULL == app_bt_conn_find(conn_id))
+    {
+        return WICED_BT_GATT_ERROR;
+    }
+
+    app_bt_link_ctrl_activity(conn_id, APP_BT_LINK_ACT_NOTIFY);
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        app_bt_notify_conn_t *p_pending = &app_bt_notify_pending[i];
+        if (p_pending->conn_id != conn_id)
+        {
+            continue;
+        }
+        for (uint8_t j = 0; j < p_pending->count; j++)
+        {
+            if (p_pending->entry[j].handle == attr_handle)
+            {
+                p_pending->entry[j] = p_pending->entry[--p_pending->count];
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return app_bt_notify_send_single(conn_id, attr_handle, len, p_val);
+}
+
+/**
+* Function Name:
+* app_bt_notify_flush_conn
+*
+* Function Description:
+* @brief  Sends everything pending for one connection. Several values go out
+*         as one Multiple Handle Value Notification when the peer enabled
+*         that feature and they fit the MTU.
+*
+* @param p_pending    Pending notifications of the connection
+*
+* @return void
+*/
+static void app_bt_notify_flush_conn(app_bt_notify_conn_t *p_pending)
+{
+    app_bt_notify_entry_t entry[APP_BT_NOTIFY_MAX_PENDING];
+    app_bt_conn_t *p_conn;
+    uint16_t conn_id;
+    uint16_t bearer_id;
+    bool same_bearer = true;
+    uint8_t count;
+    uint16_t total = APP_BT_NOTIFY_ATT_OPCODE_LEN;
+    uint16_t used = 0;
+    uint8_t *p_buf;
+    wiced_bt_gatt_status_t status;
+
+    taskENTER_CRITICAL();
+    conn_id = p_pending->conn_id;
+    count = p_pending->count;
+    memcpy(entry, p_pending->entry, count * sizeof(entry[0]));
+    p_pending->count = 0;
+    p_pending->conn_id = 0;
+    taskEXIT_CRITICAL();
+
+    p_conn = app_bt_conn_find(conn_id);
+    if ((0 == count) || (NULL == p_conn))
+    {
+        return;
+    }
+
+    /* Only values of one traffic class are combined, so classes with their
+     * own enhanced bearer keep it */
+    bearer_id = app_bt_bearer_for_traffic(conn_id, app_bt_bearer_traffic_of_handle(entry[0].handle));
+    for (uint8_t i = 0; i < count; i++)
+    {
+        total += APP_BT_NOTIFY_TUPLE_HDR_LEN + entry[i].len;
+        if (bearer_id != app_bt_bearer_for_traffic(conn_id,
+                                app_bt_bearer_traffic_of_handle(entry[i].handle)))
+        {
+            same_bearer = false;
+        }
+    }
+
+    if ((count > 1) && same_bearer &&
+        (p_conn->client_features & APP_BT_CLIENT_FEATURE_MULTI_NOTIF) &&
+        (total <= app_bt_bearer_mtu(bearer_id)))
+    {
+        p_buf = app_bt_alloc_buffer(total - APP_BT_NOTIFY_ATT_OPCODE_LEN);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            p_buf[used++] = (uint8_t)(entry[i].handle & 0xFF);
+            p_buf[used++] = FROM_BIT16_TO_8(entry[i].handle);
+            p_buf[used++] = (uint8_t)(entry[i].len & 0xFF);
+            p_buf[used++] = FROM_BIT16_TO_8(entry[i].len);
+            memcpy(&p_buf[used], entry[i].value, entry[i].len);
+            used += entry[i].len;
+        }
+
+        status = wiced_bt_gatt_server_send_multiple_notifications(bearer_id, used, p_buf,
+                                                                   (void *)app_bt_free_buffer);
+        if (WICED_BT_GATT_SUCCESS == status)
+        {
+            return;
+        }
+        /* Fall back to individual PDUs */
+        app_bt_free_buffer(p_buf);
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        app_bt_notify_send_single(conn_id, entry[i].handle, entry[i].len, entry[i].value);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_notify_flush
+*
+* Function Description:
+* @brief  Sends the notifications pending for every connection
+*
+* @return void
+*/
+void app_bt_notify_flush(void)
+{
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (0 != app_bt_notify_pending[i].conn_id)
+        {
+            app_bt_notify_flush_conn(&app_bt_notify_pending[i]);
+        }
+    }
+}
+
+/**
+* Function Name:
+* app_bt_notify_conn_down
+*
+* Function Description:
+* @brief  Drops the notifications pending for a connection that went down
+*
+* @param conn_id      Connection ID
+*
+* @return void
+*/
+void app_bt_notify_conn_down(uint16_t conn_id)
+{
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < APP_BT_MAX_CONNECTIONS; i++)
+    {
+        if (app_bt_notify_pending[i].conn_id == conn_id)
+        {
+            app_bt_notify_pending[i].conn_id = 0;
+            app_bt_notify_pending[i].count = 0;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_bt_notify_timer_cb
+*
+* Function Description:
+* @brief  Closes the collection window, runs in the timer service task
+*
+* @param timer        unused
+*
+* @return void
+*/
+static void app_bt_notify_timer_cb(TimerHandle_t timer)
+{
+    (void)timer;
+    app_bt_notify_flush();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * File Name: app_bt_notify.h
+ *
+ * Description: This file is the public interface of app_bt_notify.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_NOTIFY_H__
+#define APP_BT_NOTIFY_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "wiced_bt_gatt.h"
+#include "app_bt_conn.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Time during which notifications to one connection are collected
+ *        before they are sent out together
+ */
+#define APP_BT_NOTIFY_WINDOW_MS         (10u)
+
+/**
+ * @brief Maximum number of distinct attributes pending per connection
+ */
+#define APP_BT_NOTIFY_MAX_PENDING       (4u)
+
+/**
+ * @brief Largest value that can be queued, longer values are sent at once
+ */
+#define APP_BT_NOTIFY_MAX_VAL_LEN       (20u)
+
+/**
+ * @brief Client Supported Features bit for Multiple Handle Value
+ *        Notifications (Core Spec Vol 3, Part G, 7.2)
+ */
+#define APP_BT_CLIENT_FEATURE_MULTI_NOTIF   (0x04u)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void                    app_bt_notify_init      (void);
+wiced_bt_gatt_status_t  app_bt_notify_queue     (uint16_t conn_id, uint16_t attr_handle,
+                                                 uint16_t len, const uint8_t *p_val);
+wiced_bt_gatt_status_t  app_bt_notify_send      (uint16_t conn_id, uint16_t attr_handle,
+                                                 uint16_t len, const uint8_t *p_val);
+void                    app_bt_notify_flush     (void);
+void                    app_bt_notify_conn_down (uint16_t conn_id);
+
+#endif
+/* [] END OF FILE */
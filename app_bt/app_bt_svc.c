@@ -0,0 +1,287 @@
+/*******************************************************************************
+ * File Name: app_bt_svc.c
+ *
+ * Description: This file implements the GATT service dispatch. Each
+ *              service registers the handle range it owns, and every request is
+ *              routed with one lookup in a handle indexed map.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include "cyhal.h"
+#include "wiced_bt_stack.h"
+#include "app_bt_utils.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_svc.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Map entry of a handle no service has claimed */
+#define APP_BT_SVC_NONE                 (0xFFu)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Registered services
+ */
+static const app_bt_svc_t *app_bt_svc_table[APP_BT_SVC_MAX_SERVICES];
+static uint8_t app_bt_svc_count;
+
+/**
+ * @brief Handle to index of the owning service in app_bt_svc_table
+ */
+static uint8_t app_bt_svc_map[APP_BT_SVC_MAX_HANDLE + 1];
+
+/**
+ * @brief Handle to index in app_gatt_db_ext_attr_tbl
+ */
+static uint8_t app_bt_svc_attr_map[APP_BT_SVC_MAX_HANDLE + 1];
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_svc_init
+*
+* Function Description:
+* @brief  Clears the service table and indexes the GATT database lookup table
+*         by handle
+*
+* @return void
+*/
+void app_bt_svc_init(void)
+{
+    app_bt_svc_count = 0;
+    memset(app_bt_svc_map, APP_BT_SVC_NONE, sizeof(app_bt_svc_map));
+    memset(app_bt_svc_attr_map, APP_BT_SVC_NONE, sizeof(app_bt_svc_attr_map));
+
+    for (uint8_t i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    {
+        /* The database outgrew the maps, raise APP_BT_SVC_MAX_HANDLE */
+        CY_ASSERT(app_gatt_db_ext_attr_tbl[i].handle <= APP_BT_SVC_MAX_HANDLE);
+        app_bt_svc_attr_map[app_gatt_db_ext_attr_tbl[i].handle] = i;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_register
+*
+* Function Description:
+* @brief  Hands the handle range of a service to its callbacks. The service
+*         descriptor must stay valid, it is referenced and not copied.
+*
+* @param p_svc        Service descriptor
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_svc_register(const app_bt_svc_t *p_svc)
+{
+    if ((NULL == p_svc) || (p_svc->start_handle > p_svc->end_handle) ||
+        (p_svc->end_handle > APP_BT_SVC_MAX_HANDLE) ||
+        (app_bt_svc_count >= APP_BT_SVC_MAX_SERVICES))
+    {
+        return WICED_BT_GATT_ILLEGAL_PARAMETER;
+    }
+
+    for (uint16_t handle = p_svc->start_handle; handle <= p_svc->end_handle; handle++)
+    {
+        if (APP_BT_SVC_NONE != app_bt_svc_map[handle])
+        {
+            APP_LOG_ERR("Service %s overlaps %s at handle 0x%x\r\n", p_svc->name,
+                   app_bt_svc_table[app_bt_svc_map[handle]]->name, handle);
+            return WICED_BT_GATT_ILLEGAL_PARAMETER;
+        }
+    }
+
+    app_bt_svc_table[app_bt_svc_count] = p_svc;
+    for (uint16_t handle = p_svc->start_handle; handle <= p_svc->end_handle; handle++)
+    {
+        app_bt_svc_map[handle] = app_bt_svc_count;
+    }
+    app_bt_svc_count++;
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_svc_lookup
+*
+* Function Description:
+* @brief  Returns the service that owns a handle
+*
+* @param attr_handle  Attribute handle
+*
+* @return const app_bt_svc_t*  Owning service, NULL if none
+*/
+const app_bt_svc_t *app_bt_svc_lookup(uint16_t attr_handle)
+{
+    if ((attr_handle > APP_BT_SVC_MAX_HANDLE) ||
+        (APP_BT_SVC_NONE == app_bt_svc_map[attr_handle]))
+    {
+        return NULL;
+    }
+    return app_bt_svc_table[app_bt_svc_map[attr_handle]];
+}
+
+/**
+* Function Name:
+* app_bt_svc_attr
+*
+* Function Description:
+* @brief  Returns the GATT database lookup table entry of a handle
+*
+* @param attr_handle  Attribute handle
+*
+* @return gatt_db_lookup_table_t*  Table entry, NULL if the handle has none
+*/
+gatt_db_lookup_table_t *app_bt_svc_attr(uint16_t attr_handle)
+{
+    if ((attr_handle > APP_BT_SVC_MAX_HANDLE) ||
+        (APP_BT_SVC_NONE == app_bt_svc_attr_map[attr_handle]))
+    {
+        return NULL;
+    }
+    return &app_gatt_db_ext_attr_tbl[app_bt_svc_attr_map[attr_handle]];
+}
+
+/**
+* Function Name:
+* app_bt_svc_read
+*
+* Function Description:
+* @brief  Resolves the value of an attribute for one connection. CCCDs are
+*         rebuilt from the connection table, other handles go to the owning
+*         service or to the GATT database.
+*
+* @param conn_id      Connection ID of the reader
+*
+* @param attr_handle  Attribute handle
+*
+* @param offset       Offset of the request, 0 for reads without offset
+*
+* @param p_scratch    Caller buffer of at least 2 bytes for rebuilt values
+*
+* @param pp_val       Set to the value
+*
+* @param p_len        Set to the length of the value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_svc_read(uint16_t conn_id, uint16_t attr_handle,
+                                       uint16_t offset, uint8_t *p_scratch, uint8_t **pp_val,
+                                       uint16_t *p_len)
+{
+    const app_bt_svc_t *p_svc = app_bt_svc_lookup(attr_handle);
+    gatt_db_lookup_table_t *p_attr;
+    int cccd = app_bt_conn_cccd_from_handle(attr_handle);
+
+    if (cccd >= 0)
+    {
+        uint16_t value = app_bt_conn_cccd_value(conn_id, (app_bt_cccd_t)cccd);
+
+        p_scratch[0] = (uint8_t)(value & 0xFF);
+        p_scratch[1] = FROM_BIT16_TO_8(value);
+        *pp_val = p_scratch;
+        *p_len = 2;
+        return WICED_BT_GATT_SUCCESS;
+    }
+
+    if ((NULL != p_svc) && (NULL != p_svc->read))
+    {
+        return p_svc->read(conn_id, attr_handle, offset, pp_val, p_len);
+    }
+
+    p_attr = app_bt_svc_attr(attr_handle);
+    if (NULL == p_attr)
+    {
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+    *pp_val = p_attr->p_data;
+    *p_len = p_attr->cur_len;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_svc_write
+*
+* Function Description:
+* @brief  Routes a write to the owning service. CCCD writes are stored per
+*         connection first and then reported to the service.
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param p_write_req  Write request
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+wiced_bt_gatt_status_t app_bt_svc_write(uint16_t conn_id,
+                                        wiced_bt_gatt_write_req_t *p_write_req)
+{
+    const app_bt_svc_t *p_svc = app_bt_svc_lookup(p_write_req->handle);
+    wiced_bt_gatt_status_t status;
+    int cccd = app_bt_conn_cccd_from_handle(p_write_req->handle);
+
+    if (cccd >= 0)
+    {
+        status = app_bt_conn_cccd_write(conn_id, (app_bt_cccd_t)cccd,
+                                        p_write_req->p_val, p_write_req->val_len);
+        if ((WICED_BT_GATT_SUCCESS == status) && (NULL != p_svc) && (NULL != p_svc->cccd))
+        {
+            p_svc->cccd(conn_id, (app_bt_cccd_t)cccd,
+                        app_bt_conn_cccd_value(conn_id, (app_bt_cccd_t)cccd));
+        }
+        return status;
+    }
+
+    if ((NULL != p_svc) && (NULL != p_svc->write))
+    {
+        return p_svc->write(conn_id, p_write_req);
+    }
+
+    return app_bt_set_value(p_write_req->handle, p_write_req->p_val, p_write_req->val_len);
+}
+
+/* [] END OF FILE */
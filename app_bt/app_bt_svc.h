@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * File Name: app_bt_svc.h
+ *
+ * Description: This file is the public interface of app_bt_svc.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BT_SVC_H__
+#define APP_BT_SVC_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "wiced_bt_gatt.h"
+#include "GeneratedSource/cycfg_gatt_db.h"
+#include "app_bt_conn.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Highest attribute handle the dispatch maps can hold. Must cover the
+ *        last handle of the GATT database generated from design.cybt.
+ */
+#define APP_BT_SVC_MAX_HANDLE           (0x3Fu)
+
+/**
+ * @brief Number of services that can be registered
+ */
+#define APP_BT_SVC_MAX_SERVICES         (8u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Read callback. Points *pp_val at the full value of the attribute,
+ *        the dispatcher applies the offset and length of the request. The
+ *        offset is passed so that values built on demand are only rebuilt
+ *        when a (long) read starts at 0.
+ */
+typedef wiced_bt_gatt_status_t (*app_bt_svc_read_cb_t)(uint16_t conn_id, uint16_t attr_handle,
+                                                       uint16_t offset, uint8_t **pp_val,
+                                                       uint16_t *p_len);
+
+/**
+ * @brief Write callback for the characteristic values of a service
+ */
+typedef wiced_bt_gatt_status_t (*app_bt_svc_write_cb_t)(uint16_t conn_id,
+                                                        wiced_bt_gatt_write_req_t *p_write_req);
+
+/**
+ * @brief Called after a peer has written one of the CCCDs of a service
+ */
+typedef void (*app_bt_svc_cccd_cb_t)(uint16_t conn_id, app_bt_cccd_t cccd, uint16_t value);
+
+/**
+ * @brief A service and the handle range it owns. Callbacks left NULL fall
+ *        back to the GATT database: reads are served from
+ *        app_gatt_db_ext_attr_tbl and writes are stored there.
+ */
+typedef struct
+{
+    const char             *name;
+    uint16_t                start_handle;   /* Service declaration handle */
+    uint16_t                end_handle;     /* Last handle of the service */
+    app_bt_svc_read_cb_t    read;
+    app_bt_svc_write_cb_t   write;
+    app_bt_svc_cccd_cb_t    cccd;
+} app_bt_svc_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void                    app_bt_svc_init          (void);
+wiced_bt_gatt_status_t  app_bt_svc_register      (const app_bt_svc_t *p_svc);
+const app_bt_svc_t     *app_bt_svc_lookup        (uint16_t attr_handle);
+gatt_db_lookup_table_t *app_bt_svc_attr          (uint16_t attr_handle);
+
+wiced_bt_gatt_status_t  app_bt_svc_read          (uint16_t conn_id, uint16_t attr_handle,
+                                                  uint16_t offset, uint8_t *p_scratch,
+                                                  uint8_t **pp_val,
+                                                  uint16_t *p_len);
+wiced_bt_gatt_status_t  app_bt_svc_write         (uint16_t conn_id,
+                                                  wiced_bt_gatt_write_req_t *p_write_req);
+
+#endif
+/* [] END OF FILE */
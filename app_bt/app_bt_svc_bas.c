@@ -0,0 +1,154 @@
+/*******************************************************************************
+ * File Name: app_bt_svc_bas.c
+ *
+ * Description: This file implements the GATT handlers of the Battery
+ *              Service
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "cyhal.h"
+#include "wiced_bt_stack.h"
+#include "app_bt_event_handler.h"
+#include "app_bt_conn.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_bas.h"
+#include "app_bas_hist.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BAS
+#include "app_log.h"
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_bt_svc_bas_cccd(uint16_t conn_id, app_bt_cccd_t cccd, uint16_t value);
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const app_bt_svc_t app_bt_svc_bas =
+{
+    .name           = "BAS",
+    .start_handle   = HDLS_BAS,
+    .end_handle     = HDLD_BAS_BATTERY_LEVEL_CLIENT_CHAR_CONFIG,
+    .read           = NULL,
+    .write          = NULL,
+    .cccd           = app_bt_svc_bas_cccd,
+};
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_svc_bas_register
+*
+* Function Description:
+* @brief  Registers the Battery Service with the GATT dispatch
+*
+* @return void
+*/
+void app_bt_svc_bas_register(void)
+{
+    if (WICED_BT_GATT_SUCCESS != app_bt_svc_register(&app_bt_svc_bas))
+    {
+        APP_LOG_ERR("BAS service registration failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_bas_cccd
+*
+* Function Description:
+* @brief  Reports a change of the Battery Level CCCD of one connection
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param cccd         CCCD that was written
+*
+* @param value        New CCCD value
+*
+* @return void
+*/
+static void app_bt_svc_bas_cccd(uint16_t conn_id, app_bt_cccd_t cccd, uint16_t value)
+{
+    (void)cccd;
+
+    APP_LOG_INFO("Battery Server Notifications %s for conn_id %d \r\n",
+           (value & GATT_CLIENT_CONFIG_NOTIFICATION) ? "Enabled" : "Disabled", conn_id);
+}
+
+/**
+* Function Name:
+* app_bt_svc_bas_update
+*
+* Function Description:
+* @brief  Updates the dummy battery level, adds it to the history and
+*         notifies every subscribed peer. The level is reduced by
+*         BATTERY_LEVEL_CHANGE percent and starts again at 100 once it
+*         reaches 0. Runs in the application loop every
+*         BATTERY_LEVEL_UPDATE_MS.
+*
+* @return void
+*/
+void app_bt_svc_bas_update(void)
+{
+    if (0 == app_bas_battery_level[0])
+    {
+        app_bas_battery_level[0] = 100;
+    }
+    else
+    {
+        app_bas_battery_level[0] = app_bas_battery_level[0] - BATTERY_LEVEL_CHANGE;
+    }
+    app_bas_hist_add(app_bas_battery_level[0]);
+
+    /* Serialize once, fan out to every subscribed central */
+    if (0 != app_bt_conn_notify_all(APP_BT_CCCD_BAS_BATTERY_LEVEL,
+                                    HDLC_BAS_BATTERY_LEVEL_VALUE,
+                                    app_bas_battery_level_len,
+                                    app_bas_battery_level))
+    {
+        APP_LOG_INFO("================================================\r\n");
+        APP_LOG_INFO("Sending Notification: Battery level: %u\r\n",
+                app_bas_battery_level[0]);
+        APP_LOG_INFO("================================================\r\n");
+    }
+}
+
+/* [] END OF FILE */
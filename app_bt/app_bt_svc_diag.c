@@ -0,0 +1,470 @@
+/*******************************************************************************
+ * File Name: app_bt_svc_diag.c
+ *
+ * Description: This file contains the Diagnostics service. Its Log
+ *              Levels characteristic reads and sets the run-time log level of
+ *              every module and reports the CPU time spent on logging. The
+ *              OTA Telemetry characteristic reports the counters of the last
+ *              OTA session, Task Stats the CPU usage of every task.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "app_ota_context.h"
+#include "app_ota_telemetry.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_diag.h"
+#include "app_rtstats.h"
+#include "app_kv.h"
+#include "app_ota_storage.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_GATT
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Log Levels value: one level per app_log_module_t, then the caller and
+ * log task CPU time as uint32 little endian microseconds */
+#define APP_BT_SVC_DIAG_LEVELS_LEN      (APP_LOG_MOD_COUNT + 2u * sizeof(uint32_t))
+
+/* OTA Telemetry value, see app_bt_svc_diag_telemetry() for the layout */
+#define APP_BT_SVC_DIAG_TELEMETRY_LEN   (56u)
+
+/* Task Stats value: window u32 us and task count u8, then per task the
+ * name, run time u32 us and CPU share u16 in 0.1 % units */
+#define APP_BT_SVC_DIAG_TASK_LEN        (APP_RTSTATS_NAME_LEN + 6u)
+#define APP_BT_SVC_DIAG_TASKS_LEN       (5u + APP_RTSTATS_MAX_TASKS * APP_BT_SVC_DIAG_TASK_LEN)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static wiced_bt_gatt_status_t app_bt_svc_diag_read(uint16_t conn_id, uint16_t attr_handle,
+                                                   uint16_t offset, uint8_t **pp_val,
+                                                   uint16_t *p_len);
+static wiced_bt_gatt_status_t app_bt_svc_diag_write(uint16_t conn_id,
+                                                    wiced_bt_gatt_write_req_t *p_write_req);
+static void app_bt_svc_diag_levels_save(void);
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const app_bt_svc_t app_bt_svc_diag =
+{
+    .name           = "DIAG",
+    .start_handle   = HDLS_DIAGNOSTICS,
+    .end_handle     = HDLC_DIAGNOSTICS_TASK_STATS_VALUE,
+    .read           = app_bt_svc_diag_read,
+    .write          = app_bt_svc_diag_write,
+    .cccd           = NULL,
+};
+
+/* Values are serialized when a read starts at offset 0, the Read Blob
+ * requests of a long read continue from the same snapshot */
+static uint8_t app_bt_svc_diag_levels[APP_BT_SVC_DIAG_LEVELS_LEN];
+static uint8_t app_bt_svc_diag_telemetry_val[APP_BT_SVC_DIAG_TELEMETRY_LEN];
+static uint8_t app_bt_svc_diag_tasks[APP_BT_SVC_DIAG_TASKS_LEN];
+static uint16_t app_bt_svc_diag_tasks_len;
+
+/* A save of the log levels is waiting in the storage task */
+static volatile bool app_bt_svc_diag_levels_queued;
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_svc_diag_register
+*
+* Function Description:
+* @brief  Registers the Diagnostics service with the GATT dispatch
+*
+* @return void
+*/
+void app_bt_svc_diag_register(void)
+{
+    if (WICED_BT_GATT_SUCCESS != app_bt_svc_register(&app_bt_svc_diag))
+    {
+        APP_LOG_ERR("DIAG service registration failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_levels_restore
+*
+* Function Description:
+* @brief  Applies the log levels last written to the Log Levels
+*         characteristic, kept in the key-value store. Called by the store
+*         task once the store is loaded.
+*
+* @return void
+*/
+void app_bt_svc_diag_levels_restore(void)
+{
+    uint8_t levels[APP_LOG_MOD_COUNT];
+    uint8_t len = 0;
+
+    if (CY_RSLT_SUCCESS != app_kv_get(APP_KV_KEY_LOG_LEVELS, levels, sizeof(levels), &len))
+    {
+        return;
+    }
+    for (uint16_t module = 0; (module < len) && (module < APP_LOG_MOD_COUNT); module++)
+    {
+        if (CY_LOG_MAX > levels[module])
+        {
+            app_log_set_level((app_log_module_t)module, (CY_LOG_LEVEL_T)levels[module]);
+        }
+    }
+    APP_LOG_INFO("Log levels restored\r\n");
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_put_u32
+*
+* Function Description:
+* @brief  Stores a 32-bit value little endian
+*
+* @param p_dst      Destination
+*
+* @param value      Value
+*
+* @return uint8_t*  First byte after the value
+*/
+static uint8_t *app_bt_svc_diag_put_u32(uint8_t *p_dst, uint32_t value)
+{
+    p_dst[0] = (uint8_t)(value);
+    p_dst[1] = (uint8_t)(value >> 8);
+    p_dst[2] = (uint8_t)(value >> 16);
+    p_dst[3] = (uint8_t)(value >> 24);
+    return p_dst + 4;
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_put_u16
+*
+* Function Description:
+* @brief  Stores a 16-bit value little endian
+*
+* @param p_dst      Destination
+*
+* @param value      Value
+*
+* @return uint8_t*  First byte after the value
+*/
+static uint8_t *app_bt_svc_diag_put_u16(uint8_t *p_dst, uint16_t value)
+{
+    p_dst[0] = (uint8_t)(value);
+    p_dst[1] = (uint8_t)(value >> 8);
+    return p_dst + 2;
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_levels_value
+*
+* Function Description:
+* @brief  Serializes the Log Levels characteristic: the level of every
+*         module, then the CPU time of the logging callers and of the log
+*         task in microseconds
+*
+* @return void
+*/
+static void app_bt_svc_diag_levels_value(void)
+{
+    app_log_cpu_stats_t stats;
+    uint8_t *p = app_bt_svc_diag_levels;
+    uint32_t module;
+
+    for (module = 0; module < APP_LOG_MOD_COUNT; module++)
+    {
+        *p++ = (uint8_t)app_log_level[module];
+    }
+    app_log_cpu_stats(&stats);
+    p = app_bt_svc_diag_put_u32(p, stats.caller_us);
+    (void)app_bt_svc_diag_put_u32(p, stats.task_us);
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_telemetry_value
+*
+* Function Description:
+* @brief  Serializes the OTA Telemetry characteristic, little endian:
+*         bytes u32, chunks u32, average and max chunk gap u32 us, program
+*         time u32 us, programmed bytes u32, erase time u32 us, erased bytes
+*         u32, write amplification u16 (programmed / received x 100),
+*         retries u32, session time u32 ms, MTU u16, connection interval u16
+*         (1.25 ms units), TX PHY u8, RX PHY u8, GATT and L2CAP image
+*         throughput u32 B/s
+*
+* @return void
+*/
+static void app_bt_svc_diag_telemetry_value(void)
+{
+    app_ota_telemetry_t telemetry;
+    uint8_t *p = app_bt_svc_diag_telemetry_val;
+    uint32_t gap_avg_us = 0;
+    uint32_t write_amp = 0;
+
+    app_ota_telemetry_get(&telemetry);
+    if (telemetry.chunks > 1)
+    {
+        gap_avg_us = telemetry.gap_sum_us / (telemetry.chunks - 1);
+    }
+    if (0 != telemetry.bytes)
+    {
+        write_amp = (uint32_t)(((uint64_t)telemetry.prog_bytes * 100u) / telemetry.bytes);
+        if (write_amp > UINT16_MAX)
+        {
+            write_amp = UINT16_MAX;
+        }
+    }
+
+    /* Refresh the link parameters while the OTA host is still connected */
+    app_bt_ota_link_update(ota_app.bt_conn_id);
+
+    p = app_bt_svc_diag_put_u32(p, telemetry.bytes);
+    p = app_bt_svc_diag_put_u32(p, telemetry.chunks);
+    p = app_bt_svc_diag_put_u32(p, gap_avg_us);
+    p = app_bt_svc_diag_put_u32(p, telemetry.gap_max_us);
+    p = app_bt_svc_diag_put_u32(p, telemetry.prog_us);
+    p = app_bt_svc_diag_put_u32(p, telemetry.prog_bytes);
+    p = app_bt_svc_diag_put_u32(p, telemetry.erase_us);
+    p = app_bt_svc_diag_put_u32(p, telemetry.erase_bytes);
+    p = app_bt_svc_diag_put_u16(p, (uint16_t)write_amp);
+    p = app_bt_svc_diag_put_u32(p, telemetry.retries);
+    p = app_bt_svc_diag_put_u32(p, telemetry.session_ms);
+    p = app_bt_svc_diag_put_u16(p, ota_app.bt_mtu);
+    p = app_bt_svc_diag_put_u16(p, ota_app.bt_conn_params.conn_interval);
+    *p++ = ota_app.bt_tx_phy;
+    *p++ = ota_app.bt_rx_phy;
+    p = app_bt_svc_diag_put_u32(p, telemetry.rate[APP_OTA_TELEMETRY_GATT]);
+    p = app_bt_svc_diag_put_u32(p, telemetry.rate[APP_OTA_TELEMETRY_L2CAP]);
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_tasks_value
+*
+* Function Description:
+* @brief  Serializes the Task Stats characteristic from the last run-time
+*         statistics window. Only the tasks present are sent.
+*
+* @return void
+*/
+static void app_bt_svc_diag_tasks_value(void)
+{
+    uint8_t *p = app_bt_svc_diag_tasks;
+#if APP_RTSTATS
+    static app_rtstats_report_t report;
+    uint8_t i;
+
+    app_rtstats_report(&report);
+    p = app_bt_svc_diag_put_u32(p, report.window_us);
+    *p++ = report.count;
+    for (i = 0; i < report.count; i++)
+    {
+        memcpy(p, report.task[i].name, APP_RTSTATS_NAME_LEN);
+        p += APP_RTSTATS_NAME_LEN;
+        p = app_bt_svc_diag_put_u32(p, report.task[i].run_us);
+        p = app_bt_svc_diag_put_u16(p, report.task[i].permille);
+    }
+#else
+    /* Run-time statistics are disabled, report an empty window */
+    p = app_bt_svc_diag_put_u32(p, 0);
+    *p++ = 0;
+#endif
+    app_bt_svc_diag_tasks_len = (uint16_t)(p - app_bt_svc_diag_tasks);
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_read
+*
+* Function Description:
+* @brief  Serves the Diagnostics characteristics
+*
+* @param conn_id      Connection ID of the reader
+*
+* @param attr_handle  Attribute handle being read
+*
+* @param offset       Offset of the request
+*
+* @param pp_val       Receives a pointer to the value
+*
+* @param p_len        Receives the length of the value
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_svc_diag_read(uint16_t conn_id, uint16_t attr_handle,
+                                                   uint16_t offset, uint8_t **pp_val,
+                                                   uint16_t *p_len)
+{
+    (void)conn_id;
+
+    switch (attr_handle)
+    {
+    case HDLC_DIAGNOSTICS_LOG_LEVELS_VALUE:
+        if (0 == offset)
+        {
+            app_bt_svc_diag_levels_value();
+        }
+        *pp_val = app_bt_svc_diag_levels;
+        *p_len  = sizeof(app_bt_svc_diag_levels);
+        break;
+
+    case HDLC_DIAGNOSTICS_OTA_TELEMETRY_VALUE:
+        if (0 == offset)
+        {
+            app_bt_svc_diag_telemetry_value();
+        }
+        *pp_val = app_bt_svc_diag_telemetry_val;
+        *p_len  = sizeof(app_bt_svc_diag_telemetry_val);
+        break;
+
+    case HDLC_DIAGNOSTICS_TASK_STATS_VALUE:
+        if (0 == offset)
+        {
+            app_bt_svc_diag_tasks_value();
+        }
+        *pp_val = app_bt_svc_diag_tasks;
+        *p_len  = app_bt_svc_diag_tasks_len;
+        break;
+
+    default:
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_write
+*
+* Function Description:
+* @brief  Sets the log level of the modules. Byte n of the value is the new
+*         level of module n, modules past the end of the value keep their
+*         level. Writing 0xFF to a module also leaves it unchanged. The
+*         levels apply at once; they are saved to the key-value store by
+*         the storage task after the response, and restored at boot.
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param p_write_req  Pointer to Bluetooth LE GATT write request
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_svc_diag_write(uint16_t conn_id,
+                                                    wiced_bt_gatt_write_req_t *p_write_req)
+{
+    uint16_t module;
+
+    (void)conn_id;
+
+    if (HDLC_DIAGNOSTICS_LOG_LEVELS_VALUE != p_write_req->handle)
+    {
+        return WICED_BT_GATT_WRITE_NOT_PERMIT;
+    }
+    if ((0 == p_write_req->val_len) || (APP_LOG_MOD_COUNT < p_write_req->val_len))
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+    for (module = 0; module < p_write_req->val_len; module++)
+    {
+        if ((0xFF != p_write_req->p_val[module]) &&
+            (CY_LOG_MAX <= p_write_req->p_val[module]))
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+    }
+
+    for (module = 0; module < p_write_req->val_len; module++)
+    {
+        if (0xFF != p_write_req->p_val[module])
+        {
+            app_log_set_level((app_log_module_t)module,
+                              (CY_LOG_LEVEL_T)p_write_req->p_val[module]);
+        }
+    }
+
+    /* Writes made while a save is queued are picked up by that save */
+    if (!app_bt_svc_diag_levels_queued)
+    {
+        app_bt_svc_diag_levels_queued = true;
+        if (CY_RSLT_SUCCESS != app_ota_storage_run(app_bt_svc_diag_levels_save))
+        {
+            app_bt_svc_diag_levels_queued = false;
+            APP_LOG_WARNING("Log levels not saved\r\n");
+        }
+    }
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_svc_diag_levels_save
+*
+* Function Description:
+* @brief  Saves the current log levels to the key-value store. Runs in the
+*         storage task, away from the GATT path.
+*
+* @return void
+*/
+static void app_bt_svc_diag_levels_save(void)
+{
+    uint8_t levels[APP_LOG_MOD_COUNT];
+
+    app_bt_svc_diag_levels_queued = false;
+    for (uint16_t module = 0; module < APP_LOG_MOD_COUNT; module++)
+    {
+        levels[module] = (uint8_t)app_log_level[module];
+    }
+    if (CY_RSLT_SUCCESS != app_kv_set(APP_KV_KEY_LOG_LEVELS, levels, sizeof(levels)))
+    {
+        APP_LOG_WARNING("Log levels not saved\r\n");
+    }
+}
+
+/* [] END OF FILE */
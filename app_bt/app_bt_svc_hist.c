@@ -0,0 +1,538 @@
+/*******************************************************************************
+ * File Name: app_bt_svc_hist.c
+ *
+ * Description: Battery History service: streams a time range of the
+ *              battery level history as back-to-back notifications, a few in
+ *              flight at a time
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_gatt_queue.h"
+#include "app_bt_bearer.h"
+#include "app_bt_conn.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_hist.h"
+#include "app_bas_hist.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BAS
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Commands written to the characteristic: stop, or read from..to in device
+ * seconds as uint32 little endian */
+#define APP_BT_SVC_HIST_CMD_STOP        (0x00u)
+#define APP_BT_SVC_HIST_CMD_READ        (0x01u)
+#define APP_BT_SVC_HIST_CMD_READ_LEN    (9u)
+
+/* Notifications: the next bytes of the block stream, then the device time
+ * now uint32 and the number of blocks sent uint16 */
+#define APP_BT_SVC_HIST_FRAME_DATA      (0x01u)
+#define APP_BT_SVC_HIST_FRAME_END       (0x02u)
+#define APP_BT_SVC_HIST_END_LEN         (7u)
+
+/* Notifications queued in the stack at a time. Each one sent frees a
+ * buffer, and the GATT task queues the next. */
+#define APP_BT_SVC_HIST_WINDOW          (4u)
+
+/* ATT notification header: opcode and handle */
+#define APP_BT_SVC_HIST_ATT_HDR_LEN     (3u)
+
+/* Each frame buffer starts with the generation of its read, in front of
+ * the value given to the stack */
+#define APP_BT_SVC_HIST_GEN_LEN         (1u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief The read in progress. One peer reads at a time. Only the GATT
+ *        task uses it.
+ */
+typedef struct
+{
+    bool                    active;
+    bool                    end_sent;
+    uint16_t                conn_id;
+    uint16_t                bearer_id;      /* Bearer of the battery traffic */
+    uint16_t                frame_len;      /* Largest notification value */
+    uint32_t                t_from;
+    uint32_t                t_to;
+    uint32_t                seq;            /* Next block to read */
+    uint32_t                end_seq;
+    uint16_t                blocks;         /* Blocks sent */
+    uint16_t                block_len;
+    uint16_t                block_pos;      /* Bytes of the block already sent */
+    uint8_t                 in_flight;
+    uint8_t                *p_pending;      /* Frame the stack refused, sent again next */
+    uint16_t                pending_len;
+    app_bas_hist_block_t    block;
+} app_bt_svc_hist_stream_t;
+
+static app_bt_svc_hist_stream_t app_bt_svc_hist_stream;
+
+/* Notifications the stack has sent since the GATT task last counted them */
+static volatile uint8_t app_bt_svc_hist_sent_count;
+
+/* Counted frames are those of this generation. It changes when a read is
+ * dropped at a disconnection, so the buffers of that read, freed later,
+ * do not count against the next one. */
+static volatile uint8_t app_bt_svc_hist_gen;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static wiced_bt_gatt_status_t app_bt_svc_hist_write(uint16_t conn_id,
+                                                    wiced_bt_gatt_write_req_t *p_write_req);
+static void app_bt_svc_hist_cccd(uint16_t conn_id, app_bt_cccd_t cccd, uint16_t value);
+static void app_bt_svc_hist_sent(uint8_t *p_buf);
+static void app_bt_svc_hist_pump(void);
+static void app_bt_svc_hist_stop(void);
+
+static const app_bt_svc_t app_bt_svc_hist =
+{
+    .name           = "HIST",
+    .start_handle   = HDLS_HISTORY,
+    .end_handle     = HDLD_HISTORY_BATTERY_HISTORY_CLIENT_CHAR_CONFIG,
+    .read           = NULL,
+    .write          = app_bt_svc_hist_write,
+    .cccd           = app_bt_svc_hist_cccd,
+};
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_svc_hist_register
+*
+* Function Description:
+* @brief  Registers the History service with the GATT dispatch
+*
+* @return void
+*/
+void app_bt_svc_hist_register(void)
+{
+    if (WICED_BT_GATT_SUCCESS != app_bt_svc_register(&app_bt_svc_hist))
+    {
+        APP_LOG_ERR("HIST service registration failed\r\n");
+        CY_ASSERT(0);
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_stop
+*
+* Function Description:
+* @brief  Ends the read in progress. Notifications already queued are still
+*         sent, their buffers are freed as usual.
+*
+* @return void
+*/
+static void app_bt_svc_hist_stop(void)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+
+    if (NULL != p_stream->p_pending)
+    {
+        app_bt_free_buffer(p_stream->p_pending - APP_BT_SVC_HIST_GEN_LEN);
+        p_stream->p_pending = NULL;
+    }
+    p_stream->active = false;
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_conn_down
+*
+* Function Description:
+* @brief  Stops the read of a peer that disconnected. Runs in the GATT
+*         task on APP_BT_GATT_QUEUE_EVT_CONN_DOWN. The stack still frees the
+*         notifications of the link later; a new generation keeps them out
+*         of the count, so the next read can start at once.
+*
+* @return void
+*/
+void app_bt_svc_hist_conn_down(void)
+{
+    if (app_bt_svc_hist_stream.active &&
+        (NULL == app_bt_conn_find(app_bt_svc_hist_stream.conn_id)))
+    {
+        app_bt_svc_hist_stop();
+        taskENTER_CRITICAL();
+        app_bt_svc_hist_gen++;
+        app_bt_svc_hist_sent_count = 0;
+        taskEXIT_CRITICAL();
+        app_bt_svc_hist_stream.in_flight = 0;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_next_block
+*
+* Function Description:
+* @brief  Loads the next block of the range. Blocks overwritten since the
+*         read started are skipped, the first block newer than the range
+*         ends it.
+*
+* @return bool    false once the range is exhausted
+*/
+static bool app_bt_svc_hist_next_block(void)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+    uint16_t size;
+
+    while (p_stream->seq < p_stream->end_seq)
+    {
+        size = app_bas_hist_read(p_stream->seq++, &p_stream->block);
+        if ((0u == size) || (p_stream->block.hdr.t_last < p_stream->t_from))
+        {
+            continue;
+        }
+        if (p_stream->block.hdr.t_first > p_stream->t_to)
+        {
+            break;
+        }
+        p_stream->block_len = size;
+        p_stream->block_pos = 0;
+        p_stream->blocks++;
+        return true;
+    }
+    p_stream->seq = p_stream->end_seq;
+    return false;
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_frame
+*
+* Function Description:
+* @brief  Builds the next notification: block bytes while there are any
+*         left, then the end frame
+*
+* @param p_len      Receives the length of the frame
+*
+* @return uint8_t*  Frame in a stack buffer, after its generation byte,
+*                   NULL once the end was sent
+*/
+static uint8_t *app_bt_svc_hist_frame(uint16_t *p_len)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+    uint8_t *p_buf;
+    uint16_t len = 1;
+    uint16_t n;
+    uint32_t now;
+
+    if (p_stream->end_sent)
+    {
+        return NULL;
+    }
+    p_buf = app_bt_alloc_buffer(APP_BT_SVC_HIST_GEN_LEN + p_stream->frame_len);
+    if (NULL == p_buf)
+    {
+        return NULL;
+    }
+    p_buf[0] = app_bt_svc_hist_gen;
+    p_buf += APP_BT_SVC_HIST_GEN_LEN;
+
+    while (len < p_stream->frame_len)
+    {
+        if ((p_stream->block_pos == p_stream->block_len) && !app_bt_svc_hist_next_block())
+        {
+            break;
+        }
+        n = p_stream->block_len - p_stream->block_pos;
+        if (n > p_stream->frame_len - len)
+        {
+            n = p_stream->frame_len - len;
+        }
+        memcpy(&p_buf[len], (const uint8_t *)&p_stream->block + p_stream->block_pos, n);
+        p_stream->block_pos += n;
+        len += n;
+    }
+
+    if (len > 1u)
+    {
+        p_buf[0] = APP_BT_SVC_HIST_FRAME_DATA;
+    }
+    else
+    {
+        now = app_bas_hist_now();
+        p_buf[0] = APP_BT_SVC_HIST_FRAME_END;
+        p_buf[1] = (uint8_t)(now);
+        p_buf[2] = (uint8_t)(now >> 8);
+        p_buf[3] = (uint8_t)(now >> 16);
+        p_buf[4] = (uint8_t)(now >> 24);
+        p_buf[5] = (uint8_t)(p_stream->blocks);
+        p_buf[6] = (uint8_t)(p_stream->blocks >> 8);
+        len = APP_BT_SVC_HIST_END_LEN;
+        p_stream->end_sent = true;
+    }
+    *p_len = len;
+    return p_buf;
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_pump
+*
+* Function Description:
+* @brief  Queues frames until APP_BT_SVC_HIST_WINDOW are in flight. A frame
+*         the stack refuses is kept and offered again when a buffer comes
+*         back; with none in flight nothing would bring it back, so the
+*         read is dropped.
+*
+* @return void
+*/
+static void app_bt_svc_hist_pump(void)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+    wiced_bt_gatt_status_t status;
+
+    while (p_stream->active && (p_stream->in_flight < APP_BT_SVC_HIST_WINDOW))
+    {
+        if (NULL == p_stream->p_pending)
+        {
+            p_stream->p_pending = app_bt_svc_hist_frame(&p_stream->pending_len);
+            if (NULL == p_stream->p_pending)
+            {
+                if (p_stream->end_sent)
+                {
+                    APP_LOG_INFO("History read done, %d blocks\r\n", p_stream->blocks);
+                }
+                else
+                {
+                    APP_LOG_ERR("History read dropped, no buffer\r\n");
+                }
+                app_bt_svc_hist_stop();
+                break;
+            }
+        }
+
+        status = wiced_bt_gatt_server_send_notification(p_stream->bearer_id,
+                                                        HDLC_HISTORY_BATTERY_HISTORY_VALUE,
+                                                        p_stream->pending_len,
+                                                        p_stream->p_pending,
+                                                        (void *)app_bt_svc_hist_sent);
+        if (WICED_BT_GATT_SUCCESS != status)
+        {
+            if (0u == p_stream->in_flight)
+            {
+                APP_LOG_ERR("History read dropped, status %d\r\n", status);
+                app_bt_svc_hist_stop();
+            }
+            break;
+        }
+        p_stream->p_pending = NULL;
+        p_stream->in_flight++;
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_sent
+*
+* Function Description:
+* @brief  Frees a notification buffer once the stack has sent it, and has
+*         the GATT task queue the next frame in its place. Runs in the
+*         Bluetooth stack task, so it leaves the stream alone. Frames of an
+*         earlier generation are only freed.
+*
+* @param p_buf    Value of the notification, after its generation byte
+*
+* @return void
+*/
+static void app_bt_svc_hist_sent(uint8_t *p_buf)
+{
+    uint8_t gen;
+
+    p_buf -= APP_BT_SVC_HIST_GEN_LEN;
+    gen = p_buf[0];
+    app_bt_free_buffer(p_buf);
+    taskENTER_CRITICAL();
+    if (gen == app_bt_svc_hist_gen)
+    {
+        app_bt_svc_hist_sent_count++;
+    }
+    taskEXIT_CRITICAL();
+    app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_HIST);
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_resume
+*
+* Function Description:
+* @brief  Counts the notifications sent and queues the next frames. Runs
+*         in the GATT task on APP_BT_GATT_QUEUE_EVT_HIST.
+*
+* @return void
+*/
+void app_bt_svc_hist_resume(void)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+    uint8_t sent;
+
+    taskENTER_CRITICAL();
+    sent = app_bt_svc_hist_sent_count;
+    app_bt_svc_hist_sent_count = 0;
+    taskEXIT_CRITICAL();
+
+    p_stream->in_flight = (sent < p_stream->in_flight) ? (uint8_t)(p_stream->in_flight - sent) : 0u;
+    app_bt_svc_hist_pump();
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_cccd
+*
+* Function Description:
+* @brief  Stops the read of a peer that turns notifications off
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param cccd         CCCD that was written
+*
+* @param value        New CCCD value
+*
+* @return void
+*/
+static void app_bt_svc_hist_cccd(uint16_t conn_id, app_bt_cccd_t cccd, uint16_t value)
+{
+    (void)cccd;
+
+    if ((0u == (value & GATT_CLIENT_CONFIG_NOTIFICATION)) &&
+        app_bt_svc_hist_stream.active &&
+        (app_bt_bearer_conn_id(conn_id) == app_bt_svc_hist_stream.conn_id))
+    {
+        app_bt_svc_hist_stop();
+    }
+}
+
+/**
+* Function Name:
+* app_bt_svc_hist_write
+*
+* Function Description:
+* @brief  Starts or stops a read of the history. 01 <from> <to> streams the
+*         blocks holding samples from..to (device seconds, uint32 little
+*         endian), 00 stops the read of the writer. Notifications must be
+*         enabled first, and only one peer reads at a time.
+*
+* @param conn_id      Connection ID of the writer, or of the bearer it wrote on
+*
+* @param p_write_req  Pointer to Bluetooth LE GATT write request
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_svc_hist_write(uint16_t conn_id,
+                                                    wiced_bt_gatt_write_req_t *p_write_req)
+{
+    app_bt_svc_hist_stream_t *p_stream = &app_bt_svc_hist_stream;
+    const uint8_t *p_val = p_write_req->p_val;
+    uint32_t t_from;
+    uint32_t t_to;
+    uint16_t mtu;
+
+    if (HDLC_HISTORY_BATTERY_HISTORY_VALUE != p_write_req->handle)
+    {
+        return WICED_BT_GATT_WRITE_NOT_PERMIT;
+    }
+
+    if ((1u == p_write_req->val_len) && (APP_BT_SVC_HIST_CMD_STOP == p_val[0]))
+    {
+        if (p_stream->active && (app_bt_bearer_conn_id(conn_id) == p_stream->conn_id))
+        {
+            app_bt_svc_hist_stop();
+        }
+        return WICED_BT_GATT_SUCCESS;
+    }
+    if ((APP_BT_SVC_HIST_CMD_READ_LEN != p_write_req->val_len) ||
+        (APP_BT_SVC_HIST_CMD_READ != p_val[0]))
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+    if (0u == (app_bt_conn_cccd_value(conn_id, APP_BT_CCCD_HISTORY) &
+               GATT_CLIENT_CONFIG_NOTIFICATION))
+    {
+        return WICED_BT_GATT_CCC_CFG_ERR;
+    }
+    /* Buffers of the previous read must have come back too */
+    if (p_stream->active || (0u != p_stream->in_flight))
+    {
+        return WICED_BT_GATT_PRC_IN_PROGRESS;
+    }
+
+    t_from = (uint32_t)p_val[1] | ((uint32_t)p_val[2] << 8) |
+             ((uint32_t)p_val[3] << 16) | ((uint32_t)p_val[4] << 24);
+    t_to = (uint32_t)p_val[5] | ((uint32_t)p_val[6] << 8) |
+           ((uint32_t)p_val[7] << 16) | ((uint32_t)p_val[8] << 24);
+    if (t_from > t_to)
+    {
+        return WICED_BT_GATT_OUT_OF_RANGE;
+    }
+
+    memset(p_stream, 0, offsetof(app_bt_svc_hist_stream_t, block));
+    if (!app_bas_hist_range(t_from, &p_stream->seq, &p_stream->end_seq))
+    {
+        return WICED_BT_GATT_WRONG_STATE;
+    }
+    p_stream->conn_id = app_bt_bearer_conn_id(conn_id);
+    p_stream->bearer_id = app_bt_bearer_for_traffic(conn_id,
+                              app_bt_bearer_traffic_of_handle(HDLC_HISTORY_BATTERY_HISTORY_VALUE));
+    mtu = app_bt_bearer_mtu(p_stream->bearer_id);
+    p_stream->frame_len = mtu - APP_BT_SVC_HIST_ATT_HDR_LEN;
+    p_stream->t_from = t_from;
+    p_stream->t_to = t_to;
+    p_stream->active = true;
+
+    APP_LOG_INFO("History read %lu..%lu, blocks %lu to %lu, %d byte frames\r\n",
+                 (unsigned long)t_from, (unsigned long)t_to, (unsigned long)p_stream->seq,
+                 (unsigned long)p_stream->end_seq, p_stream->frame_len);
+    app_bt_svc_hist_pump();
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,659 @@
+/*******************************************************************************
+ * File Name: app_bt_svc_ota.c
+ *
+ * Description: This file implements the GATT handlers of the OTA
+ *              firmware upgrade service: the control point commands and the image
+ *              data writes.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <stdio.h>
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "wiced_bt_stack.h"
+#include "cy_ota_api.h"
+#include "app_ota_context.h"
+#include "app_ota_telemetry.h"
+#include "app_ota_storage.h"
+#include "app_ota_l2cap.h"
+#include "app_bt_gatt_handler.h"
+#include "app_bt_gatt_queue.h"
+#include "app_bt_conn.h"
+#include "app_bt_link_ctrl.h"
+#include "app_bt_svc.h"
+#include "app_bt_svc_ota.h"
+#include "app_sched.h"
+#include "app_reboot.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_OTA
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Period of the download progress report while a download runs */
+#define APP_BT_SVC_OTA_PROGRESS_MS      (5000u)
+
+/* A download receiving no data for this long is reported stalled, and the
+ * progress report stops until the next PREPARE */
+#define APP_BT_SVC_OTA_STALL_MS         (30000u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* How the GATT task answers a command that ran in the storage task */
+typedef enum
+{
+    APP_BT_SVC_OTA_REPLY_NONE,
+    APP_BT_SVC_OTA_REPLY_NOTIFY,
+    APP_BT_SVC_OTA_REPLY_INDICATE,
+} app_bt_svc_ota_reply_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static wiced_bt_gatt_status_t app_bt_svc_ota_write(uint16_t conn_id,
+                                                   wiced_bt_gatt_write_req_t *p_write_req);
+static void app_bt_svc_ota_progress(void);
+static wiced_bt_gatt_status_t app_bt_svc_ota_defer(app_ota_storage_job_t job);
+static void app_bt_svc_ota_prepare(void);
+static void app_bt_svc_ota_verify(void);
+static void app_bt_svc_ota_abort(void);
+static void app_bt_svc_ota_done(app_bt_svc_ota_reply_t reply, uint8_t status);
+static bool app_bt_svc_ota_aborted(void);
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const app_bt_svc_t app_bt_svc_ota =
+{
+    .name           = "OTA",
+    .start_handle   = HDLS_OTA_FW_UPGRADE_SERVICE,
+    .end_handle     = HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_DATA_VALUE,
+    .read           = NULL,
+    .write          = app_bt_svc_ota_write,
+    .cccd           = NULL,
+};
+
+/* Image size announced by the DOWNLOAD command */
+static uint32_t app_bt_svc_ota_total;
+
+/* CRC of the image announced by the VERIFY command */
+static uint32_t app_bt_svc_ota_crc;
+
+/* Set while a PREPARE, VERIFY or ABORT command runs in the storage task,
+ * until the GATT task has queued its answer */
+static volatile bool app_bt_svc_ota_busy;
+
+/* Answer of the last command, set before APP_BT_GATT_QUEUE_EVT_OTA */
+static app_bt_svc_ota_reply_t app_bt_svc_ota_reply_kind;
+static uint8_t app_bt_svc_ota_reply_status;
+
+/* ABORT written by the owner while a command runs in the storage task */
+static volatile bool app_bt_svc_ota_abort_req;
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bt_svc_ota_register
+*
+* Function Description:
+* @brief  Registers the OTA service with the GATT dispatch
+*
+* @return void
+*/
+void app_bt_svc_ota_register(void)
+{
+    if (WICED_BT_GATT_SUCCESS != app_bt_svc_register(&app_bt_svc_ota))
+    {
+        APP_LOG_ERR("OTA service registration failed\r\n");
+        CY_ASSERT(0);
+    }
+    app_sched_register(APP_SCHED_EVT_OTA, app_bt_svc_ota_progress, APP_BT_SVC_OTA_PROGRESS_MS);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_progress
+*
+* Function Description:
+* @brief  Reports the progress of the download every
+*         APP_BT_SVC_OTA_PROGRESS_MS, runs in the application loop. The
+*         timer is started at PREPARE and stopped at VERIFY or ABORT, or
+*         here once no data came for APP_BT_SVC_OTA_STALL_MS, for example
+*         after the central went away.
+*
+* @return void
+*/
+static void app_bt_svc_ota_progress(void)
+{
+    static uint32_t last_bytes;
+    static uint32_t idle_ms;
+    app_ota_telemetry_t telemetry;
+
+    app_ota_telemetry_get(&telemetry);
+    if (telemetry.bytes < last_bytes)
+    {
+        /* A new session started */
+        last_bytes = 0;
+        idle_ms = 0;
+    }
+
+    if (telemetry.bytes != last_bytes)
+    {
+        APP_LOG_INFO("OTA %lu of %lu bytes, %lu B/s, %lu retries\r\n",
+                     (unsigned long)telemetry.bytes, (unsigned long)app_bt_svc_ota_total,
+                     (unsigned long)(((telemetry.bytes - last_bytes) * 1000u) /
+                                     APP_BT_SVC_OTA_PROGRESS_MS),
+                     (unsigned long)telemetry.retries);
+        idle_ms = 0;
+    }
+    else
+    {
+        idle_ms += APP_BT_SVC_OTA_PROGRESS_MS;
+        if (idle_ms >= APP_BT_SVC_OTA_STALL_MS)
+        {
+            APP_LOG_WARNING("OTA stalled at %lu of %lu bytes\r\n",
+                            (unsigned long)telemetry.bytes,
+                            (unsigned long)app_bt_svc_ota_total);
+            app_sched_periodic(APP_SCHED_EVT_OTA, false);
+            idle_ms = 0;
+        }
+    }
+    last_bytes = telemetry.bytes;
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_defer
+*
+* Function Description:
+* @brief  Hands a control point command to the OTA storage task. The write
+*         is acknowledged at once, the job reports its result through the
+*         control point.
+*
+* @param job      Command to run
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status of the write
+*/
+static wiced_bt_gatt_status_t app_bt_svc_ota_defer(app_ota_storage_job_t job)
+{
+    app_bt_svc_ota_abort_req = false;
+    app_bt_svc_ota_busy = true;
+    if (CY_RSLT_SUCCESS != app_ota_storage_run(job))
+    {
+        app_bt_svc_ota_busy = false;
+        APP_LOG_ERR("OTA command not queued\n");
+        return WICED_BT_GATT_ERROR;
+    }
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_prepare
+*
+* Function Description:
+* @brief  Runs the PREPARE command in the OTA storage task, once the storage
+*         bring-up has ended and the L2CAP writer is idle, and notifies its
+*         status on the control point
+*
+* @return void
+*/
+static void app_bt_svc_ota_prepare(void)
+{
+    cy_rslt_t result;
+    uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_BAD;
+    app_bt_svc_ota_reply_t reply = APP_BT_SVC_OTA_REPLY_NOTIFY;
+    bool paused = app_ota_l2cap_pause();
+
+    result = app_ota_storage_wait(0);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        APP_LOG_ERR("OTA storage unavailable - result: 0x%lx\n", result);
+    }
+    else if (!paused || app_bt_svc_ota_abort_req)
+    {
+        result = CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    else
+    {
+        /* The next image is validated at its first boot */
+        app_ota_storage_forget();
+        ota_app.connection_type = CY_OTA_CONNECTION_BLE;
+        result = init_ota(&ota_app);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            APP_LOG_ERR("init_ota() Failed - result: 0x%lx\n", result);
+        }
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        APP_LOG_INFO("Preparing to download the image \r\n");
+        /* Logging cost is reported per download at VERIFY, telemetry
+         * describes the latest session */
+        app_log_cpu_stats_reset();
+        app_ota_telemetry_start();
+        APP_LOG_INFO("OTA link: MTU %d (chunk %d), LL tx %d octets, PHY tx %d rx %d \r\n",
+               ota_app.bt_mtu, ota_app.bt_mtu - 3, ota_app.bt_tx_octets,
+               ota_app.bt_tx_phy, ota_app.bt_rx_phy);
+        result = cy_ota_ble_download_prepare(ota_app.ota_context);
+        if (result == CY_RSLT_SUCCESS)
+        {
+            app_bt_svc_ota_total = 0;
+            app_sched_periodic(APP_SCHED_EVT_OTA, true);
+            APP_LOG_INFO("\ncy_ota_ble_download_prepare completed, Sending notification");
+            bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
+        }
+        else
+        {
+            APP_LOG_ERR("cy_ota_ble_prepare_download() Failed - result: 0x%lx\n", result);
+        }
+    }
+    if (paused)
+    {
+        if (app_bt_svc_ota_aborted())
+        {
+            reply = APP_BT_SVC_OTA_REPLY_NONE;
+        }
+        app_ota_l2cap_resume();
+    }
+    app_bt_svc_ota_done(reply, bt_notify_buff);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_verify
+*
+* Function Description:
+* @brief  Runs the VERIFY command in the OTA storage task, once the SDUs
+*         received on the L2CAP channel are written, and indicates its
+*         status on the control point. The confirmation of the indication
+*         reboots into the new image.
+*
+* @return void
+*/
+static void app_bt_svc_ota_verify(void)
+{
+    cy_rslt_t result = CY_RSLT_OTA_ERROR_GENERAL;
+    bool crc_or_sig_verify = true;
+    app_log_cpu_stats_t log_stats;
+    app_ota_telemetry_t telemetry;
+    uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_BAD;
+    app_bt_svc_ota_reply_t reply = APP_BT_SVC_OTA_REPLY_INDICATE;
+
+    if (app_ota_l2cap_pause())
+    {
+        if (!app_bt_svc_ota_abort_req)
+        {
+            result = cy_ota_ble_download_verify(ota_app.ota_context, app_bt_svc_ota_crc, crc_or_sig_verify);
+        }
+        if (app_bt_svc_ota_aborted())
+        {
+            reply = APP_BT_SVC_OTA_REPLY_NONE;
+            result = CY_RSLT_OTA_ERROR_GENERAL;
+        }
+        app_ota_l2cap_resume();
+    }
+    app_ota_telemetry_stop();
+    app_sched_periodic(APP_SCHED_EVT_OTA, false);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        APP_LOG_INFO("\ncy_ota_ble_download_verify completed, Sending notification");
+        app_log_cpu_stats(&log_stats);
+        APP_LOG_NOTICE("OTA logging CPU time: callers %lu us, log task %lu us\r\n",
+                       (unsigned long)log_stats.caller_us,
+                       (unsigned long)log_stats.task_us);
+        app_ota_telemetry_get(&telemetry);
+        APP_LOG_NOTICE("OTA throughput: GATT %lu B/s, L2CAP %lu B/s, session %lu ms\r\n",
+                       (unsigned long)telemetry.rate[APP_OTA_TELEMETRY_GATT],
+                       (unsigned long)telemetry.rate[APP_OTA_TELEMETRY_L2CAP],
+                       (unsigned long)telemetry.session_ms);
+        bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
+    }
+    else if (APP_BT_SVC_OTA_REPLY_NONE != reply)
+    {
+        APP_LOG_ERR("cy_ota_ble_download_verify() Failed - result: 0x%lx\n", result);
+    }
+    app_bt_svc_ota_done(reply, bt_notify_buff);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_abort
+*
+* Function Description:
+* @brief  Runs the ABORT command in the OTA storage task, after the SDUs
+*         received on the L2CAP channel are written
+*
+* @return void
+*/
+static void app_bt_svc_ota_abort(void)
+{
+    if (app_ota_l2cap_pause())
+    {
+        (void)cy_ota_ble_download_abort(ota_app.ota_context);
+        app_ota_l2cap_resume();
+    }
+    app_sched_periodic(APP_SCHED_EVT_OTA, false);
+    app_bt_svc_ota_done(APP_BT_SVC_OTA_REPLY_NONE, 0);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_aborted
+*
+* Function Description:
+* @brief  Runs an ABORT the owner wrote while a PREPARE or VERIFY was in the
+*         storage task. Called by these commands, with the L2CAP writer
+*         paused.
+*
+* @return bool    true if the command was aborted and must not answer
+*/
+static bool app_bt_svc_ota_aborted(void)
+{
+    if (!app_bt_svc_ota_abort_req)
+    {
+        return false;
+    }
+    APP_LOG_INFO("OTA aborted by the central\n");
+    (void)cy_ota_ble_download_abort(ota_app.ota_context);
+    app_sched_periodic(APP_SCHED_EVT_OTA, false);
+    return true;
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_done
+*
+* Function Description:
+* @brief  Ends a command in the OTA storage task. The GATT task sends the
+*         answer, the storage task does not call the stack.
+*
+* @param reply    How the command is answered
+*
+* @param status   CY_OTA_UPGRADE_STATUS_OK or CY_OTA_UPGRADE_STATUS_BAD
+*
+* @return void
+*/
+static void app_bt_svc_ota_done(app_bt_svc_ota_reply_t reply, uint8_t status)
+{
+    app_bt_svc_ota_reply_kind = reply;
+    app_bt_svc_ota_reply_status = status;
+    app_bt_gatt_queue_signal(APP_BT_GATT_QUEUE_EVT_OTA);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_reply
+*
+* Function Description:
+* @brief  Sends the status of the PREPARE or VERIFY that ended on the
+*         control point, and takes commands again. Runs in the GATT task
+*         on APP_BT_GATT_QUEUE_EVT_OTA.
+*
+* @return void
+*/
+void app_bt_svc_ota_reply(void)
+{
+    uint8_t status = app_bt_svc_ota_reply_status;
+
+    if (APP_BT_SVC_OTA_REPLY_NOTIFY == app_bt_svc_ota_reply_kind)
+    {
+        if (app_bt_ble_send_response(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE,
+                                     1, &status) != WICED_BT_GATT_SUCCESS)
+        {
+            APP_LOG_ERR("\nApplication BT Send notification callback failed\n");
+        }
+    }
+    else if (APP_BT_SVC_OTA_REPLY_INDICATE == app_bt_svc_ota_reply_kind)
+    {
+        if (app_bt_ble_send_indication(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE,
+                                       1, &status) != WICED_BT_GATT_SUCCESS)
+        {
+            APP_LOG_ERR("\nApplication BT Send Indication callback failed\n");
+        }
+    }
+    /* A session that failed to start, or was aborted, is closed */
+    if ((APP_BT_SVC_OTA_REPLY_NONE == app_bt_svc_ota_reply_kind) ||
+        ((APP_BT_SVC_OTA_REPLY_NOTIFY == app_bt_svc_ota_reply_kind) &&
+         (CY_OTA_UPGRADE_STATUS_OK != status)))
+    {
+        ota_app.bt_conn_id = 0;
+    }
+    /* Cleared once the answer is queued: the next command may arrive as
+     * soon as it is sent */
+    app_bt_svc_ota_busy = false;
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_write
+*
+* Function Description:
+* @brief  Handles writes to the OTA control point and to the OTA data
+*         characteristic
+*
+* @param conn_id      Connection ID of the writer
+*
+* @param p_write_req  Pointer to Bluetooth LE GATT write request
+*
+* @return wiced_bt_gatt_status_t  Bluetooth LE GATT status
+*/
+static wiced_bt_gatt_status_t app_bt_svc_ota_write(uint16_t conn_id,
+                                                   wiced_bt_gatt_write_req_t *p_write_req)
+{
+    cy_rslt_t result;
+    wiced_bt_gatt_status_t gatt_status = WICED_BT_GATT_SUCCESS;
+    uint32_t total_size = 0;
+    app_bt_conn_t *p_conn = NULL;
+
+    switch (p_write_req->handle)
+    {
+    case HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE:
+        /* PREPARE and VERIFY answer through the control point once they
+         * are done. Until then only an ABORT from the owner is taken, the
+         * command checks for it. */
+        p_conn = app_bt_conn_find(conn_id);
+        if (app_bt_svc_ota_busy)
+        {
+            gatt_status = WICED_BT_GATT_PRC_IN_PROGRESS;
+            if ((CY_OTA_UPGRADE_COMMAND_ABORT == p_write_req->p_val[0]) && (NULL != p_conn) &&
+                (p_conn->conn_id == ota_app.bt_conn_id))
+            {
+                app_bt_svc_ota_abort_req = true;
+                gatt_status = WICED_BT_GATT_SUCCESS;
+            }
+            break;
+        }
+        /* The central that started the session drives it alone. Others
+         * may only PREPARE once no session is open. */
+        if ((NULL == p_conn) ||
+            ((p_conn->conn_id != ota_app.bt_conn_id) &&
+             ((0u != ota_app.bt_conn_id) ||
+              (CY_OTA_UPGRADE_COMMAND_PREPARE_DOWNLOAD != p_write_req->p_val[0]))))
+        {
+            gatt_status = WICED_BT_GATT_PRC_IN_PROGRESS;
+            break;
+        }
+        switch (p_write_req->p_val[0])
+        {
+        case CY_OTA_UPGRADE_COMMAND_PREPARE_DOWNLOAD:
+            /* Control point status goes back to the central driving the
+             * OTA. The link is recorded, the bearer is picked per PDU. */
+            ota_app.bt_conn_id = p_conn->conn_id;
+            memcpy(ota_app.bt_peer_addr, p_conn->peer_addr, BD_ADDR_LEN);
+            app_bt_ota_link_update(conn_id);
+            /* Move to the shortest interval before the image starts */
+            app_bt_link_ctrl_activity(conn_id, APP_BT_LINK_ACT_OTA_START);
+            gatt_status = app_bt_svc_ota_defer(app_bt_svc_ota_prepare);
+            if (WICED_BT_GATT_SUCCESS != gatt_status)
+            {
+                ota_app.bt_conn_id = 0;
+            }
+            break;
+
+        case CY_OTA_UPGRADE_COMMAND_DOWNLOAD:
+            if (p_write_req->val_len < 4)
+            {
+                APP_LOG_ERR("CY_OTA_UPGRADE_COMMAND_DOWNLOAD len < 4\n");
+                gatt_status = WICED_BT_GATT_ERROR;
+                break;
+            }
+
+            total_size = (((uint32_t)p_write_req->p_val[4]) << 24) +
+                (((uint32_t)p_write_req->p_val[3]) << 16) +
+                (((uint32_t)p_write_req->p_val[2]) << 8) +
+                (((uint32_t)p_write_req->p_val[1]) << 0);
+
+            result = cy_ota_ble_download(ota_app.ota_context, total_size);
+            if (result == CY_RSLT_SUCCESS)
+            {
+                app_bt_svc_ota_total = total_size;
+                APP_LOG_INFO("\ncy_ota_ble_download completed, Sending notification");
+                uint8_t bt_notify_buff = CY_OTA_UPGRADE_STATUS_OK;
+                gatt_status = app_bt_ble_send_response(ota_app.bt_conn_id, HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_CONTROL_POINT_VALUE, 1, &bt_notify_buff);
+                if (gatt_status != WICED_BT_GATT_SUCCESS)
+                {
+                    APP_LOG_ERR("\nApplication BT Send notification callback failed: 0x%lx\n", result);
+                    break;
+                }
+            }
+            else
+            {
+                APP_LOG_ERR("cy_ota_ble_download() Failed - result: 0x%lx\n", result);
+                gatt_status = WICED_BT_GATT_ERROR;
+            }
+
+            break;
+
+        case CY_OTA_UPGRADE_COMMAND_VERIFY:
+            if (p_write_req->val_len != 5)
+            {
+                APP_LOG_ERR("CY_OTA_UPGRADE_COMMAND_VERIFY len != 5\n");
+                gatt_status = WICED_BT_GATT_ERROR;
+                break;
+            }
+
+            app_bt_svc_ota_crc = (((uint32_t)p_write_req->p_val[1]) << 0) +
+                (((uint32_t)p_write_req->p_val[2]) << 8) +
+                (((uint32_t)p_write_req->p_val[3]) << 16) +
+                (((uint32_t)p_write_req->p_val[4]) << 24);
+            APP_LOG_INFO("\nFinal CRC from Host : 0x%lx\n", app_bt_svc_ota_crc);
+            gatt_status = app_bt_svc_ota_defer(app_bt_svc_ota_verify);
+            break;
+
+        case CY_OTA_UPGRADE_COMMAND_ABORT:
+            gatt_status = app_bt_svc_ota_defer(app_bt_svc_ota_abort);
+            break;
+        }
+        break;
+
+    case HDLC_OTA_FW_UPGRADE_SERVICE_OTA_UPGRADE_DATA_VALUE:
+        /* The storage task uses the context while a command runs, and only
+         * the owner of the session sends the image */
+        p_conn = app_bt_conn_find(conn_id);
+        if (app_bt_svc_ota_busy || (NULL == p_conn) || (p_conn->conn_id != ota_app.bt_conn_id))
+        {
+            gatt_status = WICED_BT_GATT_PRC_IN_PROGRESS;
+            break;
+        }
+        /*Call OTA write handler to handle OTA related writes*/
+        APP_LOG_DEBUG("application downloading... \r\n");
+        app_bt_link_ctrl_activity(conn_id, APP_BT_LINK_ACT_OTA_DATA);
+        app_ota_telemetry_chunk(APP_OTA_TELEMETRY_GATT, p_write_req->val_len);
+        result = cy_ota_ble_download_write(ota_app.ota_context, p_write_req->p_val, p_write_req->val_len, p_write_req->offset);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            app_ota_telemetry_retry();
+            gatt_status = WICED_BT_GATT_ERROR;
+            break;
+        }
+        gatt_status = WICED_BT_GATT_SUCCESS;
+        break;
+
+    default:
+        /* Other OTA attributes are plain database values */
+        return app_bt_set_value(p_write_req->handle,
+            p_write_req->p_val,
+            p_write_req->val_len);
+    }
+    return (gatt_status);
+}
+
+/**
+* Function Name:
+* app_bt_svc_ota_value_conf
+*
+* Function Description:
+* @brief  Handles the confirmation of the control point indication sent at
+*         the end of VERIFY. Starts the reboot into the new image when the
+*         download completed, stops the OTA agent otherwise. Only the
+*         central driving the OTA can confirm.
+*
+* @param conn_id      Connection ID that confirmed
+*
+* @return void
+*/
+void app_bt_svc_ota_value_conf(uint16_t conn_id)
+{
+    cy_ota_agent_state_t ota_lib_state;
+    app_bt_conn_t *p_conn = app_bt_conn_find(conn_id);
+
+    if ((NULL == p_conn) || (0u == ota_app.bt_conn_id) ||
+        (p_conn->conn_id != ota_app.bt_conn_id))
+    {
+        return;
+    }
+
+    cy_ota_get_state(ota_app.ota_context, &ota_lib_state);
+    if ((ota_lib_state == CY_OTA_STATE_OTA_COMPLETE) && /* Check if we completed the download before rebooting */
+        (ota_app.reboot_at_end != 0))
+    {
+        app_reboot_request(APP_REBOOT_CAUSE_OTA);
+    }
+    else
+    {
+        cy_ota_agent_stop(&ota_app.ota_context); /* Stop OTA */
+        ota_app.bt_conn_id = 0;
+    }
+}
+
+/* [] END OF FILE */
@@ -45,6 +45,8 @@
  ******************************************************************************/
 #include "app_bt_utils.h"
 #include "wiced_bt_dev.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BT
+#include "app_log.h"
 
 /****************************************************************************
  *                              FUNCTION DEFINITIONS
@@ -63,7 +65,7 @@
 */
 void print_bd_address(wiced_bt_device_address_t bdadr)
 {
-    printf("%02X:%02X:%02X:%02X:%02X:%02X\n",bdadr[0],bdadr[1],bdadr[2],bdadr[3],bdadr[4],bdadr[5]);
+    APP_LOG_INFO("%02X:%02X:%02X:%02X:%02X:%02X\n",bdadr[0],bdadr[1],bdadr[2],bdadr[3],bdadr[4],bdadr[5]);
 }
 
 /**
@@ -249,5 +251,36 @@ const char *get_bt_gatt_status_name(wiced_bt_gatt_status_t status)
     return "UNKNOWN_STATUS";
 }
 
+/**
+* Function Name
+* get_bt_gatt_event_name
+*
+* Function Description:
+* @brief    The function converts the wiced_bt_gatt_evt_t enum value to its corresponding
+*           string literal. This will help the programmer to debug easily with log traces
+*           without navigating through the source code.
+*
+* @param  wiced_bt_gatt_evt_t event: GATT event type
+*
+* @return  const char*
+*
+*/
+const char *get_bt_gatt_event_name(wiced_bt_gatt_evt_t event)
+{
+    switch ( (int)event )
+    {
+    CASE_RETURN_STR(GATT_CONNECTION_STATUS_EVT)
+    CASE_RETURN_STR(GATT_OPERATION_CPLT_EVT)
+    CASE_RETURN_STR(GATT_DISCOVERY_RESULT_EVT)
+    CASE_RETURN_STR(GATT_DISCOVERY_CPLT_EVT)
+    CASE_RETURN_STR(GATT_ATTRIBUTE_REQUEST_EVT)
+    CASE_RETURN_STR(GATT_CONGESTION_EVT)
+    CASE_RETURN_STR(GATT_GET_RESPONSE_BUFFER_EVT)
+    CASE_RETURN_STR(GATT_APP_BUFFER_TRANSMITTED_EVT)
+    }
+
+    return "UNKNOWN_EVENT";
+}
+
 
 /* [] END OF FILE */
@@ -71,10 +71,13 @@ typedef struct
 
 #ifdef COMPONENT_OTA_BLUETOOTH
 
-    uint16_t                    bt_conn_id;                 /* Host Bluetooth® Connection ID */
-    uint8_t                     bt_peer_addr[BD_ADDR_LEN];  /* Host Bluetooth® address */
+    uint16_t                    bt_conn_id;                 /* Connection ID of the Host driving the OTA */
+    uint8_t                     bt_peer_addr[BD_ADDR_LEN];  /* Bluetooth® address of the Host driving the OTA */
     wiced_bt_ble_conn_params_t  bt_conn_params;             /* Bluetooth® connection parameters */
-    uint16_t                    bt_config_descriptor;       /* Bluetooth® configuration to determine if Device sends Notification/Indication */
+    uint16_t                    bt_mtu;                     /* ATT MTU, data chunks are bt_mtu - 3 bytes */
+    uint16_t                    bt_tx_octets;               /* LL max TX payload after data length update */
+    uint8_t                     bt_tx_phy;                  /* TX PHY of the OTA link */
+    uint8_t                     bt_rx_phy;                  /* RX PHY of the OTA link */
 #endif
     uint8_t                 connected;
     cy_ota_update_flow_t    update_flow;
@@ -48,6 +48,8 @@
 #include "stdio.h"
 #include "cy_ota_storage_api.h"
 #include "cyabs_rtos.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_OTA
+#include "app_log.h"
 
 ota_app_context_t ota_app;
 
@@ -95,9 +97,9 @@ cy_rslt_t cy_ota_ble_check_build_vs_configurator( void )
     /* Check UUID for non-secure Bluetooth� upgrade service */
     if (0 != memcmp(NON_SECURE_UUID_SERVICE_OTA_FW_UPGRADE_SERVICE, BLE_CONFIG_UUID_SERVICE_OTA_FW_UPGRADE_SERVICE, sizeof(NON_SECURE_UUID_SERVICE_OTA_FW_UPGRADE_SERVICE)))
     {
-        printf("    SECURE <appname>.cybt File does not match NON-SECURE APP build!\n");
-        printf( "      Change the <appname>.cybt File to use NON-SECURE OTA UUID.\n");
-        printf("        (Set 'GATT->Server->OTA FW UPGRADE SERVICE' to 'ae5d1e47-5c13-43a0-8635-82ad38a1381f')\n");
+        APP_LOG_ERR("    SECURE <appname>.cybt File does not match NON-SECURE APP build!\n");
+        APP_LOG_ERR("      Change the <appname>.cybt File to use NON-SECURE OTA UUID.\n");
+        APP_LOG_ERR("        (Set 'GATT->Server->OTA FW UPGRADE SERVICE' to 'ae5d1e47-5c13-43a0-8635-82ad38a1381f')\n");
         return CY_RSLT_OTA_ERROR_GENERAL;
     }
 #endif
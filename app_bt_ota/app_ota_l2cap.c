@@ -0,0 +1,332 @@
+/******************************************************************************
+* File Name:   app_ota_l2cap.c
+*
+* Description: OTA image data over an LE credit based L2CAP channel. SDUs are
+*              queued for a writer task which feeds
+*              cy_ota_ble_download_write(), and credits are only returned to
+*              the peer when a queue slot is free again.
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include "cyhal.h"
+#include "wiced_bt_l2c.h"
+#include "app_ota_context.h"
+#include "app_ota_l2cap.h"
+#include "app_ota_telemetry.h"
+#include "app_monitor.h"
+#include "app_bt_link_ctrl.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_OTA
+#include "app_log.h"
+
+#if APP_OTA_L2CAP_SUPPORT
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+/* PDUs needed for one full SDU, the first one also carries the 2 byte SDU length */
+#define APP_OTA_L2CAP_CREDITS_PER_SDU   ((APP_OTA_L2CAP_SDU_SIZE + 2u + APP_OTA_L2CAP_MPS - 1u) / \
+                                          APP_OTA_L2CAP_MPS)
+
+#define APP_OTA_L2CAP_TASK_NAME         "OTA L2CAP"
+#define APP_OTA_L2CAP_TASK_STACK_SIZE   (1024u)
+#define APP_OTA_L2CAP_TASK_PRIORITY     (configMAX_PRIORITIES - 3)
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+typedef struct
+{
+    uint16_t    channel;    /* app_ota_l2cap_channel when the SDU arrived */
+    uint16_t    len;
+    uint8_t     data[APP_OTA_L2CAP_SDU_SIZE];
+} app_ota_l2cap_sdu_t;
+
+/******************************************************
+ *               Variables Definitions
+ ******************************************************/
+static app_ota_l2cap_sdu_t  app_ota_l2cap_sdu[APP_OTA_L2CAP_QUEUE_DEPTH];
+
+/* Indexes of free and filled SDU slots */
+static QueueHandle_t        app_ota_l2cap_free_q;
+static QueueHandle_t        app_ota_l2cap_full_q;
+
+/* Held by the writer for each SDU, and by the OTA commands between
+ * app_ota_l2cap_pause() and app_ota_l2cap_resume() */
+static SemaphoreHandle_t    app_ota_l2cap_lock;
+
+/* Local CID of the open channel, 0 when closed */
+static volatile uint16_t    app_ota_l2cap_lcid;
+/* Counts accepted channels, tells SDUs of an earlier channel apart */
+static volatile uint16_t    app_ota_l2cap_channel;
+static uint32_t             app_ota_l2cap_bytes;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/* Peer opens the channel: accept one channel at a time and grant exactly the
+ * credits the free SDU slots can absorb. Slots still held by the writer for
+ * an earlier channel are not counted, the writer credits them when it frees
+ * them. The slot queues are never reset, the writer may own a slot. */
+static void app_ota_l2cap_connect_ind_cb(void *context, wiced_bt_device_address_t bd_addr,
+                                         uint16_t local_cid, uint16_t psm, uint8_t id,
+                                         uint16_t mtu_peer)
+{
+    uint16_t result = L2CAP_LE_RESULT_CONN_OK;
+    uint16_t credits = 0;
+
+    (void)context;
+    (void)psm;
+    (void)mtu_peer;
+
+    taskENTER_CRITICAL();
+    if (0 != app_ota_l2cap_lcid)
+    {
+        result = L2CAP_LE_RESULT_NO_RESOURCES;
+    }
+    else
+    {
+        app_ota_l2cap_lcid = local_cid;
+        app_ota_l2cap_channel++;
+        app_ota_l2cap_bytes = 0;
+        credits = (uint16_t)(uxQueueMessagesWaiting(app_ota_l2cap_free_q) *
+                             APP_OTA_L2CAP_CREDITS_PER_SDU);
+    }
+    taskEXIT_CRITICAL();
+
+    APP_LOG_INFO("OTA L2CAP channel 0x%x %s\n", local_cid,
+           (L2CAP_LE_RESULT_CONN_OK == result) ? "accepted" : "rejected");
+    wiced_bt_l2cap_le_connect_rsp(bd_addr, id, local_cid, result, APP_OTA_L2CAP_SDU_SIZE,
+                                  credits);
+}
+
+static void app_ota_l2cap_disconnect_ind_cb(void *context, uint16_t local_cid, wiced_bool_t ack)
+{
+    (void)context;
+
+    if (local_cid == app_ota_l2cap_lcid)
+    {
+        APP_LOG_INFO("OTA L2CAP channel closed, %lu bytes received\n", app_ota_l2cap_bytes);
+        app_ota_l2cap_lcid = 0;
+    }
+    if (ack)
+    {
+        wiced_bt_l2cap_le_disconnect_rsp(local_cid);
+    }
+}
+
+static void app_ota_l2cap_disconnect_cfm_cb(void *context, uint16_t local_cid, uint16_t result)
+{
+    (void)context;
+    (void)result;
+
+    if (local_cid == app_ota_l2cap_lcid)
+    {
+        app_ota_l2cap_lcid = 0;
+    }
+}
+
+/* Runs in the Bluetooth stack task: only copy the SDU, the flash write is
+ * done by the writer task */
+static void app_ota_l2cap_data_ind_cb(void *context, uint16_t local_cid, uint8_t *p_data,
+                                      uint16_t len)
+{
+    uint8_t slot;
+
+    (void)context;
+
+    if ((local_cid != app_ota_l2cap_lcid) || (len > APP_OTA_L2CAP_SDU_SIZE))
+    {
+        return;
+    }
+
+    /* The peer only has credits for free slots, so no slot means it
+     * ignored flow control */
+    if (pdTRUE != xQueueReceive(app_ota_l2cap_free_q, &slot, 0))
+    {
+        APP_LOG_WARNING("OTA L2CAP overrun, closing channel\n");
+        wiced_bt_l2cap_le_disconnect_req(local_cid);
+        return;
+    }
+
+    app_ota_telemetry_chunk(APP_OTA_TELEMETRY_L2CAP, len);
+    memcpy(app_ota_l2cap_sdu[slot].data, p_data, len);
+    app_ota_l2cap_sdu[slot].channel = app_ota_l2cap_channel;
+    app_ota_l2cap_sdu[slot].len = len;
+    xQueueSend(app_ota_l2cap_full_q, &slot, 0);
+}
+
+static void app_ota_l2cap_writer_task(void *arg)
+{
+    uint8_t slot;
+    uint16_t lcid;
+    bool current;
+    cy_rslt_t result;
+
+    (void)arg;
+
+    while (true)
+    {
+        xQueueReceive(app_ota_l2cap_full_q, &slot, portMAX_DELAY);
+
+        /* SDUs left over from an earlier channel are dropped */
+        result = CY_RSLT_SUCCESS;
+        xSemaphoreTake(app_ota_l2cap_lock, portMAX_DELAY);
+        if (app_ota_l2cap_sdu[slot].channel == app_ota_l2cap_channel)
+        {
+            result = cy_ota_ble_download_write(ota_app.ota_context, app_ota_l2cap_sdu[slot].data,
+                                               app_ota_l2cap_sdu[slot].len, 0);
+            if (CY_RSLT_SUCCESS == result)
+            {
+                app_ota_l2cap_bytes += app_ota_l2cap_sdu[slot].len;
+                app_bt_link_ctrl_activity(ota_app.bt_conn_id, APP_BT_LINK_ACT_OTA_DATA);
+            }
+        }
+        xSemaphoreGive(app_ota_l2cap_lock);
+
+        /* Free the slot and read the channel together, so that the slot is
+         * credited either by connect_ind_cb or here, never both */
+        taskENTER_CRITICAL();
+        xQueueSend(app_ota_l2cap_free_q, &slot, 0);
+        lcid = app_ota_l2cap_lcid;
+        current = (app_ota_l2cap_sdu[slot].channel == app_ota_l2cap_channel);
+        taskEXIT_CRITICAL();
+
+        if (0 == lcid)
+        {
+            continue;
+        }
+        if ((CY_RSLT_SUCCESS != result) && current)
+        {
+            app_ota_telemetry_retry();
+            APP_LOG_ERR("cy_ota_ble_download_write() Failed - result: 0x%lx\n", result);
+            wiced_bt_l2cap_le_disconnect_req(lcid);
+            continue;
+        }
+
+        /* The slot is free again, let the peer send the next SDU */
+        wiced_bt_l2cap_le_send_flow_control_credit(lcid, APP_OTA_L2CAP_CREDITS_PER_SDU);
+    }
+}
+
+/* Waits until every SDU received has been written, then keeps the writer
+ * off the OTA context until app_ota_l2cap_resume(). A slot is only back in
+ * the free queue once its SDU is written. Called by the OTA commands that
+ * set up, verify or abort the context. */
+bool app_ota_l2cap_pause(void)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (true)
+    {
+        if (pdTRUE != xSemaphoreTake(app_ota_l2cap_lock, pdMS_TO_TICKS(APP_OTA_L2CAP_PAUSE_MS)))
+        {
+            break;
+        }
+        if (APP_OTA_L2CAP_QUEUE_DEPTH == uxQueueMessagesWaiting(app_ota_l2cap_free_q))
+        {
+            return true;
+        }
+        xSemaphoreGive(app_ota_l2cap_lock);
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(APP_OTA_L2CAP_PAUSE_MS))
+        {
+            break;
+        }
+        vTaskDelay(1);
+    }
+    APP_LOG_ERR("OTA L2CAP writer still busy after %d ms\n", APP_OTA_L2CAP_PAUSE_MS);
+    return false;
+}
+
+void app_ota_l2cap_resume(void)
+{
+    xSemaphoreGive(app_ota_l2cap_lock);
+}
+
+cy_rslt_t app_ota_l2cap_init(void)
+{
+    static wiced_bt_l2cap_le_appl_information_t l2cap_appl_info =
+    {
+        .le_connect_ind_cb      = app_ota_l2cap_connect_ind_cb,
+        .le_disconnect_ind_cb   = app_ota_l2cap_disconnect_ind_cb,
+        .le_disconnect_cfm_cb   = app_ota_l2cap_disconnect_cfm_cb,
+        .le_data_ind_cb         = app_ota_l2cap_data_ind_cb,
+        .le_mps                 = APP_OTA_L2CAP_MPS,
+    };
+
+    app_ota_l2cap_free_q = xQueueCreate(APP_OTA_L2CAP_QUEUE_DEPTH, sizeof(uint8_t));
+    app_ota_l2cap_full_q = xQueueCreate(APP_OTA_L2CAP_QUEUE_DEPTH, sizeof(uint8_t));
+    app_ota_l2cap_lock = xSemaphoreCreateMutex();
+    if ((NULL == app_ota_l2cap_free_q) || (NULL == app_ota_l2cap_full_q) ||
+        (NULL == app_ota_l2cap_lock))
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    for (uint8_t slot = 0; slot < APP_OTA_L2CAP_QUEUE_DEPTH; slot++)
+    {
+        xQueueSend(app_ota_l2cap_free_q, &slot, 0);
+    }
+
+    if (pdPASS != xTaskCreate(app_ota_l2cap_writer_task, APP_OTA_L2CAP_TASK_NAME,
+                              APP_OTA_L2CAP_TASK_STACK_SIZE, NULL,
+                              APP_OTA_L2CAP_TASK_PRIORITY, NULL))
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    app_monitor_task_size(APP_OTA_L2CAP_TASK_NAME, APP_OTA_L2CAP_TASK_STACK_SIZE);
+
+    if (0 == wiced_bt_l2cap_le_register(APP_OTA_L2CAP_PSM, &l2cap_appl_info, NULL))
+    {
+        APP_LOG_ERR("OTA L2CAP PSM 0x%x registration failed\n", APP_OTA_L2CAP_PSM);
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    APP_LOG_INFO("OTA L2CAP transport on PSM 0x%x, SDU %d bytes\n", APP_OTA_L2CAP_PSM,
+           APP_OTA_L2CAP_SDU_SIZE);
+    return CY_RSLT_SUCCESS;
+}
+
+#endif /* APP_OTA_L2CAP_SUPPORT */
@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name:   app_ota_l2cap.h
+*
+* Description: Interface of the LE credit based L2CAP channel used as an
+*              alternate transport for OTA image data
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+#ifndef APP_OTA_L2CAP_H_
+#define APP_OTA_L2CAP_H_
+
+#include <stdbool.h>
+#include "cy_result.h"
+#include "wiced_bt_types.h"
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+#ifndef APP_OTA_L2CAP_SUPPORT
+#define APP_OTA_L2CAP_SUPPORT           (0)
+#endif
+
+/* LE PSM the host connects to for OTA data (dynamic range 0x0080-0x00FF) */
+#define APP_OTA_L2CAP_PSM               (0x0085u)
+
+/* Largest SDU accepted, one SDU is handed to the OTA library at a time.
+ * L2capMtuSize in design.cybt must be at least this large. */
+#define APP_OTA_L2CAP_SDU_SIZE          (4096u)
+
+/* Largest L2CAP PDU payload, one credit covers one PDU */
+#define APP_OTA_L2CAP_MPS               (247u)
+
+/* SDUs that can wait for the flash writer. The peer never holds more
+ * credits than fit in the free slots of this queue. */
+#define APP_OTA_L2CAP_QUEUE_DEPTH       (2u)
+
+/* Longest wait of an OTA command for the SDUs already received to be
+ * written */
+#define APP_OTA_L2CAP_PAUSE_MS          (1000u)
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+#if APP_OTA_L2CAP_SUPPORT
+cy_rslt_t app_ota_l2cap_init(void);
+bool app_ota_l2cap_pause(void);
+void app_ota_l2cap_resume(void);
+#else
+/* No writer to wait for */
+static inline bool app_ota_l2cap_pause(void) { return true; }
+static inline void app_ota_l2cap_resume(void) { }
+#endif
+
+#endif /* APP_OTA_L2CAP_H_ */
@@ -0,0 +1,369 @@
+/******************************************************************************
+* File Name:   app_ota_storage.c
+*
+* Description: Bring-up of the OTA storage in its own task:
+*              cy_ota_storage_init() and cy_ota_storage_image_validate() run
+*              while the Bluetooth controller starts. OTA control point
+*              commands wait for the result.
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <event_groups.h>
+#include "cy_ota_api.h"
+#include "cy_ota_storage_api.h"
+#include "cy_ota_flash.h"
+#include "cy_device_headers.h"
+#include "app_ota_storage.h"
+#include "app_boot_time.h"
+#include "app_monitor.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_OTA
+#include "app_log.h"
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+#define APP_OTA_STORAGE_TASK_NAME       "OTA Storage"
+#define APP_OTA_STORAGE_TASK_STACK_SIZE (1024u)
+/* Below the Bluetooth stack and the application tasks, so that advertising
+ * comes first and the link stays served during long OTA jobs */
+#define APP_OTA_STORAGE_TASK_PRIORITY   (tskIDLE_PRIORITY + 1)
+
+/* Jobs waiting for the task: an OTA control point command, and the log
+ * level and bond store writes, each queued once at most */
+#define APP_OTA_STORAGE_JOB_DEPTH       (4u)
+
+#define APP_OTA_STORAGE_READY_BIT       (1u << 0)
+#define APP_OTA_STORAGE_IDLE_BIT        (1u << 1)
+
+/* MCUboot image header and TLV area, see bootutil/image.h */
+#define APP_OTA_IMAGE_MAGIC             (0x96f3b83du)
+#define APP_OTA_IMAGE_TLV_INFO_MAGIC    (0x6907u)
+#define APP_OTA_IMAGE_TLV_SHA256        (0x10u)
+#define APP_OTA_IMAGE_SHA256_SIZE       (32u)
+
+#define APP_OTA_CONFIRM_MAGIC           (0x4F544143u)   /* "OTAC" */
+#define APP_OTA_CONFIRM_MAGIC_ERASED    (0xFFFFFFFFu)
+
+/* Byte address of an external flash offset in the XIP window. Reading
+ * there needs no SMIF mode switch and no critical section. */
+#define APP_OTA_STORAGE_XIP(offset)     ((const uint8_t *)(CY_XIP_BASE + (offset)))
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+/* Start of the MCUboot image header */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    load_addr;
+    uint16_t    hdr_size;
+    uint16_t    protect_tlv_size;
+    uint32_t    img_size;
+    uint32_t    flags;
+    uint8_t     version[8];
+} app_ota_image_header_t;
+
+/* Image that was confirmed, kept in APP_OTA_STORAGE_CONFIRM_OFFSET */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    img_size;
+    uint8_t     version[8];
+    uint8_t     sha256[APP_OTA_IMAGE_SHA256_SIZE];
+} app_ota_confirm_t;
+
+/******************************************************
+ *               Variables Definitions
+ ******************************************************/
+static EventGroupHandle_t   app_ota_storage_events;
+static QueueHandle_t        app_ota_storage_jobs;
+
+/* Result of the bring-up, valid once APP_OTA_STORAGE_READY_BIT is set */
+static cy_rslt_t            app_ota_storage_result = CY_RSLT_OTA_ERROR_GENERAL;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/* Identifies the image of the primary slot by its header and by the SHA-256
+ * of its TLV area, read through XIP. Returns false when they are not found. */
+static bool app_ota_storage_identify(app_ota_confirm_t *p_id)
+{
+    app_ota_image_header_t hdr;
+    uint32_t off;
+    uint32_t end;
+    uint16_t tlv[2];
+
+    memcpy(&hdr, APP_OTA_STORAGE_XIP(APP_OTA_STORAGE_PRIMARY_OFFSET), sizeof(hdr));
+    if ((hdr.magic != APP_OTA_IMAGE_MAGIC) ||
+        (((uint32_t)hdr.hdr_size + hdr.img_size + hdr.protect_tlv_size) >=
+         APP_OTA_STORAGE_PRIMARY_SIZE))
+    {
+        return false;
+    }
+
+    /* Unprotected TLVs follow the image and the protected TLVs */
+    off = APP_OTA_STORAGE_PRIMARY_OFFSET + hdr.hdr_size + hdr.img_size + hdr.protect_tlv_size;
+    memcpy(tlv, APP_OTA_STORAGE_XIP(off), sizeof(tlv));
+    if (tlv[0] != APP_OTA_IMAGE_TLV_INFO_MAGIC)
+    {
+        return false;
+    }
+    end = off + tlv[1];
+    if (end > (APP_OTA_STORAGE_PRIMARY_OFFSET + APP_OTA_STORAGE_PRIMARY_SIZE))
+    {
+        return false;
+    }
+
+    /* Each TLV: type, pad, 16-bit length, value */
+    for (off += sizeof(tlv); (off + sizeof(tlv)) <= end; off += sizeof(tlv) + tlv[1])
+    {
+        memcpy(tlv, APP_OTA_STORAGE_XIP(off), sizeof(tlv));
+        if (((tlv[0] & 0xFFu) == APP_OTA_IMAGE_TLV_SHA256) &&
+            (tlv[1] == APP_OTA_IMAGE_SHA256_SIZE) &&
+            ((off + sizeof(tlv) + APP_OTA_IMAGE_SHA256_SIZE) <= end))
+        {
+            p_id->magic = APP_OTA_CONFIRM_MAGIC;
+            p_id->img_size = hdr.img_size;
+            memcpy(p_id->version, hdr.version, sizeof(p_id->version));
+            memcpy(p_id->sha256, APP_OTA_STORAGE_XIP(off + sizeof(tlv)),
+                   APP_OTA_IMAGE_SHA256_SIZE);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Writes the confirmation record. Done once per new image. */
+static void app_ota_storage_remember(app_ota_confirm_t *p_id)
+{
+    if ((cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, APP_OTA_STORAGE_CONFIRM_OFFSET,
+                          APP_OTA_STORAGE_CONFIRM_SIZE) != CY_RSLT_SUCCESS) ||
+        (cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, APP_OTA_STORAGE_CONFIRM_OFFSET,
+                          p_id, sizeof(*p_id)) != CY_RSLT_SUCCESS))
+    {
+        APP_LOG_WARNING("Image confirmation record not written\n");
+    }
+}
+
+/* Erases the confirmation record, so that the image installed by the OTA
+ * about to start is validated at its first boot even when it is the same
+ * image. Call before the download. */
+void app_ota_storage_forget(void)
+{
+    uint32_t magic = 0;
+
+    /* Read through the flash API, under its mutex. An XIP read may come
+     * while another task programs or erases the flash, which answers no
+     * reads then, or return a cache line read before the last write. */
+    if ((cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, APP_OTA_STORAGE_CONFIRM_OFFSET,
+                         (uint8_t *)&magic, sizeof(magic)) == CY_RSLT_SUCCESS) &&
+        (magic == APP_OTA_CONFIRM_MAGIC_ERASED))
+    {
+        return;
+    }
+
+    if (cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, APP_OTA_STORAGE_CONFIRM_OFFSET,
+                         APP_OTA_STORAGE_CONFIRM_SIZE) != CY_RSLT_SUCCESS)
+    {
+        APP_LOG_WARNING("Image confirmation record not erased\n");
+    }
+}
+
+/* Initializes the external flash (SMIF, SFDP, quad enable) and validates
+ * the running image so that the bootloader does not revert it, then runs
+ * the jobs posted with app_ota_storage_run(). When the confirmation record
+ * names the running image, it was validated at an earlier boot and no OTA
+ * has started since: the validation, with its SMIF reads and possible
+ * trailer writes, is skipped. */
+static void app_ota_storage_task(void *arg)
+{
+    uint32_t start_us = app_boot_time_now();
+    cy_rslt_t result;
+    cy_rslt_t validate_result;
+    app_ota_confirm_t id;
+    bool identified;
+    app_ota_storage_job_t job;
+
+    (void)arg;
+
+    result = cy_ota_storage_init();
+    if (result != CY_RSLT_SUCCESS)
+    {
+        APP_LOG_ERR("cy_ota_storage_init() Failed - result: 0x%lx\n", result);
+    }
+
+    identified = app_ota_storage_identify(&id);
+    if (identified &&
+        (0 == memcmp(&id, APP_OTA_STORAGE_XIP(APP_OTA_STORAGE_CONFIRM_OFFSET), sizeof(id))))
+    {
+        APP_LOG_INFO("Image already confirmed, validation skipped\n");
+    }
+    else
+    {
+        /* Validate the update so we do not revert on reboot */
+        validate_result = cy_ota_storage_image_validate(0);
+        if (validate_result != CY_RSLT_SUCCESS)
+        {
+            APP_LOG_ERR("cy_ota_storage_image_validate() Failed - result: 0x%lx\n", validate_result);
+            if (result == CY_RSLT_SUCCESS)
+            {
+                result = validate_result;
+            }
+        }
+        else
+        {
+            APP_LOG_INFO("cy_ota_storage_image_validate() Successful\n");
+            if (identified && (result == CY_RSLT_SUCCESS))
+            {
+                app_ota_storage_remember(&id);
+            }
+        }
+    }
+    app_boot_time_storage(start_us, app_boot_time_now());
+
+    app_ota_storage_result = result;
+    xEventGroupSetBits(app_ota_storage_events, APP_OTA_STORAGE_READY_BIT);
+
+    while (true)
+    {
+        xQueueReceive(app_ota_storage_jobs, &job, portMAX_DELAY);
+        job();
+    }
+}
+
+/* Starts the bring-up. Call from main() before the scheduler starts. */
+cy_rslt_t app_ota_storage_start(void)
+{
+    app_ota_storage_events = xEventGroupCreate();
+    app_ota_storage_jobs = xQueueCreate(APP_OTA_STORAGE_JOB_DEPTH, sizeof(app_ota_storage_job_t));
+    if ((NULL == app_ota_storage_events) || (NULL == app_ota_storage_jobs))
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    if (pdPASS != xTaskCreate(app_ota_storage_task, APP_OTA_STORAGE_TASK_NAME,
+                              APP_OTA_STORAGE_TASK_STACK_SIZE, NULL,
+                              APP_OTA_STORAGE_TASK_PRIORITY, NULL))
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    app_monitor_task_size(APP_OTA_STORAGE_TASK_NAME, APP_OTA_STORAGE_TASK_STACK_SIZE);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/* Waits for the end of the bring-up. Returns its result, or an error when
+ * it has not ended within timeout_ms. Returns at once after the first wait. */
+cy_rslt_t app_ota_storage_wait(uint32_t timeout_ms)
+{
+    EventBits_t bits;
+
+    if (NULL == app_ota_storage_events)
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    bits = xEventGroupWaitBits(app_ota_storage_events, APP_OTA_STORAGE_READY_BIT,
+                               pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    if (0u == (bits & APP_OTA_STORAGE_READY_BIT))
+    {
+        APP_LOG_ERR("OTA storage not ready after %lu ms\n", (unsigned long)timeout_ms);
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    return app_ota_storage_result;
+}
+
+/* Runs a job in the storage task, after the bring-up. The caller returns at
+ * once; the job reports its own result. Returns an error when the queue is
+ * full. */
+cy_rslt_t app_ota_storage_run(app_ota_storage_job_t job)
+{
+    if ((NULL == app_ota_storage_jobs) ||
+        (pdTRUE != xQueueSend(app_ota_storage_jobs, &job, 0)))
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+/* Last job of app_ota_storage_drain(), all jobs queued before it have run */
+static void app_ota_storage_mark_idle(void)
+{
+    xEventGroupSetBits(app_ota_storage_events, APP_OTA_STORAGE_IDLE_BIT);
+}
+
+/* Waits until the jobs queued so far, and the bring-up, have run, so that
+ * a reset does not cut off a flash erase or program. Returns an error when
+ * they have not within timeout_ms. */
+cy_rslt_t app_ota_storage_drain(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    TickType_t elapsed;
+    EventBits_t bits;
+
+    if (NULL == app_ota_storage_events)
+    {
+        return CY_RSLT_OTA_ERROR_GENERAL;
+    }
+
+    xEventGroupClearBits(app_ota_storage_events, APP_OTA_STORAGE_IDLE_BIT);
+    while (CY_RSLT_SUCCESS != app_ota_storage_run(app_ota_storage_mark_idle))
+    {
+        if ((xTaskGetTickCount() - start) >= timeout)
+        {
+            return CY_RSLT_OTA_ERROR_GENERAL;
+        }
+        vTaskDelay(1);
+    }
+
+    elapsed = xTaskGetTickCount() - start;
+    bits = xEventGroupWaitBits(app_ota_storage_events, APP_OTA_STORAGE_IDLE_BIT, pdTRUE, pdTRUE,
+                               (elapsed < timeout) ? (timeout - elapsed) : 0);
+    return (0u != (bits & APP_OTA_STORAGE_IDLE_BIT)) ? CY_RSLT_SUCCESS : CY_RSLT_OTA_ERROR_GENERAL;
+}
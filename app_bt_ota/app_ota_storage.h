@@ -0,0 +1,82 @@
+/******************************************************************************
+* File Name:   app_ota_storage.h
+*
+* Description: Bring-up of the OTA storage in its own task, so that advertising
+*              does not wait for the external flash
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+#ifndef APP_OTA_STORAGE_H_
+#define APP_OTA_STORAGE_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+/* Longest wait of an OTA control point command for the storage */
+#define APP_OTA_STORAGE_WAIT_MS         (3000u)
+
+/* Primary slot in the external flash, must match flashmap.mk */
+#define APP_OTA_STORAGE_PRIMARY_OFFSET  (0x00020000u)
+#define APP_OTA_STORAGE_PRIMARY_SIZE    (0x00060000u)
+
+/* Sector of the confirmation record: the last sector of the external
+ * flash, outside the bootloader, slot, status and scratch areas */
+#define APP_OTA_STORAGE_CONFIRM_OFFSET  (0x000FF000u)
+#define APP_OTA_STORAGE_CONFIRM_SIZE    (0x00001000u)
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+/* Work done in the storage task, such as an OTA command that erases or
+ * reads the whole slot */
+typedef void (*app_ota_storage_job_t)(void);
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+cy_rslt_t app_ota_storage_start(void);
+cy_rslt_t app_ota_storage_wait (uint32_t timeout_ms);
+void      app_ota_storage_forget(void);
+cy_rslt_t app_ota_storage_run  (app_ota_storage_job_t job);
+cy_rslt_t app_ota_storage_drain(uint32_t timeout_ms);
+
+#endif /* APP_OTA_STORAGE_H_ */
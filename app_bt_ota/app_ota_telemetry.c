@@ -0,0 +1,203 @@
+/******************************************************************************
+* File Name:   app_ota_telemetry.c
+*
+* Description: Counters of the OTA pipeline, reset at every PREPARE. They are
+*              read through the OTA Telemetry characteristic of the Diagnostics
+*              service to compare downloads between hosts.
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cy_device_headers.h"
+#include "app_ota_telemetry.h"
+
+/******************************************************
+ *               Variables Definitions
+ ******************************************************/
+static app_ota_telemetry_t  app_ota_telemetry;
+
+/* CYCCNT at the last chunk, valid once a chunk has been received */
+static uint32_t             app_ota_telemetry_last_chunk;
+static TickType_t           app_ota_telemetry_start_tick;
+static bool                 app_ota_telemetry_running;
+
+/* Chunks of each link, to time its throughput. The first chunk only opens
+ * the interval, so its bytes are left out of the rate. */
+static struct
+{
+    uint32_t    chunks;
+    uint32_t    bytes;
+    TickType_t  first_tick;
+    TickType_t  last_tick;
+} app_ota_telemetry_link[APP_OTA_TELEMETRY_TRANSPORTS];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/* Cycles to microseconds. Every measured interval is shorter than one
+ * CYCCNT wrap (about 44 s at 96 MHz). */
+static uint32_t app_ota_telemetry_us(uint32_t start)
+{
+    return (DWT->CYCCNT - start) / (SystemCoreClock / 1000000u);
+}
+
+/* Called at PREPARE: counters always describe the latest session */
+void app_ota_telemetry_start(void)
+{
+    taskENTER_CRITICAL();
+    memset(&app_ota_telemetry, 0, sizeof(app_ota_telemetry));
+    memset(app_ota_telemetry_link, 0, sizeof(app_ota_telemetry_link));
+    app_ota_telemetry_start_tick = xTaskGetTickCount();
+    app_ota_telemetry_running = true;
+    taskEXIT_CRITICAL();
+}
+
+/* Called at the end of VERIFY, freezes the session time */
+void app_ota_telemetry_stop(void)
+{
+    taskENTER_CRITICAL();
+    if (app_ota_telemetry_running)
+    {
+        app_ota_telemetry.session_ms = (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount() -
+                                                               app_ota_telemetry_start_tick);
+        app_ota_telemetry_running = false;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/* Bytes per second of one link over its own chunks */
+static uint32_t app_ota_telemetry_rate(app_ota_telemetry_transport_t transport)
+{
+    uint32_t ms = (uint32_t)pdTICKS_TO_MS(app_ota_telemetry_link[transport].last_tick -
+                                          app_ota_telemetry_link[transport].first_tick);
+
+    if (0 == ms)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)app_ota_telemetry_link[transport].bytes * 1000u) / ms);
+}
+
+/* Called when image data arrives, before it is written */
+void app_ota_telemetry_chunk(app_ota_telemetry_transport_t transport, uint32_t len)
+{
+    uint32_t now = DWT->CYCCNT;
+    TickType_t tick = xTaskGetTickCount();
+    uint32_t gap_us;
+
+    taskENTER_CRITICAL();
+    if (0 == app_ota_telemetry_link[transport].chunks++)
+    {
+        app_ota_telemetry_link[transport].first_tick = tick;
+    }
+    else
+    {
+        app_ota_telemetry_link[transport].bytes += len;
+    }
+    app_ota_telemetry_link[transport].last_tick = tick;
+    if (0 != app_ota_telemetry.chunks)
+    {
+        gap_us = app_ota_telemetry_us(app_ota_telemetry_last_chunk);
+        app_ota_telemetry.gap_sum_us += gap_us;
+        if (gap_us > app_ota_telemetry.gap_max_us)
+        {
+            app_ota_telemetry.gap_max_us = gap_us;
+        }
+    }
+    app_ota_telemetry_last_chunk = now;
+    app_ota_telemetry.chunks++;
+    app_ota_telemetry.bytes += len;
+    taskEXIT_CRITICAL();
+}
+
+void app_ota_telemetry_retry(void)
+{
+    taskENTER_CRITICAL();
+    app_ota_telemetry.retries++;
+    taskEXIT_CRITICAL();
+}
+
+/* Start time of a flash operation, pass it to app_ota_telemetry_prog() or
+ * app_ota_telemetry_erase() */
+uint32_t app_ota_telemetry_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+void app_ota_telemetry_prog(uint32_t start, uint32_t len)
+{
+    uint32_t us = app_ota_telemetry_us(start);
+
+    taskENTER_CRITICAL();
+    app_ota_telemetry.prog_us += us;
+    app_ota_telemetry.prog_bytes += len;
+    taskEXIT_CRITICAL();
+}
+
+void app_ota_telemetry_erase(uint32_t start, uint32_t len)
+{
+    uint32_t us = app_ota_telemetry_us(start);
+
+    taskENTER_CRITICAL();
+    app_ota_telemetry.erase_us += us;
+    app_ota_telemetry.erase_bytes += len;
+    taskEXIT_CRITICAL();
+}
+
+/* Consistent copy of the counters */
+void app_ota_telemetry_get(app_ota_telemetry_t *p_telemetry)
+{
+    taskENTER_CRITICAL();
+    *p_telemetry = app_ota_telemetry;
+    for (uint32_t i = 0; i < APP_OTA_TELEMETRY_TRANSPORTS; i++)
+    {
+        p_telemetry->rate[i] = app_ota_telemetry_rate((app_ota_telemetry_transport_t)i);
+    }
+    if (app_ota_telemetry_running)
+    {
+        p_telemetry->session_ms = (uint32_t)pdTICKS_TO_MS(xTaskGetTickCount() -
+                                                          app_ota_telemetry_start_tick);
+    }
+    taskEXIT_CRITICAL();
+}
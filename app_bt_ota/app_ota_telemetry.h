@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name:   app_ota_telemetry.h
+*
+* Description: Interface of the OTA telemetry counters: data arrival, flash
+*              timing and link parameters of the current OTA session
+*
+* Related Document: See Readme.md
+*
+*******************************************************************************
+* Copyright 2022-2026, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ *                              INCLUDES
+ ******************************************************************************/
+#ifndef APP_OTA_TELEMETRY_H_
+#define APP_OTA_TELEMETRY_H_
+
+#include <stdint.h>
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+/* Link that carried an image chunk */
+typedef enum
+{
+    APP_OTA_TELEMETRY_GATT,     /* Write (without response) to the OTA data characteristic */
+    APP_OTA_TELEMETRY_L2CAP,    /* SDU on the OTA L2CAP channel */
+    APP_OTA_TELEMETRY_TRANSPORTS
+} app_ota_telemetry_transport_t;
+
+typedef struct
+{
+    uint32_t    bytes;          /* Image bytes received */
+    uint32_t    chunks;         /* GATT writes or L2CAP SDUs carrying image data */
+    uint32_t    gap_sum_us;     /* Sum of the times between two chunks */
+    uint32_t    gap_max_us;     /* Longest time between two chunks */
+    uint32_t    prog_us;        /* Time spent in cy_ota_mem_write() */
+    uint32_t    prog_bytes;     /* Bytes programmed, including read-modify-write of partial rows */
+    uint32_t    erase_us;       /* Time spent in cy_ota_mem_erase() */
+    uint32_t    erase_bytes;    /* Bytes erased */
+    uint32_t    retries;        /* Chunks rejected, the host has to send them again */
+    uint32_t    session_ms;     /* Time from PREPARE to VERIFY, or to now while in progress */
+    uint32_t    rate[APP_OTA_TELEMETRY_TRANSPORTS]; /* B/s from the first to the last chunk on each link, 0 if unused */
+} app_ota_telemetry_t;
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+void     app_ota_telemetry_start (void);
+void     app_ota_telemetry_stop  (void);
+void     app_ota_telemetry_chunk (app_ota_telemetry_transport_t transport, uint32_t len);
+void     app_ota_telemetry_retry (void);
+uint32_t app_ota_telemetry_now   (void);
+void     app_ota_telemetry_prog  (uint32_t start, uint32_t len);
+void     app_ota_telemetry_erase (uint32_t start, uint32_t len);
+void     app_ota_telemetry_get   (app_ota_telemetry_t *p_telemetry);
+
+#endif /* APP_OTA_TELEMETRY_H_ */
@@ -36,6 +36,7 @@
  */
 
 /* Header file includes */
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -43,7 +44,12 @@
 #include "cy_pdl.h"
 #include "cyhal.h"
 #include "cybsp.h"
+#include "cyabs_rtos.h"
 #include "cy_ota_flash.h"
+#include "app_ota_telemetry.h"
+#include "app_trace.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_FLASH
+#include "app_log.h"
 
 #if !(defined (CYW20829B1010) || defined (CYW89829B1232))
 #include <cycfg_pins.h>
@@ -52,6 +58,11 @@
 /**********************************************************************************************************************************
  * local defines
  **********************************************************************************************************************************/
+/* Trace a memory access: handle = 4 KB page of addr, arg = len clamped to 16 bits */
+#define OTA_MEM_TRACE(id, type, addr, len)  app_trace_record((id), (uint8_t)(type), 0,                  \
+                                                             (uint16_t)((addr) >> 12),                  \
+                                                             (uint16_t)(((len) > 0xFFFFu) ? 0xFFFFu : (len)))
+
 /* This defines if External Flash (SMIF) will be used for Upgrade Slots */
 #if (defined (CYW20829) || defined (CYW89829))
 #define CY_FLASH_BASE                       CY_XIP_BASE /* Override value in /mtb-pdl-cat1/devices/COMPONENT_CAT1A/include/cy_device_common.h for CYW20829 and CYW89829 */
@@ -127,6 +138,25 @@
 
 #define CY_BOOT_TRAILER_MAX_UPDATE_SIZE             (16)
 
+#if (defined (CYW20829B1010) || defined (CYW89829B1232)) && defined(OTA_USE_EXTERNAL_FLASH)
+/* The memory configuration found by SFDP is kept in external flash and
+ * reused while the flash JEDEC ID is the same */
+#define OTA_SMIF_CACHE_SUPPORT
+#endif
+
+#ifdef OTA_SMIF_CACHE_SUPPORT
+/* Sector of the SMIF configuration record, right after the scratch area */
+#define OTA_SMIF_CACHE_OFFSET                       (0x000EE000UL)
+#define OTA_SMIF_CACHE_SIZE                         (0x00001000UL)
+#define OTA_SMIF_CACHE_MAGIC                        (0x53464443UL)  /* "SFDC" */
+
+#define OTA_SMIF_CMD_READ_JEDEC_ID                  (0x9Fu)
+#define OTA_SMIF_JEDEC_ID_SIZE                      (3u)
+
+/* Commands kept in the record, in this order */
+#define OTA_SMIF_CACHE_CMDS                         (9u)
+#endif
+
 /**********************************************************************************************************************************
  * local variables & data
  **********************************************************************************************************************************/
@@ -134,6 +164,12 @@
 static cy_stc_smif_context_t ota_QSPI_context;
 static volatile uint32_t     status_flags;
 
+/* Serializes cy_ota_mem_read/write/erase between the tasks that use the
+ * external flash: the OTA library, the bond and key-value stores. Recursive,
+ * a write reads and may erase. */
+static cy_mutex_t            ota_mem_mutex;
+static bool                  ota_mem_mutex_ready;
+
 /* Default QSPI configuration */
 cy_stc_smif_config_t ota_SMIF_config =
 {
@@ -154,6 +190,41 @@ extern const cy_stc_smif_block_config_t smifBlockConfig;
 /* Used for testing the write functionality */
 static uint8_t read_back_test[1024];
 #endif
+
+#ifdef OTA_SMIF_CACHE_SUPPORT
+/* SMIF configuration record. The sizes of the PDL structures are part of
+ * the key, so that a PDL update discards a record written by an older one. */
+typedef struct
+{
+    uint32_t                magic;
+    uint16_t                record_size;
+    uint8_t                 cmd_size;
+    uint8_t                 cmd_present;    /* Bit n set: command n was configured */
+    uint8_t                 jedec_id[4];
+    uint32_t                numOfAddrBytes;
+    uint32_t                memSize;
+    uint32_t                eraseSize;
+    uint32_t                programSize;
+    uint32_t                stsRegBusyMask;
+    uint32_t                stsRegQuadEnableMask;
+    uint32_t                eraseTime;
+    uint32_t                chipEraseTime;
+    uint32_t                programTime;
+    cy_stc_smif_mem_cmd_t   cmd[OTA_SMIF_CACHE_CMDS];
+    uint32_t                crc32;          /* Of every field above */
+} ota_smif_cache_t;
+
+/* Record loaded from flash, or built after discovery */
+static ota_smif_cache_t             ota_smif_cache;
+static bool                         ota_smif_cache_in_ram;  /* ota_smif_cache matches the flash */
+static uint8_t                      ota_smif_jedec_id[OTA_SMIF_JEDEC_ID_SIZE];
+
+/* Block configuration used when the record applies: the configurator one,
+ * without SFDP detection */
+static cy_stc_smif_mem_config_t     ota_smif_cache_mem;
+static cy_stc_smif_mem_config_t    *ota_smif_cache_mems[1];
+static cy_stc_smif_block_config_t   ota_smif_cache_block;
+#endif
 #endif /* CY_IP_MXSMIF & !XMC7100 & !XMC7200 */
 
 #ifdef ENABLE_ON_THE_FLY_ENCRYPTION
@@ -305,6 +376,231 @@ static cy_en_smif_status_t EnableQuadMode(cy_stc_smif_mem_config_t const *memCon
 
     return status;
 }
+
+#ifdef OTA_SMIF_CACHE_SUPPORT
+/*******************************************************************************
+* Function Name: ota_smif_cache_cmds
+****************************************************************************//**
+*
+* Lists the command pointers of a device configuration in record order.
+*
+*******************************************************************************/
+static void ota_smif_cache_cmds(cy_stc_smif_mem_device_cfg_t *dev, cy_stc_smif_mem_cmd_t *cmds[])
+{
+    cmds[0] = dev->readCmd;
+    cmds[1] = dev->writeEnCmd;
+    cmds[2] = dev->writeDisCmd;
+    cmds[3] = dev->eraseCmd;
+    cmds[4] = dev->chipEraseCmd;
+    cmds[5] = dev->programCmd;
+    cmds[6] = dev->readStsRegWipCmd;
+    cmds[7] = dev->readStsRegQeCmd;
+    cmds[8] = dev->writeStsRegQeCmd;
+}
+
+/*******************************************************************************
+* Function Name: ota_smif_cache_crc32
+****************************************************************************//**
+*
+* CRC-32 (IEEE) of the record, without its crc32 field. Bitwise, so that it
+* needs no table in XIP memory.
+*
+*******************************************************************************/
+static uint32_t ota_smif_cache_crc32(const ota_smif_cache_t *rec)
+{
+    const uint8_t *p = (const uint8_t *)rec;
+    uint32_t crc = 0xFFFFFFFFUL;
+    uint32_t i;
+    uint32_t bit;
+
+    for (i = 0; i < offsetof(ota_smif_cache_t, crc32); i++)
+    {
+        crc ^= p[i];
+        for (bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+/*******************************************************************************
+* Function Name: ota_smif_cache_load
+****************************************************************************//**
+*
+* Reads the record through XIP and prepares the block configuration used
+* with it. Once the record has been read or written, the RAM copy is used:
+* XIP may still return cached data after the record is written. Call with
+* XIP on.
+*
+* \return true when the record is intact and was written by this build's PDL
+*
+*******************************************************************************/
+static bool ota_smif_cache_load(void)
+{
+    if (!ota_smif_cache_in_ram)
+    {
+        memcpy(&ota_smif_cache, (const void *)(CY_XIP_BASE + OTA_SMIF_CACHE_OFFSET),
+               sizeof(ota_smif_cache));
+        ota_smif_cache_in_ram = true;
+    }
+
+    if ((ota_smif_cache.magic != OTA_SMIF_CACHE_MAGIC) ||
+        (ota_smif_cache.record_size != sizeof(ota_smif_cache_t)) ||
+        (ota_smif_cache.cmd_size != sizeof(cy_stc_smif_mem_cmd_t)) ||
+        (ota_smif_cache.crc32 != ota_smif_cache_crc32(&ota_smif_cache)) ||
+        (smifBlockConfig.memCount != 1u))
+    {
+        return false;
+    }
+
+    memcpy(&ota_smif_cache_mem, smifBlockConfig.memConfig[MEM_SLOT], sizeof(ota_smif_cache_mem));
+    ota_smif_cache_mem.flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+    ota_smif_cache_mems[0] = &ota_smif_cache_mem;
+    ota_smif_cache_block = smifBlockConfig;
+    ota_smif_cache_block.memConfig = ota_smif_cache_mems;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ota_smif_read_jedec_id
+****************************************************************************//**
+*
+* Reads the manufacturer and device ID of the memory. Call with XIP off.
+*
+*******************************************************************************/
+static cy_en_smif_status_t ota_smif_read_jedec_id(uint8_t id[])
+{
+    cy_en_smif_status_t status;
+
+    status = Cy_SMIF_TransmitCommand(SMIF0, OTA_SMIF_CMD_READ_JEDEC_ID, CY_SMIF_WIDTH_SINGLE,
+                                     NULL, 0u, CY_SMIF_WIDTH_SINGLE,
+                                     smifMemConfigs[0]->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE,
+                                     &ota_QSPI_context);
+    if (CY_SMIF_SUCCESS == status)
+    {
+        status = Cy_SMIF_ReceiveDataBlocking(SMIF0, id, OTA_SMIF_JEDEC_ID_SIZE,
+                                             CY_SMIF_WIDTH_SINGLE, &ota_QSPI_context);
+    }
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: ota_smif_cache_apply
+****************************************************************************//**
+*
+* Fills the device configuration from the record when it was written for
+* this memory. Call with XIP off: the copies go through volatile pointers
+* so that the compiler does not turn them into memcpy() calls, which are
+* not RAM resident.
+*
+* \return true when the configuration was filled
+*
+*******************************************************************************/
+static bool ota_smif_cache_apply(cy_stc_smif_mem_device_cfg_t *dev)
+{
+    cy_stc_smif_mem_cmd_t *cmds[OTA_SMIF_CACHE_CMDS];
+    volatile uint8_t *dst;
+    const volatile uint8_t *src;
+    uint32_t n;
+    uint32_t i;
+
+    for (i = 0; i < OTA_SMIF_JEDEC_ID_SIZE; i++)
+    {
+        if (ota_smif_cache.jedec_id[i] != ota_smif_jedec_id[i])
+        {
+            return false;
+        }
+    }
+
+    ota_smif_cache_cmds(dev, cmds);
+    for (n = 0; n < OTA_SMIF_CACHE_CMDS; n++)
+    {
+        if ((cmds[n] == NULL) != (0u == (ota_smif_cache.cmd_present & (1u << n))))
+        {
+            return false;
+        }
+    }
+
+    for (n = 0; n < OTA_SMIF_CACHE_CMDS; n++)
+    {
+        if (cmds[n] != NULL)
+        {
+            dst = (volatile uint8_t *)cmds[n];
+            src = (const volatile uint8_t *)&ota_smif_cache.cmd[n];
+            for (i = 0; i < sizeof(cy_stc_smif_mem_cmd_t); i++)
+            {
+                dst[i] = src[i];
+            }
+        }
+    }
+    dev->numOfAddrBytes       = ota_smif_cache.numOfAddrBytes;
+    dev->memSize              = ota_smif_cache.memSize;
+    dev->eraseSize            = ota_smif_cache.eraseSize;
+    dev->programSize          = ota_smif_cache.programSize;
+    dev->stsRegBusyMask       = ota_smif_cache.stsRegBusyMask;
+    dev->stsRegQuadEnableMask = ota_smif_cache.stsRegQuadEnableMask;
+    dev->eraseTime            = ota_smif_cache.eraseTime;
+    dev->chipEraseTime        = ota_smif_cache.chipEraseTime;
+    dev->programTime          = ota_smif_cache.programTime;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ota_smif_cache_save
+****************************************************************************//**
+*
+* Writes the record for the discovered configuration, with quad mode
+* enabled. Configurations with hybrid sectors are not kept. Call with XIP
+* on, after FLAG_HAL_INIT_DONE is set.
+*
+*******************************************************************************/
+static void ota_smif_cache_save(cy_stc_smif_mem_device_cfg_t *dev)
+{
+    cy_stc_smif_mem_cmd_t *cmds[OTA_SMIF_CACHE_CMDS];
+    uint32_t n;
+
+    if (dev->hybridRegionCount != 0u)
+    {
+        return;
+    }
+
+    memset(&ota_smif_cache, 0, sizeof(ota_smif_cache));
+    ota_smif_cache.magic = OTA_SMIF_CACHE_MAGIC;
+    ota_smif_cache.record_size = (uint16_t)sizeof(ota_smif_cache_t);
+    ota_smif_cache.cmd_size = (uint8_t)sizeof(cy_stc_smif_mem_cmd_t);
+    memcpy(ota_smif_cache.jedec_id, ota_smif_jedec_id, OTA_SMIF_JEDEC_ID_SIZE);
+    ota_smif_cache.numOfAddrBytes       = dev->numOfAddrBytes;
+    ota_smif_cache.memSize              = dev->memSize;
+    ota_smif_cache.eraseSize            = dev->eraseSize;
+    ota_smif_cache.programSize          = dev->programSize;
+    ota_smif_cache.stsRegBusyMask       = dev->stsRegBusyMask;
+    ota_smif_cache.stsRegQuadEnableMask = dev->stsRegQuadEnableMask;
+    ota_smif_cache.eraseTime            = dev->eraseTime;
+    ota_smif_cache.chipEraseTime        = dev->chipEraseTime;
+    ota_smif_cache.programTime          = dev->programTime;
+
+    ota_smif_cache_cmds(dev, cmds);
+    for (n = 0; n < OTA_SMIF_CACHE_CMDS; n++)
+    {
+        if (cmds[n] != NULL)
+        {
+            ota_smif_cache.cmd_present |= (uint8_t)(1u << n);
+            ota_smif_cache.cmd[n] = *cmds[n];
+        }
+    }
+    ota_smif_cache.crc32 = ota_smif_cache_crc32(&ota_smif_cache);
+
+    if ((cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, OTA_SMIF_CACHE_OFFSET,
+                          OTA_SMIF_CACHE_SIZE) != CY_RSLT_SUCCESS) ||
+        (cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, OTA_SMIF_CACHE_OFFSET,
+                          &ota_smif_cache, sizeof(ota_smif_cache)) != CY_RSLT_SUCCESS))
+    {
+        APP_LOG_WARNING("SMIF configuration record not written\n");
+        ota_smif_cache.magic = 0;
+    }
+}
+#endif /* OTA_SMIF_CACHE_SUPPORT */
 #endif /* OTA_USE_EXTERNAL_FLASH */
 #endif /* CY_IP_MXSMIF & !PSOC_062_1M & !XMC7100 & !XMC7200 */
 
@@ -642,10 +938,20 @@ cy_rslt_t cy_ota_mem_init( void )
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    if (!ota_mem_mutex_ready)
+    {
+        ota_mem_mutex_ready = (cy_rtos_init_mutex2(&ota_mem_mutex, true) == CY_RSLT_SUCCESS);
+    }
+
 #if (defined (CY_IP_MXSMIF) && !defined (XMC7100) && !defined (XMC7200))
 #if defined(OTA_USE_EXTERNAL_FLASH)
     cy_rslt_t smif_status = CY_SMIF_BAD_PARAM;    /* Does not return error if SMIF Quad fails */
     bool QE_status = false;
+#ifdef OTA_SMIF_CACHE_SUPPORT
+    uint32_t init_start = app_log_cycles();
+    bool cache_valid = ota_smif_cache_load();
+    bool from_cache = false;
+#endif
 
 #ifndef ENABLE_ON_THE_FLY_ENCRYPTION
     /* pre-access to SMIF */
@@ -668,8 +974,21 @@ cy_rslt_t cy_ota_mem_init( void )
     Cy_SMIF_SetDataSelect(SMIF0, smifMemConfigs[0]->slaveSelect, smifMemConfigs[0]->dataSelect);
     Cy_SMIF_Enable(SMIF0, &ota_QSPI_context);
 
+#ifdef OTA_SMIF_CACHE_SUPPORT
+    /* A record written for this memory replaces SFDP discovery and the
+     * quad enable round trips */
+    if ((ota_smif_read_jedec_id(ota_smif_jedec_id) == CY_SMIF_SUCCESS) && cache_valid)
+    {
+        from_cache = ota_smif_cache_apply(smifMemConfigs[0]->deviceCfg);
+    }
+
+    /* Map memory device to memory map */
+    smif_status = Cy_SMIF_Memslot_Init(SMIF0, from_cache ? &ota_smif_cache_block : &smifBlockConfig,
+                                       &ota_QSPI_context);
+#else
     /* Map memory device to memory map */
     smif_status = Cy_SMIF_Memslot_Init(SMIF0, &smifBlockConfig, &ota_QSPI_context);
+#endif
     if (smif_status != CY_SMIF_SUCCESS)
     {
         result = smif_status;
@@ -679,8 +998,13 @@ cy_rslt_t cy_ota_mem_init( void )
 #if (defined (CYW20829B1010) || defined (CYW89829B1232))
     /* Even after SFDP enumeration QE command is not initialized */
     /* So, it should be 1.0 device */
-    if ((smifMemConfigs[0]->deviceCfg->readStsRegQeCmd->command == 0) ||                        /* 0 - if configurator generated code */
-        (smifMemConfigs[0]->deviceCfg->readStsRegQeCmd->command == CY_SMIF_NO_COMMAND_OR_MODE)) /* 0xFF's if SFDP enumerated          */
+    /* Skipped when the configuration comes from the record */
+    if (
+#ifdef OTA_SMIF_CACHE_SUPPORT
+        !from_cache &&
+#endif
+        ((smifMemConfigs[0]->deviceCfg->readStsRegQeCmd->command == 0) ||                        /* 0 - if configurator generated code */
+         (smifMemConfigs[0]->deviceCfg->readStsRegQeCmd->command == CY_SMIF_NO_COMMAND_OR_MODE))) /* 0xFF's if SFDP enumerated          */
     {
         smif_status = Cy_SMIF_MemInitSfdpMode(SMIF0,
                                               smifMemConfigs[0],
@@ -717,21 +1041,27 @@ cy_rslt_t cy_ota_mem_init( void )
     #endif /* ! CY_RUN_CODE_FROM_XIP */
 #endif /* CYW20829B1010/CYW89829B1232 */
 
-    smif_status = IsQuadEnabled(smifMemConfigs[0], &QE_status);
-    if(smif_status != CY_RSLT_SUCCESS)
-    {
-        result = CY_RSLT_TYPE_ERROR;
-    }
-
-    /* If not enabled, enable quad mode */
-    if(!QE_status)
+#ifdef OTA_SMIF_CACHE_SUPPORT
+    /* The record is only written once quad mode is enabled, and QE is non-volatile */
+    if (!from_cache)
+#endif
     {
-        /* Enable Quad mode */
-        smif_status = EnableQuadMode(smifMemConfigs[0]);
+        smif_status = IsQuadEnabled(smifMemConfigs[0], &QE_status);
         if(smif_status != CY_RSLT_SUCCESS)
         {
             result = CY_RSLT_TYPE_ERROR;
         }
+
+        /* If not enabled, enable quad mode */
+        if(!QE_status)
+        {
+            /* Enable Quad mode */
+            smif_status = EnableQuadMode(smifMemConfigs[0]);
+            if(smif_status != CY_RSLT_SUCCESS)
+            {
+                result = CY_RSLT_TYPE_ERROR;
+            }
+        }
     }
 
     SET_FLAG(FLAG_HAL_INIT_DONE);
@@ -741,6 +1071,16 @@ cy_rslt_t cy_ota_mem_init( void )
     /* post-access to SMIF */
     POST_SMIF_ACCESS_TURN_ON_XIP;
 #endif
+
+#ifdef OTA_SMIF_CACHE_SUPPORT
+    APP_LOG_INFO("SMIF init %lu us, configuration %s\n",
+                 (unsigned long)((app_log_cycles() - init_start) / (SystemCoreClock / 1000000UL)),
+                 from_cache ? "from record" : "discovered");
+    if (!from_cache && (result == CY_RSLT_SUCCESS) && IS_FLAG_SET(FLAG_HAL_INIT_DONE))
+    {
+        ota_smif_cache_save(smifMemConfigs[0]->deviceCfg);
+    }
+#endif
 #endif
 #endif /* CY_IP_MXSMIF & !XMC7100 & !XMC7200 */
     return result;
@@ -757,10 +1097,12 @@ cy_rslt_t cy_ota_mem_init( void )
  * @return  CY_RSLT_SUCCESS on success
  *          CY_RSLT_TYPE_ERROR on failure
  */
-cy_rslt_t cy_ota_mem_read( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
+static cy_rslt_t ota_mem_read_unlocked( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    OTA_MEM_TRACE(APP_TRACE_MEM_READ, mem_type, addr, len);
+
     if( mem_type == CY_OTA_MEM_TYPE_INTERNAL_FLASH )
     {
 #if !(defined (CYW20829B1010) || defined (CYW89829B1232))
@@ -772,7 +1114,7 @@ cy_rslt_t cy_ota_mem_read( cy_ota_mem_type_t mem_type, uint32_t addr, void *data
         return result;
 #else
         (void)result;
-        printf("%s() READ not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() READ not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
 #endif
     }
@@ -803,7 +1145,7 @@ cy_rslt_t cy_ota_mem_read( cy_ota_mem_type_t mem_type, uint32_t addr, void *data
     }
     else
     {
-        printf("%s() READ not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() READ not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
     }
 }
@@ -824,7 +1166,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
         rc = xmc_internal_flash_write((uint8_t *)data, addr, len);
         if (rc != 0 )
         {
-            printf("xmc_internal_flash_write(0x%08x, 0x%08x, %u) FAILED rc:%u\n", (unsigned int)data, (unsigned int)addr, len, rc);
+            APP_LOG_ERR("xmc_internal_flash_write(0x%08x, 0x%08x, %u) FAILED rc:%u\n", (unsigned int)data, (unsigned int)addr, len, rc);
             result = CY_RSLT_TYPE_ERROR;
         }
         return result;
@@ -839,7 +1181,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
 
 #else
         (void)result;
-        printf("%s() Write not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() Write not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
 #endif
     }
@@ -862,7 +1204,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
             cbus_addr = cy_flash_addr_to_cbus_addr(addr);
             if(ota_allocate_write_buffer(len) != true)
             {
-                printf("\n%s() - Memory allocation failed at %d\n", __func__, __LINE__);
+                APP_LOG_ERR("\n%s() - Memory allocation failed at %d\n", __func__, __LINE__);
                 return CY_RSLT_TYPE_ERROR;
             }
 
@@ -907,12 +1249,12 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
             if(cy_smif_result == CY_RSLT_SUCCESS)
             {
 #ifdef ENABLE_ON_THE_FLY_ENCRYPTION
-                printf("\n\rEncrypted Data : ");
+                APP_LOG_DEBUG("\n\rEncrypted Data : ");
                 for(i = 0; (i < 16 && i < len); i++)
                 {
-                    printf("0x%02x ", read_back_test[i]);
+                    APP_LOG_DEBUG("0x%02x ", read_back_test[i]);
                 }
-                printf("\n\n\r");
+                APP_LOG_DEBUG("\n\n\r");
 
                 cbus_addr = cy_flash_addr_to_cbus_addr(addr);
 
@@ -927,16 +1269,16 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
 
                 if(cy_smif_result != CY_SMIF_SUCCESS)
                 {
-                    printf("[Error] Data encryption failed with error %d\r\n\r\n", cy_smif_result);
+                    APP_LOG_ERR("[Error] Data encryption failed with error %d\r\n\r\n", cy_smif_result);
                 }
                 else
                 {
-                    printf("\n\rDecrypted Data : ");
+                    APP_LOG_DEBUG("\n\rDecrypted Data : ");
                     for(i = 0; (i < 16 && i < len); i++)
                     {
-                        printf("0x%02x ", read_back_test[i]);
+                        APP_LOG_DEBUG("0x%02x ", read_back_test[i]);
                     }
-                    printf("\n\n\r");
+                    APP_LOG_DEBUG("\n\n\r");
                 }
 #endif
                 for(i = 0; (i < 16 && i < len); i++)
@@ -944,7 +1286,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
                     if((((uint8_t *)data)[i]) != read_back_test[i])
                     {
                         result  = -1;
-                        printf("[Error] Data mismatch at index %d expected : %d got : %d \r\n", i, (((uint8_t *)data)[i]), read_back_test[i]);
+                        APP_LOG_ERR("[Error] Data mismatch at index %d expected : %d got : %d \r\n", i, (((uint8_t *)data)[i]), read_back_test[i]);
                     }
                 }
             }
@@ -957,7 +1299,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
     }
     else
     {
-        printf("%s() Write not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() Write not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
     }
 }
@@ -973,7 +1315,7 @@ static cy_rslt_t cy_ota_mem_write_row_size( cy_ota_mem_type_t mem_type, uint32_t
  * @return  CY_RSLT_SUCCESS on success
  *          CY_RSLT_TYPE_ERROR on failure
  */
-cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
+static cy_rslt_t ota_mem_write_unlocked( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
@@ -987,6 +1329,10 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
     uint32_t bytes_to_write = len;
     uint32_t curr_addr = addr;
     uint8_t *curr_src = data;
+    uint32_t prog_start = app_ota_telemetry_now();
+    uint32_t prog_bytes = 0;
+
+    OTA_MEM_TRACE(APP_TRACE_MEM_WRITE, mem_type, addr, len);
 
 #ifdef ENABLE_ON_THE_FLY_ENCRYPTION
     cy_en_smif_status_t cy_smif_result = CY_SMIF_SUCCESS;
@@ -1036,7 +1382,7 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
 
             if(cy_smif_result != CY_SMIF_SUCCESS)
             {
-                printf("[Error] Data encryption failed with error %d\r\n\r\n", cy_smif_result);
+                APP_LOG_ERR("[Error] Data encryption failed with error %d\r\n\r\n", cy_smif_result);
             }
 #endif
             memcpy (&block_buffer[row_offset], curr_src, chunk_size);
@@ -1050,7 +1396,7 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
                     result = cy_ota_mem_erase(mem_type, curr_addr, bytes_to_write);
                     if(result != CY_RSLT_SUCCESS)
                     {
-                        printf("%s() Erase failed for memory type %d\n", __func__, (int)mem_type);
+                        APP_LOG_ERR("%s() Erase failed for memory type %d\n", __func__, (int)mem_type);
                         return CY_RSLT_TYPE_ERROR;
                     }
                 }
@@ -1061,6 +1407,7 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
             {
                 return CY_RSLT_TYPE_ERROR;
             }
+            prog_bytes += sizeof(block_buffer);
         }
         else
         {
@@ -1069,6 +1416,7 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
             {
                 return CY_RSLT_TYPE_ERROR;
             }
+            prog_bytes += len;
         }
 
         curr_addr += chunk_size;
@@ -1076,6 +1424,7 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
         bytes_to_write -= chunk_size;
     }
 
+    app_ota_telemetry_prog(prog_start, prog_bytes);
     return CY_RSLT_SUCCESS;
 }
 
@@ -1089,10 +1438,13 @@ cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *dat
  * @return  CY_RSLT_SUCCESS
  *          CY_RSLT_TYPE_ERROR
  */
-cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t len )
+static cy_rslt_t ota_mem_erase_unlocked( cy_ota_mem_type_t mem_type, uint32_t addr, size_t len )
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    /* Erase lengths are in 256-byte units so a whole slot fits in 16 bits */
+    OTA_MEM_TRACE(APP_TRACE_MEM_ERASE, mem_type, addr, len / 256u);
+
     if( mem_type == CY_OTA_MEM_TYPE_INTERNAL_FLASH )
     {
 #if !(defined (CYW20829B1010) || defined (CYW89829B1232))
@@ -1105,7 +1457,7 @@ cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t le
         Cy_SysLib_ExitCriticalSection(intr_status);
         if (rc != 0 )
         {
-            printf("xmc_internal_flash_erase(0x%08x, %u) FAILED rc:%d\n", (unsigned int)addr, len, rc);
+            APP_LOG_ERR("xmc_internal_flash_erase(0x%08x, %u) FAILED rc:%d\n", (unsigned int)addr, len, rc);
             result = CY_RSLT_TYPE_ERROR;
         }
 #else
@@ -1118,7 +1470,7 @@ cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t le
         return result;
 #else
         (void)result;
-        printf("%s() Erase not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() Erase not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
 #endif
     }
@@ -1134,6 +1486,8 @@ cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t le
 
         if (IS_FLAG_SET(FLAG_HAL_INIT_DONE))
         {
+            uint32_t erase_start = app_ota_telemetry_now();
+
             /* pre-access to SMIF */
             PRE_SMIF_ACCESS_TURN_OFF_XIP;
 
@@ -1167,6 +1521,8 @@ cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t le
 
             /* post-access to SMIF */
             POST_SMIF_ACCESS_TURN_ON_XIP;
+
+            app_ota_telemetry_erase(erase_start, len);
         }
         else
         {
@@ -1180,11 +1536,63 @@ cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t le
     }
     else
     {
-        printf("%s() Erase not supported for memory type %d\n", __func__, (int)mem_type);
+        APP_LOG_ERR("%s() Erase not supported for memory type %d\n", __func__, (int)mem_type);
         return CY_RSLT_TYPE_ERROR;
     }
 }
 
+/* Reads, see ota_mem_read_unlocked(), one task at a time */
+cy_rslt_t cy_ota_mem_read( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
+{
+    cy_rslt_t result;
+
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_get_mutex(&ota_mem_mutex, CY_RTOS_NEVER_TIMEOUT);
+    }
+    result = ota_mem_read_unlocked(mem_type, addr, data, len);
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_set_mutex(&ota_mem_mutex);
+    }
+    return result;
+}
+
+/* Writes, see ota_mem_write_unlocked(), one task at a time: the row buffer
+ * of a partial write is shared */
+cy_rslt_t cy_ota_mem_write( cy_ota_mem_type_t mem_type, uint32_t addr, void *data, size_t len )
+{
+    cy_rslt_t result;
+
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_get_mutex(&ota_mem_mutex, CY_RTOS_NEVER_TIMEOUT);
+    }
+    result = ota_mem_write_unlocked(mem_type, addr, data, len);
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_set_mutex(&ota_mem_mutex);
+    }
+    return result;
+}
+
+/* Erases, see ota_mem_erase_unlocked(), one task at a time */
+cy_rslt_t cy_ota_mem_erase( cy_ota_mem_type_t mem_type, uint32_t addr, size_t len )
+{
+    cy_rslt_t result;
+
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_get_mutex(&ota_mem_mutex, CY_RTOS_NEVER_TIMEOUT);
+    }
+    result = ota_mem_erase_unlocked(mem_type, addr, len);
+    if (ota_mem_mutex_ready)
+    {
+        cy_rtos_set_mutex(&ota_mem_mutex);
+    }
+    return result;
+}
+
 /**
  * @brief To get page size for programming flash, QSPI flash, or any other external memory type
  *
@@ -0,0 +1,382 @@
+/*******************************************************************************
+ * File Name: app_boot_time.c
+ *
+ * Description: Boot-phase timing from main() to the first
+ *              advertisement, with a report kept in retained RAM
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+#include "app_boot_time.h"
+#include "app_reboot.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+#if APP_BOOT_TIME
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_BOOT_TIME_MAGIC             (0x42544D32u)   /* "BTM2" */
+
+/* Cycle count accepted when it agrees with the tick count within this */
+#define APP_BOOT_TIME_TICK_SLACK_US     (2000u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+typedef struct
+{
+    uint32_t            magic;
+    uint32_t            head;       /* Next report written */
+    uint32_t            count;      /* Valid reports, up to APP_BOOT_TIME_HISTORY */
+    uint32_t            check;      /* magic ^ head ^ count */
+    app_boot_report_t   report[APP_BOOT_TIME_HISTORY];
+} app_boot_history_t;
+
+/* Not cleared by the startup code, survives a software or watchdog reset */
+static app_boot_history_t app_boot_history __attribute__((section(".noinit")));
+
+static const char *const app_boot_phase_name[APP_BOOT_PHASE_COUNT] =
+{
+    "bsp",
+    "log",
+    "smif",
+    "config check",
+    "stack init",
+    "scheduler",
+    "bt enabled",
+    "app init",
+    "adv started",
+};
+
+/* Report of this boot, filled as the phases end */
+static app_boot_report_t app_boot_current;
+static uint32_t app_boot_done;      /* Bit n set: phase n has ended */
+static bool     app_boot_saved;     /* Report is in the history */
+static uint32_t app_boot_mark_us;   /* End of the last phase */
+
+/* Time since app_boot_time_start(), see app_boot_time_now() */
+static uint32_t app_boot_elapsed_us;
+static uint32_t app_boot_last_cycles;
+static uint32_t app_boot_last_ticks;
+static uint32_t app_boot_cycles_per_us = 1u;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static bool app_boot_time_valid(void);
+static void app_boot_time_save (void);
+static void app_boot_time_print(void);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_boot_time_start
+*
+* Function Description:
+* @brief  Starts the cycle counter and the first phase. Call first in main().
+*
+* @return void
+*/
+void app_boot_time_start(void)
+{
+    app_log_cycles_enable();
+
+    memset(&app_boot_current, 0, sizeof(app_boot_current));
+    app_boot_done = 0;
+    app_boot_saved = false;
+    app_boot_mark_us = 0;
+    app_boot_elapsed_us = 0;
+    app_boot_last_cycles = DWT->CYCCNT;
+    app_boot_last_ticks = 0;
+    app_boot_cycles_per_us = (SystemCoreClock >= 1000000u) ?
+                             (SystemCoreClock / 1000000u) : 1u;
+}
+
+/**
+* Function Name:
+* app_boot_time_now
+*
+* Function Description:
+* @brief  Time since app_boot_time_start(). The cycles elapsed since the
+*         last call are converted with the clock in use at that call, so
+*         the BSP phase, which sets up the clocks, is counted at the reset
+*         clock. When the tick count shows more time than the cycle counter,
+*         which stops in Deep Sleep, the tick count is used. Interrupts are
+*         masked with PRIMASK rather than a FreeRTOS critical section, which
+*         would leave them masked before the scheduler starts. Call from
+*         main() or a task.
+*
+* @return uint32_t  Microseconds since the start of main()
+*/
+uint32_t app_boot_time_now(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now_cycles;
+    uint32_t now_ticks;
+    uint32_t us;
+    uint32_t tick_us;
+    uint32_t elapsed;
+
+    __disable_irq();
+    now_cycles = DWT->CYCCNT;
+    now_ticks = (uint32_t)xTaskGetTickCount();
+
+    us = (now_cycles - app_boot_last_cycles) / app_boot_cycles_per_us;
+    tick_us = (now_ticks - app_boot_last_ticks) * portTICK_PERIOD_MS * 1000u;
+    if (tick_us > (us + APP_BOOT_TIME_TICK_SLACK_US))
+    {
+        us = tick_us;
+    }
+
+    app_boot_elapsed_us += us;
+    app_boot_last_cycles = now_cycles;
+    app_boot_last_ticks = now_ticks;
+    app_boot_cycles_per_us = (SystemCoreClock >= 1000000u) ?
+                             (SystemCoreClock / 1000000u) : 1u;
+    elapsed = app_boot_elapsed_us;
+    __set_PRIMASK(primask);
+
+    return elapsed;
+}
+
+/**
+* Function Name:
+* app_boot_time_mark
+*
+* Function Description:
+* @brief  Ends a boot phase; the next one starts. Only the first mark of
+*         each phase counts. The end of APP_BOOT_PHASE_ADV_STARTED prints
+*         the report and saves it in retained RAM. Call from main() or the
+*         Bluetooth stack task.
+*
+* @param phase      Phase that ends
+*
+* @return void
+*/
+void app_boot_time_mark(app_boot_phase_t phase)
+{
+    uint32_t now;
+
+    if ((phase >= APP_BOOT_PHASE_COUNT) || (0u != (app_boot_done & (1u << phase))))
+    {
+        return;
+    }
+
+    now = app_boot_time_now();
+    app_boot_current.phase_us[phase] = now - app_boot_mark_us;
+    app_boot_current.total_us = now;
+    app_boot_mark_us = now;
+    app_boot_done |= (1u << phase);
+
+    if (APP_BOOT_PHASE_ADV_STARTED == phase)
+    {
+        app_boot_time_save();
+        app_boot_time_print();
+    }
+}
+
+/**
+* Function Name:
+* app_boot_time_storage
+*
+* Function Description:
+* @brief  Records the OTA storage bring-up, which runs in its own task
+*         alongside the boot phases. When it ends after the first
+*         advertisement, the report already saved is updated.
+*
+* @param start_us   app_boot_time_now() when the bring-up started
+*
+* @param end_us     app_boot_time_now() when the storage was ready
+*
+* @return void
+*/
+void app_boot_time_storage(uint32_t start_us, uint32_t end_us)
+{
+    app_boot_current.storage_us = end_us - start_us;
+    app_boot_current.storage_ready_us = end_us;
+
+    if (app_boot_saved && app_boot_time_valid() && (app_boot_history.count > 0u))
+    {
+        app_boot_history.report[(app_boot_history.head - 1u) % APP_BOOT_TIME_HISTORY] =
+            app_boot_current;
+        APP_LOG_NOTICE("  ota storage    %8lu us, ready at %lu us (after advertising)\r\n",
+                       (unsigned long)app_boot_current.storage_us,
+                       (unsigned long)app_boot_current.storage_ready_us);
+    }
+}
+
+/**
+* Function Name:
+* app_boot_time_report
+*
+* Function Description:
+* @brief  Returns a retained boot report
+*
+* @param age        0 for the last boot that reached advertising, 1 for the
+*                   one before, and so on
+*
+* @return const app_boot_report_t*  Report, NULL when not available
+*/
+const app_boot_report_t *app_boot_time_report(uint32_t age)
+{
+    if (!app_boot_time_valid() || (age >= app_boot_history.count))
+    {
+        return NULL;
+    }
+
+    return &app_boot_history.report[(app_boot_history.head - 1u - age) %
+                                    APP_BOOT_TIME_HISTORY];
+}
+
+/**
+* Function Name:
+* app_boot_time_valid
+*
+* Function Description:
+* @brief  Checks the header of the retained history, which holds garbage
+*         after a power-on reset
+*
+* @return bool      true when the history can be used
+*/
+static bool app_boot_time_valid(void)
+{
+    return (APP_BOOT_TIME_MAGIC == app_boot_history.magic) &&
+           (app_boot_history.head < APP_BOOT_TIME_HISTORY) &&
+           (app_boot_history.count <= APP_BOOT_TIME_HISTORY) &&
+           (app_boot_history.check == (APP_BOOT_TIME_MAGIC ^ app_boot_history.head ^
+                                       app_boot_history.count));
+}
+
+/**
+* Function Name:
+* app_boot_time_save
+*
+* Function Description:
+* @brief  Appends the report of this boot to the retained history, after
+*         clearing the history when its header is not intact
+*
+* @return void
+*/
+static void app_boot_time_save(void)
+{
+    if (!app_boot_time_valid())
+    {
+        memset(&app_boot_history, 0, sizeof(app_boot_history));
+        app_boot_history.magic = APP_BOOT_TIME_MAGIC;
+    }
+
+    app_boot_current.version[0] = APP_VERSION_MAJOR;
+    app_boot_current.version[1] = APP_VERSION_MINOR;
+    app_boot_current.version[2] = APP_VERSION_BUILD;
+    app_boot_current.reset_reason = Cy_SysLib_GetResetReason();
+    app_boot_current.reboot_cause = (uint8_t)app_reboot_last(&app_boot_current.shutdown_us);
+
+    app_boot_history.report[app_boot_history.head] = app_boot_current;
+    app_boot_history.head = (app_boot_history.head + 1u) % APP_BOOT_TIME_HISTORY;
+    if (app_boot_history.count < APP_BOOT_TIME_HISTORY)
+    {
+        app_boot_history.count++;
+    }
+    app_boot_history.check = APP_BOOT_TIME_MAGIC ^ app_boot_history.head ^
+                             app_boot_history.count;
+    app_boot_saved = true;
+}
+
+/**
+* Function Name:
+* app_boot_time_print
+*
+* Function Description:
+* @brief  Prints the phases of this boot, then the total of every retained
+*         boot, oldest first
+*
+* @return void
+*/
+static void app_boot_time_print(void)
+{
+    const app_boot_report_t *p_report;
+    uint32_t age;
+    uint32_t i;
+
+    APP_LOG_NOTICE("Boot to first advertisement: %lu us\r\n",
+                   (unsigned long)app_boot_current.total_us);
+    for (i = 0; i < APP_BOOT_PHASE_COUNT; i++)
+    {
+        APP_LOG_NOTICE("  %-14s %8lu us\r\n", app_boot_phase_name[i],
+                       (unsigned long)app_boot_current.phase_us[i]);
+    }
+    if (0u != app_boot_current.storage_ready_us)
+    {
+        APP_LOG_NOTICE("  ota storage    %8lu us, ready at %lu us (own task)\r\n",
+                       (unsigned long)app_boot_current.storage_us,
+                       (unsigned long)app_boot_current.storage_ready_us);
+    }
+    if (APP_REBOOT_CAUSE_NONE != app_boot_current.reboot_cause)
+    {
+        /* The bootloader, which installs an OTA image, is not timed */
+        APP_LOG_NOTICE("Reboot (%s) to first advertisement: %lu us, shutdown %lu us + boot %lu us\r\n",
+                       app_reboot_name((app_reboot_cause_t)app_boot_current.reboot_cause),
+                       (unsigned long)(app_boot_current.shutdown_us + app_boot_current.total_us),
+                       (unsigned long)app_boot_current.shutdown_us,
+                       (unsigned long)app_boot_current.total_us);
+    }
+
+    for (age = app_boot_history.count; age > 0u; age--)
+    {
+        p_report = app_boot_time_report(age - 1u);
+        APP_LOG_NOTICE("  boot -%lu: v%u.%u.%u reset 0x%08lX (%s) %8lu us, storage ready %8lu us\r\n",
+                       (unsigned long)(age - 1u), p_report->version[0],
+                       p_report->version[1], p_report->version[2],
+                       (unsigned long)p_report->reset_reason,
+                       app_reboot_name((app_reboot_cause_t)p_report->reboot_cause),
+                       (unsigned long)p_report->total_us,
+                       (unsigned long)p_report->storage_ready_us);
+    }
+}
+
+#endif /* APP_BOOT_TIME */
+
+/* [] END OF FILE */
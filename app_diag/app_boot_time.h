@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * File Name: app_boot_time.h
+ *
+ * Description: This file is the public interface of app_boot_time.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BOOT_TIME_H__
+#define APP_BOOT_TIME_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Boot reports kept in retained RAM, must be a power of 2
+ */
+#define APP_BOOT_TIME_HISTORY           (8u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Boot phases, in order. Each value marks the end of the phase.
+ */
+typedef enum
+{
+    APP_BOOT_PHASE_BSP = 0,         /* cybsp_init() */
+    APP_BOOT_PHASE_LOG,             /* Debug UART, logging and trace */
+    APP_BOOT_PHASE_SMIF,            /* cybsp_smif_init() */
+    APP_BOOT_PHASE_CONFIG_CHECK,    /* Configurator check */
+    APP_BOOT_PHASE_STACK_INIT,      /* wiced_bt_stack_init() */
+    APP_BOOT_PHASE_SCHEDULER,       /* Heap and tasks, up to vTaskStartScheduler() */
+    APP_BOOT_PHASE_BT_ENABLED,      /* Controller up, BTM_ENABLED_EVT */
+    APP_BOOT_PHASE_APP_INIT,        /* app_bt_init(), advertising requested */
+    APP_BOOT_PHASE_ADV_STARTED,     /* First BTM_BLE_ADVERT_STATE_CHANGED_EVT */
+    APP_BOOT_PHASE_COUNT
+} app_boot_phase_t;
+
+/**
+ * @brief Boot report, kept for the last APP_BOOT_TIME_HISTORY boots
+ */
+typedef struct
+{
+    uint8_t     version[3];                         /* Major, minor, build */
+    uint8_t     reboot_cause;                       /* app_reboot_cause_t of the reset */
+    uint32_t    reset_reason;                       /* Cy_SysLib_GetResetReason() */
+    uint32_t    shutdown_us;                        /* Reboot request to reset, requested reboots */
+    uint32_t    phase_us[APP_BOOT_PHASE_COUNT];     /* Duration of each phase */
+    uint32_t    total_us;                           /* main() to first advertisement */
+    uint32_t    storage_us;                         /* OTA storage bring-up, in its own task */
+    uint32_t    storage_ready_us;                   /* main() to OTA storage ready, 0 if pending */
+} app_boot_report_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if APP_BOOT_TIME
+void                     app_boot_time_start (void);
+uint32_t                 app_boot_time_now   (void);
+void                     app_boot_time_mark  (app_boot_phase_t phase);
+void                     app_boot_time_storage(uint32_t start_us, uint32_t end_us);
+const app_boot_report_t *app_boot_time_report(uint32_t age);
+#else
+#define app_boot_time_start()
+#define app_boot_time_now()         (0u)
+#define app_boot_time_mark(phase)
+#define app_boot_time_storage(start_us, end_us)
+#define app_boot_time_report(age)   ((const app_boot_report_t *)0)
+#endif
+
+#endif
+/* [] END OF FILE */
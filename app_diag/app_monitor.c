@@ -0,0 +1,338 @@
+/*******************************************************************************
+ * File Name: app_monitor.c
+ *
+ * Description: This file contains the memory monitor. It periodically
+ *              samples the stack high-water mark of every task, the peak use of
+ *              the Bluetooth stack heap and of the C heap, and logs a recommended
+ *              size with a safety margin whenever a peak grows.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include <malloc.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_memory.h"
+#include "app_monitor.h"
+#include "app_sched.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+#if APP_MONITOR
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Recommended sizes are rounded up to this many words or bytes */
+#define APP_MONITOR_ROUND               (16u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Configured stack size of a task, in words */
+typedef struct
+{
+    const char *name;
+    uint32_t    stack_words;
+} app_monitor_size_t;
+
+static app_monitor_size_t app_monitor_sizes[APP_MONITOR_MAX_TASKS] =
+{
+    { "IDLE",                 configMINIMAL_STACK_SIZE },
+    { "Tmr Svc",              configTIMER_TASK_STACK_DEPTH },
+};
+static uint8_t app_monitor_size_count = 2;
+
+/* Lowest high-water mark reported per task, matched by xTaskNumber */
+static UBaseType_t      app_monitor_number[APP_MONITOR_MAX_TASKS];
+static configSTACK_DEPTH_TYPE app_monitor_hwm[APP_MONITOR_MAX_TASKS];
+static uint8_t          app_monitor_count;
+
+static TaskStatus_t     app_monitor_status[APP_MONITOR_MAX_TASKS];
+
+static wiced_bt_heap_t *app_monitor_bt_heap_ptr;
+static uint32_t         app_monitor_bt_heap_size;
+static uint32_t         app_monitor_bt_heap_peak;
+static uint32_t         app_monitor_c_heap_peak;
+
+/* Bounds of the C heap from the linker script */
+extern uint8_t __HeapBase;
+extern uint8_t __HeapLimit;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_monitor_sample(void);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_monitor_init
+*
+* Function Description:
+* @brief  Starts sampling every APP_MONITOR_PERIOD_MS in the application
+*         loop. Call after app_sched_init().
+*
+* @return void
+*/
+void app_monitor_init(void)
+{
+    app_sched_register(APP_SCHED_EVT_MONITOR, app_monitor_sample, APP_MONITOR_PERIOD_MS);
+    app_sched_periodic(APP_SCHED_EVT_MONITOR, true);
+}
+
+/**
+* Function Name:
+* app_monitor_task_size
+*
+* Function Description:
+* @brief  Registers the stack size a task was created with, so that the
+*         monitor can tell how much of it is used. Tasks that are not
+*         registered, such as the Bluetooth stack tasks, are only reported
+*         with their high-water mark.
+*
+* @param name         Task name as passed to xTaskCreate()
+*
+* @param stack_words  Stack depth as passed to xTaskCreate()
+*
+* @return void
+*/
+void app_monitor_task_size(const char *name, uint32_t stack_words)
+{
+    taskENTER_CRITICAL();
+    if (app_monitor_size_count < APP_MONITOR_MAX_TASKS)
+    {
+        app_monitor_sizes[app_monitor_size_count].name = name;
+        app_monitor_sizes[app_monitor_size_count].stack_words = stack_words;
+        app_monitor_size_count++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_monitor_bt_heap
+*
+* Function Description:
+* @brief  Registers the Bluetooth heap created by the application
+*
+* @param p_heap     Heap returned by wiced_bt_create_heap()
+*
+* @param size       Size the heap was created with, in bytes
+*
+* @return void
+*/
+void app_monitor_bt_heap(wiced_bt_heap_t *p_heap, uint32_t size)
+{
+    app_monitor_bt_heap_ptr = p_heap;
+    app_monitor_bt_heap_size = size;
+}
+
+/**
+* Function Name:
+* app_monitor_recommend
+*
+* Function Description:
+* @brief  Adds the safety margin to a measured peak and rounds it up
+*
+* @param peak       Measured peak
+*
+* @return uint32_t  Recommended size
+*/
+static uint32_t app_monitor_recommend(uint32_t peak)
+{
+    uint32_t size = peak + ((peak * APP_MONITOR_MARGIN_PCT) + 99u) / 100u;
+
+    return (size + APP_MONITOR_ROUND - 1u) & ~(APP_MONITOR_ROUND - 1u);
+}
+
+/**
+* Function Name:
+* app_monitor_stack_words
+*
+* Function Description:
+* @brief  Looks up the registered stack size of a task
+*
+* @param name       Task name
+*
+* @return uint32_t  Stack depth in words, 0 when not registered
+*/
+static uint32_t app_monitor_stack_words(const char *name)
+{
+    uint8_t i;
+
+    for (i = 0; i < app_monitor_size_count; i++)
+    {
+        if (0 == strncmp(app_monitor_sizes[i].name, name, configMAX_TASK_NAME_LEN))
+        {
+            return app_monitor_sizes[i].stack_words;
+        }
+    }
+    return 0;
+}
+
+/**
+* Function Name:
+* app_monitor_stacks
+*
+* Function Description:
+* @brief  Logs every task whose stack high-water mark went down since the
+*         last report, with a recommended stack size when its configured
+*         size is known
+*
+* @return void
+*/
+static void app_monitor_stacks(void)
+{
+    UBaseType_t count;
+    UBaseType_t i;
+    uint8_t slot;
+    configSTACK_DEPTH_TYPE hwm;
+    uint32_t words;
+
+    count = uxTaskGetSystemState(app_monitor_status, APP_MONITOR_MAX_TASKS, NULL);
+    if (0u == count)
+    {
+        APP_LOG_WARNING("Monitor: more than %u tasks\r\n", (unsigned int)APP_MONITOR_MAX_TASKS);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        hwm = app_monitor_status[i].usStackHighWaterMark;
+        for (slot = 0; slot < app_monitor_count; slot++)
+        {
+            if (app_monitor_number[slot] == app_monitor_status[i].xTaskNumber)
+            {
+                break;
+            }
+        }
+        if (slot == app_monitor_count)
+        {
+            if (app_monitor_count == APP_MONITOR_MAX_TASKS)
+            {
+                continue;
+            }
+            app_monitor_number[slot] = app_monitor_status[i].xTaskNumber;
+            app_monitor_count++;
+        }
+        else if (hwm >= app_monitor_hwm[slot])
+        {
+            continue;
+        }
+        app_monitor_hwm[slot] = hwm;
+
+        words = app_monitor_stack_words(app_monitor_status[i].pcTaskName);
+        if (0u != words)
+        {
+            APP_LOG_INFO("Stack %-16s %4lu of %4lu words used, recommended %lu\r\n",
+                         app_monitor_status[i].pcTaskName,
+                         (unsigned long)(words - hwm), (unsigned long)words,
+                         (unsigned long)app_monitor_recommend(words - hwm));
+        }
+        else
+        {
+            APP_LOG_INFO("Stack %-16s %4lu words never used\r\n",
+                         app_monitor_status[i].pcTaskName, (unsigned long)hwm);
+        }
+    }
+}
+
+/**
+* Function Name:
+* app_monitor_heaps
+*
+* Function Description:
+* @brief  Logs the peak use of the Bluetooth heap and of the C heap when it
+*         grew since the last report. FreeRTOS uses heap_3, so its
+*         allocations come from the C heap and configTOTAL_HEAP_SIZE is not
+*         used; the peak of the C heap is the highest break newlib has
+*         taken from the linker .heap region.
+*
+* @return void
+*/
+static void app_monitor_heaps(void)
+{
+    wiced_bt_heap_statistics_t bt_stats;
+    struct mallinfo info = mallinfo();
+    uint32_t c_heap_size = (uint32_t)(&__HeapLimit - &__HeapBase);
+
+    if ((NULL != app_monitor_bt_heap_ptr) &&
+        wiced_bt_get_heap_statistics(app_monitor_bt_heap_ptr, &bt_stats) &&
+        (bt_stats.max_heap_size > app_monitor_bt_heap_peak))
+    {
+        app_monitor_bt_heap_peak = bt_stats.max_heap_size;
+        APP_LOG_INFO("BT heap peak %lu of %lu bytes, recommended BT_HEAP_SIZE %lu\r\n",
+                     (unsigned long)app_monitor_bt_heap_peak,
+                     (unsigned long)app_monitor_bt_heap_size,
+                     (unsigned long)app_monitor_recommend(app_monitor_bt_heap_peak));
+    }
+
+    if ((uint32_t)info.arena > app_monitor_c_heap_peak)
+    {
+        app_monitor_c_heap_peak = (uint32_t)info.arena;
+        APP_LOG_INFO("C heap peak %lu of %lu bytes (%lu in use, min free %lu), recommended %lu\r\n",
+                     (unsigned long)app_monitor_c_heap_peak, (unsigned long)c_heap_size,
+                     (unsigned long)info.uordblks,
+                     (unsigned long)(c_heap_size - app_monitor_c_heap_peak),
+                     (unsigned long)app_monitor_recommend(app_monitor_c_heap_peak));
+    }
+}
+
+/**
+* Function Name:
+* app_monitor_sample
+*
+* Function Description:
+* @brief  Samples stacks and heaps, every APP_MONITOR_PERIOD_MS. Only peaks
+*         that grew are logged, so the output stops once the application
+*         has gone through its worst case, an OTA for example.
+*
+* @return void
+*/
+static void app_monitor_sample(void)
+{
+    app_monitor_stacks();
+    app_monitor_heaps();
+}
+
+#endif /* APP_MONITOR */
+
+/* [] END OF FILE */
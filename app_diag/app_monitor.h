@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * File Name: app_monitor.h
+ *
+ * Description: This file is the public interface of app_monitor.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_MONITOR_H__
+#define APP_MONITOR_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include "wiced_memory.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Sampling period of the monitor
+ */
+#define APP_MONITOR_PERIOD_MS           (10000u)
+
+/**
+ * @brief Safety margin added to every measured peak, in percent
+ */
+#define APP_MONITOR_MARGIN_PCT          (25u)
+
+/**
+ * @brief Tasks whose configured stack size can be registered
+ */
+#define APP_MONITOR_MAX_TASKS           (16u)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if APP_MONITOR
+void app_monitor_init      (void);
+void app_monitor_task_size (const char *name, uint32_t stack_words);
+void app_monitor_bt_heap   (wiced_bt_heap_t *p_heap, uint32_t size);
+#else
+#define app_monitor_init()
+#define app_monitor_task_size(name, stack_words)
+#define app_monitor_bt_heap(p_heap, size)
+#endif
+
+#endif
+/* [] END OF FILE */
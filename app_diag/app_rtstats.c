@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * File Name: app_rtstats.c
+ *
+ * Description: This file contains the FreeRTOS run-time statistics
+ *              support. The run-time counter is the CPU cycle counter scaled to
+ *              microseconds, and the application loop takes a snapshot of every task each
+ *              window to report its share of the CPU.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cy_device_headers.h"
+#include "app_rtstats.h"
+#include "app_sched.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+#if APP_RTSTATS
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Run-time counter state, see app_rtstats_counter() */
+static uint32_t app_rtstats_cycles_per_us = 1u;
+static uint32_t app_rtstats_last_cycles;
+static uint32_t app_rtstats_rem_cycles;
+static uint32_t app_rtstats_us;
+
+/* Task states of the current snapshot and counters of the previous one */
+static TaskStatus_t app_rtstats_status[APP_RTSTATS_MAX_TASKS];
+static UBaseType_t  app_rtstats_prev_number[APP_RTSTATS_MAX_TASKS];
+static uint32_t     app_rtstats_prev_counter[APP_RTSTATS_MAX_TASKS];
+static UBaseType_t  app_rtstats_prev_count;
+static uint32_t     app_rtstats_prev_total;
+
+/* Last complete window, read by app_rtstats_report() */
+static app_rtstats_report_t app_rtstats_last;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_rtstats_window(void);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_rtstats_timer_init
+*
+* Function Description:
+* @brief  Starts the cycle counter behind the run-time counter. Called by
+*         vTaskStartScheduler() through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS.
+*
+* @return void
+*/
+void app_rtstats_timer_init(void)
+{
+    app_log_cycles_enable();
+
+    app_rtstats_cycles_per_us = SystemCoreClock / 1000000u;
+    if (0u == app_rtstats_cycles_per_us)
+    {
+        app_rtstats_cycles_per_us = 1u;
+    }
+    app_rtstats_last_cycles = DWT->CYCCNT;
+}
+
+/**
+* Function Name:
+* app_rtstats_counter
+*
+* Function Description:
+* @brief  Run-time counter of FreeRTOS, in microseconds. Called on every
+*         context switch, so it only folds the cycles elapsed since the last
+*         call into the count. The count wraps after about 71 minutes;
+*         CYCCNT wraps after about 44 s, a context switch or a snapshot
+*         happens well within that. The cycle counter stops in Deep Sleep,
+*         so the counter measures the time the CPU is awake.
+*
+* @return uint32_t  Microseconds of CPU time since the scheduler started
+*/
+uint32_t app_rtstats_counter(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+    uint32_t cycles;
+
+    __disable_irq();
+    now = DWT->CYCCNT;
+    cycles = (now - app_rtstats_last_cycles) + app_rtstats_rem_cycles;
+    app_rtstats_last_cycles = now;
+    app_rtstats_us += cycles / app_rtstats_cycles_per_us;
+    app_rtstats_rem_cycles = cycles % app_rtstats_cycles_per_us;
+    __set_PRIMASK(primask);
+
+    return app_rtstats_us;
+}
+
+/**
+* Function Name:
+* app_rtstats_init
+*
+* Function Description:
+* @brief  Starts the periodic snapshot in the application loop. Call
+*         before the scheduler starts, after app_sched_init().
+*
+* @return void
+*/
+void app_rtstats_init(void)
+{
+    app_sched_register(APP_SCHED_EVT_RTSTATS, app_rtstats_window, APP_RTSTATS_WINDOW_MS);
+    app_sched_periodic(APP_SCHED_EVT_RTSTATS, true);
+}
+
+/**
+* Function Name:
+* app_rtstats_prev
+*
+* Function Description:
+* @brief  Finds the run-time counter of a task in the previous snapshot
+*
+* @param number     xTaskNumber of the task
+*
+* @return uint32_t  Counter of the previous snapshot, 0 for a new task
+*/
+static uint32_t app_rtstats_prev(UBaseType_t number)
+{
+    UBaseType_t i;
+
+    for (i = 0; i < app_rtstats_prev_count; i++)
+    {
+        if (app_rtstats_prev_number[i] == number)
+        {
+            return app_rtstats_prev_counter[i];
+        }
+    }
+    return 0;
+}
+
+/**
+* Function Name:
+* app_rtstats_snapshot
+*
+* Function Description:
+* @brief  Closes the current window: computes the run time of every task
+*         since the previous snapshot and its share of the window. Called by
+*         the application loop every APP_RTSTATS_WINDOW_MS, can also be called directly
+*         to close a window early.
+*
+* @return void
+*/
+void app_rtstats_snapshot(void)
+{
+    app_rtstats_report_t report;
+    uint32_t total = 0;
+    uint32_t delta;
+    UBaseType_t count;
+    UBaseType_t i;
+
+    count = uxTaskGetSystemState(app_rtstats_status, APP_RTSTATS_MAX_TASKS, &total);
+    if (0u == count)
+    {
+        APP_LOG_WARNING("Run-time stats: more than %u tasks\r\n",
+                        (unsigned int)APP_RTSTATS_MAX_TASKS);
+        return;
+    }
+
+    memset(&report, 0, sizeof(report));
+    report.window_us = total - app_rtstats_prev_total;
+    report.count = (uint8_t)count;
+    for (i = 0; i < count; i++)
+    {
+        delta = app_rtstats_status[i].ulRunTimeCounter -
+                app_rtstats_prev(app_rtstats_status[i].xTaskNumber);
+        strncpy(report.task[i].name, app_rtstats_status[i].pcTaskName, APP_RTSTATS_NAME_LEN);
+        report.task[i].run_us = delta;
+        if (0u != report.window_us)
+        {
+            report.task[i].permille = (uint16_t)(((uint64_t)delta * 1000u) / report.window_us);
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        app_rtstats_prev_number[i] = app_rtstats_status[i].xTaskNumber;
+        app_rtstats_prev_counter[i] = app_rtstats_status[i].ulRunTimeCounter;
+    }
+    app_rtstats_prev_count = count;
+    app_rtstats_prev_total = total;
+
+    taskENTER_CRITICAL();
+    app_rtstats_last = report;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_rtstats_report
+*
+* Function Description:
+* @brief  Returns the report of the last complete window
+*
+* @param p_report   Receives the report
+*
+* @return void
+*/
+void app_rtstats_report(app_rtstats_report_t *p_report)
+{
+    taskENTER_CRITICAL();
+    *p_report = app_rtstats_last;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* Function Name:
+* app_rtstats_print
+*
+* Function Description:
+* @brief  Prints the report of the last complete window at DEBUG level of
+*         the SYS module
+*
+* @return void
+*/
+void app_rtstats_print(void)
+{
+    static app_rtstats_report_t report;
+    uint8_t i;
+
+    if (CY_LOG_DEBUG > app_log_level[APP_LOG_MOD_SYS])
+    {
+        return;
+    }
+
+    app_rtstats_report(&report);
+    APP_LOG_DEBUG("CPU usage over %lu ms awake:\r\n",
+                  (unsigned long)(report.window_us / 1000u));
+    for (i = 0; i < report.count; i++)
+    {
+        APP_LOG_DEBUG("  %-8.*s %8lu us %3u.%u %%\r\n", (int)APP_RTSTATS_NAME_LEN,
+                      report.task[i].name, (unsigned long)report.task[i].run_us,
+                      report.task[i].permille / 10u, report.task[i].permille % 10u);
+    }
+}
+
+/**
+* Function Name:
+* app_rtstats_window
+*
+* Function Description:
+* @brief  Closes a window every APP_RTSTATS_WINDOW_MS, runs in the
+*         application loop
+*
+* @return void
+*/
+static void app_rtstats_window(void)
+{
+    app_rtstats_snapshot();
+    app_rtstats_print();
+}
+
+#endif /* APP_RTSTATS */
+
+/* [] END OF FILE */
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * File Name: app_rtstats.h
+ *
+ * Description: This file is the public interface of app_rtstats.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_RTSTATS_H__
+#define APP_RTSTATS_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Length of the window over which CPU usage is computed
+ */
+#define APP_RTSTATS_WINDOW_MS           (5000u)
+
+/**
+ * @brief Largest number of tasks that can be tracked
+ */
+#define APP_RTSTATS_MAX_TASKS           (16u)
+
+/**
+ * @brief Characters of the task name kept in a report
+ */
+#define APP_RTSTATS_NAME_LEN            (8u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief CPU time of one task over the last window
+ */
+typedef struct
+{
+    char        name[APP_RTSTATS_NAME_LEN];     /* Not NUL terminated when full */
+    uint32_t    run_us;                         /* Run time in the window */
+    uint16_t    permille;                       /* Share of the window, 0.1 % units */
+} app_rtstats_task_t;
+
+/**
+ * @brief Report of the last complete window
+ */
+typedef struct
+{
+    uint32_t            window_us;              /* Awake time covered by the report */
+    uint8_t             count;                  /* Valid entries of task[] */
+    app_rtstats_task_t  task[APP_RTSTATS_MAX_TASKS];
+} app_rtstats_report_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if APP_RTSTATS
+void     app_rtstats_init        (void);
+void     app_rtstats_timer_init  (void);
+uint32_t app_rtstats_counter     (void);
+void     app_rtstats_snapshot    (void);
+void     app_rtstats_report      (app_rtstats_report_t *p_report);
+void     app_rtstats_print       (void);
+#endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,285 @@
+/*******************************************************************************
+ * File Name: app_trace.c
+ *
+ * Description: This file contains the event trace. Bluetooth
+ *              management, GATT, write and OTA storage events are recorded with a
+ *              cycle counter timestamp in a ring kept in no-init RAM, so the
+ *              events before a reset can be printed after it. Render the printed
+ *              trace with scripts/app_trace_timeline.py.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+#include "app_bt_utils.h"
+#include "app_trace.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+#if APP_TRACE
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_TRACE_MAGIC                 (0x54524331u)   /* "TRC1" */
+
+#define APP_TRACE_TASK_NAME             "Trace"
+#define APP_TRACE_TASK_STACK_SIZE       (384u)
+#define APP_TRACE_TASK_PRIORITY         (tskIDLE_PRIORITY + 1)
+
+/* Entries printed before the dump lets the log task catch up */
+#define APP_TRACE_DUMP_BATCH            (8u)
+#define APP_TRACE_DUMP_PAUSE_MS         (60u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+typedef struct
+{
+    uint32_t            magic;
+    uint32_t            head;       /* Next entry written */
+    uint32_t            count;      /* Valid entries, up to APP_TRACE_ENTRIES */
+    uint32_t            check;      /* magic ^ head ^ count */
+    app_trace_entry_t   entry[APP_TRACE_ENTRIES];
+} app_trace_ring_t;
+
+/* Not cleared by the startup code, survives a software or watchdog reset */
+static app_trace_ring_t app_trace_ring __attribute__((section(".noinit")));
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_trace_task(void *arg);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_trace_init
+*
+* Function Description:
+* @brief  Keeps the ring of the previous run when its header is intact,
+*         clears it otherwise, and records the boot. When entries of the
+*         previous run are present, a task prints the ring once the
+*         scheduler runs. Call before the scheduler starts.
+*
+* @return void
+*/
+void app_trace_init(void)
+{
+    bool retained = (APP_TRACE_MAGIC == app_trace_ring.magic) &&
+                    (app_trace_ring.head < APP_TRACE_ENTRIES) &&
+                    (app_trace_ring.count <= APP_TRACE_ENTRIES) &&
+                    (app_trace_ring.check == (APP_TRACE_MAGIC ^ app_trace_ring.head ^
+                                              app_trace_ring.count));
+
+    if (!retained)
+    {
+        memset(&app_trace_ring, 0, sizeof(app_trace_ring));
+        app_trace_ring.magic = APP_TRACE_MAGIC;
+        app_trace_ring.check = APP_TRACE_MAGIC;
+    }
+
+    /* Timestamps come from the DWT cycle counter */
+    app_log_cycles_enable();
+
+    app_trace_record(APP_TRACE_BOOT, 0, 0, 0, (uint16_t)Cy_SysLib_GetResetReason());
+
+    if (retained && (app_trace_ring.count > 1u))
+    {
+        if (pdPASS != xTaskCreate(app_trace_task, APP_TRACE_TASK_NAME,
+                                  APP_TRACE_TASK_STACK_SIZE, NULL,
+                                  APP_TRACE_TASK_PRIORITY, NULL))
+        {
+            APP_LOG_ERR("Trace task creation failed\r\n");
+        }
+    }
+}
+
+/**
+* Function Name:
+* app_trace_record
+*
+* Function Description:
+* @brief  Appends one entry, overwriting the oldest when the ring is full.
+*         Safe from any task or interrupt.
+*
+* @param id         Event identifier
+*
+* @param code       Event code, see app_trace_id_t
+*
+* @param conn_id    Connection ID, 0 when not connection related
+*
+* @param handle     Attribute handle or other event data
+*
+* @param arg        Status, opcode or length
+*
+* @return void
+*/
+void app_trace_record(app_trace_id_t id, uint8_t code, uint16_t conn_id,
+                      uint16_t handle, uint16_t arg)
+{
+    uint32_t primask = __get_PRIMASK();
+    app_trace_entry_t *p_entry;
+
+    __disable_irq();
+    p_entry = &app_trace_ring.entry[app_trace_ring.head];
+    p_entry->cycles  = DWT->CYCCNT;
+    p_entry->ms      = (uint32_t)xTaskGetTickCountFromISR();
+    p_entry->id      = (uint8_t)id;
+    p_entry->code    = code;
+    p_entry->conn_id = conn_id;
+    p_entry->handle  = handle;
+    p_entry->arg     = arg;
+
+    app_trace_ring.head = (app_trace_ring.head + 1u) & (APP_TRACE_ENTRIES - 1u);
+    if (app_trace_ring.count < APP_TRACE_ENTRIES)
+    {
+        app_trace_ring.count++;
+    }
+    app_trace_ring.check = APP_TRACE_MAGIC ^ app_trace_ring.head ^ app_trace_ring.count;
+    __set_PRIMASK(primask);
+}
+
+/**
+* Function Name:
+* app_trace_code_name
+*
+* Function Description:
+* @brief  Name of the event code of an entry
+*
+* @param p_entry      Entry
+*
+* @return const char*  Name, "-" when the code has no name
+*/
+static const char *app_trace_code_name(const app_trace_entry_t *p_entry)
+{
+    switch (p_entry->id)
+    {
+    case APP_TRACE_BOOT:
+        return "BOOT";
+    case APP_TRACE_BTM:
+        return get_bt_event_name((wiced_bt_management_evt_t)p_entry->code);
+    case APP_TRACE_GATT:
+        return get_bt_gatt_event_name((wiced_bt_gatt_evt_t)p_entry->code);
+    case APP_TRACE_WRITE:
+        return "WRITE";
+    case APP_TRACE_MEM_READ:
+        return "MEM_READ";
+    case APP_TRACE_MEM_WRITE:
+        return "MEM_WRITE";
+    case APP_TRACE_MEM_ERASE:
+        return "MEM_ERASE";
+    default:
+        return "-";
+    }
+}
+
+/**
+* Function Name:
+* app_trace_dump
+*
+* Function Description:
+* @brief  Prints the ring, oldest entry first, as one CSV line per entry:
+*         TRC,<index>,<cycles>,<ms>,<id>,<code>,<conn_id>,<handle>,<arg>,<name>
+*         after a TRC-HDR,<cycles per us>,<entries> line. Entries recorded
+*         while printing are left for the next dump. Blocks between batches
+*         so that the log ring does not overflow, call from a task.
+*
+* @return void
+*/
+void app_trace_dump(void)
+{
+    app_trace_entry_t entry;
+    uint32_t count;
+    uint32_t first;
+    uint32_t i;
+
+    taskENTER_CRITICAL();
+    count = app_trace_ring.count;
+    first = (app_trace_ring.head - count) & (APP_TRACE_ENTRIES - 1u);
+    taskEXIT_CRITICAL();
+
+    printf("TRC-HDR,%lu,%lu\r\n", (unsigned long)(SystemCoreClock / 1000000u),
+           (unsigned long)count);
+    for (i = 0; i < count; i++)
+    {
+        taskENTER_CRITICAL();
+        entry = app_trace_ring.entry[(first + i) & (APP_TRACE_ENTRIES - 1u)];
+        taskEXIT_CRITICAL();
+
+        printf("TRC,%lu,%lu,%lu,%u,%u,%u,%u,%u,%s\r\n", (unsigned long)i,
+               (unsigned long)entry.cycles, (unsigned long)entry.ms,
+               entry.id, entry.code, entry.conn_id, entry.handle, entry.arg,
+               app_trace_code_name(&entry));
+
+        if ((APP_TRACE_DUMP_BATCH - 1u) == (i % APP_TRACE_DUMP_BATCH))
+        {
+            vTaskDelay(pdMS_TO_TICKS(APP_TRACE_DUMP_PAUSE_MS));
+        }
+    }
+    printf("TRC-END\r\n");
+}
+
+/**
+* Function Name:
+* app_trace_task
+*
+* Function Description:
+* @brief  Prints the trace retained from the previous run, then exits
+*
+* @param arg        Unused
+*
+* @return void
+*/
+static void app_trace_task(void *arg)
+{
+    (void)arg;
+
+    app_trace_dump();
+    vTaskDelete(NULL);
+}
+
+#endif /* APP_TRACE */
+
+/* [] END OF FILE */
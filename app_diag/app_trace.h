@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * File Name: app_trace.h
+ *
+ * Description: This file is the public interface of app_trace.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_TRACE_H__
+#define APP_TRACE_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Entries kept in the trace ring, must be a power of 2
+ */
+#define APP_TRACE_ENTRIES               (256u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Trace event identifiers. The meaning of the code, handle and arg
+ *        fields of an entry depends on the identifier.
+ */
+typedef enum
+{
+    APP_TRACE_BOOT = 1,     /* code: 0, arg: reset reason (low 16 bits) */
+    APP_TRACE_BTM,          /* code: wiced_bt_management_evt_t, arg: status, advertising mode or connection interval */
+    APP_TRACE_GATT,         /* code: wiced_bt_gatt_evt_t, conn_id, handle: attribute, arg: opcode or connected */
+    APP_TRACE_WRITE,        /* conn_id, handle: attribute written, arg: value length */
+    APP_TRACE_MEM_READ,     /* code: cy_ota_mem_type_t, handle: addr / 4 KB, arg: length */
+    APP_TRACE_MEM_WRITE,    /* code: cy_ota_mem_type_t, handle: addr / 4 KB, arg: length */
+    APP_TRACE_MEM_ERASE,    /* code: cy_ota_mem_type_t, handle: addr / 4 KB, arg: length / 256 */
+} app_trace_id_t;
+
+/**
+ * @brief One trace entry
+ */
+typedef struct
+{
+    uint32_t    cycles;     /* DWT CYCCNT when the event was recorded */
+    uint32_t    ms;         /* RTOS tick count (ms), to order entries across CYCCNT wraps */
+    uint8_t     id;         /* app_trace_id_t */
+    uint8_t     code;
+    uint16_t    conn_id;
+    uint16_t    handle;
+    uint16_t    arg;
+} app_trace_entry_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if APP_TRACE
+void app_trace_init  (void);
+void app_trace_record(app_trace_id_t id, uint8_t code, uint16_t conn_id,
+                      uint16_t handle, uint16_t arg);
+void app_trace_dump  (void);
+#else
+#define app_trace_init()
+#define app_trace_record(id, code, conn_id, handle, arg) \
+    ((void)(id), (void)(code), (void)(conn_id), (void)(handle), (void)(arg))
+#define app_trace_dump()
+#endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,1199 @@
+/*******************************************************************************
+ * File Name: app_log.c
+ *
+ * Description: This file keeps the per-module log levels and implements
+ *              deferred logging. printf() and cy_log messages are queued as
+ *              binary records in a lock-free RAM ring and formatted and sent
+ *              to the debug UART by an idle priority task.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "app_log.h"
+#include "app_monitor.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Run-time level of each module, see APP_LOG_MSG()
+ */
+CY_LOG_LEVEL_T app_log_level[APP_LOG_MOD_COUNT] =
+{
+    [0 ... (APP_LOG_MOD_COUNT - 1)] = CY_LOG_INFO
+};
+
+/* Cycles spent in APP_LOG_* calls, see app_log_cpu_stats() */
+static uint64_t app_log_caller_cycles;
+
+static const char *const app_log_module_name[APP_LOG_MOD_COUNT] =
+{
+    [APP_LOG_MOD_BT]    = "BT",
+    [APP_LOG_MOD_GATT]  = "GATT",
+    [APP_LOG_MOD_OTA]   = "OTA",
+    [APP_LOG_MOD_FLASH] = "FLASH",
+    [APP_LOG_MOD_BAS]   = "BAS",
+    [APP_LOG_MOD_SYS]   = "SYS",
+};
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_log_add_cycles
+*
+* Function Description:
+* @brief  Adds the cycles elapsed since start to a 64-bit total. The short
+*         critical section keeps the total consistent across tasks.
+*
+* @param p_total    Total to add to
+*
+* @param start      app_log_cycles() at the start of the measured code
+*
+* @return void
+*/
+static void app_log_add_cycles(uint64_t *p_total, uint32_t start)
+{
+    uint32_t delta = app_log_cycles() - start;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *p_total += delta;
+    __set_PRIMASK(primask);
+}
+
+#if APP_LOG_DEFERRED
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_LOG_TASK_NAME               "Log Task"
+#define APP_LOG_TASK_STACK_SIZE         (512u)
+#define APP_LOG_TASK_PRIORITY           (tskIDLE_PRIORITY)
+
+/* Bytes of each of the two UART transmit buffers, and of one formatted record */
+#define APP_LOG_TX_BUF_SIZE             (320u)
+#define APP_LOG_LINE_SIZE               (160u)
+
+#if APP_LOG_TOKENIZED
+/* Frame on the UART: sync byte, payload length, payload, sum of the payload
+ * bytes. The payload starts with the token, token 0 carries plain text. */
+#define APP_LOG_FRAME_SYNC              (0xA5u)
+#define APP_LOG_FRAME_MAX_PAYLOAD       (255u)
+#define APP_LOG_OUT_SIZE                (APP_LOG_FRAME_MAX_PAYLOAD + 3u)
+#else
+#define APP_LOG_OUT_SIZE                (APP_LOG_LINE_SIZE)
+#endif
+
+/* Longest conversion specification kept, "%-+#012.10lld" and the like */
+#define APP_LOG_SPEC_SIZE               (24u)
+
+/* Record header: magic, record type and length in words, header included.
+ * A header word is never 0, 0 marks a record that is not committed yet. */
+#define APP_LOG_MAGIC                   (0xA5u)
+#define APP_LOG_HDR(type, words)        (((uint32_t)APP_LOG_MAGIC << 24) | \
+                                         ((uint32_t)(type) << 16) | (uint32_t)(words))
+#define APP_LOG_HDR_MAGIC(hdr)          ((uint8_t)((hdr) >> 24))
+#define APP_LOG_HDR_TYPE(hdr)           ((uint8_t)((hdr) >> 16))
+#define APP_LOG_HDR_WORDS(hdr)          ((uint16_t)(hdr))
+
+#define APP_LOG_WORDS(bytes)            (((bytes) + 3u) / 4u)
+#define APP_LOG_MIN(a, b)               (((a) < (b)) ? (a) : (b))
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Record types
+ */
+typedef enum
+{
+    APP_LOG_REC_PRINTF = 1,     /* Format pointer, then the arguments */
+    APP_LOG_REC_TEXT,           /* Byte length, then the text */
+    APP_LOG_REC_SKIP,           /* Unused words up to the end of the ring */
+    APP_LOG_REC_TOKEN,          /* Token, argument classes, then the arguments */
+} app_log_rec_t;
+
+/**
+ * @brief Storage class of the argument of one conversion specification
+ */
+typedef enum
+{
+    APP_LOG_ARG_NONE,           /* "%%", nothing stored */
+    APP_LOG_ARG_INT,            /* Any 32-bit value, pointers included */
+    APP_LOG_ARG_INT64,          /* "ll" and "j" conversions */
+    APP_LOG_ARG_DOUBLE,         /* Floating point conversions */
+    APP_LOG_ARG_STR,            /* "%s", length word then the bytes */
+    APP_LOG_ARG_COUNT,          /* "%n", the pointer is consumed and dropped */
+} app_log_arg_t;
+
+/**
+ * @brief Ring of records. Producers reserve words by moving app_log_head with
+ *        a compare and swap, the log task is the only consumer and moves
+ *        app_log_tail. Both indexes run free, the position is index & mask.
+ */
+static uint32_t app_log_ring[APP_LOG_RING_WORDS];
+static volatile uint32_t app_log_head;
+static volatile uint32_t app_log_tail;
+static volatile uint32_t app_log_dropped_count;
+
+/* Set by the log task right before it blocks on an empty ring */
+static volatile bool app_log_waiting;
+
+static TaskHandle_t app_log_task_handle;
+static SemaphoreHandle_t app_log_tx_done;
+static StaticSemaphore_t app_log_tx_done_buf;
+
+static uint8_t app_log_tx_buf[2][APP_LOG_TX_BUF_SIZE];
+
+/* Cycles spent by the log task on records, see app_log_cpu_stats() */
+static uint64_t app_log_task_cycles;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+int __wrap_printf(const char *fmt, ...);
+static void app_log_task(void *pvParam);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_log_spec
+*
+* Function Description:
+* @brief  Parses one conversion specification. Used by the producers to know
+*         what to take from the argument list and by the log task to replay it.
+*
+* @param p          Points to the '%' starting the specification
+*
+* @param p_spec     Receives the specification, NUL terminated
+*
+* @param p_arg      Receives the storage class of the argument
+*
+* @param p_stars    Receives the number of '*' width and precision arguments
+*
+* @return const char*  First character after the specification
+*/
+static const char *app_log_spec(const char *p, char *p_spec,
+                                app_log_arg_t *p_arg, uint8_t *p_stars)
+{
+    uint8_t len = 0;
+    uint8_t longs = 0;
+
+    *p_stars = 0;
+    *p_arg = APP_LOG_ARG_NONE;
+    p_spec[len++] = *p++;
+
+    while ((*p != '\0') && (len < (APP_LOG_SPEC_SIZE - 1u)))
+    {
+        char c = *p++;
+
+        p_spec[len++] = c;
+        if (c == '*')
+        {
+            (*p_stars)++;
+        }
+        else if ((c == 'l') || (c == 'j'))
+        {
+            longs += (c == 'j') ? 2u : 1u;
+        }
+        else if (strchr("-+ #0123456789.hLqzt", c) == NULL)
+        {
+            /* Conversion character ends the specification */
+            if (strchr("diouxXcp", c) != NULL)
+            {
+                *p_arg = (longs >= 2u) ? APP_LOG_ARG_INT64 : APP_LOG_ARG_INT;
+            }
+            else if (strchr("fFeEgGaA", c) != NULL)
+            {
+                *p_arg = APP_LOG_ARG_DOUBLE;
+            }
+            else if (c == 's')
+            {
+                *p_arg = APP_LOG_ARG_STR;
+            }
+            else if (c == 'n')
+            {
+                *p_arg = APP_LOG_ARG_COUNT;
+            }
+            break;
+        }
+    }
+    p_spec[len] = '\0';
+    return p;
+}
+
+/**
+* Function Name:
+* app_log_reserve
+*
+* Function Description:
+* @brief  Reserves contiguous words in the ring. Words left at the end of the
+*         ring are covered by a skip record. Safe from tasks and interrupts.
+*
+* @param words      Words to reserve, header included
+*
+* @return uint32_t*  First reserved word, NULL when the ring is full
+*/
+static uint32_t *app_log_reserve(uint32_t words)
+{
+    uint32_t head = __atomic_load_n(&app_log_head, __ATOMIC_RELAXED);
+    uint32_t tail;
+    uint32_t pos;
+    uint32_t pad;
+
+    do
+    {
+        tail = __atomic_load_n(&app_log_tail, __ATOMIC_ACQUIRE);
+        pos = head & (APP_LOG_RING_WORDS - 1u);
+        pad = ((pos + words) > APP_LOG_RING_WORDS) ? (APP_LOG_RING_WORDS - pos) : 0u;
+        if ((head + pad + words - tail) > APP_LOG_RING_WORDS)
+        {
+            __atomic_fetch_add(&app_log_dropped_count, 1u, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&app_log_head, &head, head + pad + words,
+                                          true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (0u != pad)
+    {
+        __atomic_store_n(&app_log_ring[pos], APP_LOG_HDR(APP_LOG_REC_SKIP, pad),
+                         __ATOMIC_RELEASE);
+        pos = 0;
+    }
+    return &app_log_ring[pos];
+}
+
+/**
+* Function Name:
+* app_log_commit
+*
+* Function Description:
+* @brief  Copies a record into reserved words and publishes it by writing the
+*         header last. Wakes the log task if it waits for records.
+*
+* @param type       Record type
+*
+* @param p_words    Record payload
+*
+* @param words      Payload length in words
+*
+* @return void
+*/
+static void app_log_commit(app_log_rec_t type, const uint32_t *p_words, uint32_t words)
+{
+    uint32_t *p_rec = app_log_reserve(words + 1u);
+
+    if (NULL == p_rec)
+    {
+        return;
+    }
+    memcpy(&p_rec[1], p_words, words * sizeof(uint32_t));
+    __atomic_store_n(&p_rec[0], APP_LOG_HDR(type, words + 1u), __ATOMIC_RELEASE);
+
+    if (app_log_waiting)
+    {
+        app_log_waiting = false;
+        if (xPortIsInsideInterrupt())
+        {
+            BaseType_t woken = pdFALSE;
+
+            vTaskNotifyGiveFromISR(app_log_task_handle, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+        else
+        {
+            xTaskNotifyGive(app_log_task_handle);
+        }
+    }
+}
+
+/**
+* Function Name:
+* __wrap_printf
+*
+* Function Description:
+* @brief  Replaces printf() at link time. Stores the format pointer and the
+*         raw arguments; formatting and UART output happen in the log task.
+*
+* @param fmt        Format string, must stay valid (string literal)
+*
+* @return int       Always 0, the length is not known yet
+*/
+int __wrap_printf(const char *fmt, ...)
+{
+    uint32_t words[APP_LOG_MAX_RECORD_WORDS - 1u];
+    uint32_t n = 0;
+    char spec[APP_LOG_SPEC_SIZE];
+    app_log_arg_t arg;
+    uint8_t stars;
+    const char *p = fmt;
+    va_list ap;
+
+    words[n++] = (uint32_t)fmt;
+
+    va_start(ap, fmt);
+    while (*p != '\0')
+    {
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+        p = app_log_spec(p, spec, &arg, &stars);
+
+        /* Worst case of one specification: 2 stars and a string */
+        if ((n + 2u + 1u + APP_LOG_WORDS(APP_LOG_MAX_STR_LEN)) > (sizeof(words) / sizeof(words[0])))
+        {
+            va_end(ap);
+            __atomic_fetch_add(&app_log_dropped_count, 1u, __ATOMIC_RELAXED);
+            return 0;
+        }
+        while (stars-- > 0u)
+        {
+            words[n++] = (uint32_t)va_arg(ap, int);
+        }
+        switch (arg)
+        {
+        case APP_LOG_ARG_INT:
+        case APP_LOG_ARG_COUNT:
+            words[n++] = va_arg(ap, uint32_t);
+            break;
+
+        case APP_LOG_ARG_INT64:
+        {
+            uint64_t value = va_arg(ap, uint64_t);
+
+            memcpy(&words[n], &value, sizeof(value));
+            n += 2u;
+            break;
+        }
+
+        case APP_LOG_ARG_DOUBLE:
+        {
+            double value = va_arg(ap, double);
+
+            memcpy(&words[n], &value, sizeof(value));
+            n += 2u;
+            break;
+        }
+
+        case APP_LOG_ARG_STR:
+        {
+            /* The string may live on the caller's stack, keep a copy */
+            const char *str = va_arg(ap, const char *);
+            uint32_t len = (NULL == str) ? 0u : strnlen(str, APP_LOG_MAX_STR_LEN);
+
+            words[n++] = len;
+            memcpy(&words[n], str, len);
+            n += APP_LOG_WORDS(len);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+    va_end(ap);
+
+    app_log_commit(APP_LOG_REC_PRINTF, words, n);
+    return 0;
+}
+
+/**
+* Function Name:
+* app_log_cy_log_output
+*
+* Function Description:
+* @brief  cy_log output function. cy_log formats the message itself, the text
+*         is queued as it is.
+*
+* @param facility   Unused
+*
+* @param level      Unused
+*
+* @param logmsg     Formatted message
+*
+* @return int       Always 0
+*/
+int app_log_cy_log_output(CY_LOG_FACILITY_T facility, CY_LOG_LEVEL_T level,
+                          char *logmsg)
+{
+    uint32_t words[1u + APP_LOG_WORDS(APP_LOG_MAX_TEXT_LEN)];
+    uint32_t len = strnlen(logmsg, APP_LOG_MAX_TEXT_LEN);
+
+    (void)facility;
+    (void)level;
+
+    words[0] = len;
+    memcpy(&words[1], logmsg, len);
+    app_log_commit(APP_LOG_REC_TEXT, words, 1u + APP_LOG_WORDS(len));
+    return 0;
+}
+
+#if APP_LOG_TOKENIZED
+/**
+* Function Name:
+* app_log_tok_printf
+*
+* Function Description:
+* @brief  printf() of the files that include app_log.h. The format string is
+*         not on the device, the argument classes come from the call site.
+*
+* @param token      Token of the format string
+*
+* @param types      Argument count and classes, see APP_LOG_TYPES()
+*
+* @return int       Always 0
+*/
+int app_log_tok_printf(uint32_t token, uint32_t types, ...)
+{
+    uint32_t words[APP_LOG_MAX_RECORD_WORDS - 1u];
+    uint32_t n = 0;
+    uint32_t count = types & 0x0Fu;
+    va_list ap;
+
+    words[n++] = token;
+    words[n++] = types;
+
+    va_start(ap, types);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        /* Worst case of one argument is a string */
+        if ((n + 1u + APP_LOG_WORDS(APP_LOG_MAX_STR_LEN)) > (sizeof(words) / sizeof(words[0])))
+        {
+            va_end(ap);
+            __atomic_fetch_add(&app_log_dropped_count, 1u, __ATOMIC_RELAXED);
+            return 0;
+        }
+        switch ((types >> (4u + (2u * i))) & 0x03u)
+        {
+        case APP_LOG_TYPE_INT:
+            words[n++] = va_arg(ap, uint32_t);
+            break;
+
+        case APP_LOG_TYPE_INT64:
+        {
+            uint64_t value = va_arg(ap, uint64_t);
+
+            memcpy(&words[n], &value, sizeof(value));
+            n += 2u;
+            break;
+        }
+
+        case APP_LOG_TYPE_DOUBLE:
+        {
+            double value = va_arg(ap, double);
+
+            memcpy(&words[n], &value, sizeof(value));
+            n += 2u;
+            break;
+        }
+
+        case APP_LOG_TYPE_STR:
+        default:
+        {
+            const char *str = va_arg(ap, const char *);
+            uint32_t len = (NULL == str) ? 0u : strnlen(str, APP_LOG_MAX_STR_LEN);
+
+            words[n++] = len;
+            memcpy(&words[n], str, len);
+            n += APP_LOG_WORDS(len);
+            break;
+        }
+        }
+    }
+    va_end(ap);
+
+    app_log_commit(APP_LOG_REC_TOKEN, words, n);
+    return 0;
+}
+#endif /* APP_LOG_TOKENIZED */
+
+/**
+* Function Name:
+* app_log_dropped
+*
+* Function Description:
+* @brief  Returns the number of records dropped on a full ring since boot
+*
+* @return uint32_t  Dropped records
+*/
+uint32_t app_log_dropped(void)
+{
+    return __atomic_load_n(&app_log_dropped_count, __ATOMIC_RELAXED);
+}
+
+/**
+* Function Name:
+* app_log_flush
+*
+* Function Description:
+* @brief  Waits until every record has been sent out of the UART, for
+*         example before a reset. The log task runs at idle priority, so the
+*         caller sleeps while it drains the ring.
+*
+* @param timeout_ms Longest wait
+*
+* @return bool      true when the output is complete
+*/
+bool app_log_flush(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    /* Drained: the task found the ring empty and the last buffer is out */
+    while (!app_log_waiting || (app_log_head != app_log_tail) ||
+           (0u == uxSemaphoreGetCount(app_log_tx_done)))
+    {
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms))
+        {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+/**
+* Function Name:
+* app_log_pop
+*
+* Function Description:
+* @brief  Copies the oldest committed record out of the ring and releases its
+*         words. Skip records are consumed silently.
+*
+* @param p_rec      Receives the record, APP_LOG_MAX_RECORD_WORDS words
+*
+* @return uint32_t  Words copied, 0 when no record is committed
+*/
+static uint32_t app_log_pop(uint32_t *p_rec)
+{
+    uint32_t tail = app_log_tail;
+    uint32_t pos;
+    uint32_t hdr;
+    uint32_t words;
+
+    while (true)
+    {
+        pos = tail & (APP_LOG_RING_WORDS - 1u);
+        hdr = __atomic_load_n(&app_log_ring[pos], __ATOMIC_ACQUIRE);
+        if (0u == hdr)
+        {
+            return 0;
+        }
+        words = APP_LOG_HDR_WORDS(hdr);
+        /* A damaged header would stall the ring, resynchronize on the head */
+        if ((APP_LOG_MAGIC != APP_LOG_HDR_MAGIC(hdr)) || (0u == words) ||
+            ((pos + words) > APP_LOG_RING_WORDS))
+        {
+            words = (__atomic_load_n(&app_log_head, __ATOMIC_ACQUIRE) - tail);
+            words = APP_LOG_MIN(words, APP_LOG_RING_WORDS - pos);
+            memset(&app_log_ring[pos], 0, words * sizeof(uint32_t));
+            tail += words;
+            __atomic_store_n(&app_log_tail, tail, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        if ((APP_LOG_REC_SKIP != APP_LOG_HDR_TYPE(hdr)) &&
+            (words <= APP_LOG_MAX_RECORD_WORDS))
+        {
+            memcpy(p_rec, &app_log_ring[pos], words * sizeof(uint32_t));
+        }
+        else
+        {
+            p_rec[0] = APP_LOG_HDR(APP_LOG_REC_SKIP, words);
+        }
+
+        /* Cleared words read as uncommitted on the next lap */
+        memset(&app_log_ring[pos], 0, words * sizeof(uint32_t));
+        tail += words;
+        __atomic_store_n(&app_log_tail, tail, __ATOMIC_RELEASE);
+
+        if (APP_LOG_REC_SKIP != APP_LOG_HDR_TYPE(p_rec[0]))
+        {
+            return words;
+        }
+    }
+}
+
+/**
+* Function Name:
+* app_log_format
+*
+* Function Description:
+* @brief  Replays a printf record into text, one specification at a time
+*
+* @param p_rec      Record, header included
+*
+* @param words      Record length in words
+*
+* @param p_line     Output buffer of APP_LOG_LINE_SIZE bytes
+*
+* @return uint32_t  Length of the text, truncated to the buffer
+*/
+static uint32_t app_log_format(const uint32_t *p_rec, uint32_t words, char *p_line)
+{
+    const char *p = (const char *)p_rec[1];
+    uint32_t n = 2;
+    uint32_t used = 0;
+    char spec[APP_LOG_SPEC_SIZE];
+    char expanded[APP_LOG_SPEC_SIZE + 16u];
+    app_log_arg_t arg;
+    uint8_t stars;
+    int len;
+
+    while ((*p != '\0') && (used < (APP_LOG_LINE_SIZE - 1u)))
+    {
+        if (*p != '%')
+        {
+            p_line[used++] = *p++;
+            continue;
+        }
+        p = app_log_spec(p, spec, &arg, &stars);
+
+        /* '*' arguments are written into the specification */
+        {
+            uint32_t e = 0;
+
+            for (const char *s = spec; (*s != '\0') && (e < (sizeof(expanded) - 12u)); s++)
+            {
+                if ((*s == '*') && (n < words))
+                {
+                    e += (uint32_t)snprintf(&expanded[e], sizeof(expanded) - e, "%ld",
+                                            (long)(int32_t)p_rec[n++]);
+                }
+                else
+                {
+                    expanded[e++] = *s;
+                }
+            }
+            expanded[e] = '\0';
+        }
+
+        len = 0;
+        switch (arg)
+        {
+        case APP_LOG_ARG_NONE:
+            len = snprintf(&p_line[used], APP_LOG_LINE_SIZE - used, "%s",
+                           (spec[1] == '%') ? "%" : spec);
+            break;
+
+        case APP_LOG_ARG_INT:
+            if (n < words)
+            {
+                len = snprintf(&p_line[used], APP_LOG_LINE_SIZE - used, expanded, p_rec[n]);
+            }
+            n += 1u;
+            break;
+
+        case APP_LOG_ARG_INT64:
+        case APP_LOG_ARG_DOUBLE:
+            if ((n + 1u) < words)
+            {
+                uint64_t raw;
+                double value;
+
+                memcpy(&raw, &p_rec[n], sizeof(raw));
+                memcpy(&value, &raw, sizeof(value));
+                len = (APP_LOG_ARG_INT64 == arg) ?
+                      snprintf(&p_line[used], APP_LOG_LINE_SIZE - used, expanded, raw) :
+                      snprintf(&p_line[used], APP_LOG_LINE_SIZE - used, expanded, value);
+            }
+            n += 2u;
+            break;
+
+        case APP_LOG_ARG_STR:
+            if (n < words)
+            {
+                char str[APP_LOG_MAX_STR_LEN + 1u];
+                uint32_t str_len = APP_LOG_MIN(p_rec[n], APP_LOG_MAX_STR_LEN);
+
+                memcpy(str, &p_rec[n + 1u], str_len);
+                str[str_len] = '\0';
+                len = snprintf(&p_line[used], APP_LOG_LINE_SIZE - used, expanded, str);
+                n += 1u + APP_LOG_WORDS(str_len);
+            }
+            break;
+
+        case APP_LOG_ARG_COUNT:
+        default:
+            n += 1u;
+            break;
+        }
+        if (len > 0)
+        {
+            used = APP_LOG_MIN(used + (uint32_t)len, APP_LOG_LINE_SIZE - 1u);
+        }
+    }
+    return used;
+}
+
+/**
+* Function Name:
+* app_log_uart_event
+*
+* Function Description:
+* @brief  UART interrupt callback, releases the transmit buffer when the
+*         asynchronous write completes
+*
+* @param callback_arg Unused
+*
+* @param event        UART events
+*
+* @return void
+*/
+static void app_log_uart_event(void *callback_arg, cyhal_uart_event_t event)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)callback_arg;
+
+    if (0u != (event & CYHAL_UART_IRQ_TX_DONE))
+    {
+        xSemaphoreGiveFromISR(app_log_tx_done, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+* Function Name:
+* app_log_send
+*
+* Function Description:
+* @brief  Starts the transmission of one buffer once the previous one is done
+*
+* @param p_buf      Buffer to send, must not be touched until the next call
+*
+* @param len        Bytes to send
+*
+* @return void
+*/
+static void app_log_send(uint8_t *p_buf, size_t len)
+{
+    xSemaphoreTake(app_log_tx_done, portMAX_DELAY);
+    if (CY_RSLT_SUCCESS != cyhal_uart_write_async(&cy_retarget_io_uart_obj, p_buf, len))
+    {
+        /* UART busy with another writer, fall back to a blocking write */
+        cyhal_uart_write(&cy_retarget_io_uart_obj, p_buf, &len);
+        xSemaphoreGive(app_log_tx_done);
+    }
+}
+
+/**
+* Function Name:
+* app_log_text
+*
+* Function Description:
+* @brief  Turns a record into text
+*
+* @param p_rec      Record, header included
+*
+* @param words      Record length in words
+*
+* @param p_line     Output buffer of APP_LOG_LINE_SIZE bytes
+*
+* @return uint32_t  Length of the text
+*/
+static uint32_t app_log_text(const uint32_t *p_rec, uint32_t words, char *p_line)
+{
+    uint32_t len;
+
+    if (APP_LOG_REC_TEXT == APP_LOG_HDR_TYPE(p_rec[0]))
+    {
+        len = APP_LOG_MIN(p_rec[1], APP_LOG_LINE_SIZE);
+        memcpy(p_line, &p_rec[2], len);
+        return len;
+    }
+    return app_log_format(p_rec, words, p_line);
+}
+
+#if APP_LOG_TOKENIZED
+/**
+* Function Name:
+* app_log_put_varint
+*
+* Function Description:
+* @brief  Writes an unsigned LEB128 value, 7 bits per byte
+*
+* @param p_out      Output position
+*
+* @param value      Value
+*
+* @return uint8_t*  Position after the value
+*/
+static uint8_t *app_log_put_varint(uint8_t *p_out, uint64_t value)
+{
+    while (value >= 0x80u)
+    {
+        *p_out++ = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    *p_out++ = (uint8_t)value;
+    return p_out;
+}
+
+/**
+* Function Name:
+* app_log_output
+*
+* Function Description:
+* @brief  Turns a record into one UART frame. Tokenized records keep their
+*         token and get their integers varint encoded, other records are
+*         formatted here and sent as text under token 0.
+*
+* @param p_rec      Record, header included
+*
+* @param words      Record length in words
+*
+* @param p_out      Output buffer of APP_LOG_OUT_SIZE bytes
+*
+* @return uint32_t  Length of the frame
+*/
+static uint32_t app_log_output(const uint32_t *p_rec, uint32_t words, uint8_t *p_out)
+{
+    uint8_t *p = &p_out[2];
+    uint8_t sum = 0;
+    uint32_t len;
+
+    if (APP_LOG_REC_TOKEN == APP_LOG_HDR_TYPE(p_rec[0]))
+    {
+        uint32_t types = p_rec[2];
+        uint32_t count = types & 0x0Fu;
+        uint32_t n = 3;
+
+        memcpy(p, &p_rec[1], sizeof(uint32_t));
+        p += sizeof(uint32_t);
+        for (uint32_t i = 0; (i < count) && (n < words); i++)
+        {
+            switch ((types >> (4u + (2u * i))) & 0x03u)
+            {
+            case APP_LOG_TYPE_INT:
+                p = app_log_put_varint(p, p_rec[n]);
+                n += 1u;
+                break;
+
+            case APP_LOG_TYPE_INT64:
+            {
+                uint64_t value;
+
+                memcpy(&value, &p_rec[n], sizeof(value));
+                p = app_log_put_varint(p, value);
+                n += 2u;
+                break;
+            }
+
+            case APP_LOG_TYPE_DOUBLE:
+                memcpy(p, &p_rec[n], sizeof(double));
+                p += sizeof(double);
+                n += 2u;
+                break;
+
+            case APP_LOG_TYPE_STR:
+            default:
+                *p++ = (uint8_t)p_rec[n];
+                memcpy(p, &p_rec[n + 1u], p_rec[n]);
+                p += p_rec[n];
+                n += 1u + APP_LOG_WORDS(p_rec[n]);
+                break;
+            }
+        }
+        len = (uint32_t)(p - &p_out[2]);
+    }
+    else
+    {
+        memset(p, 0, sizeof(uint32_t));
+        len = sizeof(uint32_t) + app_log_text(p_rec, words, (char *)&p[sizeof(uint32_t)]);
+    }
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        sum += p_out[2u + i];
+    }
+    p_out[0] = APP_LOG_FRAME_SYNC;
+    p_out[1] = (uint8_t)len;
+    p_out[2u + len] = sum;
+    return len + 3u;
+}
+#else
+#define app_log_output(p_rec, words, p_out) app_log_text((p_rec), (words), (char *)(p_out))
+#endif /* APP_LOG_TOKENIZED */
+
+/**
+* Function Name:
+* app_log_task
+*
+* Function Description:
+* @brief  Drains the ring. Records are formatted into one buffer while the
+*         other one is transmitted.
+*
+* @param pvParam    Unused
+*
+* @return void
+*/
+static void app_log_task(void *pvParam)
+{
+    static uint32_t rec[APP_LOG_MAX_RECORD_WORDS];
+    static uint8_t line[APP_LOG_OUT_SIZE];
+    uint32_t reported_drops = 0;
+    uint32_t used = 0;
+    uint8_t cur = 0;
+    uint32_t words;
+    uint32_t len;
+    uint32_t start;
+
+    (void)pvParam;
+
+    while (true)
+    {
+        start = app_log_cycles();
+        words = app_log_pop(rec);
+        if (0u != words)
+        {
+            len = app_log_output(rec, words, line);
+        }
+        else if (reported_drops != app_log_dropped())
+        {
+            reported_drops = app_log_dropped();
+            len = (uint32_t)snprintf((char *)&rec[2], APP_LOG_LINE_SIZE,
+                                     "<%lu log records dropped>\r\n",
+                                     (unsigned long)reported_drops);
+            rec[0] = APP_LOG_HDR(APP_LOG_REC_TEXT, 2u + APP_LOG_WORDS(len));
+            rec[1] = APP_LOG_MIN(len, APP_LOG_LINE_SIZE - 1u);
+            len = app_log_output(rec, APP_LOG_HDR_WORDS(rec[0]), line);
+        }
+        else if (0u != used)
+        {
+            /* Ring is empty, send what was formatted so far */
+            app_log_send(app_log_tx_buf[cur], used);
+            cur ^= 1u;
+            used = 0;
+            continue;
+        }
+        else
+        {
+            /* Look again after announcing the wait: a record committed in
+             * between is either found here or leaves a pending notification */
+            app_log_waiting = true;
+            words = app_log_pop(rec);
+            if (0u == words)
+            {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                continue;
+            }
+            app_log_waiting = false;
+            len = app_log_output(rec, words, line);
+        }
+        app_log_add_cycles(&app_log_task_cycles, start);
+
+        if ((used + len) > APP_LOG_TX_BUF_SIZE)
+        {
+            app_log_send(app_log_tx_buf[cur], used);
+            cur ^= 1u;
+            used = 0;
+        }
+        memcpy(&app_log_tx_buf[cur][used], line, len);
+        used += len;
+    }
+}
+
+/**
+* Function Name:
+* app_log_init
+*
+* Function Description:
+* @brief  Sets the debug UART up for DMA transmit and creates the log task.
+*         Must run after cy_retarget_io_init(). Records queued before the
+*         scheduler starts are sent once it runs.
+*
+* @return void
+*/
+void app_log_init(void)
+{
+    app_log_tx_done = xSemaphoreCreateBinaryStatic(&app_log_tx_done_buf);
+    xSemaphoreGive(app_log_tx_done);
+
+    if (CY_RSLT_SUCCESS != cyhal_uart_set_async_mode(&cy_retarget_io_uart_obj,
+                                                     CYHAL_ASYNC_DMA,
+                                                     CYHAL_DMA_PRIORITY_DEFAULT))
+    {
+        /* No DMA channel, the HAL moves the data from the UART interrupt */
+        cyhal_uart_set_async_mode(&cy_retarget_io_uart_obj, CYHAL_ASYNC_SW,
+                                  CYHAL_DMA_PRIORITY_DEFAULT);
+    }
+    cyhal_uart_register_callback(&cy_retarget_io_uart_obj, app_log_uart_event, NULL);
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj, CYHAL_UART_IRQ_TX_DONE,
+                            configLIBRARY_LOWEST_INTERRUPT_PRIORITY, true);
+
+    if (pdPASS != xTaskCreate(app_log_task, APP_LOG_TASK_NAME, APP_LOG_TASK_STACK_SIZE,
+                              NULL, APP_LOG_TASK_PRIORITY, &app_log_task_handle))
+    {
+        CY_ASSERT(0);
+    }
+    app_monitor_task_size(APP_LOG_TASK_NAME, APP_LOG_TASK_STACK_SIZE);
+}
+
+#endif /* APP_LOG_DEFERRED */
+
+/**
+* Function Name:
+* app_log_levels_init
+*
+* Function Description:
+* @brief  Sets every module, and cy_log, to one level and starts the cycle
+*         counter used to measure logging
+*
+* @param level      Initial level
+*
+* @return void
+*/
+void app_log_levels_init(CY_LOG_LEVEL_T level)
+{
+    for (uint8_t module = 0; module < APP_LOG_MOD_COUNT; module++)
+    {
+        app_log_level[module] = level;
+    }
+    cy_log_set_all_levels(level);
+
+    app_log_cycles_enable();
+}
+
+/**
+* Function Name:
+* app_log_set_level
+*
+* Function Description:
+* @brief  Changes the level of one module at run time. The OTA module also
+*         sets the level of the OTA library.
+*
+* @param module     Module
+*
+* @param level      New level, CY_LOG_OFF silences the module
+*
+* @return void
+*/
+void app_log_set_level(app_log_module_t module, CY_LOG_LEVEL_T level)
+{
+    if ((module >= APP_LOG_MOD_COUNT) || (level >= CY_LOG_MAX))
+    {
+        return;
+    }
+    app_log_level[module] = level;
+    if (APP_LOG_MOD_OTA == module)
+    {
+        cy_log_set_facility_level(CYLF_OTA, level);
+    }
+    printf("Log level of %s: %d\r\n", app_log_module_name[module], level);
+}
+
+/**
+* Function Name:
+* app_log_account
+*
+* Function Description:
+* @brief  Counts the cycles of one APP_LOG_* call
+*
+* @param start      app_log_cycles() before the call
+*
+* @return void
+*/
+void app_log_account(uint32_t start)
+{
+    app_log_add_cycles(&app_log_caller_cycles, start);
+}
+
+/**
+* Function Name:
+* app_log_cpu_stats
+*
+* Function Description:
+* @brief  Returns the CPU time spent on logging since the last reset
+*
+* @param p_stats    Receives the statistics
+*
+* @return void
+*/
+void app_log_cpu_stats(app_log_cpu_stats_t *p_stats)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+    uint32_t primask = __get_PRIMASK();
+    uint64_t caller;
+    uint64_t task = 0;
+
+    __disable_irq();
+    caller = app_log_caller_cycles;
+#if APP_LOG_DEFERRED
+    task = app_log_task_cycles;
+#endif
+    __set_PRIMASK(primask);
+
+    p_stats->caller_us = (uint32_t)(caller / cycles_per_us);
+    p_stats->task_us = (uint32_t)(task / cycles_per_us);
+}
+
+/**
+* Function Name:
+* app_log_cpu_stats_reset
+*
+* Function Description:
+* @brief  Restarts the logging CPU time measurement
+*
+* @return void
+*/
+void app_log_cpu_stats_reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    app_log_caller_cycles = 0;
+#if APP_LOG_DEFERRED
+    app_log_task_cycles = 0;
+#endif
+    __set_PRIMASK(primask);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * File Name: app_log.h
+ *
+ * Description: This file is the public interface of app_log.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_LOG_H__
+#define APP_LOG_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_device_headers.h"
+#include "cy_log.h"
+
+#if APP_LOG_TOKENIZED
+#if !APP_LOG_DEFERRED
+#error "APP_LOG_TOKENIZED requires APP_LOG_DEFERRED"
+#endif
+/* printf() of every file that includes this header sends a token */
+#include "app_log_token.h"
+#endif
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Messages less severe than the floor are removed at compile time,
+ *        whatever the run-time level of their module. Set APP_LOG_FLOOR in
+ *        the Makefile.
+ */
+#ifndef APP_LOG_LEVEL_FLOOR
+#define APP_LOG_LEVEL_FLOOR             CY_LOG_DEBUG
+#endif
+
+/**
+ * @brief Logs a message of the module named by APP_LOG_MODULE in the
+ *        calling file. CPU time spent here is counted, see
+ *        app_log_cpu_stats().
+ */
+#define APP_LOG_MSG(level, fmt, ...)                                           \
+    do                                                                         \
+    {                                                                          \
+        if (((level) <= APP_LOG_LEVEL_FLOOR) &&                                \
+            ((level) <= app_log_level[APP_LOG_MODULE]))                        \
+        {                                                                      \
+            uint32_t app_log_start_ = app_log_cycles();                        \
+            printf(fmt, ##__VA_ARGS__);                                        \
+            app_log_account(app_log_start_);                                   \
+        }                                                                      \
+    } while (0)
+
+#define APP_LOG_ERR(fmt, ...)           APP_LOG_MSG(CY_LOG_ERR, fmt, ##__VA_ARGS__)
+#define APP_LOG_WARNING(fmt, ...)       APP_LOG_MSG(CY_LOG_WARNING, fmt, ##__VA_ARGS__)
+#define APP_LOG_NOTICE(fmt, ...)        APP_LOG_MSG(CY_LOG_NOTICE, fmt, ##__VA_ARGS__)
+#define APP_LOG_INFO(fmt, ...)          APP_LOG_MSG(CY_LOG_INFO, fmt, ##__VA_ARGS__)
+#define APP_LOG_DEBUG(fmt, ...)         APP_LOG_MSG(CY_LOG_DEBUG, fmt, ##__VA_ARGS__)
+
+#if APP_LOG_DEFERRED
+/**
+ * @brief Size of the log ring in 32-bit words, must be a power of 2
+ */
+#define APP_LOG_RING_WORDS              (1024u)
+
+/**
+ * @brief Largest record, header included, in 32-bit words. A printf() whose
+ *        arguments do not fit is dropped.
+ */
+#define APP_LOG_MAX_RECORD_WORDS        (48u)
+
+/**
+ * @brief Bytes kept of each "%s" argument and of each cy_log message
+ */
+#define APP_LOG_MAX_STR_LEN             (48u)
+#define APP_LOG_MAX_TEXT_LEN            (128u)
+#else
+/* cy_log keeps its default output */
+#define app_log_cy_log_output           NULL
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Modules with their own run-time log level
+ */
+typedef enum
+{
+    APP_LOG_MOD_BT = 0,         /* Bluetooth management events */
+    APP_LOG_MOD_GATT,           /* GATT server, connections and bearers */
+    APP_LOG_MOD_OTA,            /* OTA service and the OTA library */
+    APP_LOG_MOD_FLASH,          /* OTA flash driver */
+    APP_LOG_MOD_BAS,            /* Battery Service */
+    APP_LOG_MOD_SYS,            /* RTOS and system diagnostics */
+    APP_LOG_MOD_COUNT
+} app_log_module_t;
+
+/**
+ * @brief CPU time spent on logging, in microseconds
+ */
+typedef struct
+{
+    uint32_t caller_us;         /* In the APP_LOG_* calls */
+    uint32_t task_us;           /* In the log task, formatting and sending */
+} app_log_cpu_stats_t;
+
+/* Read by every APP_LOG_* call, change with app_log_set_level() */
+extern CY_LOG_LEVEL_T app_log_level[APP_LOG_MOD_COUNT];
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void     app_log_levels_init  (CY_LOG_LEVEL_T level);
+void     app_log_set_level    (app_log_module_t module, CY_LOG_LEVEL_T level);
+void     app_log_cpu_stats    (app_log_cpu_stats_t *p_stats);
+void     app_log_cpu_stats_reset(void);
+void     app_log_account      (uint32_t start);
+
+/**
+ * @brief Free-running CPU cycle counter, DWT CYCCNT. Reads 0 when the core
+ *        has no cycle counter.
+ */
+static inline uint32_t app_log_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Starts DWT CYCCNT if the core has one. The counter is never reset,
+ *        so callers that already hold a reading keep a valid delta.
+ */
+static inline void app_log_cycles_enable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    if (0u == (DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk))
+    {
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+#if APP_LOG_DEFERRED
+/* printf() is linked to __wrap_printf(): only the format pointer and the
+ * arguments are queued, so the format must be a string literal */
+void     app_log_init         (void);
+int      app_log_cy_log_output(CY_LOG_FACILITY_T facility, CY_LOG_LEVEL_T level,
+                               char *logmsg);
+uint32_t app_log_dropped      (void);
+bool     app_log_flush        (uint32_t timeout_ms);
+#else
+#define app_log_init()
+#define app_log_dropped()               (0u)
+#define app_log_flush(timeout_ms)       (true)
+#endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * File Name: app_log_token.h
+ *
+ * Description: This file turns printf() calls into tokenized log
+ *              records when APP_LOG_TOKENIZED is set. The format string is
+ *              replaced by a 32-bit hash computed by the compiler and kept only
+ *              in a non-loaded ELF section that scripts/app_log_db.py extracts
+ *              into the host token database.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_LOG_TOKEN_H__
+#define APP_LOG_TOKEN_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+/* stdio.h first, its printf() prototype must not see the macro below */
+#include <stdio.h>
+#include <stdint.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Characters of a format string covered by its token. Must match
+ *        HASH_LENGTH in scripts/app_log_db.py.
+ */
+#define APP_LOG_TOKEN_HASH_LEN          (80)
+
+/**
+ * @brief Section holding the format strings. The text after '@' comments
+ *        out the flags GCC appends, so the section is not allocated and
+ *        takes no flash; only the ELF file keeps it.
+ */
+#define APP_LOG_FMT_SECTION             ".app_log_fmt,\"\",%progbits @"
+
+/**
+ * @brief Argument classes sent in a tokenized record, 2 bits per argument
+ */
+#define APP_LOG_TYPE_INT                (0u)
+#define APP_LOG_TYPE_INT64              (1u)
+#define APP_LOG_TYPE_DOUBLE             (2u)
+#define APP_LOG_TYPE_STR                (3u)
+
+/* Most arguments one tokenized printf() may take */
+#define APP_LOG_TOKEN_MAX_ARGS          (12u)
+
+#define APP_LOG_TYPE(a)                 _Generic((a),                           \
+                                            char *: APP_LOG_TYPE_STR,           \
+                                            const char *: APP_LOG_TYPE_STR,     \
+                                            long long: APP_LOG_TYPE_INT64,      \
+                                            unsigned long long: APP_LOG_TYPE_INT64, \
+                                            float: APP_LOG_TYPE_DOUBLE,         \
+                                            double: APP_LOG_TYPE_DOUBLE,        \
+                                            default: APP_LOG_TYPE_INT)
+
+/* Argument count in bits 0-3, class of argument n in bits 4 + 2n */
+#define APP_LOG_T(n, a)                 (APP_LOG_TYPE(a) << (4u + (2u * (n))))
+#define APP_LOG_T0()                    (0u)
+#define APP_LOG_T1(a) \
+                                        (APP_LOG_T0() | APP_LOG_T(0, a))
+#define APP_LOG_T2(a, b) \
+                                        (APP_LOG_T1(a) | APP_LOG_T(1, b))
+#define APP_LOG_T3(a, b, c) \
+                                        (APP_LOG_T2(a, b) | APP_LOG_T(2, c))
+#define APP_LOG_T4(a, b, c, d) \
+                                        (APP_LOG_T3(a, b, c) | APP_LOG_T(3, d))
+#define APP_LOG_T5(a, b, c, d, e) \
+                                        (APP_LOG_T4(a, b, c, d) | APP_LOG_T(4, e))
+#define APP_LOG_T6(a, b, c, d, e, f) \
+                                        (APP_LOG_T5(a, b, c, d, e) | APP_LOG_T(5, f))
+#define APP_LOG_T7(a, b, c, d, e, f, g) \
+                                        (APP_LOG_T6(a, b, c, d, e, f) | APP_LOG_T(6, g))
+#define APP_LOG_T8(a, b, c, d, e, f, g, h) \
+                                        (APP_LOG_T7(a, b, c, d, e, f, g) | APP_LOG_T(7, h))
+#define APP_LOG_T9(a, b, c, d, e, f, g, h, i) \
+                                        (APP_LOG_T8(a, b, c, d, e, f, g, h) | APP_LOG_T(8, i))
+#define APP_LOG_T10(a, b, c, d, e, f, g, h, i, j) \
+                                        (APP_LOG_T9(a, b, c, d, e, f, g, h, i) | APP_LOG_T(9, j))
+#define APP_LOG_T11(a, b, c, d, e, f, g, h, i, j, k) \
+                                        (APP_LOG_T10(a, b, c, d, e, f, g, h, i, j) | APP_LOG_T(10, k))
+#define APP_LOG_T12(a, b, c, d, e, f, g, h, i, j, k, l) \
+                                        (APP_LOG_T11(a, b, c, d, e, f, g, h, i, j, k) | APP_LOG_T(11, l))
+
+#define APP_LOG_NARGS(...)              APP_LOG_NARGS_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, \
+                                                       7, 6, 5, 4, 3, 2, 1, 0)
+#define APP_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, n, ...) n
+#define APP_LOG_CAT(a, b)               APP_LOG_CAT_(a, b)
+#define APP_LOG_CAT_(a, b)              a##b
+#define APP_LOG_TYPES(...)              ((uint32_t)APP_LOG_NARGS(__VA_ARGS__) | \
+                                         APP_LOG_CAT(APP_LOG_T, APP_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__))
+
+/* Character i of a string literal, 0 past its end */
+#define APP_LOG_C(s, i)                 (((i) < (sizeof(s) - 1u)) ? \
+                                         (uint32_t)(uint8_t)(s)[((i) < sizeof(s)) ? (i) : 0u] : 0u)
+
+/**
+ * @brief 65599 hash of a string literal: the length plus each character
+ *        times the next power of 65599. The compiler folds it to a constant.
+ */
+#define APP_LOG_TOKEN(s)                ((uint32_t)(sizeof(s) - 1u) + \
+                                         APP_LOG_C(s,  0u) * 0x0001003fu + \
+                                         APP_LOG_C(s,  1u) * 0x007e0f81u + \
+                                         APP_LOG_C(s,  2u) * 0x2e86d0bfu + \
+                                         APP_LOG_C(s,  3u) * 0x43ec5f01u + \
+                                         APP_LOG_C(s,  4u) * 0x162c613fu + \
+                                         APP_LOG_C(s,  5u) * 0xd62aee81u + \
+                                         APP_LOG_C(s,  6u) * 0xa311b1bfu + \
+                                         APP_LOG_C(s,  7u) * 0xd319be01u + \
+                                         APP_LOG_C(s,  8u) * 0xb156c23fu + \
+                                         APP_LOG_C(s,  9u) * 0x6698cd81u + \
+                                         APP_LOG_C(s, 10u) * 0x0d1b92bfu + \
+                                         APP_LOG_C(s, 11u) * 0xcc881d01u + \
+                                         APP_LOG_C(s, 12u) * 0x7280233fu + \
+                                         APP_LOG_C(s, 13u) * 0x50c7ac81u + \
+                                         APP_LOG_C(s, 14u) * 0x8da473bfu + \
+                                         APP_LOG_C(s, 15u) * 0x4f377c01u + \
+                                         APP_LOG_C(s, 16u) * 0xfaa8843fu + \
+                                         APP_LOG_C(s, 17u) * 0x33b78b81u + \
+                                         APP_LOG_C(s, 18u) * 0x45ac54bfu + \
+                                         APP_LOG_C(s, 19u) * 0x7a27db01u + \
+                                         APP_LOG_C(s, 20u) * 0xeacfe53fu + \
+                                         APP_LOG_C(s, 21u) * 0xae686a81u + \
+                                         APP_LOG_C(s, 22u) * 0x563335bfu + \
+                                         APP_LOG_C(s, 23u) * 0x6c593a01u + \
+                                         APP_LOG_C(s, 24u) * 0xe3f6463fu + \
+                                         APP_LOG_C(s, 25u) * 0x5fda4981u + \
+                                         APP_LOG_C(s, 26u) * 0xe03916bfu + \
+                                         APP_LOG_C(s, 27u) * 0x44cb9901u + \
+                                         APP_LOG_C(s, 28u) * 0x871ba73fu + \
+                                         APP_LOG_C(s, 29u) * 0xe70d2881u + \
+                                         APP_LOG_C(s, 30u) * 0x04bdf7bfu + \
+                                         APP_LOG_C(s, 31u) * 0x227ef801u + \
+                                         APP_LOG_C(s, 32u) * 0x7540083fu + \
+                                         APP_LOG_C(s, 33u) * 0xe3010781u + \
+                                         APP_LOG_C(s, 34u) * 0xe4c1d8bfu + \
+                                         APP_LOG_C(s, 35u) * 0x24735701u + \
+                                         APP_LOG_C(s, 36u) * 0x4f63693fu + \
+                                         APP_LOG_C(s, 37u) * 0xf2b5e681u + \
+                                         APP_LOG_C(s, 38u) * 0xa144b9bfu + \
+                                         APP_LOG_C(s, 39u) * 0x69a8b601u + \
+                                         APP_LOG_C(s, 40u) * 0xb685ca3fu + \
+                                         APP_LOG_C(s, 41u) * 0xb52bc581u + \
+                                         APP_LOG_C(s, 42u) * 0x5b469abfu + \
+                                         APP_LOG_C(s, 43u) * 0x111f1501u + \
+                                         APP_LOG_C(s, 44u) * 0x4ba72b3fu + \
+                                         APP_LOG_C(s, 45u) * 0xc962a481u + \
+                                         APP_LOG_C(s, 46u) * 0x33c77bbfu + \
+                                         APP_LOG_C(s, 47u) * 0x39d67401u + \
+                                         APP_LOG_C(s, 48u) * 0xafc78c3fu + \
+                                         APP_LOG_C(s, 49u) * 0xce5a8381u + \
+                                         APP_LOG_C(s, 50u) * 0x4bc75cbfu + \
+                                         APP_LOG_C(s, 51u) * 0x02ced301u + \
+                                         APP_LOG_C(s, 52u) * 0x83e6ed3fu + \
+                                         APP_LOG_C(s, 53u) * 0x63136281u + \
+                                         APP_LOG_C(s, 54u) * 0xc4463dbfu + \
+                                         APP_LOG_C(s, 55u) * 0x8b083201u + \
+                                         APP_LOG_C(s, 56u) * 0x69054e3fu + \
+                                         APP_LOG_C(s, 57u) * 0x268d4181u + \
+                                         APP_LOG_C(s, 58u) * 0xbe441ebfu + \
+                                         APP_LOG_C(s, 59u) * 0xf1829101u + \
+                                         APP_LOG_C(s, 60u) * 0x0022af3fu + \
+                                         APP_LOG_C(s, 61u) * 0xb7c82081u + \
+                                         APP_LOG_C(s, 62u) * 0x5ac0ffbfu + \
+                                         APP_LOG_C(s, 63u) * 0x553df001u + \
+                                         APP_LOG_C(s, 64u) * 0xea3f103fu + \
+                                         APP_LOG_C(s, 65u) * 0xb5c3ff81u + \
+                                         APP_LOG_C(s, 66u) * 0xbabce0bfu + \
+                                         APP_LOG_C(s, 67u) * 0xd53a4f01u + \
+                                         APP_LOG_C(s, 68u) * 0xc85a713fu + \
+                                         APP_LOG_C(s, 69u) * 0xbf80de81u + \
+                                         APP_LOG_C(s, 70u) * 0xff37c1bfu + \
+                                         APP_LOG_C(s, 71u) * 0x9077ae01u + \
+                                         APP_LOG_C(s, 72u) * 0x3b74d23fu + \
+                                         APP_LOG_C(s, 73u) * 0x73febd81u + \
+                                         APP_LOG_C(s, 74u) * 0x4931a2bfu + \
+                                         APP_LOG_C(s, 75u) * 0xa5f60d01u + \
+                                         APP_LOG_C(s, 76u) * 0xe48e333fu + \
+                                         APP_LOG_C(s, 77u) * 0x723d9c81u + \
+                                         APP_LOG_C(s, 78u) * 0xb9aa83bfu + \
+                                         APP_LOG_C(s, 79u) * 0x34b56c01u)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+int app_log_tok_printf(uint32_t token, uint32_t types, ...);
+
+/**
+ * @brief Every printf() of a file that includes app_log.h becomes a token,
+ *        the argument classes and the raw arguments
+ */
+#undef printf
+#define printf(fmt, ...)                                                       \
+    ({                                                                         \
+        static const char app_log_fmt_[]                                       \
+            __attribute__((section(APP_LOG_FMT_SECTION), used)) = fmt;         \
+        _Static_assert(APP_LOG_NARGS(__VA_ARGS__) <= APP_LOG_TOKEN_MAX_ARGS,   \
+                       "too many printf() arguments for a tokenized record");  \
+        app_log_tok_printf(APP_LOG_TOKEN(fmt), APP_LOG_TYPES(__VA_ARGS__),     \
+                           ##__VA_ARGS__);                                     \
+    })
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,266 @@
+/*******************************************************************************
+ * File Name: app_reboot.c
+ *
+ * Description: This file contains the reboot sequence, which closes
+ *              the links, writes the data still in RAM to the flash and drains
+ *              the log before the reset, and keeps the cause across it.
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cyhal.h"
+#include "wiced_bt_ble.h"
+#include "app_bt_conn.h"
+#include "app_bas_hist.h"
+#include "app_ota_storage.h"
+#include "app_sched.h"
+#include "app_reboot.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_REBOOT_MAGIC                (0x52425431u)   /* "RBT1" */
+
+/* Period of the check for the last disconnection */
+#define APP_REBOOT_POLL_MS              (5u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    cause;          /* app_reboot_cause_t */
+    uint32_t    shutdown_us;    /* Request to reset */
+    uint32_t    check;          /* magic ^ cause ^ shutdown_us */
+} app_reboot_record_t;
+
+/* Not cleared by the startup code, survives the reset of the sequence */
+static app_reboot_record_t app_reboot_record __attribute__((section(".noinit")));
+
+static const char *const app_reboot_cause_name[APP_REBOOT_CAUSE_COUNT] =
+{
+    "none",
+    "ota",
+};
+
+/* Record of the reboot that started this run */
+static app_reboot_cause_t   app_reboot_last_cause;
+static uint32_t             app_reboot_last_shutdown_us;
+
+/* Reboot requested and DWT cycle count at the request */
+static volatile app_reboot_cause_t app_reboot_cause;
+static uint32_t             app_reboot_start;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_reboot_run(void);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_reboot_init
+*
+* Function Description:
+* @brief  Takes the record of the reboot that started this run and clears
+*         it, so that a later watchdog or fault reset is not reported as
+*         requested. Registers the sequence with the application loop. Call
+*         from main() after app_sched_init().
+*
+* @return void
+*/
+void app_reboot_init(void)
+{
+    if ((APP_REBOOT_MAGIC == app_reboot_record.magic) &&
+        (app_reboot_record.cause < APP_REBOOT_CAUSE_COUNT) &&
+        (app_reboot_record.check == (APP_REBOOT_MAGIC ^ app_reboot_record.cause ^
+                                     app_reboot_record.shutdown_us)))
+    {
+        app_reboot_last_cause = (app_reboot_cause_t)app_reboot_record.cause;
+        app_reboot_last_shutdown_us = app_reboot_record.shutdown_us;
+    }
+    app_reboot_record.magic = 0;
+
+    app_sched_register(APP_SCHED_EVT_REBOOT, app_reboot_run, 0);
+}
+
+/**
+* Function Name:
+* app_reboot_request
+*
+* Function Description:
+* @brief  Starts the reboot sequence in the application loop. Callable from
+*         any task; the caller returns at once. Later requests are ignored.
+*
+* @param cause    Cause kept across the reset
+*
+* @return void
+*/
+void app_reboot_request(app_reboot_cause_t cause)
+{
+    if (APP_REBOOT_CAUSE_NONE != app_reboot_cause)
+    {
+        return;
+    }
+    app_reboot_start = app_log_cycles();
+    app_reboot_cause = cause;
+    app_sched_post(APP_SCHED_EVT_REBOOT);
+}
+
+/**
+* Function Name:
+* app_reboot_pending
+*
+* Function Description:
+* @brief  Tells whether a reboot was requested. Advertising is not started
+*         again once it is.
+*
+* @return bool    true after app_reboot_request()
+*/
+bool app_reboot_pending(void)
+{
+    return (APP_REBOOT_CAUSE_NONE != app_reboot_cause);
+}
+
+/**
+* Function Name:
+* app_reboot_last
+*
+* Function Description:
+* @brief  Returns the cause of the reboot that started this run
+*
+* @param p_shutdown_us  Set to the time from the request to the reset, may
+*                       be NULL
+*
+* @return app_reboot_cause_t  APP_REBOOT_CAUSE_NONE when the reset was not
+*                             requested by the application
+*/
+app_reboot_cause_t app_reboot_last(uint32_t *p_shutdown_us)
+{
+    if (NULL != p_shutdown_us)
+    {
+        *p_shutdown_us = app_reboot_last_shutdown_us;
+    }
+    return app_reboot_last_cause;
+}
+
+/**
+* Function Name:
+* app_reboot_name
+*
+* Function Description:
+* @brief  Returns the name of a reboot cause
+*
+* @param cause    Reboot cause
+*
+* @return const char*  Name, "?" when unknown
+*/
+const char *app_reboot_name(app_reboot_cause_t cause)
+{
+    return (cause < APP_REBOOT_CAUSE_COUNT) ? app_reboot_cause_name[cause] : "?";
+}
+
+/**
+* Function Name:
+* app_reboot_run
+*
+* Function Description:
+* @brief  Reboot sequence, runs in the application loop. Advertising stops
+*         and every central is disconnected with the Remote User Terminated
+*         reason. While the links close, the battery samples still in RAM are
+*         written to the flash. Once the stack has reported the last
+*         disconnection, or after APP_REBOOT_DISCONNECT_MS, the bond store and
+*         settings writes still queued in the OTA storage task are run, for
+*         up to APP_REBOOT_STORAGE_MS. Then the log output is drained, the
+*         cause and duration are recorded and the device resets.
+*
+* @return void
+*/
+static void app_reboot_run(void)
+{
+    app_reboot_cause_t cause = app_reboot_cause;
+    TickType_t start;
+    uint8_t links;
+    uint8_t up;
+
+    if (APP_REBOOT_CAUSE_NONE == cause)
+    {
+        return;
+    }
+
+    /* No central may connect while the links close */
+    (void)wiced_bt_start_advertisements(BTM_BLE_ADVERT_OFF, 0, NULL);
+    links = app_bt_conn_disconnect_all();
+    app_bas_hist_flush();
+
+    start = xTaskGetTickCount();
+    while ((0u != app_bt_conn_count()) &&
+           ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(APP_REBOOT_DISCONNECT_MS)))
+    {
+        vTaskDelay(pdMS_TO_TICKS(APP_REBOOT_POLL_MS));
+    }
+    up = app_bt_conn_count();
+    if (CY_RSLT_SUCCESS != app_ota_storage_drain(APP_REBOOT_STORAGE_MS))
+    {
+        APP_LOG_WARNING("Reboot: flash writes still queued after %u ms\r\n",
+                        (unsigned)APP_REBOOT_STORAGE_MS);
+    }
+    APP_LOG_NOTICE("Reboot (%s): %u links disconnected, %u still up, after %lu us\r\n",
+                   app_reboot_name(cause), (unsigned)links, (unsigned)up,
+                   (unsigned long)((app_log_cycles() - app_reboot_start) /
+                                   (SystemCoreClock / 1000000u)));
+    (void)app_log_flush(APP_REBOOT_LOG_MS);
+
+    app_reboot_record.cause = (uint32_t)cause;
+    app_reboot_record.shutdown_us = (app_log_cycles() - app_reboot_start) /
+                                    (SystemCoreClock / 1000000u);
+    app_reboot_record.check = APP_REBOOT_MAGIC ^ app_reboot_record.cause ^
+                              app_reboot_record.shutdown_us;
+    app_reboot_record.magic = APP_REBOOT_MAGIC;
+
+    Cy_SysPm_TriggerXRes();
+}
+
+/* [] END OF FILE */
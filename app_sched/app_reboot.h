@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * File Name: app_reboot.h
+ *
+ * Description: This file is the public interface of app_reboot.c
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+#ifndef APP_REBOOT_H__
+#define APP_REBOOT_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Longest wait for the centrals to acknowledge the disconnection
+ */
+#define APP_REBOOT_DISCONNECT_MS        (500u)
+
+/**
+ * @brief Longest wait for the log output to reach the UART
+ */
+#define APP_REBOOT_LOG_MS               (200u)
+
+/**
+ * @brief Longest wait for the flash writes queued in the OTA storage task
+ */
+#define APP_REBOOT_STORAGE_MS           (1000u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Cause of a reboot requested by the application, kept across the
+ *        reset. Other resets leave APP_REBOOT_CAUSE_NONE.
+ */
+typedef enum
+{
+    APP_REBOOT_CAUSE_NONE = 0,
+    APP_REBOOT_CAUSE_OTA,           /* New image downloaded and verified */
+    APP_REBOOT_CAUSE_COUNT
+} app_reboot_cause_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void               app_reboot_init    (void);
+void               app_reboot_request (app_reboot_cause_t cause);
+bool               app_reboot_pending (void);
+app_reboot_cause_t app_reboot_last    (uint32_t *p_shutdown_us);
+const char        *app_reboot_name    (app_reboot_cause_t cause);
+
+#endif
+/* [] END OF FILE */
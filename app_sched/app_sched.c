@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * File Name: app_sched.c
+ *
+ * Description: Application event loop: one task waiting on an event
+ *              group, fed by software timers and by the Bluetooth callbacks
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include <event_groups.h>
+#include "cy_utils.h"
+#include "app_monitor.h"
+#include "app_sched.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_SYS
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_SCHED_TASK_NAME             "Sched"
+/* Handlers program the battery history into the external flash */
+#define APP_SCHED_TASK_STACK_SIZE       (512u)
+#define APP_SCHED_TASK_PRIORITY         (configMAX_PRIORITIES - 3)
+
+#define APP_SCHED_ALL_BITS              ((EventBits_t)((1u << APP_SCHED_EVT_COUNT) - 1u))
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static EventGroupHandle_t   app_sched_events;
+static app_sched_handler_t  app_sched_handlers[APP_SCHED_EVT_COUNT];
+
+/* Timer posting an event periodically, NULL for events only posted */
+static TimerHandle_t        app_sched_timers[APP_SCHED_EVT_COUNT];
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void app_sched_timer_cb(TimerHandle_t timer);
+static void app_sched_task(void *arg);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_sched_init
+*
+* Function Description:
+* @brief  Creates the event group and the loop task. Call from main()
+*         before any module registers a handler.
+*
+* @return void
+*/
+void app_sched_init(void)
+{
+    app_sched_events = xEventGroupCreate();
+    if ((NULL == app_sched_events) ||
+        (pdPASS != xTaskCreate(app_sched_task, APP_SCHED_TASK_NAME, APP_SCHED_TASK_STACK_SIZE,
+                               NULL, APP_SCHED_TASK_PRIORITY, NULL)))
+    {
+        APP_LOG_ERR("Event loop creation failed\r\n");
+        CY_ASSERT(0);
+    }
+    app_monitor_task_size(APP_SCHED_TASK_NAME, APP_SCHED_TASK_STACK_SIZE);
+}
+
+/**
+* Function Name:
+* app_sched_register
+*
+* Function Description:
+* @brief  Sets the handler of an event. With a period, a software timer is
+*         created for it, stopped until app_sched_periodic() starts it.
+*
+* @param evt        Event
+*
+* @param handler    Handler, runs in the loop task
+*
+* @param period_ms  Period of the timer posting the event, 0 for none
+*
+* @return void
+*/
+void app_sched_register(app_sched_evt_t evt, app_sched_handler_t handler, uint32_t period_ms)
+{
+    app_sched_handlers[evt] = handler;
+    if ((0u != period_ms) && (NULL == app_sched_timers[evt]))
+    {
+        app_sched_timers[evt] = xTimerCreate(APP_SCHED_TASK_NAME, pdMS_TO_TICKS(period_ms),
+                                             pdTRUE, (void *)(uintptr_t)evt,
+                                             app_sched_timer_cb);
+        if (NULL == app_sched_timers[evt])
+        {
+            APP_LOG_ERR("Event %d timer creation failed\r\n", evt);
+        }
+    }
+}
+
+/**
+* Function Name:
+* app_sched_periodic
+*
+* Function Description:
+* @brief  Starts or stops the timer of an event. Timers only run while
+*         their event is needed, so the device stays in Deep Sleep between
+*         the events that are.
+*
+* @param evt      Event registered with a period
+*
+* @param enable   true to start posting the event, false to stop
+*
+* @return void
+*/
+void app_sched_periodic(app_sched_evt_t evt, bool enable)
+{
+    TimerHandle_t timer = app_sched_timers[evt];
+    BaseType_t result;
+
+    if (NULL == timer)
+    {
+        return;
+    }
+    result = enable ? xTimerStart(timer, 0) : xTimerStop(timer, 0);
+    if (pdPASS != result)
+    {
+        APP_LOG_ERR("Event %d timer command failed\r\n", evt);
+    }
+}
+
+/**
+* Function Name:
+* app_sched_post
+*
+* Function Description:
+* @brief  Posts an event to the loop. Callable from any task, the handler
+*         runs later in the loop task.
+*
+* @param evt      Event
+*
+* @return void
+*/
+void app_sched_post(app_sched_evt_t evt)
+{
+    (void)xEventGroupSetBits(app_sched_events, (EventBits_t)(1u << evt));
+}
+
+/**
+* Function Name:
+* app_sched_timer_cb
+*
+* Function Description:
+* @brief  Posts the event of a timer, runs in the timer task
+*
+* @param timer    Timer, its ID is the event
+*
+* @return void
+*/
+static void app_sched_timer_cb(TimerHandle_t timer)
+{
+    app_sched_post((app_sched_evt_t)(uintptr_t)pvTimerGetTimerID(timer));
+}
+
+/**
+* Function Name:
+* app_sched_task
+*
+* Function Description:
+* @brief  Waits for events and runs their handlers in event order
+*
+* @param arg      Unused
+*
+* @return void
+*/
+static void app_sched_task(void *arg)
+{
+    EventBits_t bits;
+
+    (void)arg;
+
+    while (true)
+    {
+        bits = xEventGroupWaitBits(app_sched_events, APP_SCHED_ALL_BITS,
+                                   pdTRUE, pdFALSE, portMAX_DELAY);
+        for (uint8_t evt = 0; evt < APP_SCHED_EVT_COUNT; evt++)
+        {
+            if ((0u != (bits & (1u << evt))) && (NULL != app_sched_handlers[evt]))
+            {
+                app_sched_handlers[evt]();
+            }
+        }
+    }
+}
+
+/* [] END OF FILE */
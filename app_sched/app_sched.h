@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * File Name: app_sched.h
+ *
+ * Description: Public interface of the application event loop
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_SCHED_H__
+#define APP_SCHED_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Events of the application loop. Each one is a bit of the loop's
+ *        event group: events posted while the loop is busy are merged and
+ *        the handler runs once.
+ */
+typedef enum
+{
+    APP_SCHED_EVT_BATTERY = 0,      /* Battery level sample */
+    APP_SCHED_EVT_LED,              /* Advertising or connection state changed */
+    APP_SCHED_EVT_OTA,              /* OTA download progress check */
+    APP_SCHED_EVT_RTSTATS,          /* Run-time statistics window closes */
+    APP_SCHED_EVT_MONITOR,          /* Stack and heap peaks sampling */
+    APP_SCHED_EVT_REBOOT,           /* Reboot requested, runs the sequence */
+    APP_SCHED_EVT_COUNT
+} app_sched_evt_t;
+
+/**
+ * @brief Handler of an event, runs in the application loop task
+ */
+typedef void (*app_sched_handler_t)(void);
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void app_sched_init     (void);
+void app_sched_register (app_sched_evt_t evt, app_sched_handler_t handler,
+                         uint32_t period_ms);
+void app_sched_periodic (app_sched_evt_t evt, bool enable);
+void app_sched_post     (app_sched_evt_t evt);
+
+#endif
+/* [] END OF FILE */
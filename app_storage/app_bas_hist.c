@@ -0,0 +1,629 @@
+/*******************************************************************************
+ * File Name: app_bas_hist.c
+ *
+ * Description: Battery level history: timestamped samples delta
+ *              encoded into blocks kept in a ring of external flash sectors
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "cy_ota_api.h"
+#include "cy_ota_flash.h"
+#include "app_ota_storage.h"
+#include "app_bas_hist.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_BAS
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_BAS_HIST_MAGIC              (0x4842u)       /* "BH" */
+
+/* Nibbles of samples a block can hold after the first sample */
+#define APP_BAS_HIST_NIBBLES            (2u * sizeof(((app_bas_hist_block_t *)0)->data))
+
+/* A short sample is one nibble, a long one the escape and 6 nibbles */
+#define APP_BAS_HIST_ESCAPE             (0x8u)
+#define APP_BAS_HIST_LONG_NIBBLES       (7u)
+#define APP_BAS_HIST_DELTA_MAX          (7)
+
+#define APP_BAS_HIST_BLOCK(seq)         (APP_BAS_HIST_FLASH_OFFSET + \
+                                         ((seq) % APP_BAS_HIST_BLOCKS) * APP_BAS_HIST_BLOCK_SIZE)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+CY_STATIC_ASSERT(sizeof(app_bas_hist_block_t) == APP_BAS_HIST_BLOCK_SIZE,
+                 "History block is not packed");
+CY_STATIC_ASSERT((APP_BAS_HIST_NIBBLES + 1u) <= UINT8_MAX, "History block count overflows");
+
+/* Block being filled, written to the flash once full */
+static app_bas_hist_block_t app_bas_hist_ram;
+static uint16_t             app_bas_hist_nibbles;
+static uint8_t              app_bas_hist_level;
+
+/* Oldest block still in the flash and the sequence number of the block
+ * being filled */
+static uint32_t             app_bas_hist_first_seq;
+static uint32_t             app_bas_hist_next_seq;
+static bool                 app_bas_hist_loaded;
+
+/* Device time: seconds since boot, on top of the time of the last sample
+ * stored before the boot */
+static uint32_t             app_bas_hist_base;
+static uint32_t             app_bas_hist_secs;
+static uint32_t             app_bas_hist_ms;
+static TickType_t           app_bas_hist_tick;
+
+static SemaphoreHandle_t    app_bas_hist_mutex;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static uint32_t app_bas_hist_crc32      (uint32_t crc, const uint8_t *p_data, uint32_t len);
+static uint32_t app_bas_hist_block_crc  (const app_bas_hist_block_t *p_block);
+static bool     app_bas_hist_fetch      (uint32_t seq, app_bas_hist_block_t *p_block);
+static void     app_bas_hist_put        (uint8_t code);
+static void     app_bas_hist_begin      (uint32_t t, uint8_t level);
+static void     app_bas_hist_close      (void);
+static void     app_bas_hist_load       (void);
+static bool     app_bas_hist_ready      (void);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_bas_hist_crc32
+*
+* Function Description:
+* @brief  Continues a CRC-32 (IEEE 802.3) over a buffer, bit by bit: a block
+*         is checked once when it is read
+*
+* @param crc      CRC so far, 0 to start
+*
+* @param p_data   Buffer
+*
+* @param len      Length of the buffer
+*
+* @return uint32_t  CRC including the buffer
+*/
+static uint32_t app_bas_hist_crc32(uint32_t crc, const uint8_t *p_data, uint32_t len)
+{
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p_data++;
+        for (uint8_t bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+* Function Name:
+* app_bas_hist_block_crc
+*
+* Function Description:
+* @brief  CRC of a block: the header up to its crc field, then the samples
+*
+* @param p_block  Block
+*
+* @return uint32_t  CRC of the block
+*/
+static uint32_t app_bas_hist_block_crc(const app_bas_hist_block_t *p_block)
+{
+    uint32_t crc = app_bas_hist_crc32(0, (const uint8_t *)&p_block->hdr,
+                                      offsetof(app_bas_hist_hdr_t, crc));
+
+    return app_bas_hist_crc32(crc, p_block->data, p_block->hdr.len);
+}
+
+/**
+* Function Name:
+* app_bas_hist_fetch
+*
+* Function Description:
+* @brief  Reads a block from the flash and checks it
+*
+* @param seq      Sequence number of the block
+*
+* @param p_block  Receives the block
+*
+* @return bool    false if the slot holds another block or a damaged one
+*/
+static bool app_bas_hist_fetch(uint32_t seq, app_bas_hist_block_t *p_block)
+{
+    return (CY_RSLT_SUCCESS == cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                               APP_BAS_HIST_BLOCK(seq), p_block,
+                                               sizeof(*p_block))) &&
+           (APP_BAS_HIST_MAGIC == p_block->hdr.magic) &&
+           (seq == p_block->hdr.seq) &&
+           (0u != p_block->hdr.count) &&
+           (p_block->hdr.len <= sizeof(p_block->data)) &&
+           (p_block->hdr.crc == app_bas_hist_block_crc(p_block));
+}
+
+/**
+* Function Name:
+* app_bas_hist_put
+*
+* Function Description:
+* @brief  Appends a 4-bit code to the block being filled, high nibble first
+*
+* @param code     Code, only the low nibble is used
+*
+* @return void
+*/
+static void app_bas_hist_put(uint8_t code)
+{
+    uint8_t *p = &app_bas_hist_ram.data[app_bas_hist_nibbles / 2u];
+
+    if (0u == (app_bas_hist_nibbles & 1u))
+    {
+        *p = (uint8_t)(code << 4);
+    }
+    else
+    {
+        *p |= (uint8_t)(code & 0x0Fu);
+    }
+    app_bas_hist_nibbles++;
+}
+
+/**
+* Function Name:
+* app_bas_hist_begin
+*
+* Function Description:
+* @brief  Starts a new block with its first sample
+*
+* @param t        Device time of the sample
+*
+* @param level    Battery level in percent
+*
+* @return void
+*/
+static void app_bas_hist_begin(uint32_t t, uint8_t level)
+{
+    memset(&app_bas_hist_ram, 0, sizeof(app_bas_hist_ram));
+    app_bas_hist_ram.hdr.count = 1;
+    app_bas_hist_ram.hdr.t_first = t;
+    app_bas_hist_ram.hdr.t_last = t;
+    app_bas_hist_ram.hdr.level_first = level;
+    app_bas_hist_nibbles = 0;
+    app_bas_hist_level = level;
+}
+
+/**
+* Function Name:
+* app_bas_hist_close
+*
+* Function Description:
+* @brief  Writes the block being filled to the next slot of the ring. The
+*         first block of a sector erases it, dropping the oldest blocks. A
+*         block that fails to program is lost, the next one takes the next
+*         slot.
+*
+* @return void
+*/
+static void app_bas_hist_close(void)
+{
+    app_bas_hist_hdr_t *p_hdr = &app_bas_hist_ram.hdr;
+    uint32_t seq = app_bas_hist_next_seq;
+    uint32_t addr = APP_BAS_HIST_BLOCK(seq);
+
+    if (0u == p_hdr->count)
+    {
+        return;
+    }
+
+    p_hdr->magic = APP_BAS_HIST_MAGIC;
+    p_hdr->len = (uint8_t)((app_bas_hist_nibbles + 1u) / 2u);
+    p_hdr->seq = seq;
+    p_hdr->crc = app_bas_hist_block_crc(&app_bas_hist_ram);
+
+    if (0u == (seq % APP_BAS_HIST_BLOCKS_PER_SECTOR))
+    {
+        /* The sector held the blocks APP_BAS_HIST_BLOCKS before this one */
+        if (seq + APP_BAS_HIST_BLOCKS_PER_SECTOR > app_bas_hist_first_seq + APP_BAS_HIST_BLOCKS)
+        {
+            app_bas_hist_first_seq = seq + APP_BAS_HIST_BLOCKS_PER_SECTOR - APP_BAS_HIST_BLOCKS;
+        }
+        if (CY_RSLT_SUCCESS != cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, addr,
+                                                APP_BAS_HIST_SECTOR_SIZE))
+        {
+            APP_LOG_ERR("History sector erase failed at 0x%lx\r\n", (unsigned long)addr);
+        }
+    }
+    if (CY_RSLT_SUCCESS != cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, addr,
+                                            &app_bas_hist_ram,
+                                            sizeof(app_bas_hist_hdr_t) + p_hdr->len))
+    {
+        APP_LOG_ERR("History block %lu write failed\r\n", (unsigned long)seq);
+    }
+
+    app_bas_hist_next_seq = seq + 1u;
+    p_hdr->count = 0;
+}
+
+/**
+* Function Name:
+* app_bas_hist_load
+*
+* Function Description:
+* @brief  Finds the newest block in the flash, then walks back to the oldest
+*         block of the run of consecutive ones before it. The newest block
+*         may have been cut short by a reset, it is then skipped. The device
+*         time continues from the last stored sample.
+*
+* @return void
+*/
+static void app_bas_hist_load(void)
+{
+    static app_bas_hist_block_t block;
+    app_bas_hist_hdr_t hdr;
+    uint32_t newest = 0;
+    bool found = false;
+    uint32_t seq;
+
+    for (uint32_t slot = 0; slot < APP_BAS_HIST_BLOCKS; slot++)
+    {
+        if ((CY_RSLT_SUCCESS == cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                APP_BAS_HIST_FLASH_OFFSET +
+                                                slot * APP_BAS_HIST_BLOCK_SIZE,
+                                                &hdr, sizeof(hdr))) &&
+            (APP_BAS_HIST_MAGIC == hdr.magic) &&
+            (slot == (hdr.seq % APP_BAS_HIST_BLOCKS)) &&
+            (!found || (hdr.seq > newest)))
+        {
+            newest = hdr.seq;
+            found = true;
+        }
+    }
+
+    app_bas_hist_next_seq = 0;
+    app_bas_hist_first_seq = 0;
+    if (found)
+    {
+        app_bas_hist_next_seq = newest + 1u;
+        app_bas_hist_first_seq = app_bas_hist_next_seq;
+        for (seq = newest; (newest - seq) < APP_BAS_HIST_BLOCKS; seq--)
+        {
+            if (app_bas_hist_fetch(seq, &block))
+            {
+                if (app_bas_hist_first_seq == app_bas_hist_next_seq)
+                {
+                    taskENTER_CRITICAL();
+                    app_bas_hist_base = block.hdr.t_last + 1u;
+                    taskEXIT_CRITICAL();
+                }
+                app_bas_hist_first_seq = seq;
+            }
+            else if (seq != newest)
+            {
+                break;
+            }
+            if (0u == seq)
+            {
+                break;
+            }
+        }
+    }
+
+    APP_LOG_INFO("History: blocks %lu to %lu, time %lu\r\n",
+                 (unsigned long)app_bas_hist_first_seq,
+                 (unsigned long)app_bas_hist_next_seq,
+                 (unsigned long)app_bas_hist_now());
+}
+
+/**
+* Function Name:
+* app_bas_hist_ready
+*
+* Function Description:
+* @brief  Loads the history on first use, once the external flash is up
+*
+* @return bool    true if the history is loaded
+*/
+static bool app_bas_hist_ready(void)
+{
+    if (app_bas_hist_loaded)
+    {
+        return true;
+    }
+    if (CY_RSLT_SUCCESS != app_ota_storage_wait(APP_BAS_HIST_STORAGE_WAIT_MS))
+    {
+        APP_LOG_WARNING("History sample dropped, flash not ready\r\n");
+        return false;
+    }
+
+    xSemaphoreTake(app_bas_hist_mutex, portMAX_DELAY);
+    app_bas_hist_load();
+    app_bas_hist_loaded = true;
+    xSemaphoreGive(app_bas_hist_mutex);
+    return true;
+}
+
+/**
+* Function Name:
+* app_bas_hist_init
+*
+* Function Description:
+* @brief  Creates the history lock. Call from main() before the scheduler
+*         starts; the flash is read when the first sample is added.
+*
+* @return bool    false if the lock cannot be created
+*/
+bool app_bas_hist_init(void)
+{
+    app_bas_hist_mutex = xSemaphoreCreateMutex();
+    return (NULL != app_bas_hist_mutex);
+}
+
+/**
+* Function Name:
+* app_bas_hist_now
+*
+* Function Description:
+* @brief  Device time in seconds. It keeps increasing across resets: after
+*         the history is loaded it starts from the time of the last stored
+*         sample.
+*
+* @return uint32_t  Device time in seconds
+*/
+uint32_t app_bas_hist_now(void)
+{
+    TickType_t tick;
+    uint32_t now;
+
+    taskENTER_CRITICAL();
+    tick = xTaskGetTickCount();
+    app_bas_hist_ms += (uint32_t)(tick - app_bas_hist_tick) * portTICK_PERIOD_MS;
+    app_bas_hist_tick = tick;
+    app_bas_hist_secs += app_bas_hist_ms / 1000u;
+    app_bas_hist_ms %= 1000u;
+    now = app_bas_hist_base + app_bas_hist_secs;
+    taskEXIT_CRITICAL();
+    return now;
+}
+
+/**
+* Function Name:
+* app_bas_hist_add
+*
+* Function Description:
+* @brief  Adds a sample at the current device time. Samples at the interval
+*         of the block with a change of at most 7 percent take a nibble,
+*         others take 7. The block is written to the flash once full, this
+*         may block the caller for a sector erase.
+*
+* @param level    Battery level in percent
+*
+* @return void
+*/
+void app_bas_hist_add(uint8_t level)
+{
+    app_bas_hist_hdr_t *p_hdr = &app_bas_hist_ram.hdr;
+    uint32_t t;
+    uint32_t dt;
+    int32_t delta;
+    bool is_short;
+
+    if (!app_bas_hist_ready())
+    {
+        return;
+    }
+
+    xSemaphoreTake(app_bas_hist_mutex, portMAX_DELAY);
+    t = app_bas_hist_now();
+    if (0u == p_hdr->count)
+    {
+        app_bas_hist_begin(t, level);
+    }
+    else
+    {
+        dt = t - p_hdr->t_last;
+        delta = (int32_t)level - (int32_t)app_bas_hist_level;
+        if ((1u == p_hdr->count) && (dt <= UINT8_MAX))
+        {
+            p_hdr->interval = (uint8_t)dt;
+        }
+        is_short = (dt == p_hdr->interval) &&
+                   (delta >= -APP_BAS_HIST_DELTA_MAX) && (delta <= APP_BAS_HIST_DELTA_MAX);
+
+        if ((dt > UINT16_MAX) ||
+            (app_bas_hist_nibbles + (is_short ? 1u : APP_BAS_HIST_LONG_NIBBLES) >
+             APP_BAS_HIST_NIBBLES))
+        {
+            app_bas_hist_close();
+            app_bas_hist_begin(t, level);
+        }
+        else
+        {
+            if (is_short)
+            {
+                app_bas_hist_put((uint8_t)delta);
+            }
+            else
+            {
+                app_bas_hist_put(APP_BAS_HIST_ESCAPE);
+                for (int8_t shift = 12; shift >= 0; shift -= 4)
+                {
+                    app_bas_hist_put((uint8_t)(dt >> shift));
+                }
+                app_bas_hist_put((uint8_t)(level >> 4));
+                app_bas_hist_put(level);
+            }
+            p_hdr->count++;
+            p_hdr->t_last = t;
+            app_bas_hist_level = level;
+        }
+    }
+    if (app_bas_hist_nibbles == APP_BAS_HIST_NIBBLES)
+    {
+        app_bas_hist_close();
+    }
+    xSemaphoreGive(app_bas_hist_mutex);
+}
+
+/**
+* Function Name:
+* app_bas_hist_flush
+*
+* Function Description:
+* @brief  Writes the block being filled to the flash before it is full, so
+*         that its samples survive a reset. The next sample starts a new
+*         block. Call before a requested reboot.
+*
+* @return void
+*/
+void app_bas_hist_flush(void)
+{
+    if (NULL == app_bas_hist_mutex)
+    {
+        return;
+    }
+
+    /* A block only holds samples once the history is loaded */
+    xSemaphoreTake(app_bas_hist_mutex, portMAX_DELAY);
+    app_bas_hist_close();
+    xSemaphoreGive(app_bas_hist_mutex);
+}
+
+/**
+* Function Name:
+* app_bas_hist_range
+*
+* Function Description:
+* @brief  Finds the blocks to stream for samples from a given time: a binary
+*         search for the first block whose last sample is not older. Blocks
+*         are in time order, damaged ones are taken as newer.
+*
+* @param t_from     Device time of the oldest sample wanted
+*
+* @param p_seq      Receives the sequence number of the first block
+*
+* @param p_end_seq  Receives the sequence number after the last block, the
+*                   block being filled included
+*
+* @return bool      false if the history is not loaded yet
+*/
+bool app_bas_hist_range(uint32_t t_from, uint32_t *p_seq, uint32_t *p_end_seq)
+{
+    app_bas_hist_hdr_t hdr;
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+
+    xSemaphoreTake(app_bas_hist_mutex, portMAX_DELAY);
+    if (!app_bas_hist_loaded)
+    {
+        xSemaphoreGive(app_bas_hist_mutex);
+        return false;
+    }
+
+    lo = app_bas_hist_first_seq;
+    hi = app_bas_hist_next_seq;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2u;
+        if ((CY_RSLT_SUCCESS == cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                APP_BAS_HIST_BLOCK(mid), &hdr, sizeof(hdr))) &&
+            (APP_BAS_HIST_MAGIC == hdr.magic) && (mid == hdr.seq) && (hdr.t_last < t_from))
+        {
+            lo = mid + 1u;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *p_seq = lo;
+    *p_end_seq = app_bas_hist_next_seq + ((0u != app_bas_hist_ram.hdr.count) ? 1u : 0u);
+    xSemaphoreGive(app_bas_hist_mutex);
+    return true;
+}
+
+/**
+* Function Name:
+* app_bas_hist_read
+*
+* Function Description:
+* @brief  Reads a block. The block being filled is returned as it is now,
+*         as if it were stored.
+*
+* @param seq      Sequence number of the block
+*
+* @param p_block  Receives the block
+*
+* @return uint16_t  Bytes of the block, header included. 0 if the block was
+*                   overwritten, is damaged or does not exist yet.
+*/
+uint16_t app_bas_hist_read(uint32_t seq, app_bas_hist_block_t *p_block)
+{
+    uint16_t size = 0;
+
+    xSemaphoreTake(app_bas_hist_mutex, portMAX_DELAY);
+    if (!app_bas_hist_loaded)
+    {
+        /* Nothing to read yet */
+    }
+    else if ((seq == app_bas_hist_next_seq) && (0u != app_bas_hist_ram.hdr.count))
+    {
+        *p_block = app_bas_hist_ram;
+        p_block->hdr.magic = APP_BAS_HIST_MAGIC;
+        p_block->hdr.len = (uint8_t)((app_bas_hist_nibbles + 1u) / 2u);
+        p_block->hdr.seq = seq;
+        p_block->hdr.crc = app_bas_hist_block_crc(p_block);
+        size = (uint16_t)(sizeof(app_bas_hist_hdr_t) + p_block->hdr.len);
+    }
+    else if ((seq >= app_bas_hist_first_seq) && (seq < app_bas_hist_next_seq) &&
+             app_bas_hist_fetch(seq, p_block))
+    {
+        size = (uint16_t)(sizeof(app_bas_hist_hdr_t) + p_block->hdr.len);
+    }
+    xSemaphoreGive(app_bas_hist_mutex);
+    return size;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * File Name: app_bas_hist.h
+ *
+ * Description: Public interface of the battery level history kept in
+ *              the external flash
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_BAS_HIST_H__
+#define APP_BAS_HIST_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Region of the history in the external flash, after the key-value
+ *        store. Must not overlap flashmap.mk areas. Blocks are written in a
+ *        ring; entering a sector erases it and drops its oldest blocks.
+ */
+#define APP_BAS_HIST_FLASH_OFFSET       (0x000F5000u)
+#define APP_BAS_HIST_SECTOR_SIZE        (0x00001000u)
+#define APP_BAS_HIST_SECTOR_COUNT       (8u)
+
+/**
+ * @brief Size of a block, header included. A block holds up to
+ *        1 + 2 * (APP_BAS_HIST_BLOCK_SIZE - header) samples.
+ */
+#define APP_BAS_HIST_BLOCK_SIZE         (128u)
+
+#define APP_BAS_HIST_BLOCKS_PER_SECTOR  (APP_BAS_HIST_SECTOR_SIZE / APP_BAS_HIST_BLOCK_SIZE)
+#define APP_BAS_HIST_BLOCKS             (APP_BAS_HIST_SECTOR_COUNT * APP_BAS_HIST_BLOCKS_PER_SECTOR)
+
+/**
+ * @brief Longest wait of the first sample for the OTA storage bring-up
+ */
+#define APP_BAS_HIST_STORAGE_WAIT_MS    (3000u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Header of a block, little endian, followed by len bytes of samples.
+ *
+ *        The first sample is in the header. Each following sample is one
+ *        4-bit code, high nibble first: a level change of -7..+7 percent,
+ *        interval seconds after the previous sample. Code 0x8 escapes to a
+ *        long sample of 6 more nibbles: 16 bits of seconds since the
+ *        previous sample, then 8 bits of level.
+ */
+typedef struct
+{
+    uint16_t    magic;
+    uint8_t     len;            /* Bytes of samples after the header */
+    uint8_t     count;          /* Samples, the first one included */
+    uint32_t    seq;            /* Block number, consecutive */
+    uint32_t    t_first;        /* Device seconds of the first sample */
+    uint32_t    t_last;         /* Device seconds of the last sample */
+    uint8_t     level_first;
+    uint8_t     interval;       /* Seconds between samples of a short code */
+    uint16_t    reserved;
+    uint32_t    crc;            /* CRC-32 of the header up to here and the samples */
+} app_bas_hist_hdr_t;
+
+/**
+ * @brief A block as stored in the flash
+ */
+typedef struct
+{
+    app_bas_hist_hdr_t  hdr;
+    uint8_t             data[APP_BAS_HIST_BLOCK_SIZE - sizeof(app_bas_hist_hdr_t)];
+} app_bas_hist_block_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+bool     app_bas_hist_init     (void);
+uint32_t app_bas_hist_now      (void);
+void     app_bas_hist_add      (uint8_t level);
+void     app_bas_hist_flush    (void);
+bool     app_bas_hist_range    (uint32_t t_from, uint32_t *p_seq, uint32_t *p_end_seq);
+uint16_t app_bas_hist_read     (uint32_t seq, app_bas_hist_block_t *p_block);
+
+#endif
+/* [] END OF FILE */
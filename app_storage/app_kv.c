@@ -0,0 +1,981 @@
+/*******************************************************************************
+ * File Name: app_kv.c
+ *
+ * Description: Log-structured key-value store in a ring of external
+ *              flash sectors, with a RAM hash index and compaction in a
+ *              background task
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <event_groups.h>
+#include "cy_ota_api.h"
+#include "cy_ota_flash.h"
+#include "app_ota_storage.h"
+#include "app_monitor.h"
+#include "app_kv.h"
+#define APP_LOG_MODULE                  APP_LOG_MOD_FLASH
+#include "app_log.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define APP_KV_TASK_NAME                "KV Store"
+#define APP_KV_TASK_STACK_SIZE          (1024u)
+#define APP_KV_TASK_PRIORITY            (tskIDLE_PRIORITY + 1)
+
+#define APP_KV_READY_BIT                (1u << 0)
+
+/* The store task waits this long for the OTA storage bring-up */
+#define APP_KV_STORAGE_WAIT_MS          (10000u)
+
+#define APP_KV_MAGIC                    (0x5453564Bu)   /* "KVST" */
+
+/* Record types. An erased header reads as APP_KV_REC_FREE. */
+#define APP_KV_REC_VALUE                (0x5Au)
+#define APP_KV_REC_DELETE               (0xA5u)
+#define APP_KV_REC_FREE                 (0xFFu)
+
+/* Records start on a word boundary */
+#define APP_KV_ALIGN(len)               (((len) + 3u) & ~3u)
+#define APP_KV_REC_SIZE(len)            (sizeof(app_kv_rec_t) + APP_KV_ALIGN(len))
+
+#define APP_KV_SECTOR(index)            (APP_KV_FLASH_OFFSET + ((uint32_t)(index) * APP_KV_SECTOR_SIZE))
+#define APP_KV_SECTOR_OF(addr)          ((uint8_t)(((addr) - APP_KV_FLASH_OFFSET) / APP_KV_SECTOR_SIZE))
+#define APP_KV_NEXT(index)              ((uint8_t)(((index) + 1u) % APP_KV_SECTOR_COUNT))
+
+/* Free sectors kept ahead of the head. One takes the records moved by a
+ * compaction, the other keeps writes from waiting for it. */
+#define APP_KV_FREE_MIN                 (2u)
+
+/* Open addressing hash index, twice the number of keys */
+#define APP_KV_INDEX_SIZE               (2u * APP_KV_MAX_KEYS)
+
+/* Bytes read at a time when checking that a sector is blank */
+#define APP_KV_BLANK_CHUNK              (256u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Header at the start of a sector in use. A higher sequence number
+ *        means newer records, so a later record of a key wins at load.
+ */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    seq;
+} app_kv_sector_t;
+
+/**
+ * @brief Header of a record, followed by the value
+ */
+typedef struct
+{
+    uint16_t    key;
+    uint8_t     type;
+    uint8_t     len;            /* Value bytes, before alignment */
+    uint32_t    crc;            /* CRC-32 of key, type, len and the value */
+} app_kv_rec_t;
+
+/**
+ * @brief Slot of the RAM index
+ */
+typedef enum
+{
+    APP_KV_SLOT_EMPTY = 0,
+    APP_KV_SLOT_USED,
+    APP_KV_SLOT_DELETED         /* Keeps probe chains going past it */
+} app_kv_slot_state_t;
+
+typedef struct
+{
+    uint16_t    key;
+    uint8_t     state;
+    uint8_t     len;
+    uint32_t    addr;           /* Flash offset of the record header */
+} app_kv_slot_t;
+
+/* Every live record fits in the sector a compaction moves them to */
+CY_STATIC_ASSERT((sizeof(app_kv_sector_t) + APP_KV_MAX_KEYS * APP_KV_REC_SIZE(APP_KV_VALUE_MAX))
+                 <= APP_KV_SECTOR_SIZE, "KV store keys do not fit in a sector");
+
+static app_kv_slot_t        app_kv_index[APP_KV_INDEX_SIZE];
+static uint8_t              app_kv_keys;
+
+/* Sequence number of each sector, 0 when it is free (erased) */
+static uint32_t             app_kv_seq[APP_KV_SECTOR_COUNT];
+/* Bytes of each sector still referenced by the index */
+static uint16_t             app_kv_live[APP_KV_SECTOR_COUNT];
+
+/* Sector being appended to, offset of the next record in it, highest
+ * sequence number in use */
+static uint8_t              app_kv_head;
+static uint32_t             app_kv_wr;
+static uint32_t             app_kv_max_seq;
+
+static app_kv_stats_t       app_kv_stats;
+
+static SemaphoreHandle_t    app_kv_mutex;
+static EventGroupHandle_t   app_kv_events;
+static TaskHandle_t         app_kv_task_handle;
+static app_kv_loaded_cb_t   app_kv_loaded_cb;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static uint32_t         app_kv_crc32    (uint32_t crc, const uint8_t *p_data, uint32_t len);
+static uint32_t         app_kv_rec_crc  (const app_kv_rec_t *p_rec, const uint8_t *p_value);
+static app_kv_slot_t   *app_kv_lookup   (uint16_t key, uint32_t *p_probes);
+static bool             app_kv_put      (uint16_t key, uint32_t addr, uint8_t len);
+static void             app_kv_remove   (uint16_t key);
+static uint8_t          app_kv_free     (void);
+static bool             app_kv_erase    (uint8_t sector);
+static bool             app_kv_open     (void);
+static bool             app_kv_append   (uint16_t key, uint8_t type, const void *p_value,
+                                         uint8_t len, uint32_t *p_addr);
+static bool             app_kv_compact  (void);
+static void             app_kv_load     (void);
+static cy_rslt_t        app_kv_write    (uint16_t key, uint8_t type, const void *p_value,
+                                         uint8_t len);
+static cy_rslt_t        app_kv_acquire  (void);
+static void             app_kv_task     (void *arg);
+
+/*******************************************************************************
+*       Function Definitions
+*******************************************************************************/
+/**
+* Function Name:
+* app_kv_crc32
+*
+* Function Description:
+* @brief  Continues a CRC-32 (IEEE 802.3) over a buffer, bit by bit: records
+*         are small and only checked at load
+*
+* @param crc      CRC so far, 0 to start
+*
+* @param p_data   Buffer
+*
+* @param len      Length of the buffer
+*
+* @return uint32_t  CRC including the buffer
+*/
+static uint32_t app_kv_crc32(uint32_t crc, const uint8_t *p_data, uint32_t len)
+{
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p_data++;
+        for (uint8_t bit = 0; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+* Function Name:
+* app_kv_rec_crc
+*
+* Function Description:
+* @brief  CRC of a record: key, type and length, then the value
+*
+* @param p_rec    Record header, its crc field is not covered
+*
+* @param p_value  Value of the record
+*
+* @return uint32_t  CRC of the record
+*/
+static uint32_t app_kv_rec_crc(const app_kv_rec_t *p_rec, const uint8_t *p_value)
+{
+    uint32_t crc = app_kv_crc32(0, (const uint8_t *)p_rec, offsetof(app_kv_rec_t, crc));
+
+    return app_kv_crc32(crc, p_value, p_rec->len);
+}
+
+/**
+* Function Name:
+* app_kv_lookup
+*
+* Function Description:
+* @brief  Finds the index slot of a key, probing linearly from its hash
+*
+* @param key        Key
+*
+* @param p_probes   Incremented by the number of slots visited, may be NULL
+*
+* @return app_kv_slot_t*  Slot of the key, NULL if the key is not stored
+*/
+static app_kv_slot_t *app_kv_lookup(uint16_t key, uint32_t *p_probes)
+{
+    uint32_t slot = ((uint32_t)key * 2654435761u) % APP_KV_INDEX_SIZE;
+
+    for (uint32_t i = 0; i < APP_KV_INDEX_SIZE; i++)
+    {
+        app_kv_slot_t *p_slot = &app_kv_index[(slot + i) % APP_KV_INDEX_SIZE];
+
+        if (NULL != p_probes)
+        {
+            (*p_probes)++;
+        }
+        if (APP_KV_SLOT_EMPTY == p_slot->state)
+        {
+            break;
+        }
+        if ((APP_KV_SLOT_USED == p_slot->state) && (key == p_slot->key))
+        {
+            return p_slot;
+        }
+    }
+    return NULL;
+}
+
+/**
+* Function Name:
+* app_kv_put
+*
+* Function Description:
+* @brief  Points the index entry of a key to a new record. The record it
+*         pointed to before is no longer live.
+*
+* @param key      Key
+*
+* @param addr     Flash offset of the record
+*
+* @param len      Length of the value
+*
+* @return bool    false if the key is new and the index is full
+*/
+static bool app_kv_put(uint16_t key, uint32_t addr, uint8_t len)
+{
+    app_kv_slot_t *p_slot = app_kv_lookup(key, NULL);
+    uint32_t slot = ((uint32_t)key * 2654435761u) % APP_KV_INDEX_SIZE;
+
+    if (NULL != p_slot)
+    {
+        app_kv_live[APP_KV_SECTOR_OF(p_slot->addr)] -= APP_KV_REC_SIZE(p_slot->len);
+    }
+    else
+    {
+        if (APP_KV_MAX_KEYS == app_kv_keys)
+        {
+            return false;
+        }
+        /* Fewer keys than slots, a free slot is always found */
+        while (APP_KV_SLOT_USED == app_kv_index[slot].state)
+        {
+            slot = (slot + 1u) % APP_KV_INDEX_SIZE;
+        }
+        p_slot = &app_kv_index[slot];
+        p_slot->key = key;
+        p_slot->state = APP_KV_SLOT_USED;
+        app_kv_keys++;
+    }
+    p_slot->addr = addr;
+    p_slot->len = len;
+    app_kv_live[APP_KV_SECTOR_OF(addr)] += APP_KV_REC_SIZE(len);
+    return true;
+}
+
+/**
+* Function Name:
+* app_kv_remove
+*
+* Function Description:
+* @brief  Drops a key from the index, its record is no longer live
+*
+* @param key      Key
+*
+* @return void
+*/
+static void app_kv_remove(uint16_t key)
+{
+    app_kv_slot_t *p_slot = app_kv_lookup(key, NULL);
+
+    if (NULL != p_slot)
+    {
+        app_kv_live[APP_KV_SECTOR_OF(p_slot->addr)] -= APP_KV_REC_SIZE(p_slot->len);
+        p_slot->state = APP_KV_SLOT_DELETED;
+        app_kv_keys--;
+    }
+}
+
+/**
+* Function Name:
+* app_kv_free
+*
+* Function Description:
+* @brief  Counts the free sectors
+*
+* @return uint8_t  Number of erased sectors
+*/
+static uint8_t app_kv_free(void)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < APP_KV_SECTOR_COUNT; i++)
+    {
+        count += (0u == app_kv_seq[i]) ? 1u : 0u;
+    }
+    return count;
+}
+
+/**
+* Function Name:
+* app_kv_erase
+*
+* Function Description:
+* @brief  Erases a sector, which becomes free
+*
+* @param sector   Sector index
+*
+* @return bool    true if the sector was erased
+*/
+static bool app_kv_erase(uint8_t sector)
+{
+    if (CY_RSLT_SUCCESS != cy_ota_mem_erase(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                            APP_KV_SECTOR(sector), APP_KV_SECTOR_SIZE))
+    {
+        APP_LOG_ERR("KV sector %d erase failed\r\n", sector);
+        return false;
+    }
+    app_kv_seq[sector] = 0;
+    app_kv_live[sector] = 0;
+    app_kv_stats.erases++;
+    return true;
+}
+
+/**
+* Function Name:
+* app_kv_open
+*
+* Function Description:
+* @brief  Makes the sector after the head the new head. Sectors are used in
+*         ring order, so every sector is erased as often as the others and
+*         the sector after the head is always the oldest one in use.
+*
+* @return bool    false if that sector is not free or cannot be written
+*/
+static bool app_kv_open(void)
+{
+    uint8_t next = APP_KV_NEXT(app_kv_head);
+    app_kv_sector_t hdr = { APP_KV_MAGIC, app_kv_max_seq + 1u };
+
+    if (0u != app_kv_seq[next])
+    {
+        return false;
+    }
+    if (CY_RSLT_SUCCESS != cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                            APP_KV_SECTOR(next), &hdr, sizeof(hdr)))
+    {
+        APP_LOG_ERR("KV sector %d header write failed\r\n", next);
+        return false;
+    }
+    app_kv_stats.flash_bytes += sizeof(hdr);
+    app_kv_seq[next] = hdr.seq;
+    app_kv_max_seq = hdr.seq;
+    app_kv_head = next;
+    app_kv_wr = APP_KV_SECTOR(next) + sizeof(hdr);
+
+    /* Wake the store task before the last spare sector is needed */
+    if ((app_kv_free() < APP_KV_FREE_MIN) && (NULL != app_kv_task_handle))
+    {
+        xTaskNotifyGive(app_kv_task_handle);
+    }
+    return true;
+}
+
+/**
+* Function Name:
+* app_kv_append
+*
+* Function Description:
+* @brief  Programs a record at the head, opening the next sector when the
+*         head is full
+*
+* @param key        Key
+*
+* @param type       APP_KV_REC_VALUE or APP_KV_REC_DELETE
+*
+* @param p_value    Value, may be NULL when len is 0
+*
+* @param len        Length of the value
+*
+* @param p_addr     Set to the flash offset of the record
+*
+* @return bool      true if the record was written
+*/
+static bool app_kv_append(uint16_t key, uint8_t type, const void *p_value,
+                          uint8_t len, uint32_t *p_addr)
+{
+    uint8_t buf[APP_KV_REC_SIZE(APP_KV_VALUE_MAX)];
+    app_kv_rec_t *p_rec = (app_kv_rec_t *)buf;
+    uint32_t size = APP_KV_REC_SIZE(len);
+
+    if ((app_kv_wr + size > APP_KV_SECTOR(app_kv_head) + APP_KV_SECTOR_SIZE) &&
+        !app_kv_open())
+    {
+        return false;
+    }
+
+    /* Padding stays erased */
+    memset(buf, 0xFF, size);
+    p_rec->key = key;
+    p_rec->type = type;
+    p_rec->len = len;
+    if (0u != len)
+    {
+        memcpy(&buf[sizeof(app_kv_rec_t)], p_value, len);
+    }
+    p_rec->crc = app_kv_rec_crc(p_rec, &buf[sizeof(app_kv_rec_t)]);
+
+    if (CY_RSLT_SUCCESS != cy_ota_mem_write(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                            app_kv_wr, buf, size))
+    {
+        /* Part of the record may be programmed, the next one goes to a new
+         * sector */
+        APP_LOG_ERR("KV record write failed\r\n");
+        app_kv_wr = APP_KV_SECTOR(app_kv_head) + APP_KV_SECTOR_SIZE;
+        return false;
+    }
+    *p_addr = app_kv_wr;
+    app_kv_wr += size;
+    app_kv_stats.flash_bytes += size;
+    return true;
+}
+
+/**
+* Function Name:
+* app_kv_compact
+*
+* Function Description:
+* @brief  Frees the oldest sector: copies its live records to the head, then
+*         erases it. Delete records are dropped, no older sector is left
+*         for them to hide a value in. A reset before the erase leaves
+*         both copies, the newer one wins at load.
+*
+* @return bool    true if a sector was freed
+*/
+static bool app_kv_compact(void)
+{
+    uint8_t buf[APP_KV_REC_SIZE(APP_KV_VALUE_MAX)];
+    app_kv_rec_t *p_rec = (app_kv_rec_t *)buf;
+    uint8_t tail = APP_KV_NEXT(app_kv_head);
+    uint32_t end = APP_KV_SECTOR(tail) + APP_KV_SECTOR_SIZE;
+    uint32_t moved = 0;
+    uint32_t addr;
+    uint32_t new_addr;
+    app_kv_slot_t *p_slot;
+
+    /* Skip free sectors up to the oldest one in use */
+    while ((0u == app_kv_seq[tail]) && (tail != app_kv_head))
+    {
+        tail = APP_KV_NEXT(tail);
+        end = APP_KV_SECTOR(tail) + APP_KV_SECTOR_SIZE;
+    }
+    if (tail == app_kv_head)
+    {
+        return false;
+    }
+
+    addr = APP_KV_SECTOR(tail) + sizeof(app_kv_sector_t);
+    while ((app_kv_live[tail] > 0u) && (addr + sizeof(app_kv_rec_t) <= end))
+    {
+        if (CY_RSLT_SUCCESS != cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, addr,
+                                               buf, sizeof(app_kv_rec_t)))
+        {
+            return false;
+        }
+        if ((APP_KV_REC_FREE == p_rec->type) || (p_rec->len > APP_KV_VALUE_MAX))
+        {
+            break;
+        }
+        p_slot = app_kv_lookup(p_rec->key, NULL);
+        if ((NULL != p_slot) && (p_slot->addr == addr))
+        {
+            if ((CY_RSLT_SUCCESS != cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                    addr + sizeof(app_kv_rec_t),
+                                                    &buf[sizeof(app_kv_rec_t)], p_rec->len)) ||
+                !app_kv_append(p_rec->key, APP_KV_REC_VALUE, &buf[sizeof(app_kv_rec_t)],
+                               p_rec->len, &new_addr))
+            {
+                return false;
+            }
+            (void)app_kv_put(p_rec->key, new_addr, p_rec->len);
+            moved += APP_KV_REC_SIZE(p_rec->len);
+        }
+        addr += APP_KV_REC_SIZE(p_rec->len);
+    }
+
+    if (!app_kv_erase(tail))
+    {
+        return false;
+    }
+    app_kv_stats.compact_bytes += moved;
+    APP_LOG_INFO("KV sector %d compacted, %lu bytes moved, %lu bytes written for "
+                 "%lu bytes stored\r\n", tail, (unsigned long)moved,
+                 (unsigned long)app_kv_stats.flash_bytes,
+                 (unsigned long)app_kv_stats.user_bytes);
+    return true;
+}
+
+/**
+* Function Name:
+* app_kv_load
+*
+* Function Description:
+* @brief  Builds the index from the sectors in use, oldest first. Scanning
+*         the head stops at the first erased or damaged record; after a
+*         damaged one, writing resumes in the next sector. Sectors not in
+*         use are erased unless they are blank.
+*
+* @return void
+*/
+static void app_kv_load(void)
+{
+    uint8_t buf[APP_KV_REC_SIZE(APP_KV_VALUE_MAX)];
+    app_kv_rec_t *p_rec = (app_kv_rec_t *)buf;
+    app_kv_sector_t hdr;
+    uint8_t order[APP_KV_SECTOR_COUNT];
+    uint8_t used = 0;
+    uint32_t addr = 0;
+    uint32_t end = 0;
+    uint8_t sector;
+
+    for (sector = 0; sector < APP_KV_SECTOR_COUNT; sector++)
+    {
+        app_kv_seq[sector] = 0;
+        if ((CY_RSLT_SUCCESS == cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                APP_KV_SECTOR(sector), &hdr, sizeof(hdr))) &&
+            (APP_KV_MAGIC == hdr.magic) && (0u != hdr.seq) && (0xFFFFFFFFu != hdr.seq))
+        {
+            app_kv_seq[sector] = hdr.seq;
+            /* Insertion sort by sequence number */
+            uint8_t i = used++;
+            while ((i > 0u) && (app_kv_seq[order[i - 1u]] > hdr.seq))
+            {
+                order[i] = order[i - 1u];
+                i--;
+            }
+            order[i] = sector;
+        }
+    }
+
+    for (uint8_t i = 0; i < used; i++)
+    {
+        sector = order[i];
+        addr = APP_KV_SECTOR(sector) + sizeof(app_kv_sector_t);
+        end = APP_KV_SECTOR(sector) + APP_KV_SECTOR_SIZE;
+        while (addr + sizeof(app_kv_rec_t) <= end)
+        {
+            if (CY_RSLT_SUCCESS != cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH, addr,
+                                                   buf, sizeof(app_kv_rec_t)))
+            {
+                addr = end;
+                break;
+            }
+            if (APP_KV_REC_FREE == p_rec->type)
+            {
+                break;
+            }
+            if ((p_rec->len > APP_KV_VALUE_MAX) ||
+                (addr + APP_KV_REC_SIZE(p_rec->len) > end) ||
+                (CY_RSLT_SUCCESS != cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                    addr + sizeof(app_kv_rec_t),
+                                                    &buf[sizeof(app_kv_rec_t)], p_rec->len)) ||
+                (p_rec->crc != app_kv_rec_crc(p_rec, &buf[sizeof(app_kv_rec_t)])))
+            {
+                APP_LOG_WARNING("KV sector %d damaged at 0x%lx\r\n", sector,
+                                (unsigned long)addr);
+                addr = end;
+                break;
+            }
+
+            if (APP_KV_REC_VALUE == p_rec->type)
+            {
+                if (!app_kv_put(p_rec->key, addr, p_rec->len))
+                {
+                    APP_LOG_ERR("KV index full, key 0x%04x dropped\r\n", p_rec->key);
+                }
+            }
+            else if (APP_KV_REC_DELETE == p_rec->type)
+            {
+                app_kv_remove(p_rec->key);
+            }
+            addr += APP_KV_REC_SIZE(p_rec->len);
+        }
+        app_kv_head = sector;
+        app_kv_max_seq = app_kv_seq[sector];
+    }
+
+    if (0u == used)
+    {
+        /* The first write opens sector 0 */
+        app_kv_head = APP_KV_SECTOR_COUNT - 1u;
+        app_kv_max_seq = 0;
+        addr = APP_KV_SECTOR(app_kv_head) + APP_KV_SECTOR_SIZE;
+    }
+    app_kv_wr = addr;
+
+    for (sector = 0; sector < APP_KV_SECTOR_COUNT; sector++)
+    {
+        if (0u != app_kv_seq[sector])
+        {
+            continue;
+        }
+        for (uint32_t off = 0; off < APP_KV_SECTOR_SIZE; off += APP_KV_BLANK_CHUNK)
+        {
+            uint8_t chunk[APP_KV_BLANK_CHUNK];
+            uint32_t j = 0;
+
+            if (CY_RSLT_SUCCESS == cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                                   APP_KV_SECTOR(sector) + off,
+                                                   chunk, sizeof(chunk)))
+            {
+                while ((j < sizeof(chunk)) && (0xFFu == chunk[j]))
+                {
+                    j++;
+                }
+            }
+            if (j < sizeof(chunk))
+            {
+                (void)app_kv_erase(sector);
+                break;
+            }
+        }
+    }
+
+    APP_LOG_INFO("KV store: %d keys, %d sectors in use, head %d\r\n",
+                 app_kv_keys, used, app_kv_head);
+}
+
+/**
+* Function Name:
+* app_kv_task
+*
+* Function Description:
+* @brief  Loads the store once the external flash is up, then compacts the
+*         oldest sectors whenever writes leave fewer than APP_KV_FREE_MIN
+*         free sectors
+*
+* @param arg      Unused
+*
+* @return void
+*/
+static void app_kv_task(void *arg)
+{
+    (void)arg;
+
+    if (CY_RSLT_SUCCESS != app_ota_storage_wait(APP_KV_STORAGE_WAIT_MS))
+    {
+        APP_LOG_ERR("KV store not loaded, flash not ready\r\n");
+        vTaskDelete(NULL);
+    }
+
+    xSemaphoreTake(app_kv_mutex, portMAX_DELAY);
+    app_kv_load();
+    xSemaphoreGive(app_kv_mutex);
+    xEventGroupSetBits(app_kv_events, APP_KV_READY_BIT);
+
+    if (NULL != app_kv_loaded_cb)
+    {
+        app_kv_loaded_cb();
+    }
+
+    while (true)
+    {
+        xSemaphoreTake(app_kv_mutex, portMAX_DELAY);
+        while ((app_kv_free() < APP_KV_FREE_MIN) && app_kv_compact())
+        {
+        }
+        xSemaphoreGive(app_kv_mutex);
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+* Function Name:
+* app_kv_start
+*
+* Function Description:
+* @brief  Creates the store task. Call from main() before the scheduler
+*         starts, after app_ota_storage_start().
+*
+* @param p_loaded_cb  Called in the store task once the store is loaded,
+*                     may be NULL
+*
+* @return cy_rslt_t   CY_RSLT_SUCCESS, or APP_KV_RSLT_NOT_READY
+*/
+cy_rslt_t app_kv_start(app_kv_loaded_cb_t p_loaded_cb)
+{
+    app_kv_loaded_cb = p_loaded_cb;
+    app_kv_mutex = xSemaphoreCreateMutex();
+    app_kv_events = xEventGroupCreate();
+    if ((NULL == app_kv_mutex) || (NULL == app_kv_events))
+    {
+        return APP_KV_RSLT_NOT_READY;
+    }
+
+    if (pdPASS != xTaskCreate(app_kv_task, APP_KV_TASK_NAME, APP_KV_TASK_STACK_SIZE,
+                              NULL, APP_KV_TASK_PRIORITY, &app_kv_task_handle))
+    {
+        return APP_KV_RSLT_NOT_READY;
+    }
+    app_monitor_task_size(APP_KV_TASK_NAME, APP_KV_TASK_STACK_SIZE);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_kv_acquire
+*
+* Function Description:
+* @brief  Waits for the store to be loaded, then takes its mutex
+*
+* @return cy_rslt_t  CY_RSLT_SUCCESS with the mutex held, or
+*                    APP_KV_RSLT_NOT_READY
+*/
+static cy_rslt_t app_kv_acquire(void)
+{
+    if ((NULL == app_kv_events) ||
+        (0u == (APP_KV_READY_BIT & xEventGroupWaitBits(app_kv_events, APP_KV_READY_BIT,
+                                                       pdFALSE, pdTRUE,
+                                                       pdMS_TO_TICKS(APP_KV_WAIT_MS)))))
+    {
+        return APP_KV_RSLT_NOT_READY;
+    }
+    xSemaphoreTake(app_kv_mutex, portMAX_DELAY);
+    return CY_RSLT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_kv_get
+*
+* Function Description:
+* @brief  Reads the value of a key. The index gives the record, the value
+*         is read from the flash.
+*
+* @param key        Key
+*
+* @param p_value    Filled with the value, truncated to size bytes
+*
+* @param size       Size of the buffer
+*
+* @param p_len      Set to the length of the stored value, may be NULL
+*
+* @return cy_rslt_t CY_RSLT_SUCCESS, APP_KV_RSLT_NOT_FOUND, APP_KV_RSLT_NOT_READY
+*                   or APP_KV_RSLT_FLASH
+*/
+cy_rslt_t app_kv_get(uint16_t key, void *p_value, uint8_t size, uint8_t *p_len)
+{
+    uint32_t start = app_log_cycles();
+    uint32_t elapsed_us;
+    app_kv_slot_t *p_slot;
+    cy_rslt_t result = app_kv_acquire();
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    app_kv_stats.lookups++;
+    p_slot = app_kv_lookup(key, &app_kv_stats.lookup_probes);
+    if (NULL == p_slot)
+    {
+        result = APP_KV_RSLT_NOT_FOUND;
+    }
+    else
+    {
+        if (NULL != p_len)
+        {
+            *p_len = p_slot->len;
+        }
+        if (CY_RSLT_SUCCESS != cy_ota_mem_read(CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+                                               p_slot->addr + sizeof(app_kv_rec_t), p_value,
+                                               (p_slot->len < size) ? p_slot->len : size))
+        {
+            result = APP_KV_RSLT_FLASH;
+        }
+    }
+
+    elapsed_us = (app_log_cycles() - start) / (SystemCoreClock / 1000000u);
+    if (elapsed_us > app_kv_stats.lookup_max_us)
+    {
+        app_kv_stats.lookup_max_us = elapsed_us;
+    }
+    xSemaphoreGive(app_kv_mutex);
+    return result;
+}
+
+/**
+* Function Name:
+* app_kv_write
+*
+* Function Description:
+* @brief  Appends a record and updates the index. When the record needs a
+*         new sector and the store task has not kept enough free sectors,
+*         compacts in the caller first, while a sector is left for it.
+*
+* @param key        Key
+*
+* @param type       APP_KV_REC_VALUE or APP_KV_REC_DELETE
+*
+* @param p_value    Value
+*
+* @param len        Length of the value
+*
+* @return cy_rslt_t CY_RSLT_SUCCESS, APP_KV_RSLT_NOT_READY, APP_KV_RSLT_FULL
+*                   or APP_KV_RSLT_FLASH
+*/
+static cy_rslt_t app_kv_write(uint16_t key, uint8_t type, const void *p_value, uint8_t len)
+{
+    uint32_t addr;
+    cy_rslt_t result = app_kv_acquire();
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    if ((APP_KV_REC_VALUE == type) && (NULL == app_kv_lookup(key, NULL)) &&
+        (APP_KV_MAX_KEYS == app_kv_keys))
+    {
+        result = APP_KV_RSLT_FULL;
+    }
+    else if ((app_kv_free() < APP_KV_FREE_MIN) &&
+             (app_kv_wr + APP_KV_REC_SIZE(len) > APP_KV_SECTOR(app_kv_head) + APP_KV_SECTOR_SIZE) &&
+             !app_kv_compact())
+    {
+        result = APP_KV_RSLT_FLASH;
+    }
+    else if (!app_kv_append(key, type, p_value, len, &addr))
+    {
+        result = APP_KV_RSLT_FLASH;
+    }
+    else if (APP_KV_REC_VALUE == type)
+    {
+        (void)app_kv_put(key, addr, len);
+        app_kv_stats.user_bytes += len;
+    }
+    else
+    {
+        app_kv_remove(key);
+    }
+
+    xSemaphoreGive(app_kv_mutex);
+    return result;
+}
+
+/**
+* Function Name:
+* app_kv_set
+*
+* Function Description:
+* @brief  Stores the value of a key. Blocks for the flash write.
+*
+* @param key        Key, not 0xFFFF
+*
+* @param p_value    Value
+*
+* @param len        Length of the value, at most APP_KV_VALUE_MAX
+*
+* @return cy_rslt_t CY_RSLT_SUCCESS, APP_KV_RSLT_BAD_ARG, APP_KV_RSLT_NOT_READY,
+*                   APP_KV_RSLT_FULL or APP_KV_RSLT_FLASH
+*/
+cy_rslt_t app_kv_set(uint16_t key, const void *p_value, uint8_t len)
+{
+    if ((0xFFFFu == key) || (len > APP_KV_VALUE_MAX) || ((NULL == p_value) && (0u != len)))
+    {
+        return APP_KV_RSLT_BAD_ARG;
+    }
+    return app_kv_write(key, APP_KV_REC_VALUE, p_value, len);
+}
+
+/**
+* Function Name:
+* app_kv_delete
+*
+* Function Description:
+* @brief  Removes a key. Deleting a key that is not stored writes nothing.
+*
+* @param key        Key
+*
+* @return cy_rslt_t CY_RSLT_SUCCESS, APP_KV_RSLT_NOT_READY or APP_KV_RSLT_FLASH
+*/
+cy_rslt_t app_kv_delete(uint16_t key)
+{
+    cy_rslt_t result = app_kv_acquire();
+    bool stored;
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+    stored = (NULL != app_kv_lookup(key, NULL));
+    xSemaphoreGive(app_kv_mutex);
+
+    return stored ? app_kv_write(key, APP_KV_REC_DELETE, NULL, 0) : CY_RSLT_SUCCESS;
+}
+
+/**
+* Function Name:
+* app_kv_get_stats
+*
+* Function Description:
+* @brief  Copies the counters of the store
+*
+* @param p_stats    Filled with the counters
+*
+* @return void
+*/
+void app_kv_get_stats(app_kv_stats_t *p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = app_kv_stats;
+    taskEXIT_CRITICAL();
+}
+
+/* [] END OF FILE */
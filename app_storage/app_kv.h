@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * File Name: app_kv.h
+ *
+ * Description: Public interface of the key-value store kept in the
+ *              external flash
+ *
+ * Related Document: See README.md
+ *
+ *
+ *******************************************************************************
+ * (c) 2021-2026, Infineon Technologies AG, or an affiliate of Infineon
+ * Technologies AG. All rights reserved.
+ * This software, associated documentation and materials ("Software") is
+ * owned by Infineon Technologies AG or one of its affiliates ("Infineon")
+ * and is protected by and subject to worldwide patent protection, worldwide
+ * copyright laws, and international treaty provisions. Therefore, you may use
+ * this Software only as provided in the license agreement accompanying the
+ * software package from which you obtained this Software. If no license
+ * agreement applies, then any use, reproduction, modification, translation, or
+ * compilation of this Software is prohibited without the express written
+ * permission of Infineon.
+ *
+ * Disclaimer: UNLESS OTHERWISE EXPRESSLY AGREED WITH INFINEON, THIS SOFTWARE
+ * IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING, BUT NOT LIMITED TO, ALL WARRANTIES OF NON-INFRINGEMENT OF
+ * THIRD-PARTY RIGHTS AND IMPLIED WARRANTIES SUCH AS WARRANTIES OF FITNESS FOR A
+ * SPECIFIC USE/PURPOSE OR MERCHANTABILITY.
+ * Infineon reserves the right to make changes to the Software without notice.
+ * You are responsible for properly designing, programming, and testing the
+ * functionality and safety of your intended application of the Software, as
+ * well as complying with any legal requirements related to its use. Infineon
+ * does not guarantee that the Software will be free from intrusion, data theft
+ * or loss, or other breaches ("Security Breaches"), and Infineon shall have
+ * no liability arising out of any Security Breaches. Unless otherwise
+ * explicitly approved by Infineon, the Software may not be used in any
+ * application where a failure of the Product or any consequences of the use
+ * thereof can reasonably be expected to result in personal injury.
+ ******************************************************************************/
+
+#ifndef APP_KV_H__
+#define APP_KV_H__
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/**
+ * @brief Region of the store in the external flash, after the bond store.
+ *        Must not overlap flashmap.mk areas. Sectors are used in a ring.
+ */
+#define APP_KV_FLASH_OFFSET             (0x000F1000u)
+#define APP_KV_SECTOR_SIZE              (0x00001000u)
+#define APP_KV_SECTOR_COUNT             (4u)
+
+/**
+ * @brief Largest number of keys and largest value
+ */
+#define APP_KV_MAX_KEYS                 (32u)
+#define APP_KV_VALUE_MAX                (64u)
+
+/**
+ * @brief Longest wait of a caller for the store to be loaded
+ */
+#define APP_KV_WAIT_MS                  (3000u)
+
+/**
+ * @brief Results besides CY_RSLT_SUCCESS
+ */
+#define APP_KV_RSLT_MODULE              (CY_RSLT_MODULE_MIDDLEWARE_BASE + 0x50u)
+#define APP_KV_RSLT_NOT_READY           CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, APP_KV_RSLT_MODULE, 1u)
+#define APP_KV_RSLT_NOT_FOUND           CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, APP_KV_RSLT_MODULE, 2u)
+#define APP_KV_RSLT_BAD_ARG             CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, APP_KV_RSLT_MODULE, 3u)
+#define APP_KV_RSLT_FULL                CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, APP_KV_RSLT_MODULE, 4u)
+#define APP_KV_RSLT_FLASH               CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, APP_KV_RSLT_MODULE, 5u)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/**
+ * @brief Keys in use. 0xFFFF is reserved, it reads as erased flash.
+ */
+typedef enum
+{
+    APP_KV_KEY_LOG_LEVELS = 0x0001,     /* Run-time level of every log module */
+} app_kv_key_t;
+
+/**
+ * @brief Counters since boot. Write amplification is flash_bytes over
+ *        user_bytes; compaction copies are part of flash_bytes.
+ */
+typedef struct
+{
+    uint32_t    user_bytes;             /* Values passed to app_kv_set() */
+    uint32_t    flash_bytes;            /* Bytes programmed, headers included */
+    uint32_t    compact_bytes;          /* Bytes copied by compaction */
+    uint32_t    erases;                 /* Sectors erased */
+    uint32_t    lookups;                /* app_kv_get() calls */
+    uint32_t    lookup_probes;          /* Index slots visited by them */
+    uint32_t    lookup_max_us;          /* Longest app_kv_get(), flash read included */
+} app_kv_stats_t;
+
+/**
+ * @brief Called by the store task once the store is loaded
+ */
+typedef void (*app_kv_loaded_cb_t)(void);
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+cy_rslt_t app_kv_start      (app_kv_loaded_cb_t p_loaded_cb);
+cy_rslt_t app_kv_get        (uint16_t key, void *p_value, uint8_t size, uint8_t *p_len);
+cy_rslt_t app_kv_set        (uint16_t key, const void *p_value, uint8_t len);
+cy_rslt_t app_kv_delete     (uint16_t key);
+void      app_kv_get_stats  (app_kv_stats_t *p_stats);
+
+#endif
+/* [] END OF FILE */
@@ -96,8 +96,17 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK            1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
-/* Run time and task stats gathering related definitions. */
+/* Run time and task stats gathering related definitions. The run-time
+ * counter counts microseconds of awake CPU time, see app_diag/app_rtstats.c */
+#if defined(APP_RTSTATS) && (APP_RTSTATS == 1)
+#define configGENERATE_RUN_TIME_STATS           1
+extern void app_rtstats_timer_init(void);
+extern uint32_t app_rtstats_counter(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() app_rtstats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        app_rtstats_counter()
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
@@ -81,22 +81,31 @@
 #include "cy_ota_storage_api.h"
 #include "app_ota_context.h"
 #include "cybsp_bt_config.h"
+#include "app_log.h"
+#include "app_rtstats.h"
+#include "app_monitor.h"
+#include "app_trace.h"
+#include "app_boot_time.h"
+#include "app_ota_storage.h"
+#include "app_bt_bond.h"
+#include "app_kv.h"
+#include "app_bas_hist.h"
+#include "app_sched.h"
+#include "app_reboot.h"
+#include "app_bt_gatt_queue.h"
+#include "app_bt_svc_bas.h"
+#include "app_bt_svc_diag.h"
 
 /*******************************************************************************
 *        Macro Definitions
 *******************************************************************************/
 /* Sufficient Heap size for Bluetooth activities */
 #define BT_HEAP_SIZE                        (0x1000)
-#define BLE_TASK_NAME                       "BAS Task"
-#define BAS_TASK_STACK_SIZE                 (256u)
-#define BAS_TASK_PRIORITY                   (configMAX_PRIORITIES - 3)
 
 /*******************************************************************************
 *        Variable Definitions
 *******************************************************************************/
 
-extern TaskHandle_t bas_task_handle;
-
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
@@ -122,7 +131,10 @@ int main()
     cy_rslt_t cy_result;
     wiced_result_t  result;
     cyhal_wdt_t wdt_obj;
-    BaseType_t rtos_result;
+    wiced_bt_heap_t *p_bt_heap;
+
+    /* Time every phase up to the first advertisement */
+    app_boot_time_start();
 
     /* Initialize the board support package */
     cy_result = cybsp_init();
@@ -130,6 +142,7 @@ int main()
     {
         CY_ASSERT(0);
     }
+    app_boot_time_mark(APP_BOOT_PHASE_BSP);
 
     /* Enable global interrupts */
     __enable_irq();
@@ -138,11 +151,19 @@ int main()
     cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX,
         CY_RETARGET_IO_BAUDRATE);
 
+    /* Queue printf() and cy_log output, the log task drains it to the UART */
+    app_log_init();
+
     /* default for all logging to WARNING */
-    cy_log_init(CY_LOG_INFO, NULL, NULL);
+    cy_log_init(CY_LOG_INFO, app_log_cy_log_output, NULL);
+
+    /* Every module, OTA included, starts at INFO. The levels can be changed
+     * through the Log Levels characteristic of the diagnostics service. */
+    app_log_levels_init(CY_LOG_INFO);
 
-    /* default for OTA logging to NOTICE */
-    cy_ota_set_log_level(CY_LOG_INFO);
+    /* Record the boot in the trace ring, print the previous run's trace */
+    app_trace_init();
+    app_boot_time_mark(APP_BOOT_PHASE_LOG);
 
 
     /*Initialize QuadSPI if using external flash*/
@@ -151,6 +172,7 @@ int main()
     {
         printf("ERROR returned from cybsp_smif_init()!!!\r\n");
     }
+    app_boot_time_mark(APP_BOOT_PHASE_SMIF);
 
     printf("*******BTSTACK FREERTOS EXAMPLE************\r\n");
     printf("*******Battery Server Application Start with OTA************\r\n");
@@ -164,25 +186,6 @@ int main()
     /* set default values for battery server context */
     ota_initialize_default_values();
 
-    /* We need to init from every ext flash write
-     * See serial_flash.h in app itself.
-     */
-    printf("call cy_ota_storage_init()\n");
-    if (cy_ota_storage_init() != CY_RSLT_SUCCESS)
-    {
-        printf("ERROR returned from cy_ota_storage_init()!!!!!\n");
-    }
-    /* Validate the update so we do not revert on reboot */
-    cy_result = cy_ota_storage_image_validate(0);
-    if (cy_result != CY_RSLT_SUCCESS)
-    {
-        printf("cy_ota_storage_image_validate() Failed\n");
-    }
-    else
-    {
-        printf("cy_ota_storage_image_validate() Successful\n");
-    }
-
     if (cy_ota_ble_check_build_vs_configurator() != CY_RSLT_SUCCESS)
     {
         printf("Failed configurator check \r \n");
@@ -191,11 +194,15 @@ int main()
             cy_rtos_delay_milliseconds(1000);
         }
     }
+    app_boot_time_mark(APP_BOOT_PHASE_CONFIG_CHECK);
 
     /* Clear watchdog so it doesn't reboot on us */
     cyhal_wdt_init(&wdt_obj, cyhal_wdt_get_max_timeout_ms());
     cyhal_wdt_free(&wdt_obj);
 
+    /* Bonds and identity keys are answered from RAM once the stack asks */
+    app_bt_bond_init();
+
     /* Register call back and configuration with stack */
     result = wiced_bt_stack_init(app_bt_management_callback, &wiced_bt_cfg_settings);
 
@@ -205,22 +212,64 @@ int main()
         printf("Bluetooth Stack Initialization failed!! \r\n");
         CY_ASSERT(0);
     }
+    app_boot_time_mark(APP_BOOT_PHASE_STACK_INIT);
 
     /* Create a buffer heap, make it the default heap.  */
-    if ( NULL == wiced_bt_create_heap("app", NULL, BT_HEAP_SIZE, NULL, WICED_TRUE))
+    p_bt_heap = wiced_bt_create_heap("app", NULL, BT_HEAP_SIZE, NULL, WICED_TRUE);
+    if (NULL == p_bt_heap)
     {
         printf("Heap create Failed");
     }
+    app_monitor_bt_heap(p_bt_heap, BT_HEAP_SIZE);
+
+    /* Battery sampling, LED updates, OTA progress and telemetry share one
+     * event loop driven by software timers */
+    app_sched_init();
+    app_sched_register(APP_SCHED_EVT_BATTERY, app_bt_svc_bas_update, BATTERY_LEVEL_UPDATE_MS);
+    app_sched_periodic(APP_SCHED_EVT_BATTERY, true);
+
+    /* Reboots close the links and flush the flash and the log first. The
+     * cause of the reboot that started this run is reported at advertising */
+    app_reboot_init();
+
+    /* GATT attribute requests are served in their own task, the stack
+     * callback only copies them */
+    app_bt_gatt_queue_init();
+
+    /* OTA storage init and image validation run while the controller starts,
+     * OTA control point commands wait for them */
+    if (app_ota_storage_start() != CY_RSLT_SUCCESS)
+    {
+        printf("OTA storage task creation failed\n");
+        CY_ASSERT(0);
+    }
 
-    /*Create battery service task*/
-    rtos_result = xTaskCreate(bas_task,BLE_TASK_NAME, BAS_TASK_STACK_SIZE,
-                            NULL,BAS_TASK_PRIORITY, &bas_task_handle);
-    if(pdPASS != rtos_result)
+    /* The key-value store loads once the external flash is up, then the
+     * saved log levels are applied */
+    if (app_kv_start(app_bt_svc_diag_levels_restore) != CY_RSLT_SUCCESS)
     {
-        printf("BAS task creation failed\n");
+        printf("KV store task creation failed\n");
         CY_ASSERT(0);
     }
 
+    /* The battery history loads from the external flash with its first
+     * sample */
+    if (!app_bas_hist_init())
+    {
+        printf("Battery history lock creation failed\n");
+        CY_ASSERT(0);
+    }
+
+    /* Logs stack and heap peaks with recommended sizes */
+    app_monitor_init();
+
+#if APP_RTSTATS
+    /* CPU usage per task, reported every APP_RTSTATS_WINDOW_MS */
+    app_rtstats_init();
+#endif
+
+    app_boot_time_mark(APP_BOOT_PHASE_SCHEDULER);
+
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
 
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Decodes a battery history read from the Battery History characteristic.
+
+Writing 01 <from u32> <to u32> (device seconds, little endian) to the
+characteristic streams the history blocks covering that range as
+notifications: 01 followed by the next bytes of the block stream, then a
+final 02 <device time now u32> <blocks u16>. Save the notification values
+one per line as hex, in the order received; other lines are ignored.
+
+The block stream is a sequence of blocks, each a 24-byte header followed
+by its samples (see app_bas_hist_hdr_t in app_storage/app_bas_hist.h):
+the first sample is in the header, then every sample is one nibble, a
+level change of -7..+7 one interval after the previous sample, or the
+escape 8 and 6 nibbles: 16 bits of seconds since the previous sample and
+8 bits of level.
+
+Prints one time,age,level line per sample, age being the seconds before
+the end of the read.
+
+Usage: app_bas_hist_decode.py [notifications.txt]
+       Reads the notifications from the file, or from stdin.
+"""
+
+import struct
+import sys
+import zlib
+
+FRAME_DATA = 0x01
+FRAME_END = 0x02
+
+HDR = struct.Struct("<HBBIIIBBHI")
+MAGIC = 0x4842
+ESCAPE = 0x8
+
+
+def frames(lines):
+    """Yields the notification values as bytes."""
+    for line in lines:
+        text = line.strip().replace(" ", "").replace(":", "").replace("-", "")
+        if text.lower().startswith("0x"):
+            text = text[2:]
+        try:
+            value = bytes.fromhex(text)
+        except ValueError:
+            continue
+        if value:
+            yield value
+
+
+def nibbles(data):
+    for byte in data:
+        yield byte >> 4
+        yield byte & 0x0F
+
+
+def decode_block(hdr, data):
+    """Returns the (time, level) samples of a block."""
+    (_, _, count, _, t_first, t_last, level, interval, _, _) = hdr
+    t = t_first
+    samples = [(t, level)]
+    codes = nibbles(data)
+    while len(samples) < count:
+        code = next(codes)
+        if code == ESCAPE:
+            dt = 0
+            for _ in range(4):
+                dt = (dt << 4) | next(codes)
+            level = (next(codes) << 4) | next(codes)
+            t += dt
+        else:
+            t += interval
+            level += code - 16 if code > 7 else code
+        samples.append((t, level))
+    if t != t_last:
+        sys.stderr.write("block ending at %d decodes to %d\n" % (t_last, t))
+    return samples
+
+
+def blocks(stream):
+    """Yields the checked blocks of the stream."""
+    pos = 0
+    while pos + HDR.size <= len(stream):
+        hdr = HDR.unpack_from(stream, pos)
+        (magic, length, _, seq) = hdr[:4]
+        data = stream[pos + HDR.size:pos + HDR.size + length]
+        if magic != MAGIC or len(data) != length:
+            sys.stderr.write("stream damaged at byte %d\n" % pos)
+            return
+        # The CRC covers the header up to the crc field, then the samples
+        crc = zlib.crc32(data, zlib.crc32(stream[pos:pos + HDR.size - 4]))
+        pos += HDR.size + length
+        if crc != hdr[-1]:
+            sys.stderr.write("block %d fails its CRC, skipped\n" % seq)
+            continue
+        yield hdr, data
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    stream = bytearray()
+    now = None
+    sent = 0
+    for value in frames(src):
+        if value[0] == FRAME_DATA:
+            stream += value[1:]
+        elif value[0] == FRAME_END and len(value) >= 7:
+            (now, sent) = struct.unpack_from("<IH", value, 1)
+
+    if now is None:
+        sys.stderr.write("no end frame, the read was cut short\n")
+    received = 0
+    print("time,age,level")
+    for hdr, data in blocks(bytes(stream)):
+        received += 1
+        for t, level in decode_block(hdr, data):
+            age = (now - t) if now is not None else ""
+            print("%d,%s,%d" % (t, age, level))
+    if now is not None and received != sent:
+        sys.stderr.write("%d blocks sent, %d decoded\n" % (sent, received))
+
+
+if __name__ == "__main__":
+    main()
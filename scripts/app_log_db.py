@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Builds the token database of a tokenized log build (APP_LOG_TOKENIZED=1).
+
+The format strings of every tokenized printf() are kept in the .app_log_fmt
+section of the ELF file. This section is not loaded to the device. The
+script reads it, computes the token of each string exactly as
+APP_LOG_TOKEN() in app_log/app_log_token.h does, and writes a JSON
+object that maps tokens to format strings for scripts/app_log_decode.py.
+
+Usage: app_log_db.py <app.elf> <tokens.json>
+"""
+
+import json
+import struct
+import sys
+
+SECTION = ".app_log_fmt"
+
+# Must match APP_LOG_TOKEN_HASH_LEN in app_log/app_log_token.h
+HASH_LENGTH = 80
+HASH_K = 65599
+
+
+def token(fmt):
+    """65599 hash of the first HASH_LENGTH bytes, seeded with the length."""
+    value = len(fmt)
+    coefficient = HASH_K
+    for byte in fmt[:HASH_LENGTH]:
+        value = (value + coefficient * byte) & 0xFFFFFFFF
+        coefficient = (coefficient * HASH_K) & 0xFFFFFFFF
+    return value
+
+
+def read_section(path, name):
+    """Returns the content of one section of a 32-bit little endian ELF file."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        raise ValueError("%s is not a 32-bit little endian ELF file" % path)
+
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def header(index):
+        return struct.unpack_from("<IIIIIIIIII", data, shoff + index * shentsize)
+
+    names = header(shstrndx)
+    for index in range(shnum):
+        sh_name, _, _, _, sh_offset, sh_size = header(index)[:6]
+        start = names[4] + sh_name
+        if data[start:data.index(b"\0", start)].decode() == name:
+            return data[sh_offset:sh_offset + sh_size]
+    return b""
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__.strip())
+        return 2
+
+    tokens = {}
+    collisions = 0
+    for fmt in read_section(argv[1], SECTION).split(b"\0"):
+        if not fmt:
+            continue
+        key = "0x%08x" % token(fmt)
+        text = fmt.decode("utf-8", "replace")
+        if key in tokens and tokens[key] != text:
+            print("app_log_db: token %s collision: %r and %r" % (key, tokens[key], text))
+            collisions += 1
+        tokens[key] = text
+
+    with open(argv[2], "w") as out:
+        json.dump(tokens, out, indent=1, sort_keys=True)
+    print("app_log_db: %d format strings in %s" % (len(tokens), argv[2]))
+    return 1 if collisions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
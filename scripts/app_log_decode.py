@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Decodes the debug UART output of a tokenized log build (APP_LOG_TOKENIZED=1).
+
+Frames are: 0xA5, payload length, payload, 8-bit sum of the payload. The
+payload starts with a 32-bit little endian token. Token 0 carries plain
+text. Any other token is looked up in the database written by
+scripts/app_log_db.py, and the arguments are decoded as the format string
+describes them:
+  - integers are unsigned LEB128
+  - doubles are 8 raw bytes
+  - strings are a length byte followed by the bytes
+Bytes outside frames, such as the bootloader output, pass through as they
+are.
+
+Usage: app_log_decode.py <tokens.json> [capture.bin]
+       Reads the raw UART capture from the file, or from stdin.
+"""
+
+import json
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+
+# One printf conversion specification, see app_log_spec() in app_log.c
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L|q)?([diouxXcspfFeEgGaAn%])")
+
+
+def varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def signed(value, bits):
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+
+def render(fmt, args):
+    """Formats a C printf string with already decoded arguments."""
+    out = []
+    pos = 0
+    index = 0
+
+    def take():
+        nonlocal index
+        index += 1
+        return args[index - 1] if index <= len(args) else 0
+
+    for match in SPEC.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+        flags, width, precision, length, conv = match.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(signed(take(), 32))
+        if precision == "*":
+            precision = str(signed(take(), 32))
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        value = take()
+        bits = 64 if length in ("ll", "j") else 32
+        if conv == "n":
+            continue
+        if conv in "di":
+            out.append((spec + "d") % signed(value, bits))
+        elif conv == "u":
+            out.append((spec + "d") % value)
+        elif conv == "p":
+            out.append(("%#" + spec[1:] + "x") % value)
+        elif conv == "c":
+            out.append((spec + "c") % chr(value & 0xFF))
+        elif conv == "s":
+            out.append((spec + "s") % value)
+        else:
+            out.append((spec + conv) % value)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode(fmt, data):
+    """Decodes the arguments of one tokenized record."""
+    args = []
+    pos = 0
+    for match in SPEC.finditer(fmt):
+        _, width, precision, length, conv = match.groups()
+        stars = (width == "*") + (precision == "*")
+        for _ in range(stars):
+            value, pos = varint(data, pos)
+            args.append(value)
+        if conv == "%":
+            continue
+        if conv in "fFeEgGaA":
+            args.append(struct.unpack_from("<d", data, pos)[0])
+            pos += 8
+        elif conv == "s":
+            size = data[pos]
+            args.append(data[pos + 1:pos + 1 + size].decode("utf-8", "replace"))
+            pos += 1 + size
+        else:
+            value, pos = varint(data, pos)
+            args.append(value)
+    return render(fmt, args)
+
+
+def frames(stream, tokens, write):
+    """Splits a byte stream into frames and passes other bytes through."""
+    buf = b""
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while buf:
+            if buf[0] != SYNC:
+                end = buf.find(bytes([SYNC]))
+                end = len(buf) if end < 0 else end
+                write(buf[:end].decode("utf-8", "replace"))
+                buf = buf[end:]
+                continue
+            if len(buf) < 2 or len(buf) < buf[1] + 3:
+                break
+            size = buf[1]
+            payload = buf[2:2 + size]
+            if size < 4 or sum(payload) & 0xFF != buf[2 + size]:
+                # Not a frame, pass the sync byte through and resynchronize
+                write(buf[:1].decode("latin-1"))
+                buf = buf[1:]
+                continue
+            buf = buf[3 + size:]
+            token, = struct.unpack_from("<I", payload)
+            if token == 0:
+                write(payload[4:].decode("utf-8", "replace"))
+            elif "0x%08x" % token in tokens:
+                try:
+                    write(decode(tokens["0x%08x" % token], payload[4:]))
+                except (IndexError, TypeError, ValueError, struct.error):
+                    write("<token 0x%08x: bad arguments %s>\n" % (token, payload[4:].hex()))
+            else:
+                write("<unknown token 0x%08x %s>\n" % (token, payload[4:].hex()))
+    if buf:
+        write(buf.decode("latin-1"))
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        print(__doc__.strip())
+        return 2
+
+    with open(argv[1]) as db:
+        tokens = json.load(db)
+
+    def write(text):
+        sys.stdout.write(text.replace("\r\n", "\n"))
+        sys.stdout.flush()
+
+    if len(argv) == 3:
+        with open(argv[2], "rb") as stream:
+            frames(stream, tokens, write)
+    else:
+        frames(sys.stdin.buffer, tokens, write)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+Turns the event trace printed by a build with APP_TRACE=1 into a timeline.
+
+At boot, the firmware prints the trace ring retained from the previous run
+between a TRC-HDR,<cycles per us>,<entries> line and a TRC-END line, one
+TRC,<index>,<cycles>,<ms>,<id>,<code>,<conn_id>,<handle>,<arg>,<name> line
+per entry (see app_diag/app_trace.h). Other lines of the capture are
+ignored. The last complete dump is decoded, it holds the oldest runs still
+in the ring; each BOOT entry starts a new run.
+
+The time between two entries comes from the cycle counter when it agrees
+with the RTOS tick count, from the tick count otherwise: the cycle counter
+wraps every few tens of seconds and stops in deep sleep.
+
+The timeline is followed by the latency of each phase of a connection:
+boot to advertising, advertising to connection, connection to MTU
+exchange, encryption, first write and disconnection.
+
+Usage: app_trace_timeline.py [capture.txt]
+       Reads the text UART capture from the file, or from stdin.
+"""
+
+import sys
+
+# app_trace_id_t in app_diag/app_trace.h
+TRACE_BOOT = 1
+TRACE_BTM = 2
+TRACE_GATT = 3
+TRACE_WRITE = 4
+
+ATT_OPCODES = {
+    0x02: "MTU",
+    0x08: "READ_BY_TYPE",
+    0x0A: "READ",
+    0x0C: "READ_BLOB",
+    0x0E: "READ_MULTI",
+    0x12: "WRITE",
+    0x16: "PREPARE",
+    0x18: "EXECUTE",
+    0x1E: "CONF",
+    0x52: "CMD_WRITE",
+}
+ATT_MTU = 0x02
+
+# Longest tick delta checked against the cycle counter, and the agreement
+# needed between the two (the tick is 1 ms)
+CYCLES_MAX_MS = 40000
+CYCLES_TOLERANCE_MS = 2.0
+
+PHASES = (
+    "boot -> advertising",
+    "advertising -> connect",
+    "connect -> MTU",
+    "connect -> encryption",
+    "connect -> first write",
+    "connect -> disconnect",
+)
+
+
+class Entry(object):
+    def __init__(self, fields):
+        (self.index, self.cycles, self.ms, self.id, self.code, self.conn_id,
+         self.handle, self.arg) = [int(f) for f in fields[1:9]]
+        self.name = fields[9] if len(fields) > 9 else "-"
+        self.time_us = 0.0
+
+
+def last_dump(lines):
+    """Returns (cycles per us, entries) of the last complete dump."""
+    dump = None
+    current = None
+    mhz = 0
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRC-HDR,"):
+            mhz = int(line.split(",")[1]) or 1
+            current = []
+        elif line.startswith("TRC-END") and current is not None:
+            dump = (mhz, current)
+            current = None
+        elif line.startswith("TRC,") and current is not None:
+            fields = line.split(",")
+            if len(fields) >= 9:
+                current.append(Entry(fields))
+    return dump
+
+
+def split_runs(entries):
+    """Splits the entries at BOOT entries."""
+    runs = []
+    for entry in entries:
+        if entry.id == TRACE_BOOT or not runs:
+            runs.append([])
+        runs[-1].append(entry)
+    return runs
+
+
+def timestamp(run, mhz):
+    """Sets time_us of every entry, relative to the first entry of the run."""
+    for prev, entry in zip(run, run[1:]):
+        delta_ms = (entry.ms - prev.ms) & 0xFFFFFFFF
+        delta_us = ((entry.cycles - prev.cycles) & 0xFFFFFFFF) / float(mhz)
+        if delta_ms > CYCLES_MAX_MS or abs(delta_us / 1000.0 - delta_ms) > CYCLES_TOLERANCE_MS:
+            delta_us = delta_ms * 1000.0
+        entry.time_us = prev.time_us + delta_us
+
+
+def describe(entry):
+    text = entry.name
+    if entry.id == TRACE_GATT and entry.name == "GATT_ATTRIBUTE_REQUEST_EVT":
+        text += " %s" % ATT_OPCODES.get(entry.arg, "0x%02X" % entry.arg)
+        if entry.handle:
+            text += " handle 0x%04X" % entry.handle
+    elif entry.id == TRACE_GATT and entry.name == "GATT_CONNECTION_STATUS_EVT":
+        text += " connected" if entry.arg else " disconnected"
+    elif entry.id == TRACE_WRITE:
+        text += " handle 0x%04X len %d" % (entry.handle, entry.arg)
+    elif entry.id == TRACE_BOOT:
+        text += " reset reason 0x%04X" % entry.arg
+    elif entry.id > TRACE_WRITE:
+        text += " type %d page 0x%04X len %d" % (entry.code, entry.handle, entry.arg)
+    else:
+        text += " %d" % entry.arg
+    if entry.conn_id:
+        text += " [conn %d]" % entry.conn_id
+    return text
+
+
+def phases(run, latencies):
+    """Adds the latency of each phase found in the run to latencies."""
+    adv_on = None
+    connections = {}
+    for entry in run:
+        if entry.id == TRACE_BTM and entry.name == "BTM_BLE_ADVERT_STATE_CHANGED_EVT":
+            if entry.arg and adv_on is None:
+                adv_on = entry.time_us
+                if not latencies[PHASES[0]] and run[0].id == TRACE_BOOT:
+                    latencies[PHASES[0]].append(adv_on - run[0].time_us)
+            elif not entry.arg:
+                adv_on = None
+        elif entry.id == TRACE_GATT and entry.name == "GATT_CONNECTION_STATUS_EVT":
+            if entry.arg:
+                if adv_on is not None:
+                    latencies[PHASES[1]].append(entry.time_us - adv_on)
+                connections[entry.conn_id] = {"start": entry.time_us, "seen": set()}
+            elif entry.conn_id in connections:
+                conn = connections.pop(entry.conn_id)
+                latencies[PHASES[5]].append(entry.time_us - conn["start"])
+        else:
+            phase = None
+            targets = []
+            if entry.id == TRACE_GATT and entry.name == "GATT_ATTRIBUTE_REQUEST_EVT" \
+                    and entry.arg == ATT_MTU:
+                phase = PHASES[2]
+                targets = [entry.conn_id]
+            elif entry.id == TRACE_BTM and entry.name == "BTM_ENCRYPTION_STATUS_EVT":
+                # Management events carry no connection ID
+                phase = PHASES[3]
+                targets = list(connections)
+            elif entry.id == TRACE_WRITE:
+                phase = PHASES[4]
+                targets = [entry.conn_id]
+            for conn_id in targets:
+                conn = connections.get(conn_id)
+                if conn is not None and phase not in conn["seen"]:
+                    conn["seen"].add(phase)
+                    latencies[phase].append(entry.time_us - conn["start"])
+                    break
+
+
+def main(argv):
+    if len(argv) not in (1, 2):
+        print(__doc__.strip())
+        return 2
+
+    if len(argv) == 2:
+        with open(argv[1], errors="replace") as capture:
+            dump = last_dump(capture)
+    else:
+        dump = last_dump(sys.stdin)
+    if dump is None:
+        print("No complete TRC-HDR ... TRC-END dump found")
+        return 1
+
+    mhz, entries = dump
+    for number, run in enumerate(split_runs(entries), 1):
+        timestamp(run, mhz)
+        latencies = dict((phase, []) for phase in PHASES)
+        phases(run, latencies)
+
+        print("Run %d: %d entries" % (number, len(run)))
+        prev = 0.0
+        for entry in run:
+            print("  %12.3f ms  %+10.3f ms  %s" % (entry.time_us / 1000.0,
+                                                   (entry.time_us - prev) / 1000.0,
+                                                   describe(entry)))
+            prev = entry.time_us
+        print("  Phase latencies (ms):")
+        for phase in PHASES:
+            values = latencies[phase]
+            if values:
+                print("    %-24s n=%-3d min %10.3f  avg %10.3f  max %10.3f" % (
+                    phase, len(values), min(values) / 1000.0,
+                    sum(values) / len(values) / 1000.0, max(values) / 1000.0))
+            else:
+                print("    %-24s -" % phase)
+        print("")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
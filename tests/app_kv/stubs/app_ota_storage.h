@@ -0,0 +1,2 @@
+/* Host stub, see test_stubs.h */
+#include "test_stubs.h"
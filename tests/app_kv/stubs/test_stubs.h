@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * File Name: test_stubs.h
+ *
+ * Description: Host stand-ins for the FreeRTOS, OTA flash and logging APIs
+ *              that app_kv.c uses. Every stub header in this directory
+ *              includes this one.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************/
+
+#ifndef TEST_STUBS_H_
+#define TEST_STUBS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* cy_result.h */
+typedef uint32_t cy_rslt_t;
+#define CY_RSLT_SUCCESS                 (0u)
+#define CY_RSLT_TYPE_ERROR              (2u)
+#define CY_RSLT_MODULE_MIDDLEWARE_BASE  (0x0A00u)
+#define CY_RSLT_CREATE(type, module, code) \
+    ((((module) & 0x3FFFu) << 18) | (((type) & 0x3u) << 16) | ((code) & 0xFFFFu))
+#define CY_STATIC_ASSERT(cond, msg)     _Static_assert(cond, msg)
+
+/* FreeRTOS: one task, so the mutex never blocks */
+typedef void *SemaphoreHandle_t;
+typedef void *EventGroupHandle_t;
+typedef void *TaskHandle_t;
+typedef uint32_t EventBits_t;
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+
+#define pdFALSE                         (0)
+#define pdTRUE                          (1)
+#define pdPASS                          (1)
+#define portMAX_DELAY                   (0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms)               ((TickType_t)(ms))
+#define tskIDLE_PRIORITY                (0)
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)1;
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    return pdTRUE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pdTRUE;
+}
+
+EventBits_t test_event_bits;
+
+static inline EventGroupHandle_t xEventGroupCreate(void)
+{
+    return (EventGroupHandle_t)1;
+}
+
+static inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    return test_event_bits |= bits;
+}
+
+static inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                              BaseType_t clear, BaseType_t all, TickType_t ticks)
+{
+    return test_event_bits;
+}
+
+/* The test runs the task body itself, see test_app_kv.c */
+BaseType_t xTaskCreate(void (*fn)(void *), const char *p_name, uint32_t stack,
+                       void *arg, uint32_t prio, TaskHandle_t *p_handle);
+void       xTaskNotifyGive(TaskHandle_t task);
+uint32_t   ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+void       vTaskDelete(TaskHandle_t task);
+
+/* cy_ota_flash.h: the external flash is a RAM array */
+typedef enum
+{
+    CY_OTA_MEM_TYPE_EXTERNAL_FLASH,
+} cy_ota_mem_type_t;
+
+cy_rslt_t cy_ota_mem_read(cy_ota_mem_type_t type, uint32_t addr, void *p_data, uint32_t len);
+cy_rslt_t cy_ota_mem_write(cy_ota_mem_type_t type, uint32_t addr, void *p_data, uint32_t len);
+cy_rslt_t cy_ota_mem_erase(cy_ota_mem_type_t type, uint32_t addr, uint32_t len);
+
+/* app_ota_storage.h, app_monitor.h */
+#define app_ota_storage_wait(ms)        (CY_RSLT_SUCCESS)
+#define app_monitor_task_size(name, size)
+
+/* app_log.h */
+#define APP_LOG_INFO(...)
+#define APP_LOG_WARNING(...)            printf(__VA_ARGS__)
+#define APP_LOG_ERR(...)                printf(__VA_ARGS__)
+#define app_log_cycles()                (0u)
+uint32_t SystemCoreClock;
+
+#endif /* TEST_STUBS_H_ */
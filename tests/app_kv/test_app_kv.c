@@ -0,0 +1,268 @@
+/*******************************************************************************
+ * File Name: test_app_kv.c
+ *
+ * Description: Host test of the key-value store. Builds app_kv.c unchanged
+ *              against the stubs in ./stubs, with the external flash held
+ *              in a RAM array that only clears bits on a write, and checks
+ *              every key against a model through random sets, deletes,
+ *              compactions and reboots.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************/
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The store under test, statics included */
+#include "../../app_storage/app_kv.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_OPS                        (20000u)
+#define TEST_REBOOT_EVERY               (997u)
+#define TEST_DELETE_ONE_IN              (8)
+#define TEST_SEED                       (1u)
+
+#define TEST_CHECK(cond, ...)                                   \
+    do                                                          \
+    {                                                           \
+        if (!(cond))                                            \
+        {                                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            exit(1);                                            \
+        }                                                       \
+    } while (0)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static uint8_t      test_flash[APP_KV_FLASH_OFFSET + APP_KV_SECTOR_COUNT * APP_KV_SECTOR_SIZE];
+static void       (*test_task_fn)(void *);
+static bool         test_notified;
+static jmp_buf      test_task_exit;
+
+/* What the store should hold: len 0 is a missing key */
+static uint8_t      test_model_len[APP_KV_MAX_KEYS + 1u];
+static uint8_t      test_model_val[APP_KV_MAX_KEYS + 1u][APP_KV_VALUE_MAX];
+
+/*******************************************************************************
+*        Stubs
+*******************************************************************************/
+cy_rslt_t cy_ota_mem_read(cy_ota_mem_type_t type, uint32_t addr, void *p_data, uint32_t len)
+{
+    (void)type;
+    TEST_CHECK(addr + len <= sizeof(test_flash), "read past the end at 0x%lx", (unsigned long)addr);
+    memcpy(p_data, &test_flash[addr], len);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_ota_mem_write(cy_ota_mem_type_t type, uint32_t addr, void *p_data, uint32_t len)
+{
+    const uint8_t *p_src = p_data;
+
+    (void)type;
+    TEST_CHECK(addr >= APP_KV_FLASH_OFFSET, "write outside the store at 0x%lx", (unsigned long)addr);
+    TEST_CHECK(addr + len <= sizeof(test_flash), "write past the end at 0x%lx", (unsigned long)addr);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        /* NOR flash only clears bits, a rewrite without an erase shows up here */
+        TEST_CHECK((test_flash[addr + i] & p_src[i]) == p_src[i],
+                   "write over programmed flash at 0x%lx", (unsigned long)(addr + i));
+        test_flash[addr + i] &= p_src[i];
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_ota_mem_erase(cy_ota_mem_type_t type, uint32_t addr, uint32_t len)
+{
+    (void)type;
+    TEST_CHECK((addr >= APP_KV_FLASH_OFFSET) && (0u == (addr % APP_KV_SECTOR_SIZE)) &&
+               (0u == (len % APP_KV_SECTOR_SIZE)) && (addr + len <= sizeof(test_flash)),
+               "bad erase 0x%lx + %lu", (unsigned long)addr, (unsigned long)len);
+    memset(&test_flash[addr], 0xFF, len);
+    return CY_RSLT_SUCCESS;
+}
+
+BaseType_t xTaskCreate(void (*fn)(void *), const char *p_name, uint32_t stack,
+                       void *arg, uint32_t prio, TaskHandle_t *p_handle)
+{
+    (void)p_name;
+    (void)stack;
+    (void)arg;
+    (void)prio;
+    test_task_fn = fn;
+    *p_handle = (TaskHandle_t)1;
+    return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    test_notified = true;
+}
+
+/* The task blocks here between compactions: return to the test instead */
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    (void)clear;
+    (void)ticks;
+    longjmp(test_task_exit, 1);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+    TEST_CHECK(false, "store task deleted");
+}
+
+/*******************************************************************************
+*        Helpers
+*******************************************************************************/
+/* Runs the store task until it waits for the next notification */
+static void test_run_task(void)
+{
+    if (0 == setjmp(test_task_exit))
+    {
+        test_task_fn(NULL);
+    }
+}
+
+/* Drops the RAM state, as a reset does, and loads the store from flash */
+static void test_reboot(void)
+{
+    memset(app_kv_index, 0, sizeof(app_kv_index));
+    memset(app_kv_seq, 0, sizeof(app_kv_seq));
+    memset(app_kv_live, 0, sizeof(app_kv_live));
+    app_kv_keys = 0;
+    app_kv_head = 0;
+    app_kv_wr = 0;
+    app_kv_max_seq = 0;
+    test_event_bits = 0;
+    test_notified = false;
+
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_start(NULL), "start failed");
+    test_run_task();
+}
+
+static void test_check_model(uint32_t op)
+{
+    uint8_t value[APP_KV_VALUE_MAX];
+    uint8_t len = 0;
+
+    for (uint16_t key = 1; key <= APP_KV_MAX_KEYS; key++)
+    {
+        cy_rslt_t result = app_kv_get(key, value, sizeof(value), &len);
+        if (0u == test_model_len[key])
+        {
+            TEST_CHECK(APP_KV_RSLT_NOT_FOUND == result, "op %lu: key %u not deleted",
+                       (unsigned long)op, key);
+        }
+        else
+        {
+            TEST_CHECK(CY_RSLT_SUCCESS == result, "op %lu: key %u lost (0x%lx)",
+                       (unsigned long)op, key, (unsigned long)result);
+            TEST_CHECK((len == test_model_len[key]) &&
+                       (0 == memcmp(value, test_model_val[key], len)),
+                       "op %lu: key %u has the wrong value", (unsigned long)op, key);
+        }
+    }
+}
+
+/*******************************************************************************
+*        Tests
+*******************************************************************************/
+static void test_basic(void)
+{
+    uint8_t value[APP_KV_VALUE_MAX];
+    uint8_t big[APP_KV_VALUE_MAX + 1u] = { 0 };
+    uint8_t len = 0;
+
+    TEST_CHECK(APP_KV_RSLT_NOT_FOUND == app_kv_get(1, value, sizeof(value), &len), "empty get");
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_set(1, "abc", 3), "set");
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_get(1, value, sizeof(value), &len), "get");
+    TEST_CHECK((3u == len) && (0 == memcmp(value, "abc", 3)), "get value");
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_set(1, "de", 2), "overwrite");
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_get(1, value, sizeof(value), &len), "get overwritten");
+    TEST_CHECK((2u == len) && (0 == memcmp(value, "de", 2)), "overwritten value");
+    TEST_CHECK(APP_KV_RSLT_BAD_ARG == app_kv_set(2, big, sizeof(big)), "value too long");
+
+    test_reboot();
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_get(1, value, sizeof(value), &len), "get after reboot");
+    TEST_CHECK((2u == len) && (0 == memcmp(value, "de", 2)), "value after reboot");
+
+    TEST_CHECK(CY_RSLT_SUCCESS == app_kv_delete(1), "delete");
+    TEST_CHECK(APP_KV_RSLT_NOT_FOUND == app_kv_get(1, value, sizeof(value), &len), "deleted get");
+    test_reboot();
+    TEST_CHECK(APP_KV_RSLT_NOT_FOUND == app_kv_get(1, value, sizeof(value), &len),
+               "deleted get after reboot");
+}
+
+static void test_random(void)
+{
+    uint8_t value[APP_KV_VALUE_MAX];
+    app_kv_stats_t stats;
+
+    srand(TEST_SEED);
+    for (uint32_t op = 0; op < TEST_OPS; op++)
+    {
+        uint16_t key = (uint16_t)(1 + (rand() % APP_KV_MAX_KEYS));
+
+        if (0 == (rand() % TEST_DELETE_ONE_IN))
+        {
+            cy_rslt_t result = app_kv_delete(key);
+            TEST_CHECK((CY_RSLT_SUCCESS == result) || (APP_KV_RSLT_NOT_FOUND == result),
+                       "op %lu: delete failed (0x%lx)", (unsigned long)op, (unsigned long)result);
+            test_model_len[key] = 0;
+        }
+        else
+        {
+            uint8_t len = (uint8_t)(1 + (rand() % APP_KV_VALUE_MAX));
+            for (uint8_t i = 0; i < len; i++)
+            {
+                value[i] = (uint8_t)rand();
+            }
+            cy_rslt_t result = app_kv_set(key, value, len);
+            TEST_CHECK(CY_RSLT_SUCCESS == result, "op %lu: set failed (0x%lx)",
+                       (unsigned long)op, (unsigned long)result);
+            test_model_len[key] = len;
+            memcpy(test_model_val[key], value, len);
+        }
+
+        if (test_notified)
+        {
+            test_notified = false;
+            test_run_task();
+        }
+        if ((TEST_REBOOT_EVERY - 1u) == (op % TEST_REBOOT_EVERY))
+        {
+            test_reboot();
+        }
+        test_check_model(op);
+    }
+
+    app_kv_get_stats(&stats);
+    TEST_CHECK(stats.erases > 0u, "no compaction ran");
+    printf("%u ops: user %lu B, flash %lu B (compaction %lu B), %lu erases, "
+           "write amplification %.2f, %.2f probes per lookup\n",
+           TEST_OPS, (unsigned long)stats.user_bytes, (unsigned long)stats.flash_bytes,
+           (unsigned long)stats.compact_bytes, (unsigned long)stats.erases,
+           (double)stats.flash_bytes / (double)stats.user_bytes,
+           (double)stats.lookup_probes / (double)stats.lookups);
+}
+
+int main(void)
+{
+    memset(test_flash, 0xFF, sizeof(test_flash));
+    test_reboot();
+
+    test_basic();
+    test_random();
+
+    printf("PASS\n");
+    return 0;
+}